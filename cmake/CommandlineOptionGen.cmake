@@ -0,0 +1,27 @@
+# commandline_option_gen(<target> <spec.json> [OUTPUT <base>])
+#
+# Run commandline-optgen on spec and add the generated <base>.h and <base>.cc
+# to target. base defaults to the spec's name without its extension; the
+# files are written under the target's binary directory, which is added to
+# its include path so sources can include "<base>.h".
+function(commandline_option_gen TARGET SPEC)
+  cmake_parse_arguments(ARG "" "OUTPUT" "" ${ARGN})
+  get_filename_component(SPEC_PATH ${SPEC} ABSOLUTE)
+  if (ARG_OUTPUT)
+    set(BASE ${ARG_OUTPUT})
+  else()
+    get_filename_component(BASE ${SPEC} NAME_WE)
+  endif()
+
+  set(OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.optgen)
+  add_custom_command(
+    OUTPUT ${OUTPUT_DIR}/${BASE}.h ${OUTPUT_DIR}/${BASE}.cc
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${OUTPUT_DIR}
+    COMMAND commandline-optgen ${SPEC_PATH} -o ${OUTPUT_DIR}/${BASE}
+    DEPENDS commandline-optgen ${SPEC_PATH}
+    COMMENT "Generating options from ${SPEC}"
+    VERBATIM)
+  target_sources(${TARGET} PRIVATE ${OUTPUT_DIR}/${BASE}.h
+                                   ${OUTPUT_DIR}/${BASE}.cc)
+  target_include_directories(${TARGET} PRIVATE ${OUTPUT_DIR})
+endfunction()
@@ -25,11 +25,12 @@ class alias : public Option {
 
   // Handle printing stuff...
   size_t getOptionWidth() const override;
-  void printOptionInfo(size_t GlobalWidth) const override;
+  void printOptionInfo(size_t GlobalWidth,
+                       llvm::raw_ostream& OS) const override;
 
   // Aliases do not need to print their values.
-  void printOptionValue(size_t /*GlobalWidth*/, bool /*Force*/) const override {
-  }
+  void printOptionValue(size_t /*GlobalWidth*/, bool /*Force*/,
+                        llvm::raw_ostream& /*OS*/) const override {}
 
   void setDefault() override { AliasFor->setDefault(); }
 
@@ -37,6 +38,12 @@ class alias : public Option {
     return AliasFor->getValueExpectedFlag();
   }
 
+  const generic_parser_base* getGenericParser() const override {
+    return AliasFor->getGenericParser();
+  }
+
+  const Option* getAliasTarget() const override { return AliasFor; }
+
   void done() {
     if (!hasArgStr())
       error("cl::alias must have argument name specified!");
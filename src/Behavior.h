@@ -1,6 +1,9 @@
 #ifndef COMMANDLINE_BEHAVIOR_H
 #define COMMANDLINE_BEHAVIOR_H
 
+#include <type_traits>
+#include <utility>
+
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
@@ -89,6 +92,60 @@ auto location(Ty& l) -> LocationClass<Ty> {
   return LocationClass<Ty>(l);
 }
 
+// The config object that field(&Config::Member) binds options into. It is
+// created on first use, so options in any translation unit can bind to it
+// during static initialization. After parsing, the whole configuration can be
+// read from it or copied out as a snapshot.
+template <class Config>
+auto getConfig() -> Config& {
+  static Config object;
+  return object;
+}
+
+namespace detail {
+// True if Opt binds fields with setFieldLocation rather than setLocation.
+template <class Opt, class Ty, class = void>
+struct has_field_location : std::false_type {};
+
+template <class Opt, class Ty>
+struct has_field_location<
+    Opt, Ty,
+    std::void_t<decltype(std::declval<Opt&>().setFieldLocation(
+        std::declval<Option&>(), std::declval<Ty&>()))>> : std::true_type {};
+}  // namespace detail
+
+// Store the value of an option with external storage in a member of a config
+// object, as location does for a variable. The member's value when the option
+// is created becomes the option's default, so setDefault and
+// printOptionValue work per field. For a list the member's elements are the
+// defaults: the first occurrence replaces them and setDefault restores them.
+template <class Config, class Ty>
+struct FieldClass {
+  Config& Object;
+  Ty Config::*Member;
+
+  FieldClass(Config& object, Ty Config::*member)
+      : Object(object), Member(member) {}
+
+  template <class Opt>
+  void apply(Opt& o) const {
+    if constexpr (detail::has_field_location<Opt, Ty>::value)
+      o.setFieldLocation(o, Object.*Member);
+    else
+      o.setLocation(o, Object.*Member);
+  }
+};
+
+template <class Config, class Ty>
+auto field(Ty Config::*member) -> FieldClass<Config, Ty> {
+  return FieldClass<Config, Ty>(getConfig<Config>(), member);
+}
+
+template <class Config, class Ty>
+auto field(Config& object, Ty Config::*member) -> FieldClass<Config, Ty> {
+  return FieldClass<Config, Ty>(object, member);
+}
+
 // Specify the Option category for the command line argument to belong to.
 struct cat {
   OptionCategory& Category;
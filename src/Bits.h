@@ -2,6 +2,9 @@
 #define COMMANDLINE_BITS_H
 
 #include "Option.h"
+#include "OptionSchema.h"
+#include "OptionState.h"
+#include "ParseStats.h"
 #include "Parser.h"
 
 #include <cassert>
@@ -15,7 +18,7 @@ namespace Commandline {
 // cl::location(x) modifier.
 //
 template <class DataType, class StorageClass>
-class bits_storage {
+class bits_storage : public OptionStorageWrites {
   unsigned* Location = nullptr;  // Where to store the bits...
 
   template <class T>
@@ -45,6 +48,8 @@ class bits_storage {
   }
 
   unsigned getBits() { return *Location; }
+  unsigned getBits() const { return *Location; }
+  void setBits(unsigned B) { *Location = B; }
 
   void clear() {
     if (Location)
@@ -61,7 +66,7 @@ class bits_storage {
 // This makes us exactly compatible with the bits in all cases that it is used.
 //
 template <class DataType>
-class bits_storage<DataType, bool> {
+class bits_storage<DataType, bool> : public OptionStorageWrites {
   unsigned Bits{0};  // Where to store the bits...
 
   template <class T>
@@ -75,12 +80,21 @@ class bits_storage<DataType, bool> {
  public:
   template <class T>
   void addValue(const T& V) {
+    noteValueWrite();
     Bits |= Bit(V);
   }
 
   unsigned getBits() { return Bits; }
+  unsigned getBits() const { return Bits; }
+  void setBits(unsigned B) {
+    noteValueWrite();
+    Bits = B;
+  }
 
-  void clear() { Bits = 0; }
+  void clear() {
+    noteValueWrite();
+    Bits = 0;
+  }
 
   template <class T>
   bool isSet(const T& V) {
@@ -96,6 +110,7 @@ template <class DataType, class Storage = bool,
 class bits : public Option, public bits_storage<DataType, Storage> {
   std::vector<unsigned> Positions;
   ParserClass Parser;
+  bool HasCallback = false;  // Was setCallback called?
 
   enum ValueExpected getValueExpectedFlagDefault() const override {
     return Parser.getValueExpectedFlagDefault();
@@ -105,11 +120,20 @@ class bits : public Option, public bits_storage<DataType, Storage> {
     return Parser.getExtraOptionNames(OptionNames);
   }
 
+  const generic_parser_base* getGenericParser() const override {
+    if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>)
+      return &Parser;
+    else
+      return nullptr;
+  }
+
   bool handleOccurrence(unsigned pos, llvm::StringRef ArgName,
                         llvm::StringRef Arg) override {
     typename ParserClass::parser_data_type Val =
         typename ParserClass::parser_data_type();
-    if (Parser.parse(*this, ArgName, Arg, Val))
+    if (ParsePhaseTimer Timer(ParsePhase::ValueParsing,
+                              schemaTypeName<ParserClass>());
+        Parser.parse(*this, ArgName, Arg, Val))
       return true;  // Parse Error!
     this->addValue(Val);
     setPosition(pos);
@@ -123,19 +147,97 @@ class bits : public Option, public bits_storage<DataType, Storage> {
     return Parser.getOptionWidth(*this);
   }
 
-  void printOptionInfo(size_t GlobalWidth) const override {
-    Parser.printOptionInfo(*this, GlobalWidth);
+  void printOptionInfo(size_t GlobalWidth,
+                       llvm::raw_ostream& OS) const override {
+    Parser.printOptionInfo(*this, GlobalWidth, OS);
+  }
+
+  // Call F with the literal name of each value whose bit is set.
+  template <class Fn>
+  void forEachSetLiteral(Fn F) const {
+    if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>) {
+      unsigned Set = bits_storage<DataType, Storage>::getBits();
+      for (unsigned i = 0, e = Parser.getNumOptions(); i != e; ++i) {
+        const auto& Val =
+            static_cast<const OptionValue<DataType>&>(Parser.getOptionValue(i));
+        unsigned BitPos = static_cast<unsigned>(Val.getValue());
+        if (BitPos < sizeof(unsigned) * CHAR_BIT && (Set & (1u << BitPos)))
+          F(Parser.getOption(i));
+      }
+    }
+  }
+
+  void printOptionValue(size_t GlobalWidth, bool Force,
+                        llvm::raw_ostream& OS) const override {
+    if (!Force && !valueDiffersFromDefault())
+      return;
+    llvm::SmallVector<std::string, 4> Values;
+    getValueTexts(Values);
+    printListOptionDiff(*this, Values, {}, GlobalWidth, OS);
+  }
+
+  bool valueDiffersFromDefault() const override {
+    return bits_storage<DataType, Storage>::getBits() != 0;
+  }
+
+  bool getValueTexts(llvm::SmallVectorImpl<std::string>& Texts) const override {
+    forEachSetLiteral(
+        [&](llvm::StringRef Name) { Texts.push_back(Name.str()); });
+    return true;
+  }
+
+  void writeValueJSON(llvm::json::OStream& json) const override {
+    json.array([&] {
+      forEachSetLiteral([&](llvm::StringRef Name) { json.value(Name); });
+    });
+  }
+
+  std::string getStateLayout() const override { return "bits:i4"; }
+
+  void saveValue(llvm::SmallVectorImpl<char>& Out) const override {
+    writeStateValue(Out, bits_storage<DataType, Storage>::getBits());
+    writeStateValue(Out, static_cast<uint32_t>(Positions.size()));
+    for (unsigned Pos : Positions)
+      writeStateValue(Out, static_cast<uint32_t>(Pos));
+  }
+
+  bool loadValue(llvm::StringRef& Data) override {
+    unsigned Set = 0;
+    uint32_t Size = 0;
+    if (!readStateValue(Data, Set) || !readStateValue(Data, Size))
+      return false;
+    Positions.clear();
+    for (uint32_t i = 0; i != Size; ++i) {
+      uint32_t Pos = 0;
+      if (!readStateValue(Data, Pos))
+        return false;
+      Positions.push_back(Pos);
+    }
+    bits_storage<DataType, Storage>::setBits(Set);
+    return true;
   }
 
-  // Unimplemented: bits options don't currently store their default values.
-  void printOptionValue(size_t /*GlobalWidth*/, bool /*Force*/) const override {
+  // Bits always start out empty.
+  void writeValueSchema(llvm::json::OStream& json) const override {
+    json.attribute("kind", "bits");
+    json.attribute("type", schemaTypeName<ParserClass>());
+    json.attributeArray("default", [] {});
   }
 
-  void setDefault() override { bits_storage<DataType, Storage>::clear(); }
+  void setDefault() override {
+    bits_storage<DataType, Storage>::clear();
+    if constexpr (!std::is_same_v<Storage, bool>)
+      markValueTouched();
+    else
+      clearValueTouched();
+  }
 
   void done() {
-    addArgument();
     Parser.initialize();
+    if constexpr (!std::is_same_v<Storage, bool>)
+      markValueTouched();
+    // Last, so that the option is complete when another thread sees it.
+    addArgument();
   }
 
  public:
@@ -153,6 +255,7 @@ class bits : public Option, public bits_storage<DataType, Storage> {
   template <class... Mods>
   explicit bits(const Mods&... Ms)
       : Option(ZeroOrMore, NotHidden), Parser(*this) {
+    this->bindStorageOwner(*this);
     apply(this, Ms...);
     done();
   }
@@ -160,8 +263,11 @@ class bits : public Option, public bits_storage<DataType, Storage> {
   void setCallback(
       std::function<void(const typename ParserClass::parser_data_type&)> CB) {
     Callback = CB;
+    HasCallback = true;
   }
 
+  bool hasCallback() const override { return HasCallback; }
+
   std::function<void(const typename ParserClass::parser_data_type&)> Callback =
       [](const typename ParserClass::parser_data_type&) {};
 };
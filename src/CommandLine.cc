@@ -19,6 +19,8 @@
 
 #include "llvm-c/Support.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
@@ -27,8 +29,10 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
@@ -38,11 +42,18 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
 using namespace Commandline;
+using namespace llvm;
+namespace cl = Commandline;
 
 #define DEBUG_TYPE "commandline"
 
@@ -136,6 +147,40 @@ raw_ostream &operator<<(raw_ostream &OS, const PrintArg& Arg) {
   return OS;
 }
 
+// A registration waiting to be applied to the registry. Option
+// constructors, categories, subcommands and literal options queue their
+// registrations on a lock-free stack, so they may run on any thread, e.g.
+// from shared libraries loaded concurrently. The thread that next parses or
+// queries the registry applies them in order.
+struct PendingRegistration {
+  enum KindTy { Options, LiteralName, Category, Sub, MoreHelp } Kind;
+  SmallVector<Option *, 1> Opts;
+  Option *Opt = nullptr;
+  StringRef Name;
+  OptionCategory *Cat = nullptr;
+  SubCommand *SC = nullptr;
+  PendingRegistration *Next = nullptr;
+
+  explicit PendingRegistration(KindTy Kind) : Kind(Kind) {}
+};
+
+// Constant-initialized, so registrations made during static initialization
+// in any translation unit can use it.
+std::atomic<PendingRegistration *> PendingRegistrations{nullptr};
+
+void queueRegistration(PendingRegistration *R) {
+  R->Next = PendingRegistrations.load(std::memory_order_relaxed);
+  while (!PendingRegistrations.compare_exchange_weak(
+      R->Next, R, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+// The innermost registration_scope active on this thread.
+thread_local registration_scope *ActiveScope = nullptr;
+
+// The walks over the registry tables in progress on this thread.
+thread_local unsigned WalksOnThisThread = 0;
+
 class CommandLineParser {
 public:
   // Globals for name and overview of program.  Program name is not a string to
@@ -157,6 +202,82 @@ public:
   // This collects the different subcommands that have been registered.
   SmallPtrSet<SubCommand *, 4> RegisteredSubCommands;
 
+  // Bumped whenever anything that shows up in the help output changes: options,
+  // literal values, categories, subcommands, the program name and overview, or
+  // the extra help. Data derived from the registry (e.g. rendered help) is
+  // stamped with the generation it was built against.
+  std::atomic<uint64_t> RegistryGeneration{0};
+
+  // The number of walks over the tables in progress on any thread:
+  // ParseCommandLineOptions, ResetAllOptionOccurrences and printing help or
+  // option values. Registrations queued meanwhile, by the walking thread or
+  // by another one looking an option up, are applied after the last walk
+  // ends, so the tables do not change under a walk, e.g. when resetting a
+  // DefaultOption removes it. Guarded by MergeLock.
+  unsigned Walkers = 0;
+
+  // The number of ChangingTables waiting for walks on other threads to end.
+  // Guarded by MergeLock.
+  unsigned WaitingChanges = 0;
+
+  // Counts a walk for its lifetime. Starting one waits for a merge or a
+  // change in progress to finish, unless this thread is walking already.
+  class WalkingTables {
+    CommandLineParser &Parser;
+
+  public:
+    explicit WalkingTables(CommandLineParser &P) : Parser(P) {
+      std::unique_lock<std::mutex> Guard(P.MergeLock);
+      if (!WalksOnThisThread)
+        P.TablesReleased.wait(Guard, [&P] { return !P.WaitingChanges; });
+      ++P.Walkers;
+      ++WalksOnThisThread;
+    }
+    ~WalkingTables() {
+      --WalksOnThisThread;
+      {
+        std::lock_guard<std::mutex> Guard(Parser.MergeLock);
+        --Parser.Walkers;
+      }
+      Parser.TablesReleased.notify_all();
+    }
+  };
+
+  // Held while removing or renaming registrations. Waits for the walks on
+  // other threads to end and keeps new ones from starting; this thread's own
+  // walks go on, as when resetting a DefaultOption removes it. Two threads
+  // must not both change the tables during their own walks.
+  //
+  // Registrations still queued are applied first, unless this thread is
+  // walking. Then they stay queued, and the change cancels those of what it
+  // removes; see forEachQueued.
+  class ChangingTables {
+    CommandLineParser &Parser;
+    std::unique_lock<std::mutex> Guard;
+
+  public:
+    explicit ChangingTables(CommandLineParser &P)
+        : Parser(P), Guard(P.MergeLock) {
+      ++P.WaitingChanges;
+      P.TablesReleased.wait(
+          Guard, [&P] { return P.Walkers == WalksOnThisThread; });
+      --P.WaitingChanges;
+      if (!P.Walkers)
+        P.applyQueuedRegistrations();
+    }
+    ~ChangingTables() {
+      Guard.unlock();
+      Parser.TablesReleased.notify_all();
+    }
+  };
+
+  // Serializes applying queued registrations and changing the tables, and
+  // starting walks with either.
+  std::mutex MergeLock;
+
+  // Signalled when a walk ends or a change finishes.
+  std::condition_variable TablesReleased;
+
   CommandLineParser() {
     registerSubCommand(&SubCommand::getTopLevel());
     registerSubCommand(&SubCommand::getAll());
@@ -164,13 +285,109 @@ public:
 
   void ResetAllOptionOccurrences();
 
+  /// \param Origins the origin of each of argv, or empty if they are all
+  /// from the command line.
   bool ParseCommandLineOptions(int argc, const char *const *argv,
                                StringRef Overview, raw_ostream *Errs = nullptr,
-                               bool LongOptionsUseDoubleDash = false);
+                               bool LongOptionsUseDoubleDash = false,
+                               ArrayRef<ValueOrigin> Origins = {});
+
+  uint64_t getRegistryGeneration() {
+    mergePendingRegistrations();
+    return RegistryGeneration.load(std::memory_order_relaxed);
+  }
+  void noteRegistryChange() {
+    RegistryGeneration.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Apply the registrations queued by any thread, in the order they were
+  // queued.
+  void mergePendingRegistrations() {
+    if (!PendingRegistrations.load(std::memory_order_acquire))
+      return;
+    std::lock_guard<std::mutex> Guard(MergeLock);
+    if (Walkers)
+      return;
+    applyQueuedRegistrations();
+  }
+
+  // Call F on each registration still queued. Entries are only applied or
+  // freed under MergeLock, which the caller holds, so F may edit them: a
+  // change cancels registrations of what it removes by dropping them from
+  // Opts or clearing Opt, Cat or SC.
+  template <typename Fn> void forEachQueued(Fn F) {
+    for (PendingRegistration *R =
+             PendingRegistrations.load(std::memory_order_acquire);
+         R; R = R->Next)
+      F(*R);
+  }
+
+  // Cancel the queued registrations of Removed and of their literal names.
+  // Requires MergeLock.
+  void cancelQueuedOptions(const SmallPtrSetImpl<Option *> &Removed) {
+    forEachQueued([&](PendingRegistration &R) {
+      erase_if(R.Opts, [&](Option *O) { return Removed.count(O) != 0; });
+      if (R.Opt && Removed.count(R.Opt))
+        R.Opt = nullptr;
+    });
+  }
+
+  // Apply the queued registrations. Requires MergeLock and no walks in
+  // progress.
+  void applyQueuedRegistrations() {
+    PendingRegistration *Head =
+        PendingRegistrations.exchange(nullptr, std::memory_order_acquire);
+    // The stack holds the latest registration first.
+    PendingRegistration *Ordered = nullptr;
+    while (Head) {
+      PendingRegistration *Next = Head->Next;
+      Head->Next = Ordered;
+      Ordered = Head;
+      Head = Next;
+    }
+    while (Ordered) {
+      std::unique_ptr<PendingRegistration> R(Ordered);
+      Ordered = R->Next;
+      switch (R->Kind) {
+      case PendingRegistration::Options:
+        for (Option *O : R->Opts)
+          addOption(O);
+        break;
+      case PendingRegistration::LiteralName:
+        if (R->Opt)
+          addLiteralOption(*R->Opt, R->Name);
+        break;
+      case PendingRegistration::Category:
+        if (R->Cat)
+          registerCategory(R->Cat);
+        break;
+      case PendingRegistration::Sub:
+        if (R->SC)
+          registerSubCommand(R->SC);
+        break;
+      case PendingRegistration::MoreHelp:
+        addMoreHelp(R->Name);
+        break;
+      }
+    }
+  }
+
+  void addMoreHelp(StringRef Help) {
+    MoreHelp.push_back(Help);
+    noteRegistryChange();
+  }
+
+  void clearMoreHelp() {
+    if (MoreHelp.empty())
+      return;
+    MoreHelp.clear();
+    noteRegistryChange();
+  }
 
   void addLiteralOption(Option &Opt, SubCommand *SC, StringRef Name) {
     if (Opt.hasArgStr())
       return;
+    noteRegistryChange();
     if (!SC->OptionsMap.insert(std::make_pair(Name, &Opt)).second) {
       errs() << ProgramName << ": CommandLine Error: Option '" << Name
              << "' registered more than once!\n";
@@ -197,11 +414,35 @@ public:
     }
   }
 
+  void removeLiteralOption(Option &Opt, StringRef Name) {
+    ChangingTables Change(*this);
+    forEachQueued([&](PendingRegistration &R) {
+      if (R.Kind == PendingRegistration::LiteralName && R.Opt == &Opt &&
+          R.Name == Name)
+        R.Opt = nullptr;
+    });
+    noteRegistryChange();
+    auto Remove = [&](SubCommand *SC) {
+      auto I = SC->OptionsMap.find(Name);
+      if (I != SC->OptionsMap.end() && I->getValue() == &Opt)
+        SC->OptionsMap.erase(I);
+    };
+    if (Opt.Subs.empty())
+      Remove(&SubCommand::getTopLevel());
+    else if (Opt.isInAllSubCommands())
+      for (auto *SC : RegisteredSubCommands)
+        Remove(SC);
+    else
+      for (auto *SC : Opt.Subs)
+        Remove(SC);
+  }
+
   void addOption(Option *O, SubCommand *SC) {
+    noteRegistryChange();
     bool HadErrors = false;
     if (O->hasArgStr()) {
       // If it's a DefaultOption, check to make sure it isn't already there.
-      if (O->isDefaultOption() && SC->OptionsMap.contains(O->ArgStr))
+      if (O->isDefaultOption() && SC->OptionsMap.count(O->ArgStr))
         return;
 
       // Add argument to the argument map!
@@ -258,6 +499,7 @@ public:
   }
 
   void removeOption(Option *O, SubCommand *SC) {
+    noteRegistryChange();
     SmallVector<StringRef, 16> OptionNames;
     O->getExtraOptionNames(OptionNames);
     if (O->hasArgStr())
@@ -291,6 +533,10 @@ public:
   }
 
   void removeOption(Option *O) {
+    ChangingTables Change(*this);
+    SmallPtrSet<Option *, 1> Removed;
+    Removed.insert(O);
+    cancelQueuedOptions(Removed);
     if (O->Subs.empty())
       removeOption(O, &SubCommand::getTopLevel());
     else {
@@ -302,6 +548,67 @@ public:
           removeOption(O, SC);
       }
     }
+    // Parses on other threads record origins and rehash values, so these go
+    // while the change holds them off.
+    O->forgetConfigHash();
+    ForgetValueOrigins(*O);
+  }
+
+  void removeOptions(ArrayRef<Option *> Opts, SubCommand *SC,
+                     const SmallPtrSetImpl<Option *> &Removed) {
+    noteRegistryChange();
+    SubCommand &Sub = *SC;
+    SmallVector<StringRef, 16> OptionNames;
+    for (Option *O : Opts) {
+      OptionNames.clear();
+      O->getExtraOptionNames(OptionNames);
+      if (O->hasArgStr())
+        OptionNames.push_back(O->ArgStr);
+      for (auto Name : OptionNames) {
+        auto I = Sub.OptionsMap.find(Name);
+        if (I != Sub.OptionsMap.end() && I->getValue() == O)
+          Sub.OptionsMap.erase(I);
+      }
+    }
+    auto IsRemoved = [&](Option *O) { return Removed.count(O) != 0; };
+    erase_if(Sub.PositionalOpts, IsRemoved);
+    erase_if(Sub.SinkOpts, IsRemoved);
+    if (Sub.ConsumeAfterOpt && IsRemoved(Sub.ConsumeAfterOpt))
+      Sub.ConsumeAfterOpt = nullptr;
+  }
+
+  void removeOptions(ArrayRef<Option *> Opts) {
+    ChangingTables Change(*this);
+    SmallPtrSet<Option *, 32> Removed(Opts.begin(), Opts.end());
+    cancelQueuedOptions(Removed);
+    // Each subcommand with the options it holds, in first-seen order.
+    SmallVector<std::pair<SubCommand *, SmallVector<Option *, 0>>, 4> BySub;
+    DenseMap<SubCommand *, unsigned> SubIndex;
+    auto Add = [&](SubCommand *SC, Option *O) {
+      auto Inserted = SubIndex.try_emplace(SC, BySub.size());
+      if (Inserted.second)
+        BySub.emplace_back(SC, SmallVector<Option *, 0>());
+      BySub[Inserted.first->second].second.push_back(O);
+    };
+    for (Option *O : Opts) {
+      if (O->Subs.empty())
+        Add(&SubCommand::getTopLevel(), O);
+      else if (O->isInAllSubCommands())
+        for (auto *SC : RegisteredSubCommands)
+          Add(SC, O);
+      else
+        for (auto *SC : O->Subs)
+          Add(SC, O);
+    }
+    for (auto &Entry : BySub)
+      removeOptions(Entry.second, Entry.first, Removed);
+    // Unlike a reset, which only takes a DefaultOption out of the
+    // subcommands until the next parse adds it again, this removal is final.
+    erase_if(DefaultOptions, [&](Option *O) { return Removed.count(O) != 0; });
+    for (Option *O : Opts) {
+      O->forgetConfigHash();
+      ForgetValueOrigins(*O);
+    }
   }
 
   bool hasOptions(const SubCommand &Sub) const {
@@ -318,8 +625,16 @@ public:
   }
 
   SubCommand *getActiveSubCommand() { return ActiveSubCommand; }
+  void setActiveSubCommand(SubCommand *Sub) { ActiveSubCommand = Sub; }
+
+  // The subcommand that help and value dumps describe: the active one, or
+  // the top level before anything was parsed.
+  SubCommand *getDescribedSubCommand() {
+    return ActiveSubCommand ? ActiveSubCommand : &SubCommand::getTopLevel();
+  }
 
   void updateArgStr(Option *O, StringRef NewName, SubCommand *SC) {
+    noteRegistryChange();
     SubCommand &Sub = *SC;
     if (!Sub.OptionsMap.insert(std::make_pair(NewName, O)).second) {
       errs() << ProgramName << ": CommandLine Error: Option '" << O->ArgStr
@@ -330,6 +645,14 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    ChangingTables Change(*this);
+    // A queued registration adds the option under its name when applied.
+    bool Queued = false;
+    forEachQueued([&](PendingRegistration &R) {
+      Queued |= is_contained(R.Opts, O);
+    });
+    if (Queued)
+      return;
     if (O->Subs.empty())
       updateArgStr(O, NewName, &SubCommand::getTopLevel());
     else {
@@ -343,7 +666,7 @@ public:
     }
   }
 
-  void printOptionValues();
+  void printOptionValues(raw_ostream &OS, OptionValuesFormat Format, bool All);
 
   void registerCategory(OptionCategory *cat) {
     assert(count_if(RegisteredOptionCategories,
@@ -353,6 +676,17 @@ public:
            "Duplicate option categories");
 
     RegisteredOptionCategories.insert(cat);
+    noteRegistryChange();
+  }
+
+  void unregisterCategory(OptionCategory *cat) {
+    ChangingTables Change(*this);
+    forEachQueued([&](PendingRegistration &R) {
+      if (R.Cat == cat)
+        R.Cat = nullptr;
+    });
+    RegisteredOptionCategories.erase(cat);
+    noteRegistryChange();
   }
 
   void registerSubCommand(SubCommand *sub) {
@@ -363,6 +697,7 @@ public:
                     }) == 0 &&
            "Duplicate subcommands");
     RegisteredSubCommands.insert(sub);
+    noteRegistryChange();
 
     // For all options that have been registered for all subcommands, add the
     // option to this subcommand now.
@@ -379,16 +714,25 @@ public:
   }
 
   void unregisterSubCommand(SubCommand *sub) {
+    ChangingTables Change(*this);
+    forEachQueued([&](PendingRegistration &R) {
+      if (R.SC == sub)
+        R.SC = nullptr;
+    });
     RegisteredSubCommands.erase(sub);
+    noteRegistryChange();
   }
 
   iterator_range<typename SmallPtrSet<SubCommand *, 4>::iterator>
   getRegisteredSubcommands() {
+    mergePendingRegistrations();
     return make_range(RegisteredSubCommands.begin(),
                       RegisteredSubCommands.end());
   }
 
   void reset() {
+    mergePendingRegistrations();
+    noteRegistryChange();
     ActiveSubCommand = nullptr;
     ProgramName.clear();
     ProgramOverview = StringRef();
@@ -423,23 +767,177 @@ private:
 
 } // namespace
 
-static ManagedStatic<CommandLineParser> GlobalParser;
+static Commandline::ManagedStatic<CommandLineParser> GlobalParser;
+
+//===----------------------------------------------------------------------===//
+// Parse diagnostics
+//
+
+// The diagnostics of the parse running on this thread, if it was started with
+// a ParseDiagnostics.
+static thread_local ParseDiagnostics *ThreadDiags = nullptr;
+
+struct cl::ParseDiagnosticsAccess {
+  static void begin(ParseDiagnostics &Diags) {
+    Diags.Records.clear();
+    Diags.CurrentArg = -1;
+    Diags.Request = ParseResult::Success;
+    Diags.HelpHidden = Diags.HelpCategorized = false;
+  }
+  static void setProgram(ParseDiagnostics &Diags, StringRef ProgramName,
+                         StringRef Argv0) {
+    Diags.ProgramName = std::string(ProgramName);
+    Diags.Argv0 = std::string(Argv0);
+  }
+  static void setCurrentArg(ParseDiagnostics &Diags, int Index) {
+    Diags.CurrentArg = Index;
+  }
+  static void add(ParseDiagnostics &Diags, ParseDiagnostic Record) {
+    Diags.Records.push_back(std::move(Record));
+  }
+  static void addOptionError(ParseDiagnostics &Diags, ParseDiagnosticKind Kind,
+                             const Option &O, StringRef ArgName,
+                             const Twine &Message) {
+    ParseDiagnostic Record;
+    Record.Kind = Kind;
+    Record.ArgIndex = Diags.CurrentArg;
+    Record.Opt = &O;
+    Record.Arg = std::string(ArgName);
+    Record.Message = Message.str();
+    Diags.Records.push_back(std::move(Record));
+  }
+  static void request(ParseDiagnostics &Diags, ParseResult Request) {
+    Diags.Request = Request;
+  }
+  static void requestHelp(ParseDiagnostics &Diags, bool Hidden,
+                          bool Categorized) {
+    Diags.Request = ParseResult::Help;
+    Diags.HelpHidden = Hidden;
+    Diags.HelpCategorized = Categorized;
+  }
+  static ParseResult getRequest(const ParseDiagnostics &Diags) {
+    return Diags.Request;
+  }
+};
+
+using DiagsAccess = cl::ParseDiagnosticsAccess;
+
+// Tell the parse collecting diagnostics on this thread, if any, which argument
+// is being handed to an option.
+static void noteArgIndex(int Index) {
+  if (ThreadDiags)
+    DiagsAccess::setCurrentArg(*ThreadDiags, Index);
+}
+
+// Report an error of O: through Option::error, or as a record of Kind when
+// the thread collects diagnostics. Always returns true.
+static bool reportOptionError(ParseDiagnosticKind Kind, Option &O,
+                              const Twine &Message) {
+  if (!ThreadDiags)
+    return O.error(Message);
+  DiagsAccess::addOptionError(*ThreadDiags, Kind, O, O.ArgStr, Message);
+  return true;
+}
+
+// Print an error of O the way Option::error does.
+static void printOptionError(raw_ostream &OS, const Option &O,
+                             StringRef ArgName, StringRef ProgramName,
+                             const Twine &Message) {
+  if (ArgName.empty())
+    OS << O.HelpStr; // Be nice for positional arguments
+  else
+    OS << ProgramName << ": for the " << PrintArg(ArgName, 0);
+
+  OS << " option: " << Message << "\n";
+}
+
+static void printParseDiagnostic(raw_ostream &OS, const ParseDiagnostic &D,
+                                 StringRef ProgramName, StringRef Argv0) {
+  switch (D.Kind) {
+  case ParseDiagnosticKind::ResponseFile:
+    OS << D.Message << '\n';
+    break;
+  case ParseDiagnosticKind::UnknownArgument:
+    OS << ProgramName << ": Unknown command line argument '" << D.Arg
+       << "'.  Try: '" << Argv0 << " --help'\n";
+    // If we know a near match, report it as well.
+    if (!D.Suggestion.empty())
+      OS << ProgramName << ": Did you mean '" << PrintArg(D.Suggestion, 0)
+         << "'?\n";
+    break;
+  case ParseDiagnosticKind::OptionError:
+  case ParseDiagnosticKind::MissingRequired:
+  case ParseDiagnosticKind::PositionalSetup:
+    printOptionError(OS, *D.Opt, D.Arg, ProgramName, D.Message);
+    break;
+  case ParseDiagnosticKind::NotEnoughPositionals:
+    OS << ProgramName
+       << ": Not enough positional command line arguments specified!\n"
+       << "Must specify at least " << D.Count << " positional argument"
+       << (D.Count > 1 ? "s" : "") << ": See: " << Argv0 << " --help\n";
+    break;
+  case ParseDiagnosticKind::TooManyPositionals:
+    OS << ProgramName << ": Too many positional arguments specified!\n"
+       << "Can specify at most " << D.Count
+       << " positional arguments: See: " << Argv0 << " --help\n";
+    break;
+  }
+}
+
+void ParseDiagnostics::print(raw_ostream &OS) const {
+  for (const ParseDiagnostic &D : Records)
+    print(OS, D);
+}
+
+void ParseDiagnostics::print(raw_ostream &OS, const ParseDiagnostic &D) const {
+  printParseDiagnostic(OS, D, ProgramName, Argv0);
+}
 
 void cl::AddLiteralOption(Option &O, StringRef Name) {
-  GlobalParser->addLiteralOption(O, Name);
+  if (O.hasArgStr())
+    return;
+  auto *R = new PendingRegistration(PendingRegistration::LiteralName);
+  R->Opt = &O;
+  R->Name = Name;
+  queueRegistration(R);
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->LiteralNames.emplace_back(&O, Name);
 }
 
 extrahelp::extrahelp(StringRef Help) : morehelp(Help) {
-  GlobalParser->MoreHelp.push_back(Help);
+  auto *R = new PendingRegistration(PendingRegistration::MoreHelp);
+  R->Name = Help;
+  queueRegistration(R);
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
   FullyInitialized = true;
+  noteValueChanged();
+  auto *R = new PendingRegistration(PendingRegistration::Options);
+  R->Opts.push_back(this);
+  queueRegistration(R);
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->Options.push_back(this);
+}
+
+void Option::addArguments(ArrayRef<Option *> Opts) {
+  for (Option *O : Opts) {
+    O->FullyInitialized = true;
+    O->noteValueChanged();
+  }
+  auto *R = new PendingRegistration(PendingRegistration::Options);
+  R->Opts.append(Opts.begin(), Opts.end());
+  queueRegistration(R);
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->Options.insert(Scope->Options.end(), Opts.begin(), Opts.end());
 }
 
 void Option::removeArgument() { GlobalParser->removeOption(this); }
 
+void Option::removeArguments(ArrayRef<Option *> Opts) {
+  GlobalParser->removeOptions(Opts);
+}
+
 void Option::setArgStr(StringRef S) {
   if (FullyInitialized)
     GlobalParser->updateArgStr(this, S);
@@ -447,6 +945,26 @@ void Option::setArgStr(StringRef S) {
   ArgStr = S;
   if (ArgStr.size() == 1)
     setMiscFlag(Grouping);
+  if (FullyInitialized)
+    noteValueChanged();
+}
+
+void Option::setDescription(StringRef S) {
+  HelpStr = S;
+  if (FullyInitialized)
+    GlobalParser->noteRegistryChange();
+}
+
+void Option::setValueStr(StringRef S) {
+  ValueStr = S;
+  if (FullyInitialized)
+    GlobalParser->noteRegistryChange();
+}
+
+void Option::setHiddenFlag(enum OptionHidden Val) {
+  HiddenFlag = Val;
+  if (FullyInitialized)
+    GlobalParser->noteRegistryChange();
 }
 
 void Option::addCategory(OptionCategory &C) {
@@ -458,17 +976,30 @@ void Option::addCategory(OptionCategory &C) {
     Categories[0] = &C;
   else if (!is_contained(Categories, &C))
     Categories.push_back(&C);
+  if (FullyInitialized)
+    GlobalParser->noteRegistryChange();
 }
 
 void Option::reset() {
   NumOccurrences = 0;
+  ValueTouched = false;
+  ForgetValueOrigins(*this);
   setDefault();
+  noteValueChanged();
   if (isDefaultOption())
     removeArgument();
 }
 
 void OptionCategory::registerCategory() {
-  GlobalParser->registerCategory(this);
+  auto *R = new PendingRegistration(PendingRegistration::Category);
+  R->Cat = this;
+  queueRegistration(R);
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->Categories.push_back(this);
+}
+
+void OptionCategory::unregisterCategory() {
+  GlobalParser->unregisterCategory(this);
 }
 
 // A special subcommand representing no subcommand. It is particularly important
@@ -476,17 +1007,21 @@ void OptionCategory::registerCategory() {
 // initialization because it is referenced from cl::opt constructors, which run
 // dynamically in an arbitrary order.
 LLVM_REQUIRE_CONSTANT_INITIALIZATION
-ManagedStatic<SubCommand> llvm::cl::TopLevelSubCommand;
+Commandline::ManagedStatic<SubCommand> cl::top_level_sub_command;
 
 // A special subcommand that can be used to put an option into all subcommands.
-ManagedStatic<SubCommand> llvm::cl::AllSubCommands;
+Commandline::ManagedStatic<SubCommand> cl::all_sub_commands;
 
-SubCommand &SubCommand::getTopLevel() { return *TopLevelSubCommand; }
+SubCommand &SubCommand::getTopLevel() { return *top_level_sub_command; }
 
-SubCommand &SubCommand::getAll() { return *AllSubCommands; }
+SubCommand &SubCommand::getAll() { return *all_sub_commands; }
 
 void SubCommand::registerSubCommand() {
-  GlobalParser->registerSubCommand(this);
+  auto *R = new PendingRegistration(PendingRegistration::Sub);
+  R->SC = this;
+  queueRegistration(R);
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->Subs.push_back(this);
 }
 
 void SubCommand::unregisterSubCommand() {
@@ -505,6 +1040,72 @@ SubCommand::operator bool() const {
   return (GlobalParser->getActiveSubCommand() == this);
 }
 
+void generic_parser_base::noteLiteralValue(StringRef Name) {
+  GlobalParser->noteRegistryChange();
+  if (registration_scope *Scope = registration_scope::active())
+    Scope->LiteralValues.emplace_back(this, Name);
+}
+
+void generic_parser_base::noteLiteralsRemoved() {
+  GlobalParser->noteRegistryChange();
+}
+
+//===----------------------------------------------------------------------===//
+// registration_scope implementation
+//
+
+registration_scope::registration_scope()
+    : Previous(ActiveScope), Active(true) {
+  ActiveScope = this;
+}
+
+registration_scope::~registration_scope() {
+  if (Active)
+    close();
+  unregister();
+}
+
+registration_scope *registration_scope::active() { return ActiveScope; }
+
+void registration_scope::close() {
+  assert(ActiveScope == this &&
+         "only the innermost registration scope can be closed");
+  ActiveScope = Previous;
+  Active = false;
+}
+
+void registration_scope::unregister() {
+  // Options first: they find their literal names through their parsers.
+  if (!Options.empty())
+    Option::removeArguments(Options);
+  for (auto &Literal : LiteralNames)
+    GlobalParser->removeLiteralOption(*Literal.first, Literal.second);
+
+  // One pass over the literal table of each parser.
+  llvm::stable_sort(LiteralValues, [](const auto &LHS, const auto &RHS) {
+    return std::less<generic_parser_base *>()(LHS.first, RHS.first);
+  });
+  SmallVector<StringRef, 8> Names;
+  for (size_t I = 0, E = LiteralValues.size(); I != E;) {
+    generic_parser_base *Parser = LiteralValues[I].first;
+    Names.clear();
+    for (; I != E && LiteralValues[I].first == Parser; ++I)
+      Names.push_back(LiteralValues[I].second);
+    Parser->removeLiteralOptions(Names);
+  }
+
+  for (SubCommand *Sub : Subs)
+    GlobalParser->unregisterSubCommand(Sub);
+  for (OptionCategory *Category : Categories)
+    GlobalParser->unregisterCategory(Category);
+
+  Options.clear();
+  LiteralNames.clear();
+  LiteralValues.clear();
+  Subs.clear();
+  Categories.clear();
+}
+
 //===----------------------------------------------------------------------===//
 // Basic, shared command line option processing machinery.
 //
@@ -642,6 +1243,12 @@ static bool CommaSeparateAndAddOccurrence(Option *Handler, unsigned pos,
 static inline bool ProvideOption(Option *Handler, StringRef ArgName,
                                  StringRef Value, int argc,
                                  const char *const *argv, int &i) {
+  ParseTraceScope Trace("option",
+                        Handler->hasArgStr() ? Handler->ArgStr
+                                             : Handler->ValueStr,
+                        i);
+  noteArgIndex(i);
+
   // Is this a multi-argument option?
   unsigned NumAdditionalVals = Handler->getNumAdditionalVals();
 
@@ -699,7 +1306,7 @@ static inline bool ProvideOption(Option *Handler, StringRef ArgName,
   return false;
 }
 
-bool llvm::cl::ProvidePositionalOption(Option *Handler, StringRef Arg, int i) {
+bool cl::ProvidePositionalOption(Option *Handler, StringRef Arg, int i) {
   int Dummy = i;
   return ProvideOption(Handler, Handler->ArgStr, Arg, 0, nullptr, Dummy);
 }
@@ -874,6 +1481,21 @@ void cl::TokenizeGNUCommandLine(StringRef Src, StringSaver &Saver,
     NewArgv.push_back(Saver.save(Token.str()).data());
 }
 
+void cl::QuoteGNUCommandLineArg(StringRef Arg, SmallVectorImpl<char> &Out) {
+  if (!Arg.empty() && Arg.find_first_of(" \t\r\n\"'\\") == StringRef::npos) {
+    Out.append(Arg.begin(), Arg.end());
+    return;
+  }
+  // Inside double quotes a backslash escapes any character.
+  Out.push_back('"');
+  for (char C : Arg) {
+    if (C == '"' || C == '\\')
+      Out.push_back('\\');
+    Out.push_back(C);
+  }
+  Out.push_back('"');
+}
+
 /// Backslashes are interpreted in a rather complicated way in the Windows-style
 /// command line, because backslashes are used both to separate path and to
 /// escape double quote. This method consumes runs of backslashes as well as the
@@ -1072,8 +1694,11 @@ void cl::tokenizeConfigFile(StringRef Source, StringSaver &Saver,
     SmallString<128> Line;
     // Check for comment line.
     if (isWhitespace(*Cur)) {
-      while (Cur != Source.end() && isWhitespace(*Cur))
+      while (Cur != Source.end() && isWhitespace(*Cur)) {
+        if (MarkEOLs && *Cur == '\n')
+          NewArgv.push_back(nullptr);
         ++Cur;
+      }
       continue;
     }
     if (*Cur == '#') {
@@ -1083,6 +1708,7 @@ void cl::tokenizeConfigFile(StringRef Source, StringSaver &Saver,
     }
     // Find end of the current line.
     const char *Start = Cur;
+    unsigned JoinedLines = 0;
     for (const char *End = Source.end(); Cur != End; ++Cur) {
       if (*Cur == '\\') {
         if (Cur + 1 != End) {
@@ -1093,6 +1719,7 @@ void cl::tokenizeConfigFile(StringRef Source, StringSaver &Saver,
             if (*Cur == '\r')
               ++Cur;
             Start = Cur + 1;
+            ++JoinedLines;
           }
         }
       } else if (*Cur == '\n')
@@ -1101,6 +1728,10 @@ void cl::tokenizeConfigFile(StringRef Source, StringSaver &Saver,
     // Tokenize line.
     Line.append(Start, Cur);
     cl::TokenizeGNUCommandLine(Line, Saver, NewArgv, MarkEOLs);
+    // Mark the ends of the lines joined by backslashes, so that every newline
+    // in the file is marked once.
+    if (MarkEOLs)
+      NewArgv.append(JoinedLines, nullptr);
   }
 }
 
@@ -1156,6 +1787,16 @@ Error ExpansionContext::expandResponseFile(
   MemoryBuffer &MemBuf = *MemBufOrErr.get();
   StringRef Str(MemBuf.getBufferStart(), MemBuf.getBufferSize());
 
+  // Record which file was read and what it held, so that callers can tell
+  // whether an expansion would give the same result.
+  if (Digest) {
+    Digest->update(FName);
+    Digest->update(StringRef("\0", 1));
+    Digest->update(Twine(Str.size()).str());
+    Digest->update(StringRef("\0", 1));
+    Digest->update(Str);
+  }
+
   // If we have a UTF-16 byte order mark, convert to UTF-8 for parsing.
   ArrayRef<char> BufRef(MemBuf.getBufferStart(), MemBuf.getBufferEnd());
   std::string UTF8Buf;
@@ -1171,8 +1812,12 @@ Error ExpansionContext::expandResponseFile(
   else if (hasUTF8ByteOrderMark(BufRef))
     Str = StringRef(BufRef.data() + 3, BufRef.size() - 3);
 
-  // Tokenize the contents into NewArgv.
-  Tokenizer(Str, Saver, NewArgv, MarkEOLs);
+  // Tokenize the contents into NewArgv. Origins are counted in lines, so the
+  // ends of lines are marked to find them.
+  size_t FirstArg = NewArgv.size();
+  Tokenizer(Str, Saver, NewArgv, MarkEOLs || Origins);
+  if (Origins)
+    noteFileOrigins(FName, NewArgv, FirstArg);
 
   // Expanded file content may require additional transformations, like using
   // absolute paths instead of relative in '@file' constructs or expanding
@@ -1224,10 +1869,42 @@ Error ExpansionContext::expandResponseFile(
   return Error::success();
 }
 
+// Record the line of FName each argument from FirstArg on was read from in
+// FileOrigins, and remove the end of line markers unless they were asked for.
+void ExpansionContext::noteFileOrigins(StringRef FName,
+                                       SmallVectorImpl<const char *> &NewArgv,
+                                       size_t FirstArg) {
+  uint32_t Source = AddValueSource(ValueSourceKind::File, FName);
+  uint32_t Line = 1;
+  size_t Out = FirstArg;
+  FileOrigins.clear();
+  for (size_t I = FirstArg, E = NewArgv.size(); I != E; ++I) {
+    const char *Arg = NewArgv[I];
+    if (Arg || MarkEOLs) {
+      NewArgv[Out++] = Arg;
+      FileOrigins.push_back({Source, Line});
+    }
+    if (!Arg)
+      ++Line;
+  }
+  NewArgv.truncate(Out);
+}
+
+// Make Origins hold Size origins. Added ones are taken to be command line
+// arguments at the same index, as an empty Origins means all arguments are.
+static void fillArgOrigins(SmallVectorImpl<ValueOrigin> &Origins,
+                           size_t Size) {
+  if (Origins.size() > Size)
+    Origins.truncate(Size);
+  for (size_t I = Origins.size(); I < Size; ++I)
+    Origins.push_back({command_line_source, static_cast<uint32_t>(I)});
+}
+
 /// Expand response files on a command line recursively using the given
 /// StringSaver and tokenization strategy.
 Error ExpansionContext::expandResponseFiles(
     SmallVectorImpl<const char *> &Argv) {
+  ParseTraceScope Trace("expandResponseFiles");
   struct ResponseFileRecord {
     std::string File;
     size_t End;
@@ -1322,8 +1999,11 @@ Error ExpansionContext::expandResponseFiles(
     // Replace this response file argument with the tokenization of its
     // contents.  Nested response files are expanded in subsequent iterations.
     SmallVector<const char *, 0> ExpandedArgv;
-    if (Error Err = expandResponseFile(FName, ExpandedArgv))
-      return Err;
+    {
+      ParseTraceScope Trace("expandResponseFile", FName, I);
+      if (Error Err = expandResponseFile(FName, ExpandedArgv))
+        return Err;
+    }
 
     for (ResponseFileRecord &Record : FileStack) {
       // Increase the end of all active records by the number of newly expanded
@@ -1332,6 +2012,13 @@ Error ExpansionContext::expandResponseFiles(
     }
 
     FileStack.push_back({FName, I + ExpandedArgv.size()});
+    if (Origins) {
+      // Origins are only filled in once a file is expanded.
+      fillArgOrigins(*Origins, Argv.size());
+      Origins->erase(Origins->begin() + I);
+      Origins->insert(Origins->begin() + I, FileOrigins.begin(),
+                      FileOrigins.end());
+    }
     Argv.erase(Argv.begin() + I);
     Argv.insert(Argv.begin() + I, ExpandedArgv.begin(), ExpandedArgv.end());
   }
@@ -1355,12 +2042,12 @@ bool cl::expandResponseFiles(int Argc, const char *const *Argv,
 #endif
   // The environment variable specifies initial options.
   if (EnvVar)
-    if (std::optional<std::string> EnvValue = sys::Process::GetEnv(EnvVar))
+    if (auto EnvValue = sys::Process::GetEnv(EnvVar))
       Tokenize(*EnvValue, Saver, NewArgv, /*MarkEOLs=*/false);
 
   // Command line options can override the environment variable.
   NewArgv.append(Argv + 1, Argv + Argc);
-  ExpansionContext ECtx(Saver.getAllocator(), Tokenize);
+  ExpansionContext ECtx(Saver, Tokenize);
   if (Error Err = ECtx.expandResponseFiles(NewArgv)) {
     errs() << toString(std::move(Err)) << '\n';
     return false;
@@ -1370,7 +2057,7 @@ bool cl::expandResponseFiles(int Argc, const char *const *Argv,
 
 bool cl::ExpandResponseFiles(StringSaver &Saver, TokenizerCallback Tokenizer,
                              SmallVectorImpl<const char *> &Argv) {
-  ExpansionContext ECtx(Saver.getAllocator(), Tokenizer);
+  ExpansionContext ECtx(Saver, Tokenizer);
   if (Error Err = ECtx.expandResponseFiles(Argv)) {
     errs() << toString(std::move(Err)) << '\n';
     return false;
@@ -1381,6 +2068,9 @@ bool cl::ExpandResponseFiles(StringSaver &Saver, TokenizerCallback Tokenizer,
 ExpansionContext::ExpansionContext(BumpPtrAllocator &A, TokenizerCallback T)
     : Saver(A), Tokenizer(T), FS(vfs::getRealFileSystem().get()) {}
 
+ExpansionContext::ExpansionContext(StringSaver &S, TokenizerCallback T)
+    : Saver(S), Tokenizer(T), FS(vfs::getRealFileSystem().get()) {}
+
 bool ExpansionContext::findConfigFile(StringRef FileName,
                                       SmallVectorImpl<char> &FilePath) {
   SmallString<128> CfgFilePath;
@@ -1420,6 +2110,7 @@ bool ExpansionContext::findConfigFile(StringRef FileName,
 
 Error ExpansionContext::readConfigFile(StringRef CfgFile,
                                        SmallVectorImpl<const char *> &Argv) {
+  ParseTraceScope Trace("readConfigFile", CfgFile);
   SmallString<128> AbsPath;
   if (sys::path::is_relative(CfgFile)) {
     AbsPath.assign(CfgFile);
@@ -1430,41 +2121,103 @@ Error ExpansionContext::readConfigFile(StringRef CfgFile,
   }
   InConfigFile = true;
   RelativeNames = true;
+  size_t FirstArg = Argv.size();
   if (Error Err = expandResponseFile(CfgFile, Argv))
     return Err;
+  if (Origins) {
+    fillArgOrigins(*Origins, FirstArg);
+    Origins->append(FileOrigins.begin(), FileOrigins.end());
+  }
   return expandResponseFiles(Argv);
 }
 
 static void initCommonOptions();
+static bool handlePrintConfigHash();
+static void handlePrintParseStats();
 bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
                                  StringRef Overview, raw_ostream *Errs,
                                  const char *EnvVar,
                                  bool LongOptionsUseDoubleDash) {
   initCommonOptions();
+
+  // Answer shell completion queries before doing any real parsing.
+  if (HandleCompletionRequest(argc, argv, outs())) {
+    outs().flush();
+    if (ThreadDiags) {
+      DiagsAccess::request(*ThreadDiags, ParseResult::Exit);
+      return false;
+    }
+    exit(0);
+  }
+
   SmallVector<const char *, 20> NewArgv;
+  SmallVector<ValueOrigin, 0> NewOrigins;
   BumpPtrAllocator A;
   StringSaver Saver(A);
   NewArgv.push_back(argv[0]);
 
   // Parse options from environment variable.
   if (EnvVar) {
-    if (std::optional<std::string> EnvValue =
-            sys::Process::GetEnv(StringRef(EnvVar)))
+    if (auto EnvValue = sys::Process::GetEnv(StringRef(EnvVar))) {
       TokenizeGNUCommandLine(*EnvValue, Saver, NewArgv);
+      uint32_t Source = AddValueSource(ValueSourceKind::Environment, EnvVar);
+      NewOrigins.push_back({command_line_source, 0});
+      for (uint32_t Word = 1; NewOrigins.size() < NewArgv.size(); ++Word)
+        NewOrigins.push_back({Source, Word});
+    }
   }
 
-  // Append options from command line.
-  for (int I = 1; I < argc; ++I)
+  // Append options from command line. Their origins are implied unless the
+  // environment variable shifted them.
+  for (int I = 1; I < argc; ++I) {
     NewArgv.push_back(argv[I]);
+    if (!NewOrigins.empty())
+      NewOrigins.push_back({command_line_source, static_cast<uint32_t>(I)});
+  }
   int NewArgc = static_cast<int>(NewArgv.size());
 
   // Parse all options.
-  return GlobalParser->ParseCommandLineOptions(NewArgc, &NewArgv[0], Overview,
-                                               Errs, LongOptionsUseDoubleDash);
+  if (!GlobalParser->ParseCommandLineOptions(NewArgc, &NewArgv[0], Overview,
+                                             Errs, LongOptionsUseDoubleDash,
+                                             NewOrigins))
+    return false;
+
+  handlePrintParseStats();
+  // The fingerprint covers the whole command line, so it is printed only once
+  // every option has been parsed.
+  return !handlePrintConfigHash();
+}
+
+ParseResult cl::ParseCommandLineOptions(int argc, const char *const *argv,
+                                        ParseDiagnostics &Diags,
+                                        StringRef Overview, const char *EnvVar,
+                                        bool LongOptionsUseDoubleDash) {
+  DiagsAccess::begin(Diags);
+  struct CollectDiagnostics {
+    ParseDiagnostics *Previous;
+    explicit CollectDiagnostics(ParseDiagnostics &D)
+        : Previous(std::exchange(ThreadDiags, &D)) {}
+    ~CollectDiagnostics() { ThreadDiags = Previous; }
+  } Collect(Diags);
+
+  // Errors are recorded, so the stream only keeps the parse from exiting.
+  bool Parsed = ParseCommandLineOptions(argc, argv, Overview, &nulls(), EnvVar,
+                                        LongOptionsUseDoubleDash);
+  if (ParseResult Request = DiagsAccess::getRequest(Diags);
+      Request != ParseResult::Success)
+    return Request;
+  if (!Parsed || !Diags.empty())
+    return ParseResult::Error;
+  return ParseResult::Success;
 }
 
 /// Reset all options at least once, so that we can parse different options.
 void CommandLineParser::ResetAllOptionOccurrences() {
+  mergePendingRegistrations();
+  WalkingTables ResetInProgress(*this);
+  // Dropping every origin first saves each reset a search for its own.
+  ClearValueOrigins();
+
   // Reset all option values to look like they have never been seen before.
   // Options might be reset twice (they can be reference in both OptionsMap
   // and one of the other members), but that does not harm.
@@ -1480,19 +2233,41 @@ void CommandLineParser::ResetAllOptionOccurrences() {
   }
 }
 
-bool CommandLineParser::ParseCommandLineOptions(int argc,
-                                                const char *const *argv,
-                                                StringRef Overview,
-                                                raw_ostream *Errs,
-                                                bool LongOptionsUseDoubleDash) {
+bool CommandLineParser::ParseCommandLineOptions(
+    int argc, const char *const *argv, StringRef Overview, raw_ostream *Errs,
+    bool LongOptionsUseDoubleDash, ArrayRef<ValueOrigin> Origins) {
+  mergePendingRegistrations();
+  WalkingTables ParseInProgress(*this);
   assert(hasOptions() && "No options specified!");
 
+  ParseTraceScope Trace("ParseCommandLineOptions", StringRef(argv[0]));
+  ParseStatsRecorder StatsRecorder;
+  if (ProgramOverview != Overview)
+    noteRegistryChange();
   ProgramOverview = Overview;
   bool IgnoreErrors = Errs;
   if (!Errs)
     Errs = &errs();
   bool ErrorParsing = false;
 
+  // With diagnostics, errors are recorded rather than printed. A help or
+  // version request ends the parse, and in fail-fast mode so does the first
+  // error.
+  ParseDiagnostics *Diags = ThreadDiags;
+  auto Report = [&](ParseDiagnostic D) {
+    if (Diags)
+      DiagsAccess::add(*Diags, std::move(D));
+    else
+      printParseDiagnostic(*Errs, D, ProgramName, argv[0]);
+  };
+  auto StopParsing = [&] {
+    if (!Diags)
+      return false;
+    if (DiagsAccess::getRequest(*Diags) != ParseResult::Success)
+      return true;
+    return Diags->isFailFast() && (ErrorParsing || !Diags->empty());
+  };
+
   // Expand response files.
   SmallVector<const char *, 20> newArgv(argv, argv + argc);
   BumpPtrAllocator A;
@@ -1501,16 +2276,35 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
 #else
   auto Tokenize = cl::TokenizeGNUCommandLine;
 #endif
+  SmallVector<ValueOrigin, 20> ArgOrigins(Origins.begin(), Origins.end());
   ExpansionContext ECtx(A, Tokenize);
-  if (Error Err = ECtx.expandResponseFiles(newArgv)) {
-    *Errs << toString(std::move(Err)) << '\n';
-    return false;
+  ECtx.setOrigins(&ArgOrigins);
+  std::optional<MD5> CacheDigest;
+  if (IsParseCacheEnabled())
+    ECtx.setDigest(&CacheDigest.emplace());
+  {
+    ParsePhaseTimer Timer(ParsePhase::ResponseFiles);
+    if (Error Err = ECtx.expandResponseFiles(newArgv)) {
+      ParseDiagnostic D;
+      D.Kind = ParseDiagnosticKind::ResponseFile;
+      D.Message = toString(std::move(Err));
+      Report(std::move(D));
+      return false;
+    }
   }
+  StatsRecorder.noteArena(A);
   argv = &newArgv[0];
   argc = static_cast<int>(newArgv.size());
+  ValueOriginScope OriginScope(ArgOrigins);
 
   // Copy the program name into ProgName, making sure not to overflow it.
-  ProgramName = std::string(sys::path::filename(StringRef(argv[0])));
+  StringRef NewProgramName = sys::path::filename(StringRef(argv[0]));
+  if (ProgramName != NewProgramName) {
+    ProgramName = std::string(NewProgramName);
+    noteRegistryChange();
+  }
+  if (Diags)
+    DiagsAccess::setProgram(*Diags, ProgramName, argv[0]);
 
   // Check out the positional arguments to collect information about them.
   unsigned NumPositionalRequired = 0;
@@ -1523,6 +2317,7 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
   if (argc >= 2 && argv[FirstArg][0] != '-') {
     // If the first argument specifies a valid subcommand, start processing
     // options from the second argument.
+    ParsePhaseTimer Timer(ParsePhase::SubCommandSelection);
     ChosenSubCommand = LookupSubCommand(StringRef(argv[FirstArg]));
     if (ChosenSubCommand != &SubCommand::getTopLevel())
       FirstArg = 2;
@@ -1535,8 +2330,22 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
   auto &SinkOpts = ChosenSubCommand->SinkOpts;
   auto &OptionsMap = ChosenSubCommand->OptionsMap;
 
-  for (auto *O: DefaultOptions) {
-    addOption(O, true);
+  {
+    ParsePhaseTimer Timer(ParsePhase::DefaultOptions);
+    for (auto *O : DefaultOptions)
+      addOption(O, true);
+  }
+
+  // A cached result of the same command line replaces the rest of the parse.
+  std::optional<MD5::MD5Result> CacheKey;
+  if (CacheDigest) {
+    CacheKey = FinishParseCacheKey(*CacheDigest,
+                                   ArrayRef<const char *>(argv, argc),
+                                   LongOptionsUseDoubleDash);
+    if (LoadCachedParse(*CacheKey)) {
+      clearMoreHelp();
+      return true;
+    }
   }
 
   if (ConsumeAfterOpt) {
@@ -1555,10 +2364,12 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
         // ConsumeAfter cannot be combined with "optional" positional options
         // unless there is only one positional argument...
         if (PositionalOpts.size() > 1) {
-          if (!IgnoreErrors)
-            Opt->error("error - this positional option will never be matched, "
-                       "because it does not Require a value, and a "
-                       "cl::ConsumeAfter option is active!");
+          if (!IgnoreErrors || Diags)
+            reportOptionError(
+                ParseDiagnosticKind::PositionalSetup, *Opt,
+                "error - this positional option will never be matched, "
+                "because it does not Require a value, and a "
+                "cl::ConsumeAfter option is active!");
           ErrorParsing = true;
         }
       } else if (UnboundedFound && !Opt->hasArgStr()) {
@@ -1566,14 +2377,17 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
         // not specified after an option that eats all extra arguments, or this
         // one will never get any!
         //
-        if (!IgnoreErrors)
-          Opt->error("error - option can never match, because "
-                     "another positional argument will match an "
-                     "unbounded number of values, and this option"
-                     " does not require a value!");
-        *Errs << ProgramName << ": CommandLine Error: Option '" << Opt->ArgStr
-              << "' is all messed up!\n";
-        *Errs << PositionalOpts.size();
+        if (!IgnoreErrors || Diags)
+          reportOptionError(ParseDiagnosticKind::PositionalSetup, *Opt,
+                            "error - option can never match, because "
+                            "another positional argument will match an "
+                            "unbounded number of values, and this option"
+                            " does not require a value!");
+        if (!Diags) {
+          *Errs << ProgramName << ": CommandLine Error: Option '"
+                << Opt->ArgStr << "' is all messed up!\n";
+          *Errs << PositionalOpts.size();
+        }
         ErrorParsing = true;
       }
       UnboundedFound |= EatsUnboundedNumberOfValues(Opt);
@@ -1593,7 +2407,8 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
 
   // Loop over all of the arguments... processing them.
   bool DashDashFound = false; // Have we read '--'?
-  for (int i = FirstArg; i < argc; ++i) {
+  for (int i = FirstArg; i < argc && !StopParsing(); ++i) {
+    noteArgIndex(i);
     Option *Handler = nullptr;
     Option *NearestHandler = nullptr;
     std::string NearestHandlerString;
@@ -1643,8 +2458,13 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
         ArgName = ArgName.substr(1);
       }
 
-      Handler = LookupLongOption(*ChosenSubCommand, ArgName, Value,
-                                 LongOptionsUseDoubleDash, HaveDoubleDash);
+      {
+        ParsePhaseTimer Timer(ParsePhase::OptionLookup);
+        Handler = LookupLongOption(*ChosenSubCommand, ArgName, Value,
+                                   LongOptionsUseDoubleDash, HaveDoubleDash);
+        if (Handler)
+          CountParseLookup(ParseLookup::Hit);
+      }
       if (!Handler || Handler->getFormattingFlag() != cl::Positional) {
         ProvidePositionalOption(ActivePositionalArg, StringRef(argv[i]), i);
         continue; // We are done!
@@ -1657,32 +2477,37 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
         ArgName = ArgName.substr(1);
       }
 
+      ParsePhaseTimer Timer(ParsePhase::OptionLookup);
       Handler = LookupLongOption(*ChosenSubCommand, ArgName, Value,
                                  LongOptionsUseDoubleDash, HaveDoubleDash);
+      if (Handler)
+        CountParseLookup(ParseLookup::Hit);
 
       // Check to see if this "option" is really a prefixed or grouped argument.
-      if (!Handler && !(LongOptionsUseDoubleDash && HaveDoubleDash))
+      if (!Handler && !(LongOptionsUseDoubleDash && HaveDoubleDash)) {
+        CountParseLookup(ParseLookup::PrefixFallback);
         Handler = HandlePrefixedOrGroupedOption(ArgName, Value, ErrorParsing,
                                                 OptionsMap);
+      }
 
       // Otherwise, look for the closest available option to report to the user
       // in the upcoming error.
-      if (!Handler && SinkOpts.empty())
+      if (!Handler && SinkOpts.empty()) {
+        CountParseLookup(ParseLookup::NearestMatch);
         NearestHandler =
             LookupNearestOption(ArgName, OptionsMap, NearestHandlerString);
+      }
     }
 
     if (!Handler) {
       if (SinkOpts.empty()) {
-        *Errs << ProgramName << ": Unknown command line argument '" << argv[i]
-              << "'.  Try: '" << argv[0] << " --help'\n";
-
-        if (NearestHandler) {
-          // If we know a near match, report it as well.
-          *Errs << ProgramName << ": Did you mean '"
-                << PrintArg(NearestHandlerString, 0) << "'?\n";
-        }
-
+        ParseDiagnostic D;
+        D.Kind = ParseDiagnosticKind::UnknownArgument;
+        D.ArgIndex = i;
+        D.Arg = argv[i];
+        if (NearestHandler)
+          D.Suggestion = std::move(NearestHandlerString);
+        Report(std::move(D));
         ErrorParsing = true;
       } else {
         for (Option *SinkOpt : SinkOpts)
@@ -1707,98 +2532,111 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
   }
 
   // Check and handle positional arguments now...
-  if (NumPositionalRequired > PositionalVals.size()) {
-      *Errs << ProgramName
-             << ": Not enough positional command line arguments specified!\n"
-             << "Must specify at least " << NumPositionalRequired
-             << " positional argument" << (NumPositionalRequired > 1 ? "s" : "")
-             << ": See: " << argv[0] << " --help\n";
-
-    ErrorParsing = true;
-  } else if (!HasUnlimitedPositionals &&
-             PositionalVals.size() > PositionalOpts.size()) {
-    *Errs << ProgramName << ": Too many positional arguments specified!\n"
-          << "Can specify at most " << PositionalOpts.size()
-          << " positional arguments: See: " << argv[0] << " --help\n";
-    ErrorParsing = true;
-
-  } else if (!ConsumeAfterOpt) {
-    // Positional args have already been handled if ConsumeAfter is specified.
-    unsigned ValNo = 0, NumVals = static_cast<unsigned>(PositionalVals.size());
-    for (size_t i = 0, e = PositionalOpts.size(); i != e; ++i) {
-      if (RequiresValue(PositionalOpts[i])) {
-        ProvidePositionalOption(PositionalOpts[i], PositionalVals[ValNo].first,
-                                PositionalVals[ValNo].second);
-        ValNo++;
-        --NumPositionalRequired; // We fulfilled our duty...
-      }
-
-      // If we _can_ give this option more arguments, do so now, as long as we
-      // do not give it values that others need.  'Done' controls whether the
-      // option even _WANTS_ any more.
-      //
-      bool Done = PositionalOpts[i]->getNumOccurrencesFlag() == cl::Required;
-      while (NumVals - ValNo > NumPositionalRequired && !Done) {
-        switch (PositionalOpts[i]->getNumOccurrencesFlag()) {
-        case cl::Optional:
-          Done = true; // Optional arguments want _at most_ one value
-          [[fallthrough]];
-        case cl::ZeroOrMore: // Zero or more will take all they can get...
-        case cl::OneOrMore:  // One or more will take all they can get...
+  if (!StopParsing()) {
+    ParsePhaseTimer Timer(ParsePhase::Positionals);
+    if (NumPositionalRequired > PositionalVals.size()) {
+      ParseDiagnostic D;
+      D.Kind = ParseDiagnosticKind::NotEnoughPositionals;
+      D.Count = NumPositionalRequired;
+      Report(std::move(D));
+      ErrorParsing = true;
+    } else if (!HasUnlimitedPositionals &&
+               PositionalVals.size() > PositionalOpts.size()) {
+      ParseDiagnostic D;
+      D.Kind = ParseDiagnosticKind::TooManyPositionals;
+      D.ArgIndex =
+          static_cast<int>(PositionalVals[PositionalOpts.size()].second);
+      D.Count = PositionalOpts.size();
+      Report(std::move(D));
+      ErrorParsing = true;
+
+    } else if (!ConsumeAfterOpt) {
+      // Positional args have already been handled if ConsumeAfter is specified.
+      unsigned ValNo = 0,
+               NumVals = static_cast<unsigned>(PositionalVals.size());
+      for (size_t i = 0, e = PositionalOpts.size(); i != e; ++i) {
+        if (RequiresValue(PositionalOpts[i])) {
           ProvidePositionalOption(PositionalOpts[i],
                                   PositionalVals[ValNo].first,
                                   PositionalVals[ValNo].second);
           ValNo++;
-          break;
-        default:
-          llvm_unreachable("Internal error, unexpected NumOccurrences flag in "
-                           "positional argument processing!");
+          --NumPositionalRequired; // We fulfilled our duty...
+        }
+
+        // If we _can_ give this option more arguments, do so now, as long as we
+        // do not give it values that others need.  'Done' controls whether the
+        // option even _WANTS_ any more.
+        //
+        bool Done = PositionalOpts[i]->getNumOccurrencesFlag() == cl::Required;
+        while (NumVals - ValNo > NumPositionalRequired && !Done) {
+          switch (PositionalOpts[i]->getNumOccurrencesFlag()) {
+          case cl::Optional:
+            Done = true; // Optional arguments want _at most_ one value
+            [[fallthrough]];
+          case cl::ZeroOrMore: // Zero or more will take all they can get...
+          case cl::OneOrMore:  // One or more will take all they can get...
+            ProvidePositionalOption(PositionalOpts[i],
+                                    PositionalVals[ValNo].first,
+                                    PositionalVals[ValNo].second);
+            ValNo++;
+            break;
+          default:
+            llvm_unreachable("Internal error, unexpected NumOccurrences flag "
+                             "in positional argument processing!");
+          }
         }
       }
-    }
-  } else {
-    assert(ConsumeAfterOpt && NumPositionalRequired <= PositionalVals.size());
-    unsigned ValNo = 0;
-    for (size_t J = 0, E = PositionalOpts.size(); J != E; ++J)
-      if (RequiresValue(PositionalOpts[J])) {
-        ErrorParsing |= ProvidePositionalOption(PositionalOpts[J],
+    } else {
+      assert(ConsumeAfterOpt && NumPositionalRequired <= PositionalVals.size());
+      unsigned ValNo = 0;
+      for (size_t J = 0, E = PositionalOpts.size(); J != E; ++J)
+        if (RequiresValue(PositionalOpts[J])) {
+          ErrorParsing |= ProvidePositionalOption(PositionalOpts[J],
+                                                  PositionalVals[ValNo].first,
+                                                  PositionalVals[ValNo].second);
+          ValNo++;
+        }
+
+      // Handle the case where there is just one positional option, and it's
+      // optional.  In this case, we want to give JUST THE FIRST option to the
+      // positional option and keep the rest for the consume after.  The above
+      // loop would have assigned no values to positional options in this case.
+      //
+      if (PositionalOpts.size() == 1 && ValNo == 0 && !PositionalVals.empty()) {
+        ErrorParsing |= ProvidePositionalOption(PositionalOpts[0],
                                                 PositionalVals[ValNo].first,
                                                 PositionalVals[ValNo].second);
         ValNo++;
       }
 
-    // Handle the case where there is just one positional option, and it's
-    // optional.  In this case, we want to give JUST THE FIRST option to the
-    // positional option and keep the rest for the consume after.  The above
-    // loop would have assigned no values to positional options in this case.
-    //
-    if (PositionalOpts.size() == 1 && ValNo == 0 && !PositionalVals.empty()) {
-      ErrorParsing |= ProvidePositionalOption(PositionalOpts[0],
-                                              PositionalVals[ValNo].first,
-                                              PositionalVals[ValNo].second);
-      ValNo++;
-    }
-
-    // Handle over all of the rest of the arguments to the
-    // cl::ConsumeAfter command line option...
-    for (; ValNo != PositionalVals.size(); ++ValNo)
-      ErrorParsing |=
-          ProvidePositionalOption(ConsumeAfterOpt, PositionalVals[ValNo].first,
-                                  PositionalVals[ValNo].second);
+      // Handle over all of the rest of the arguments to the
+      // cl::ConsumeAfter command line option...
+      for (; ValNo != PositionalVals.size(); ++ValNo)
+        ErrorParsing |= ProvidePositionalOption(ConsumeAfterOpt,
+                                                PositionalVals[ValNo].first,
+                                                PositionalVals[ValNo].second);
+    }
   }
 
   // Loop over args and make sure all required args are specified!
-  for (const auto &Opt : OptionsMap) {
-    switch (Opt.second->getNumOccurrencesFlag()) {
-    case Required:
-    case OneOrMore:
-      if (Opt.second->getNumOccurrences() == 0) {
-        Opt.second->error("must be specified at least once!");
-        ErrorParsing = true;
+  if (!StopParsing()) {
+    ParsePhaseTimer Timer(ParsePhase::Validation);
+    noteArgIndex(-1);
+    for (const auto &Opt : OptionsMap) {
+      if (StopParsing())
+        break;
+      switch (Opt.second->getNumOccurrencesFlag()) {
+      case Required:
+      case OneOrMore:
+        if (Opt.second->getNumOccurrences() == 0) {
+          reportOptionError(ParseDiagnosticKind::MissingRequired, *Opt.second,
+                            "must be specified at least once!");
+          ErrorParsing = true;
+        }
+        [[fallthrough]];
+      default:
+        break;
       }
-      [[fallthrough]];
-    default:
-      break;
     }
   }
 
@@ -1811,7 +2649,7 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
 
   // Free all of the memory allocated to the map.  Command line options may only
   // be processed once!
-  MoreHelp.clear();
+  clearMoreHelp();
 
   // If we had an error processing our arguments, don't let the program execute
   if (ErrorParsing) {
@@ -1819,6 +2657,13 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
       exit(1);
     return false;
   }
+  // A help or version request, or an error an option recorded without
+  // failing, must not reach the parse cache.
+  if (Diags && (DiagsAccess::getRequest(*Diags) != ParseResult::Success ||
+                !Diags->empty()))
+    return false;
+  if (CacheKey)
+    StoreCachedParse(*CacheKey);
   return true;
 }
 
@@ -1826,15 +2671,24 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
 // Option Base class implementation
 //
 
-bool Option::error(const Twine &Message, StringRef ArgName, raw_ostream &Errs) {
+static thread_local raw_ostream *ThreadErrs = nullptr;
+
+raw_ostream *cl::redirectThreadErrors(raw_ostream *OS) {
+  return std::exchange(ThreadErrs, OS);
+}
+
+bool Option::error(const Twine &Message, StringRef ArgName,
+                   raw_ostream &ErrStream) {
   if (!ArgName.data())
     ArgName = ArgStr;
-  if (ArgName.empty())
-    Errs << HelpStr; // Be nice for positional arguments
-  else
-    Errs << GlobalParser->ProgramName << ": for the " << PrintArg(ArgName, 0);
-
-  Errs << " option: " << Message << "\n";
+  if (ThreadDiags) {
+    DiagsAccess::addOptionError(*ThreadDiags, ParseDiagnosticKind::OptionError,
+                                *this, ArgName, Message);
+    return true;
+  }
+  raw_ostream &Errs =
+      ThreadErrs && &ErrStream == &errs() ? *ThreadErrs : ErrStream;
+  printOptionError(Errs, *this, ArgName, GlobalParser->ProgramName, Message);
   return true;
 }
 
@@ -1843,6 +2697,8 @@ bool Option::addOccurrence(unsigned pos, StringRef ArgName, StringRef Value,
   if (!MultiArg)
     NumOccurrences++; // Increment the number of times we have been seen
 
+  RecordValueOrigin(*this, pos);
+  markValueTouched();
   return handleOccurrence(pos, ArgName, Value);
 }
 
@@ -1865,34 +2721,34 @@ size_t alias::getOptionWidth() const {
 }
 
 void Option::printHelpStr(StringRef HelpStr, size_t Indent,
-                          size_t FirstLineIndentedBy) {
+                          size_t FirstLineIndentedBy, raw_ostream &OS) {
   assert(Indent >= FirstLineIndentedBy);
   std::pair<StringRef, StringRef> Split = HelpStr.split('\n');
-  outs().indent(Indent - FirstLineIndentedBy)
+  OS.indent(Indent - FirstLineIndentedBy)
       << ArgHelpPrefix << Split.first << "\n";
   while (!Split.second.empty()) {
     Split = Split.second.split('\n');
-    outs().indent(Indent) << Split.first << "\n";
+    OS.indent(Indent) << Split.first << "\n";
   }
 }
 
 void Option::printEnumValHelpStr(StringRef HelpStr, size_t BaseIndent,
-                                 size_t FirstLineIndentedBy) {
+                                 size_t FirstLineIndentedBy, raw_ostream &OS) {
   const StringRef ValHelpPrefix = "  ";
   assert(BaseIndent >= FirstLineIndentedBy);
   std::pair<StringRef, StringRef> Split = HelpStr.split('\n');
-  outs().indent(BaseIndent - FirstLineIndentedBy)
+  OS.indent(BaseIndent - FirstLineIndentedBy)
       << ArgHelpPrefix << ValHelpPrefix << Split.first << "\n";
   while (!Split.second.empty()) {
     Split = Split.second.split('\n');
-    outs().indent(BaseIndent + ValHelpPrefix.size()) << Split.first << "\n";
+    OS.indent(BaseIndent + ValHelpPrefix.size()) << Split.first << "\n";
   }
 }
 
 // Print out the option for the alias.
-void alias::printOptionInfo(size_t GlobalWidth) const {
-  outs() << PrintArg(ArgStr);
-  printHelpStr(HelpStr, GlobalWidth, argPlusPrefixesSize(ArgStr));
+void alias::printOptionInfo(size_t GlobalWidth, raw_ostream &OS) const {
+  OS << PrintArg(ArgStr);
+  printHelpStr(HelpStr, GlobalWidth, argPlusPrefixesSize(ArgStr), OS);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1919,29 +2775,29 @@ size_t basic_parser_impl::getOptionWidth(const Option &O) const {
 // printOptionInfo - Print out information about this option.  The
 // to-be-maintained width is specified.
 //
-void basic_parser_impl::printOptionInfo(const Option &O,
-                                        size_t GlobalWidth) const {
-  outs() << PrintArg(O.ArgStr);
+void basic_parser_impl::printOptionInfo(const Option &O, size_t GlobalWidth,
+                                        raw_ostream &OS) const {
+  OS << PrintArg(O.ArgStr);
 
   auto ValName = getValueName();
   if (!ValName.empty()) {
     if (O.getMiscFlags() & PositionalEatsArgs) {
-      outs() << " <" << getValueStr(O, ValName) << ">...";
+      OS << " <" << getValueStr(O, ValName) << ">...";
     } else if (O.getValueExpectedFlag() == ValueOptional)
-      outs() << "[=<" << getValueStr(O, ValName) << ">]";
+      OS << "[=<" << getValueStr(O, ValName) << ">]";
     else {
-      outs() << (O.ArgStr.size() == 1 ? " <" : "=<") << getValueStr(O, ValName)
-             << '>';
+      OS << (O.ArgStr.size() == 1 ? " <" : "=<") << getValueStr(O, ValName)
+         << '>';
     }
   }
 
-  Option::printHelpStr(O.HelpStr, GlobalWidth, getOptionWidth(O));
+  Option::printHelpStr(O.HelpStr, GlobalWidth, getOptionWidth(O), OS);
 }
 
-void basic_parser_impl::printOptionName(const Option &O,
-                                        size_t GlobalWidth) const {
-  outs() << PrintArg(O.ArgStr);
-  outs().indent(GlobalWidth - O.ArgStr.size());
+void basic_parser_impl::printOptionName(const Option &O, size_t GlobalWidth,
+                                        raw_ostream &OS) const {
+  OS << PrintArg(O.ArgStr);
+  OS.indent(GlobalWidth - O.ArgStr.size());
 }
 
 // parser<bool> implementation
@@ -2113,50 +2969,52 @@ size_t generic_parser_base::getOptionWidth(const Option &O) const {
 // printOptionInfo - Print out information about this option.  The
 // to-be-maintained width is specified.
 //
-void generic_parser_base::printOptionInfo(const Option &O,
-                                          size_t GlobalWidth) const {
+void generic_parser_base::printOptionInfo(const Option &O, size_t GlobalWidth,
+                                          raw_ostream &OS) const {
   if (O.hasArgStr()) {
     // When the value is optional, first print a line just describing the
     // option without values.
     if (O.getValueExpectedFlag() == ValueOptional) {
       for (unsigned i = 0, e = getNumOptions(); i != e; ++i) {
         if (getOption(i).empty()) {
-          outs() << PrintArg(O.ArgStr);
+          OS << PrintArg(O.ArgStr);
           Option::printHelpStr(O.HelpStr, GlobalWidth,
-                               argPlusPrefixesSize(O.ArgStr));
+                               argPlusPrefixesSize(O.ArgStr), OS);
           break;
         }
       }
     }
 
-    outs() << PrintArg(O.ArgStr) << EqValue;
+    OS << PrintArg(O.ArgStr) << EqValue;
     Option::printHelpStr(O.HelpStr, GlobalWidth,
                          EqValue.size() +
-                             argPlusPrefixesSize(O.ArgStr));
+                             argPlusPrefixesSize(O.ArgStr), OS);
     for (unsigned i = 0, e = getNumOptions(); i != e; ++i) {
       StringRef OptionName = getOption(i);
       StringRef Description = getDescription(i);
       if (!shouldPrintOption(OptionName, Description, O))
         continue;
       size_t FirstLineIndent = OptionName.size() + getOptionPrefixesSize();
-      outs() << OptionPrefix << OptionName;
+      OS << OptionPrefix << OptionName;
       if (OptionName.empty()) {
-        outs() << EmptyOption;
+        OS << EmptyOption;
         assert(FirstLineIndent >= EmptyOption.size());
         FirstLineIndent += EmptyOption.size();
       }
       if (!Description.empty())
-        Option::printEnumValHelpStr(Description, GlobalWidth, FirstLineIndent);
+        Option::printEnumValHelpStr(Description, GlobalWidth, FirstLineIndent,
+                                    OS);
       else
-        outs() << '\n';
+        OS << '\n';
     }
   } else {
     if (!O.HelpStr.empty())
-      outs() << "  " << O.HelpStr << '\n';
+      OS << "  " << O.HelpStr << '\n';
     for (unsigned i = 0, e = getNumOptions(); i != e; ++i) {
       StringRef Option = getOption(i);
-      outs() << "    " << PrintArg(Option);
-      Option::printHelpStr(getDescription(i), GlobalWidth, Option.size() + 8);
+      OS << "    " << PrintArg(Option);
+      Option::printHelpStr(getDescription(i), GlobalWidth, Option.size() + 8,
+                           OS);
     }
   }
 }
@@ -2168,51 +3026,52 @@ static const size_t MaxOptWidth = 8; // arbitrary spacing for printOptionDiff
 // "Generic" options have each value mapped to a name.
 void generic_parser_base::printGenericOptionDiff(
     const Option &O, const GenericOptionValue &Value,
-    const GenericOptionValue &Default, size_t GlobalWidth) const {
-  outs() << "  " << PrintArg(O.ArgStr);
-  outs().indent(GlobalWidth - O.ArgStr.size());
+    const GenericOptionValue &Default, size_t GlobalWidth,
+    raw_ostream &OS) const {
+  OS << "  " << PrintArg(O.ArgStr);
+  OS.indent(GlobalWidth - O.ArgStr.size());
 
   unsigned NumOpts = getNumOptions();
   for (unsigned i = 0; i != NumOpts; ++i) {
     if (Value.compare(getOptionValue(i)))
       continue;
 
-    outs() << "= " << getOption(i);
+    OS << "= " << getOption(i);
     size_t L = getOption(i).size();
     size_t NumSpaces = MaxOptWidth > L ? MaxOptWidth - L : 0;
-    outs().indent(NumSpaces) << " (default: ";
+    OS.indent(NumSpaces) << " (default: ";
     for (unsigned j = 0; j != NumOpts; ++j) {
       if (Default.compare(getOptionValue(j)))
         continue;
-      outs() << getOption(j);
+      OS << getOption(j);
       break;
     }
-    outs() << ")\n";
+    OS << ")\n";
     return;
   }
-  outs() << "= *unknown option value*\n";
+  OS << "= *unknown option value*\n";
 }
 
 // printOptionDiff - Specializations for printing basic value types.
 //
 #define PRINT_OPT_DIFF(T)                                                      \
   void parser<T>::printOptionDiff(const Option &O, T V, OptionValue<T> D,      \
-                                  size_t GlobalWidth) const {                  \
-    printOptionName(O, GlobalWidth);                                           \
+                                  size_t GlobalWidth, raw_ostream &OS) const { \
+    printOptionName(O, GlobalWidth, OS);                                       \
     std::string Str;                                                           \
     {                                                                          \
       raw_string_ostream SS(Str);                                              \
       SS << V;                                                                 \
     }                                                                          \
-    outs() << "= " << Str;                                                     \
+    OS << "= " << Str;                                                         \
     size_t NumSpaces =                                                         \
         MaxOptWidth > Str.size() ? MaxOptWidth - Str.size() : 0;               \
-    outs().indent(NumSpaces) << " (default: ";                                 \
+    OS.indent(NumSpaces) << " (default: ";                                     \
     if (D.hasValue())                                                          \
-      outs() << D.getValue();                                                  \
+      OS << D.getValue();                                                      \
     else                                                                       \
-      outs() << "*no default*";                                                \
-    outs() << ")\n";                                                           \
+      OS << "*no default*";                                                    \
+    OS << ")\n";                                                               \
   }
 
 PRINT_OPT_DIFF(bool)
@@ -2229,23 +3088,24 @@ PRINT_OPT_DIFF(char)
 
 void parser<std::string>::printOptionDiff(const Option &O, StringRef V,
                                           const OptionValue<std::string> &D,
-                                          size_t GlobalWidth) const {
-  printOptionName(O, GlobalWidth);
-  outs() << "= " << V;
+                                          size_t GlobalWidth,
+                                          raw_ostream &OS) const {
+  printOptionName(O, GlobalWidth, OS);
+  OS << "= " << V;
   size_t NumSpaces = MaxOptWidth > V.size() ? MaxOptWidth - V.size() : 0;
-  outs().indent(NumSpaces) << " (default: ";
+  OS.indent(NumSpaces) << " (default: ";
   if (D.hasValue())
-    outs() << D.getValue();
+    OS << D.getValue();
   else
-    outs() << "*no default*";
-  outs() << ")\n";
+    OS << "*no default*";
+  OS << ")\n";
 }
 
 // Print a placeholder for options that don't yet support printOptionDiff().
-void basic_parser_impl::printOptionNoValue(const Option &O,
-                                           size_t GlobalWidth) const {
-  printOptionName(O, GlobalWidth);
-  outs() << "= *cannot print option value*\n";
+void basic_parser_impl::printOptionNoValue(const Option &O, size_t GlobalWidth,
+                                           raw_ostream &OS) const {
+  printOptionName(O, GlobalWidth, OS);
+  OS << "= *cannot print option value*\n";
 }
 
 //===----------------------------------------------------------------------===//
@@ -2310,20 +3170,33 @@ protected:
       StrOptionPairVector;
   typedef SmallVector<std::pair<const char *, SubCommand *>, 128>
       StrSubCommandPairVector;
+
+  // Help text rendered by this printer, per subcommand. An entry is only valid
+  // while the registry generation it was rendered against is current.
+  struct RenderedHelp {
+    uint64_t Generation = 0;
+    std::string Text;
+  };
+  DenseMap<SubCommand *, RenderedHelp> Rendered;
+
   // Print the options. Opts is assumed to be alphabetically sorted.
-  virtual void printOptions(StrOptionPairVector &Opts, size_t MaxArgLen) {
+  virtual void printOptions(StrOptionPairVector &Opts, size_t MaxArgLen,
+                            raw_ostream &OS) {
     for (size_t i = 0, e = Opts.size(); i != e; ++i)
-      Opts[i].second->printOptionInfo(MaxArgLen);
+      Opts[i].second->printOptionInfo(MaxArgLen, OS);
   }
 
-  void printSubCommands(StrSubCommandPairVector &Subs, size_t MaxSubLen) {
+  virtual bool isCategorized() const { return false; }
+
+  void printSubCommands(StrSubCommandPairVector &Subs, size_t MaxSubLen,
+                        raw_ostream &OS) {
     for (const auto &S : Subs) {
-      outs() << "  " << S.first;
+      OS << "  " << S.first;
       if (!S.second->getDescription().empty()) {
-        outs().indent(MaxSubLen - strlen(S.first));
-        outs() << " - " << S.second->getDescription();
+        OS.indent(MaxSubLen - strlen(S.first));
+        OS << " - " << S.second->getDescription();
       }
-      outs() << "\n";
+      OS << "\n";
     }
   }
 
@@ -2335,14 +3208,39 @@ public:
   void operator=(bool Value) {
     if (!Value)
       return;
-    printHelp();
+    if (ThreadDiags) {
+      DiagsAccess::requestHelp(*ThreadDiags, ShowHidden, isCategorized());
+      return;
+    }
+    printHelp(outs());
 
     // Halt the program since help information was printed
     exit(0);
   }
 
-  void printHelp() {
-    SubCommand *Sub = GlobalParser->getActiveSubCommand();
+  // Write the help text for the active subcommand to OS with a single write,
+  // rendering it first if the registry changed since it was last rendered.
+  void printHelp(raw_ostream &OS) {
+    GlobalParser->mergePendingRegistrations();
+    CommandLineParser::WalkingTables PrintInProgress(*GlobalParser);
+    SubCommand *Sub = GlobalParser->getDescribedSubCommand();
+    ParseTraceScope Trace("printHelp", Sub->getName());
+    RenderedHelp &Entry = Rendered[Sub];
+    if (Entry.Text.empty() ||
+        Entry.Generation != GlobalParser->getRegistryGeneration()) {
+      Entry.Text.clear();
+      raw_string_ostream SS(Entry.Text);
+      renderHelp(Sub, SS);
+      SS.flush();
+      // Rendering consumes the extra help, which bumps the generation; stamp
+      // the entry afterwards so the text stays valid until the next change.
+      Entry.Generation = GlobalParser->getRegistryGeneration();
+    }
+    OS.write(Entry.Text.data(), Entry.Text.size());
+  }
+
+  void renderHelp(SubCommand *Sub, raw_ostream &OS) {
+    ParseTraceScope Trace("renderHelp", Sub->getName());
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
     auto &ConsumeAfterOpt = Sub->ConsumeAfterOpt;
@@ -2354,31 +3252,31 @@ public:
     sortSubCommands(GlobalParser->RegisteredSubCommands, Subs);
 
     if (!GlobalParser->ProgramOverview.empty())
-      outs() << "OVERVIEW: " << GlobalParser->ProgramOverview << "\n";
+      OS << "OVERVIEW: " << GlobalParser->ProgramOverview << "\n";
 
     if (Sub == &SubCommand::getTopLevel()) {
-      outs() << "USAGE: " << GlobalParser->ProgramName;
+      OS << "USAGE: " << GlobalParser->ProgramName;
       if (Subs.size() > 2)
-        outs() << " [subcommand]";
-      outs() << " [options]";
+        OS << " [subcommand]";
+      OS << " [options]";
     } else {
       if (!Sub->getDescription().empty()) {
-        outs() << "SUBCOMMAND '" << Sub->getName()
+        OS << "SUBCOMMAND '" << Sub->getName()
                << "': " << Sub->getDescription() << "\n\n";
       }
-      outs() << "USAGE: " << GlobalParser->ProgramName << " " << Sub->getName()
+      OS << "USAGE: " << GlobalParser->ProgramName << " " << Sub->getName()
              << " [options]";
     }
 
     for (auto *Opt : PositionalOpts) {
       if (Opt->hasArgStr())
-        outs() << " --" << Opt->ArgStr;
-      outs() << " " << Opt->HelpStr;
+        OS << " --" << Opt->ArgStr;
+      OS << " " << Opt->HelpStr;
     }
 
     // Print the consume after option info if it exists...
     if (ConsumeAfterOpt)
-      outs() << " " << ConsumeAfterOpt->HelpStr;
+      OS << " " << ConsumeAfterOpt->HelpStr;
 
     if (Sub == &SubCommand::getTopLevel() && !Subs.empty()) {
       // Compute the maximum subcommand length...
@@ -2386,29 +3284,29 @@ public:
       for (size_t i = 0, e = Subs.size(); i != e; ++i)
         MaxSubLen = std::max(MaxSubLen, strlen(Subs[i].first));
 
-      outs() << "\n\n";
-      outs() << "SUBCOMMANDS:\n\n";
-      printSubCommands(Subs, MaxSubLen);
-      outs() << "\n";
-      outs() << "  Type \"" << GlobalParser->ProgramName
+      OS << "\n\n";
+      OS << "SUBCOMMANDS:\n\n";
+      printSubCommands(Subs, MaxSubLen, OS);
+      OS << "\n";
+      OS << "  Type \"" << GlobalParser->ProgramName
              << " <subcommand> --help\" to get more help on a specific "
                 "subcommand";
     }
 
-    outs() << "\n\n";
+    OS << "\n\n";
 
     // Compute the maximum argument length...
     size_t MaxArgLen = 0;
     for (size_t i = 0, e = Opts.size(); i != e; ++i)
       MaxArgLen = std::max(MaxArgLen, Opts[i].second->getOptionWidth());
 
-    outs() << "OPTIONS:\n";
-    printOptions(Opts, MaxArgLen);
+    OS << "OPTIONS:\n";
+    printOptions(Opts, MaxArgLen, OS);
 
     // Print any extra help the user has declared.
     for (const auto &I : GlobalParser->MoreHelp)
-      outs() << I;
-    GlobalParser->MoreHelp.clear();
+      OS << I;
+    GlobalParser->clearMoreHelp();
   }
 };
 
@@ -2416,6 +3314,8 @@ class CategorizedHelpPrinter : public HelpPrinter {
 public:
   explicit CategorizedHelpPrinter(bool showHidden) : HelpPrinter(showHidden) {}
 
+  bool isCategorized() const override { return true; }
+
   // Helper function for printOptions().
   // It shall return a negative value if A's name should be lexicographically
   // ordered before B's name. It returns a value greater than zero if B's name
@@ -2429,7 +3329,8 @@ public:
   using HelpPrinter::operator=;
 
 protected:
-  void printOptions(StrOptionPairVector &Opts, size_t MaxArgLen) override {
+  void printOptions(StrOptionPairVector &Opts, size_t MaxArgLen,
+                    raw_ostream &OS) override {
     std::vector<OptionCategory *> SortedCategories;
     DenseMap<OptionCategory *, std::vector<Option *>> CategorizedOptions;
 
@@ -2464,24 +3365,24 @@ protected:
         continue;
 
       // Print category information.
-      outs() << "\n";
-      outs() << Category->getName() << ":\n";
+      OS << "\n";
+      OS << Category->getName() << ":\n";
 
       // Check if description is set.
       if (!Category->getDescription().empty())
-        outs() << Category->getDescription() << "\n\n";
+        OS << Category->getDescription() << "\n\n";
       else
-        outs() << "\n";
+        OS << "\n";
 
       // When using --help-hidden explicitly state if the category has no
       // options associated with it.
       if (IsEmptyCategory) {
-        outs() << "  This option category has no options.\n";
+        OS << "  This option category has no options.\n";
         continue;
       }
       // Loop over the options in the category and print.
       for (const Option *Opt : CategoryOptions)
-        Opt->printOptionInfo(MaxArgLen);
+        Opt->printOptionInfo(MaxArgLen, OS);
     }
   }
 };
@@ -2558,6 +3459,21 @@ public:
   void operator=(bool OptionWasSpecified);
 };
 
+class CompletionScriptPrinter {
+public:
+  void operator=(CompletionShell Shell);
+};
+
+class HelpSearchPrinter {
+public:
+  void operator=(const std::string &Pattern);
+};
+
+class OptionSchemaPrinter {
+public:
+  void operator=(OptionSchemaFormat Format);
+};
+
 struct CommandLineCommonOptions {
   // Declare the four HelpPrinter instances that are used to print out help, or
   // help-hidden as an uncategorized list or in categories.
@@ -2624,6 +3540,7 @@ struct CommandLineCommonOptions {
       cl::desc("Print non-default options after command line parsing"),
       cl::Hidden,
       cl::init(false),
+      cl::DoesNotAffectOutput,
       cl::cat(GenericCategory),
       cl::sub(SubCommand::getAll())};
 
@@ -2632,6 +3549,77 @@ struct CommandLineCommonOptions {
       cl::desc("Print all option values after command line parsing"),
       cl::Hidden,
       cl::init(false),
+      cl::DoesNotAffectOutput,
+      cl::cat(GenericCategory),
+      cl::sub(SubCommand::getAll())};
+
+  cl::opt<OptionValuesFormat> PrintOptionsFormat{
+      "print-options-format",
+      cl::desc("Format of --print-options and --print-all-options"),
+      cl::values(clEnumValN(OptionValuesFormat::Text, "text", "Readable text"),
+                 clEnumValN(OptionValuesFormat::ResponseFile, "response-file",
+                            "Arguments that reproduce the values"),
+                 clEnumValN(OptionValuesFormat::JSON, "json", "JSON"),
+                 clEnumValN(OptionValuesFormat::Origins, "origins",
+                            "Readable text with where each value came from")),
+      cl::init(OptionValuesFormat::Text),
+      cl::Hidden,
+      cl::DoesNotAffectOutput,
+      cl::cat(GenericCategory),
+      cl::sub(SubCommand::getAll())};
+
+  cl::opt<bool> PrintConfigHash{
+      "print-config-hash",
+      cl::desc("Print a fingerprint of the option values after command line "
+               "parsing and exit"),
+      cl::Hidden,
+      cl::init(false),
+      cl::DoesNotAffectOutput,
+      cl::cat(GenericCategory),
+      cl::sub(SubCommand::getAll())};
+
+  cl::opt<bool> PrintParseStats{
+      "print-parse-stats",
+      cl::desc("Print the time spent in each phase of command line parsing"),
+      cl::Hidden,
+      cl::init(false),
+      cl::DoesNotAffectOutput,
+      cl::cat(GenericCategory),
+      cl::sub(SubCommand::getAll())};
+
+  CompletionScriptPrinter CompletionScriptPrinterInstance;
+
+  cl::opt<CompletionScriptPrinter, true, parser<CompletionShell>>
+      CompletionScriptOp{
+          "completion-script",
+          cl::desc("Print shell code that completes this program's arguments"),
+          cl::location(CompletionScriptPrinterInstance),
+          cl::values(clEnumValN(CompletionShell::Bash, "bash", "Bash"),
+                     clEnumValN(CompletionShell::Zsh, "zsh", "Zsh"),
+                     clEnumValN(CompletionShell::Fish, "fish", "Fish")),
+          cl::Hidden,
+          cl::cat(GenericCategory),
+          cl::sub(SubCommand::getAll())};
+
+  HelpSearchPrinter HelpSearchPrinterInstance;
+
+  cl::opt<HelpSearchPrinter, true, parser<std::string>> HelpSearchOp{
+      "help-search",
+      cl::desc("Display the options whose name, description or values match "
+               "a substring or glob"),
+      cl::value_desc("pattern"),
+      cl::location(HelpSearchPrinterInstance),
+      cl::cat(GenericCategory),
+      cl::sub(SubCommand::getAll())};
+
+  OptionSchemaPrinter OptionSchemaPrinterInstance;
+
+  cl::opt<OptionSchemaPrinter, true, parser<OptionSchemaFormat>> OptionSchemaOp{
+      "print-option-schema",
+      cl::desc("Print a machine-readable description of all options"),
+      cl::location(OptionSchemaPrinterInstance),
+      cl::values(clEnumValN(OptionSchemaFormat::JSON, "json", "JSON")),
+      cl::Hidden,
       cl::cat(GenericCategory),
       cl::sub(SubCommand::getAll())};
 
@@ -2651,19 +3639,28 @@ struct CommandLineCommonOptions {
 
 // Lazy-initialized global instance of options controlling the command-line
 // parser and general handling.
-static ManagedStatic<CommandLineCommonOptions> CommonOptions;
+static Commandline::ManagedStatic<CommandLineCommonOptions> CommonOptions;
 
 static void initCommonOptions() {
   *CommonOptions;
-  initDebugCounterOptions();
-  initGraphWriterOptions();
-  initSignalsOptions();
-  initStatisticOptions();
-  initTimerOptions();
-  initTypeSizeOptions();
-  initWithColorOptions();
-  initDebugOptions();
-  initRandomSeedOptions();
+}
+
+// Returns true if the fingerprint was printed and the parse collecting
+// diagnostics should report ParseResult::Exit.
+static bool handlePrintConfigHash() {
+  if (!CommonOptions->PrintConfigHash)
+    return false;
+  PrintConfigFingerprint(outs());
+  outs().flush();
+  if (!ThreadDiags)
+    exit(0);
+  DiagsAccess::request(*ThreadDiags, ParseResult::Exit);
+  return true;
+}
+
+static void handlePrintParseStats() {
+  if (CommonOptions->PrintParseStats)
+    PrintParseStats(GetLastParseStats(), errs());
 }
 
 OptionCategory &cl::getGeneralCategory() {
@@ -2672,10 +3669,24 @@ OptionCategory &cl::getGeneralCategory() {
   return GeneralCategory;
 }
 
+// Exit after an option printed its output, or end the parse collecting
+// diagnostics on this thread with ParseResult::Exit.
+static void exitAfterPrinting() {
+  if (!ThreadDiags)
+    exit(0);
+  outs().flush();
+  DiagsAccess::request(*ThreadDiags, ParseResult::Exit);
+}
+
 void VersionPrinter::operator=(bool OptionWasSpecified) {
   if (!OptionWasSpecified)
     return;
 
+  if (ThreadDiags) {
+    DiagsAccess::request(*ThreadDiags, ParseResult::Version);
+    return;
+  }
+
   if (CommonOptions->OverrideVersionPrinter != nullptr) {
     CommonOptions->OverrideVersionPrinter(outs());
     exit(0);
@@ -2685,6 +3696,25 @@ void VersionPrinter::operator=(bool OptionWasSpecified) {
   exit(0);
 }
 
+void CompletionScriptPrinter::operator=(CompletionShell Shell) {
+  PrintCompletionScript(Shell, GlobalParser->ProgramName, outs());
+  exitAfterPrinting();
+}
+
+void HelpSearchPrinter::operator=(const std::string &Pattern) {
+  PrintHelpSearch(*GlobalParser->getDescribedSubCommand(), Pattern, outs());
+  exitAfterPrinting();
+}
+
+void OptionSchemaPrinter::operator=(OptionSchemaFormat Format) {
+  switch (Format) {
+  case OptionSchemaFormat::JSON:
+    PrintOptionSchema(outs());
+    break;
+  }
+  exitAfterPrinting();
+}
+
 void HelpPrinterWrapper::operator=(bool Value) {
   if (!Value)
     return;
@@ -2703,34 +3733,206 @@ void HelpPrinterWrapper::operator=(bool Value) {
 }
 
 // Print the value of each option.
-void cl::PrintOptionValues() { GlobalParser->printOptionValues(); }
-
-void CommandLineParser::printOptionValues() {
+void cl::PrintOptionValues() {
   if (!CommonOptions->PrintOptions && !CommonOptions->PrintAllOptions)
     return;
+  GlobalParser->printOptionValues(outs(), CommonOptions->PrintOptionsFormat,
+                                  CommonOptions->PrintAllOptions);
+}
+
+void cl::PrintOptionValues(raw_ostream &OS, OptionValuesFormat Format,
+                           bool All) {
+  GlobalParser->printOptionValues(OS, Format, All);
+}
+
+// Append the arguments that give O the values in Texts.
+static void getOptionArgs(const Option *O, ArrayRef<std::string> Texts,
+                          std::vector<std::string> &Args) {
+  for (const std::string &Text : Texts) {
+    if (O->isPositional() || O->isSink() || O->isConsumeAfter()) {
+      Args.push_back(Text);
+    } else if (!O->hasArgStr()) {
+      // The values are the option names, e.g. -O2.
+      Args.push_back((argPrefix(Text, 0) + Text).str());
+    } else if (O->getValueExpectedFlag() == cl::ValueDisallowed) {
+      if (Text == "true")
+        Args.push_back((argPrefix(O->ArgStr, 0) + O->ArgStr).str());
+    } else if (O->getFormattingFlag() == cl::AlwaysPrefix) {
+      Args.push_back((argPrefix(O->ArgStr, 0) + O->ArgStr + Text).str());
+    } else {
+      Args.push_back((argPrefix(O->ArgStr, 0) + O->ArgStr + "=" + Text).str());
+    }
+  }
+}
 
-  SmallVector<std::pair<const char *, Option *>, 128> Opts;
-  sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
+static void printResponseFile(ArrayRef<Option *> Opts, raw_ostream &OS) {
+  std::vector<std::string> Named, Positional, ConsumeAfter;
+  SmallVector<std::string, 4> Texts;
+  for (Option *O : Opts) {
+    // Replaying the options that requested this output would print it again.
+    if (O == &CommonOptions->PrintOptions ||
+        O == &CommonOptions->PrintAllOptions ||
+        O == &CommonOptions->PrintOptionsFormat)
+      continue;
+    Texts.clear();
+    if (!O->getValueTexts(Texts))
+      continue;
+    if (O->isConsumeAfter())
+      getOptionArgs(O, Texts, ConsumeAfter);
+    else if (O->isPositional())
+      getOptionArgs(O, Texts, Positional);
+    else
+      getOptionArgs(O, Texts, Named);
+  }
 
-  // Compute the maximum argument length...
-  size_t MaxArgLen = 0;
-  for (size_t i = 0, e = Opts.size(); i != e; ++i)
-    MaxArgLen = std::max(MaxArgLen, Opts[i].second->getOptionWidth());
+  SmallString<128> Line;
+  auto Emit = [&](StringRef Arg) {
+    Line.clear();
+    cl::QuoteGNUCommandLineArg(Arg, Line);
+    OS << Line << '\n';
+  };
+  for (const std::string &Arg : Named)
+    Emit(Arg);
+  // Keep positional values that look like options from being parsed as such.
+  if (any_of(Positional, [](StringRef Arg) { return Arg.startswith("-"); }) ||
+      any_of(ConsumeAfter, [](StringRef Arg) { return Arg.startswith("-"); }))
+    Emit("--");
+  for (const std::string &Arg : Positional)
+    Emit(Arg);
+  for (const std::string &Arg : ConsumeAfter)
+    Emit(Arg);
+}
+
+static void printValuesJSON(ArrayRef<Option *> Opts, raw_ostream &OS) {
+  json::OStream J(OS, 2);
+  J.object([&] {
+    J.attributeArray("options", [&] {
+      for (Option *O : Opts) {
+        J.object([&] {
+          J.attribute("name", O->ArgStr);
+          O->writeValueSchema(J);
+          J.attributeBegin("value");
+          O->writeValueJSON(J);
+          J.attributeEnd();
+          J.attribute("num_occurrences", O->getNumOccurrences());
+          SmallVector<ValueOrigin, 1> Origins = GetValueOrigins(*O);
+          if (!Origins.empty())
+            J.attributeArray("origins", [&] {
+              for (ValueOrigin Origin : Origins)
+                J.value(DescribeValueOrigin(Origin));
+            });
+        });
+      }
+    });
+  });
+  OS << '\n';
+}
+
+void CommandLineParser::printOptionValues(raw_ostream &OS,
+                                          OptionValuesFormat Format,
+                                          bool All) {
+  mergePendingRegistrations();
+  WalkingTables PrintInProgress(*this);
+  // The output describes the configuration, which may be replayed or shared;
+  // this thread's overrides are not part of it.
+  cl::detail::SuspendOverrides Suspend;
+  SubCommand *Sub = getDescribedSubCommand();
+  SmallVector<std::pair<const char *, Option *>, 128> SortedOpts;
+  sortOpts(Sub->OptionsMap, SortedOpts, /*ShowHidden*/ true);
+
+  // Untouched options still hold their default, so only touched ones need
+  // the (virtual) value comparison.
+  SmallVector<Option *, 128> Opts;
+  auto Select = [&](Option *O) {
+    if (All || (O->isValueTouched() && O->valueDiffersFromDefault()))
+      Opts.push_back(O);
+  };
+  for (auto &Opt : SortedOpts)
+    Select(Opt.second);
+  if (Format != OptionValuesFormat::Text &&
+      Format != OptionValuesFormat::Origins) {
+    for (Option *O : Sub->SinkOpts)
+      Select(O);
+    for (Option *O : Sub->PositionalOpts)
+      Select(O);
+    if (Sub->ConsumeAfterOpt)
+      Select(Sub->ConsumeAfterOpt);
+  }
+
+  std::string Buffer;
+  raw_string_ostream SS(Buffer);
+  switch (Format) {
+  case OptionValuesFormat::Text: {
+    // Compute the maximum argument length...
+    size_t MaxArgLen = 0;
+    for (Option *O : Opts)
+      MaxArgLen = std::max(MaxArgLen, O->getOptionWidth());
+    for (Option *O : Opts)
+      O->printOptionValue(MaxArgLen, /*Force=*/true, SS);
+    break;
+  }
+  case OptionValuesFormat::Origins: {
+    size_t MaxArgLen = 0;
+    for (Option *O : Opts)
+      MaxArgLen = std::max(MaxArgLen, O->getOptionWidth());
+    SmallString<128> Origins;
+    for (Option *O : Opts) {
+      O->printOptionValue(MaxArgLen, /*Force=*/true, SS);
+      Origins.clear();
+      raw_svector_ostream OriginsOS(Origins);
+      PrintValueOrigins(*O, OriginsOS);
+      if (!Origins.empty())
+        SS.indent(4) << Origins << '\n';
+    }
+    break;
+  }
+  case OptionValuesFormat::ResponseFile:
+    printResponseFile(Opts, SS);
+    break;
+  case OptionValuesFormat::JSON:
+    printValuesJSON(Opts, SS);
+    break;
+  }
+  SS.flush();
+  OS.write(Buffer.data(), Buffer.size());
+}
+
+void cl::printListOptionDiff(const Option &O, ArrayRef<std::string> Values,
+                             ArrayRef<std::string> Defaults,
+                             size_t GlobalWidth, raw_ostream &OS) {
+  OS << PrintArg(O.ArgStr);
+  OS.indent(GlobalWidth - O.ArgStr.size());
+  std::string Str = "[" + join(Values, ", ") + "]";
+  OS << "= " << Str;
+  size_t NumSpaces = MaxOptWidth > Str.size() ? MaxOptWidth - Str.size() : 0;
+  OS.indent(NumSpaces) << " (default: [" << join(Defaults, ", ") << "])\n";
+}
 
-  for (size_t i = 0, e = Opts.size(); i != e; ++i)
-    Opts[i].second->printOptionValue(MaxArgLen, CommonOptions->PrintAllOptions);
+void cl::printScalarOptionDiff(const Option &O, StringRef Value,
+                               StringRef Default, size_t GlobalWidth,
+                               raw_ostream &OS) {
+  OS << PrintArg(O.ArgStr);
+  OS.indent(GlobalWidth - O.ArgStr.size());
+  OS << "= " << Value;
+  size_t NumSpaces =
+      MaxOptWidth > Value.size() ? MaxOptWidth - Value.size() : 0;
+  OS.indent(NumSpaces) << " (default: " << Default << ")\n";
 }
 
 // Utility function for printing the help message.
 void cl::PrintHelpMessage(bool Hidden, bool Categorized) {
+  PrintHelpMessage(outs(), Hidden, Categorized);
+}
+
+void cl::PrintHelpMessage(raw_ostream &OS, bool Hidden, bool Categorized) {
   if (!Hidden && !Categorized)
-    CommonOptions->UncategorizedNormalPrinter.printHelp();
+    CommonOptions->UncategorizedNormalPrinter.printHelp(OS);
   else if (!Hidden && Categorized)
-    CommonOptions->CategorizedNormalPrinter.printHelp();
+    CommonOptions->CategorizedNormalPrinter.printHelp(OS);
   else if (Hidden && !Categorized)
-    CommonOptions->UncategorizedHiddenPrinter.printHelp();
+    CommonOptions->UncategorizedHiddenPrinter.printHelp(OS);
   else
-    CommonOptions->CategorizedHiddenPrinter.printHelp();
+    CommonOptions->CategorizedHiddenPrinter.printHelp(OS);
 }
 
 /// Utility function for printing version number.
@@ -2748,17 +3950,54 @@ void cl::AddExtraVersionPrinter(VersionPrinterTy func) {
 
 StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
   initCommonOptions();
+  GlobalParser->mergePendingRegistrations();
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
-  assert(Subs.contains(&Sub));
+  assert(Subs.count(&Sub));
   return Sub.OptionsMap;
 }
 
+uint64_t cl::getRegistryGeneration() {
+  return GlobalParser->getRegistryGeneration();
+}
+
 iterator_range<typename SmallPtrSet<SubCommand *, 4>::iterator>
 cl::getRegisteredSubcommands() {
+  // As for getRegisteredOptions, the tables include the common options, so
+  // that the option state layout does not depend on whether a parse ran.
+  initCommonOptions();
   return GlobalParser->getRegisteredSubcommands();
 }
 
+Option *cl::findRegisteredOption(StringRef Name, SubCommand &Sub) {
+  initCommonOptions();
+  GlobalParser->mergePendingRegistrations();
+  CommandLineParser::WalkingTables Lookup(*GlobalParser);
+  return Sub.OptionsMap.lookup(Name);
+}
+
+void cl::forEachRegisteredOption(function_ref<void(StringRef, Option &)> Fn,
+                                 SubCommand &Sub) {
+  initCommonOptions();
+  GlobalParser->mergePendingRegistrations();
+  CommandLineParser::WalkingTables Walk(*GlobalParser);
+  for (auto &Entry : Sub.OptionsMap)
+    Fn(Entry.getKey(), *Entry.getValue());
+}
+
+OptionCategory *cl::findRegisteredCategory(StringRef Name) {
+  GlobalParser->mergePendingRegistrations();
+  CommandLineParser::WalkingTables Lookup(*GlobalParser);
+  for (OptionCategory *Category : GlobalParser->RegisteredOptionCategories)
+    if (Category->getName() == Name)
+      return Category;
+  return nullptr;
+}
+
+void cl::setActiveSubCommand(SubCommand &Sub) {
+  GlobalParser->setActiveSubCommand(&Sub);
+}
+
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
   initCommonOptions();
   for (auto &I : Sub.OptionsMap) {
@@ -2792,8 +4031,11 @@ void cl::ResetAllOptionOccurrences() {
   GlobalParser->ResetAllOptionOccurrences();
 }
 
+// LLVMSupport defines this C entry point itself, for LLVM's own parser.
+#if !COMMANDLINE_USE_LLVM
 void LLVMParseCommandLineOptions(int argc, const char *const *argv,
                                  const char *Overview) {
-  llvm::cl::ParseCommandLineOptions(argc, argv, StringRef(Overview),
+  cl::ParseCommandLineOptions(argc, argv, StringRef(Overview),
                                     &llvm::nulls());
 }
+#endif
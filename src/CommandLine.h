@@ -3,17 +3,38 @@
 
 #include "Alias.h"
 #include "Applicator.h"
+#include "Behavior.h"
 #include "Bits.h"
+#include "Completion.h"
+#include "ConfigHash.h"
+#include "DynamicOptions.h"
+#include "GeneratedOptions.h"
+#include "HelpSearch.h"
 #include "List.h"
 #include "ManagedStatic.h"
 #include "Opt.h"
 #include "OptionCategory.h"
 #include "OptionEnum.h"
+#include "OptionOverride.h"
+#include "OptionReadProfile.h"
+#include "OptionSchema.h"
+#include "OptionState.h"
 #include "OptionValue.h"
+#include "PackedFlags.h"
+#include "ParseDiagnostics.h"
+#include "ParseCache.h"
+#include "ParseServer.h"
+#include "ParseStats.h"
+#include "ParseTrace.h"
 #include "Parser.h"
+#include "RegistrationScope.h"
+#include "RuntimeTuning.h"
+#include "StaticOptions.h"
 #include "SubCommand.h"
+#include "ValueProvenance.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
@@ -21,7 +42,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
@@ -48,6 +69,16 @@ bool ParseCommandLineOptions(int argc, const char* const* argv,
                              const char* EnvVar = nullptr,
                              bool LongOptionsUseDoubleDash = false);
 
+// Parse like the overload above, but record errors in Diags instead of
+// printing them, and return help, version and other printing options as
+// results instead of exiting. Earlier records in Diags are dropped. With
+// fail-fast set, parsing stops at the first error.
+ParseResult ParseCommandLineOptions(int argc, const char* const* argv,
+                                    ParseDiagnostics& Diags,
+                                    llvm::StringRef Overview = "",
+                                    const char* EnvVar = nullptr,
+                                    bool LongOptionsUseDoubleDash = false);
+
 // Function pointer type for printing version information.
 using VersionPrinterTy = std::function<void(llvm::raw_ostream&)>;
 
@@ -67,20 +98,28 @@ void AddExtraVersionPrinter(VersionPrinterTy func);
 // Print option values.
 // With -print-options print the difference between option values and defaults.
 // With -print-all-options print all option values.
-// (Currently not perfect, but best-effort.)
+// The output format is chosen with -print-options-format.
 void PrintOptionValues();
 
-// Forward declaration - AddLiteralOption needs to be up here to make gcc happy.
-class Option;
+// Output formats of PrintOptionValues.
+enum class OptionValuesFormat {
+  Text,          // "-name = value (default: ...)" lines for humans.
+  ResponseFile,  // One quoted argument per line, replayable as @file.
+  JSON,          // {"options": [...]} with each value and its default.
+  Origins,       // Text, each value followed by where it came from.
+};
 
-/// Adds a new option for parsing and provides the option it refers to.
+/// Prints the option values of the active subcommand to \p OS in \p Format
+/// with a single write.
 ///
-/// \param O pointer to the option
-/// \param Name the string name for the option to handle during parsing
+/// \param All print every option instead of only those whose value differs
+/// from the default. Options that were never parsed or assigned are skipped
+/// without comparing their values.
 ///
-/// Literal options are used by some parsers to register special option values.
-/// This is how the PassNameParser registers pass names for opt.
-void AddLiteralOption(Option& O, llvm::StringRef Name);
+/// The Text and Origins formats only cover named options; the other formats
+/// also include positional, sink and consume-after options.
+void PrintOptionValues(llvm::raw_ostream& OS, OptionValuesFormat Format,
+                       bool All = false);
 
 // Provide additional help at the end of the normal help output. All occurrences
 // of cl::extrahelp will be accumulated and printed to stderr at the end of the
@@ -100,6 +139,14 @@ void PrintVersionMessage();
 /// \param Categorized if true print options in categories
 void PrintHelpMessage(bool Hidden = false, bool Categorized = false);
 
+/// Prints the help message to \p OS instead of stdout.
+///
+/// The rendered text is cached per subcommand and printer kind, and rendered
+/// again only after the set of registered options changes, so repeated calls
+/// cost a single write.
+void PrintHelpMessage(llvm::raw_ostream& OS, bool Hidden = false,
+                      bool Categorized = false);
+
 //===----------------------------------------------------------------------===//
 // Public interface for accessing registered options.
 //
@@ -134,6 +181,28 @@ void PrintHelpMessage(bool Hidden = false, bool Categorized = false);
 llvm::StringMap<Option*>& getRegisteredOptions(
     SubCommand& Sub = SubCommand::getTopLevel());
 
+/// Returns the option registered with \p Sub under \p Name, or null.
+///
+/// Unlike searching getRegisteredOptions, this may run while other threads
+/// parse, print help or register options: the tables do not change during
+/// the lookup.
+Option* findRegisteredOption(llvm::StringRef Name,
+                             SubCommand& Sub = SubCommand::getTopLevel());
+
+/// Calls \p Fn with each name registered with \p Sub and its option, with
+/// the same guarantee as findRegisteredOption. \p Fn must not register or
+/// remove options.
+void forEachRegisteredOption(
+    llvm::function_ref<void(llvm::StringRef Name, Option& O)> Fn,
+    SubCommand& Sub = SubCommand::getTopLevel());
+
+/// Returns a counter that changes whenever the registered options, literal
+/// values, categories or subcommands change.
+///
+/// Caches of data derived from the registry (rendered help, lookup indexes)
+/// remember the generation they were built against and rebuild on mismatch.
+uint64_t getRegistryGeneration();
+
 /// Use this to get all registered SubCommands from the provided parser.
 ///
 /// \return A range of all SubCommand pointers registered with the parser.
@@ -156,6 +225,19 @@ llvm::StringMap<Option*>& getRegisteredOptions(
 llvm::iterator_range<typename llvm::SmallPtrSet<SubCommand*, 4>::iterator>
 getRegisteredSubcommands();
 
+/// Returns the registered option category named \p Name, or null if there is
+/// none.
+OptionCategory* findRegisteredCategory(llvm::StringRef Name);
+
+/// Makes \p Sub the subcommand that tests true, as if ParseCommandLineOptions
+/// had chosen it. Used when a parse made by another process is restored.
+void setActiveSubCommand(SubCommand& Sub);
+
+/// Sends the messages Option::error would print to llvm::errs() on the
+/// calling thread to \p OS instead, or back to llvm::errs() if \p OS is null.
+/// Returns the stream previously in effect.
+llvm::raw_ostream* redirectThreadErrors(llvm::raw_ostream* OS);
+
 //===----------------------------------------------------------------------===//
 // Standalone command line processing utilities.
 //
@@ -176,6 +258,12 @@ void TokenizeGNUCommandLine(llvm::StringRef Source, llvm::StringSaver& Saver,
                             llvm::SmallVectorImpl<const char*>& NewArgv,
                             bool MarkEOLs = false);
 
+/// Appends \p Arg to \p Out, quoted so that TokenizeGNUCommandLine reads it
+/// back as a single argument. Empty arguments cannot be represented, since the
+/// tokenizer drops empty tokens.
+void QuoteGNUCommandLineArg(llvm::StringRef Arg,
+                            llvm::SmallVectorImpl<char>& Out);
+
 /// Tokenizes a string of Windows command line arguments, which may contain
 /// quotes and escaped quotes.
 ///
@@ -270,11 +358,28 @@ class ExpansionContext {
   /// If true, body of config file is expanded.
   bool InConfigFile = false;
 
+  /// If set, the name and contents of every file read are added to this hash.
+  llvm::MD5* Digest = nullptr;
+
+  /// If set, kept parallel to the expanded Argv with the origin of each
+  /// argument.
+  llvm::SmallVectorImpl<ValueOrigin>* Origins = nullptr;
+
+  /// The origins of the arguments read by the last expandResponseFile call.
+  llvm::SmallVector<ValueOrigin, 0> FileOrigins;
+
   llvm::Error expandResponseFile(llvm::StringRef FName,
                                  llvm::SmallVectorImpl<const char*>& NewArgv);
 
+  void noteFileOrigins(llvm::StringRef FName,
+                       llvm::SmallVectorImpl<const char*>& NewArgv,
+                       size_t FirstArg);
+
  public:
   ExpansionContext(llvm::BumpPtrAllocator& A, TokenizerCallback T);
+  /// Saves the expanded arguments with S, so they live as long as the
+  /// arguments the caller already saved with it.
+  ExpansionContext(llvm::StringSaver& S, TokenizerCallback T);
 
   ExpansionContext& setMarkEOLs(bool X) {
     MarkEOLs = X;
@@ -301,6 +406,18 @@ class ExpansionContext {
     return *this;
   }
 
+  ExpansionContext& setDigest(llvm::MD5* X) {
+    Digest = X;
+    return *this;
+  }
+
+  /// Track the origin of every argument in \p X. Arguments already in Argv
+  /// without an origin are taken to come from the command line.
+  ExpansionContext& setOrigins(llvm::SmallVectorImpl<ValueOrigin>* X) {
+    Origins = X;
+    return *this;
+  }
+
   /// Looks for the specified configuration file.
   ///
   /// \param[in]  FileName Name of the file to search for.
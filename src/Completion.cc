@@ -0,0 +1,316 @@
+#include "Completion.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CommandLine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+
+namespace Commandline {
+
+namespace {
+
+// Option names of one subcommand, sorted so that all names sharing a prefix
+// form a contiguous range.
+struct NameIndex {
+  struct Entry {
+    llvm::StringRef Name;
+    Option* Opt;
+  };
+
+  uint64_t Generation = 0;
+  bool Valid = false;
+  std::vector<Entry> Names;
+};
+
+ManagedStatic<llvm::DenseMap<SubCommand*, NameIndex>> name_indexes;
+
+auto getNameIndex(SubCommand& sub) -> const NameIndex& {
+  NameIndex& index = (*name_indexes)[&sub];
+  llvm::StringMap<Option*>& options = getRegisteredOptions(sub);
+  uint64_t generation = getRegistryGeneration();
+  if (index.Valid && index.Generation == generation) {
+    return index;
+  }
+
+  index.Names.clear();
+  index.Names.reserve(options.size());
+  for (auto& entry : options) {
+    if (entry.second->getOptionHiddenFlag() == ReallyHidden) {
+      continue;
+    }
+    index.Names.push_back({entry.getKey(), entry.second});
+  }
+  llvm::sort(index.Names,
+             [](const NameIndex::Entry& lhs, const NameIndex::Entry& rhs) {
+               return lhs.Name < rhs.Name;
+             });
+  index.Generation = generation;
+  index.Valid = true;
+  return index;
+}
+
+auto findSubCommand(llvm::StringRef name) -> SubCommand* {
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    if (sub == &SubCommand::getAll() || sub->getName().empty()) {
+      continue;
+    }
+    if (sub->getName() == name) {
+      return sub;
+    }
+  }
+  return nullptr;
+}
+
+auto stripDashes(llvm::StringRef word) -> llvm::StringRef {
+  return word.drop_front(word.startswith("--") ? 2 : 1);
+}
+
+// Return the option that word names if it is a complete "-name"/"--name"
+// argument without an attached value.
+auto lookupOptionWord(SubCommand& sub, llvm::StringRef word) -> Option* {
+  if (!word.startswith("-") || word == "-" || word == "--") {
+    return nullptr;
+  }
+  llvm::StringRef name = stripDashes(word);
+  if (name.contains('=')) {
+    return nullptr;
+  }
+  return getRegisteredOptions(sub).lookup(name);
+}
+
+void printOptionCandidates(SubCommand& sub, llvm::StringRef prefix,
+                           llvm::raw_ostream& os) {
+  const NameIndex& index = getNameIndex(sub);
+  auto it = llvm::lower_bound(
+      index.Names, prefix,
+      [](const NameIndex::Entry& entry, llvm::StringRef value) {
+        return entry.Name < value;
+      });
+  for (auto end = index.Names.end(); it != end; ++it) {
+    if (!it->Name.startswith(prefix)) {
+      break;
+    }
+    // Hidden options are only offered once the user started typing a name.
+    if (prefix.empty() && it->Opt->getOptionHiddenFlag() == Hidden) {
+      continue;
+    }
+    os << (it->Name.size() == 1 ? "-" : "--") << it->Name << '\n';
+  }
+}
+
+// Print the values option accepts that start with prefix, each preceded by
+// lead (e.g. "--color=" when completing an attached value).
+void printValueCandidates(const Option& option, llvm::StringRef prefix,
+                          llvm::StringRef lead, llvm::raw_ostream& os) {
+  const generic_parser_base* parser = option.getGenericParser();
+  if (!parser) {
+    os << CompletionFileHint << '\n';
+    return;
+  }
+  for (unsigned i = 0, e = parser->getNumOptions(); i != e; ++i) {
+    llvm::StringRef name = parser->getOption(i);
+    if (!name.empty() && name.startswith(prefix)) {
+      os << lead << name << '\n';
+    }
+  }
+}
+
+auto hasPositionals(const SubCommand& sub) -> bool {
+  return !sub.PositionalOpts.empty() || !sub.SinkOpts.empty() ||
+         sub.ConsumeAfterOpt;
+}
+
+void replaceAll(std::string& text, llvm::StringRef from, llvm::StringRef to) {
+  for (size_t pos = text.find(from.data(), 0, from.size());
+       pos != std::string::npos;
+       pos = text.find(from.data(), pos + to.size(), from.size())) {
+    text.replace(pos, from.size(), to.data(), to.size());
+  }
+}
+
+// The templates below use @PROG@ for the program name and @FUNC@ for a
+// shell-safe identifier derived from it.
+constexpr llvm::StringLiteral bash_template = R"(_@FUNC@_complete() {
+  local cur line
+  local -a words
+  read -ra words <<< "${COMP_LINE:0:COMP_POINT}"
+  [[ "${COMP_LINE:COMP_POINT-1:1}" == " " ]] && words+=("")
+  cur="${words[${#words[@]}-1]}"
+  COMPREPLY=()
+  while IFS= read -r line; do
+    if [[ "$line" == ":file" ]]; then
+      COMPREPLY+=($(compgen -f -- "${cur#*=}"))
+    elif [[ "$cur" == *=* ]]; then
+      COMPREPLY+=("${line#*=}")
+    else
+      COMPREPLY+=("$line")
+    fi
+  done < <("${words[0]}" --complete-args=$((${#words[@]} - 1)) -- \
+             "${words[@]}" 2>/dev/null)
+}
+complete -o filenames -F _@FUNC@_complete @PROG@
+)";
+
+constexpr llvm::StringLiteral zsh_template = R"(#compdef @PROG@
+_@FUNC@() {
+  local line
+  local -a candidates
+  for line in "${(@f)$("${words[1]}" --complete-args=$((CURRENT - 1)) -- \
+                         "${(@)words[1,CURRENT]}" 2>/dev/null)}"; do
+    if [[ "$line" == ":file" ]]; then
+      compset -P '*='
+      _files
+    elif [[ -n "$line" ]]; then
+      candidates+=("$line")
+    fi
+  done
+  (( ${#candidates} )) && compadd -Q -- "${candidates[@]}"
+}
+compdef _@FUNC@ @PROG@
+)";
+
+constexpr llvm::StringLiteral fish_template = R"(function __@FUNC@_complete
+  set -l tokens (commandline -opc) (commandline -ct)
+  set -l cur (commandline -ct)
+  set -l lead (string match -r '^.*=' -- $cur)
+  for line in ($tokens[1] --complete-args=(math (count $tokens) - 1) -- \
+                 $tokens 2>/dev/null)
+    if test "$line" = ":file"
+      __fish_complete_path (string replace -r '^.*=' '' -- $cur) | \
+        string replace -r '^' -- "$lead"
+    else
+      echo $line
+    end
+  end
+end
+complete -c @PROG@ -f -a '(__@FUNC@_complete)'
+)";
+
+}  // namespace
+
+void PrintCompletions(llvm::ArrayRef<llvm::StringRef> words, unsigned index,
+                      llvm::raw_ostream& os) {
+  llvm::StringRef current =
+      index < words.size() ? words[index] : llvm::StringRef();
+
+  // A leading subcommand name selects the registry to complete against.
+  SubCommand* sub = &SubCommand::getTopLevel();
+  unsigned first = 1;
+  if (index > 1 && words.size() > 1 && !words[1].startswith("-")) {
+    if (SubCommand* chosen = findSubCommand(words[1])) {
+      sub = chosen;
+      first = 2;
+    }
+  }
+
+  // Everything after "--" is positional.
+  for (unsigned i = first; i < index && i < words.size(); ++i) {
+    if (words[i] == "--") {
+      os << CompletionFileHint << '\n';
+      return;
+    }
+  }
+
+  // The previous word may be an option waiting for its value ("-o file").
+  if (index > first && index - 1 < words.size()) {
+    Option* previous = lookupOptionWord(*sub, words[index - 1]);
+    if (previous && previous->hasArgStr() &&
+        previous->getValueExpectedFlag() == ValueRequired &&
+        previous->getFormattingFlag() != AlwaysPrefix) {
+      printValueCandidates(*previous, current, "", os);
+      return;
+    }
+  }
+
+  if (current.startswith("-")) {
+    llvm::StringRef name = stripDashes(current);
+    size_t equal_pos = name.find('=');
+    if (equal_pos == llvm::StringRef::npos) {
+      printOptionCandidates(*sub, name, os);
+      return;
+    }
+    Option* option =
+        getRegisteredOptions(*sub).lookup(name.take_front(equal_pos));
+    if (option && option->getValueExpectedFlag() != ValueDisallowed) {
+      llvm::StringRef value = name.drop_front(equal_pos + 1);
+      printValueCandidates(*option, value, current.drop_back(value.size()),
+                           os);
+    }
+    return;
+  }
+
+  if (index == 1) {
+    for (SubCommand* candidate : getRegisteredSubcommands()) {
+      if (candidate->getName().empty()) {
+        continue;
+      }
+      if (candidate->getName().startswith(current)) {
+        os << candidate->getName() << '\n';
+      }
+    }
+  }
+  if (hasPositionals(*sub)) {
+    os << CompletionFileHint << '\n';
+  }
+}
+
+auto HandleCompletionRequest(int argc, const char* const* argv,
+                             llvm::raw_ostream& os) -> bool {
+  if (argc < 2) {
+    return false;
+  }
+  llvm::StringRef request(argv[1]);
+  if (!request.consume_front(CompleteArgsPrefix)) {
+    return false;
+  }
+
+  unsigned index = 0;
+  if (request.getAsInteger(10, index)) {
+    return true;
+  }
+
+  int first = 2;
+  if (first < argc && llvm::StringRef(argv[first]) == "--") {
+    ++first;
+  }
+  llvm::SmallVector<llvm::StringRef, 16> words;
+  for (int i = first; i < argc; ++i) {
+    words.push_back(argv[i]);
+  }
+  PrintCompletions(words, index, os);
+  return true;
+}
+
+void PrintCompletionScript(CompletionShell shell,
+                           llvm::StringRef program_name,
+                           llvm::raw_ostream& os) {
+  std::string function_name = program_name.str();
+  for (char& c : function_name) {
+    if (!llvm::isAlnum(c)) {
+      c = '_';
+    }
+  }
+
+  std::string script;
+  switch (shell) {
+    case CompletionShell::Bash:
+      script = bash_template.str();
+      break;
+    case CompletionShell::Zsh:
+      script = zsh_template.str();
+      break;
+    case CompletionShell::Fish:
+      script = fish_template.str();
+      break;
+  }
+  replaceAll(script, "@FUNC@", function_name);
+  replaceAll(script, "@PROG@", program_name);
+  os << script;
+}
+
+}  // namespace Commandline
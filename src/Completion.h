@@ -0,0 +1,49 @@
+#ifndef COMMANDLINE_COMPLETION_H
+#define COMMANDLINE_COMPLETION_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Shell completion support.
+//
+// A tool answers completion queries of the form
+//
+//    prog --complete-args=<index> -- <word0> <word1> ...
+//
+// where the words are the command line being edited (word0 is the program)
+// and <index> is the position of the word under the cursor. Candidates are
+// printed one per line. A line consisting of CompletionFileHint asks the shell
+// to fall back to its own file name completion.
+//
+// Queries are answered from a sorted name index over the registry, without
+// running the parser or the help machinery.
+
+enum class CompletionShell { Bash, Zsh, Fish };
+
+// Printed in place of a candidate when file names are acceptable.
+constexpr llvm::StringRef CompletionFileHint = ":file";
+
+// The argument that introduces a completion query.
+constexpr llvm::StringRef CompleteArgsPrefix = "--complete-args=";
+
+// Print the completion candidates for words[index] to os.
+void PrintCompletions(llvm::ArrayRef<llvm::StringRef> words, unsigned index,
+                      llvm::raw_ostream& os);
+
+// Handle a completion query if argv is one: print the candidates to os and
+// return true. Otherwise return false without printing anything.
+auto HandleCompletionRequest(int argc, const char* const* argv,
+                             llvm::raw_ostream& os) -> bool;
+
+// Print the glue that registers program_name's completion with shell.
+void PrintCompletionScript(CompletionShell shell,
+                           llvm::StringRef program_name,
+                           llvm::raw_ostream& os);
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_COMPLETION_H
@@ -0,0 +1,172 @@
+#include "ConfigHash.h"
+
+#include <mutex>
+#include <vector>
+
+#include "CommandLine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+
+namespace Commandline {
+
+namespace {
+
+struct ConfigHashState {
+  ConfigFingerprint Sum;
+  llvm::DenseMap<const Option*, ConfigFingerprint> Contributions;
+  // Options changed since the fingerprint was last read. A destroyed option
+  // stays listed but is skipped through Forgotten, since removing it from the
+  // list would cost a scan.
+  std::vector<Option*> Dirty;
+  llvm::SmallPtrSet<const Option*, 8> Forgotten;
+  // Options may be created, changed and destroyed on any thread, so Lock
+  // guards all of the above.
+  std::mutex Lock;
+};
+
+ManagedStatic<ConfigHashState> config_hash;
+
+void addTo(ConfigFingerprint& sum, const ConfigFingerprint& value) {
+  sum.Low += value.Low;
+  sum.High += value.High;
+}
+
+void subtractFrom(ConfigFingerprint& sum, const ConfigFingerprint& value) {
+  sum.Low -= value.Low;
+  sum.High -= value.High;
+}
+
+// Add text to md5 with its length in front, so that adjacent fields cannot
+// run into each other.
+void updateField(llvm::MD5& md5, llvm::StringRef text) {
+  md5.update((llvm::Twine(text.size()) + ":").str());
+  md5.update(text);
+}
+
+// Name unnamed options by their role and place in their subcommand.
+auto optionKey(const Option& option) -> std::string {
+  if (option.hasArgStr()) {
+    return option.ArgStr.str();
+  }
+  SubCommand& sub = option.Subs.empty() ? SubCommand::getTopLevel()
+                                        : **option.Subs.begin();
+  if (option.isConsumeAfter()) {
+    return "#consume-after";
+  }
+  if (option.isSink()) {
+    return "#sink";
+  }
+  auto it = llvm::find(sub.PositionalOpts, &option);
+  return ("#positional" +
+          llvm::Twine(static_cast<size_t>(it - sub.PositionalOpts.begin())))
+      .str();
+}
+
+auto contribution(const Option& option) -> ConfigFingerprint {
+  if (!option.affectsOutput() || option.getAliasTarget()) {
+    return {};
+  }
+  llvm::SmallVector<std::string, 4> texts;
+  if (!option.getValueTexts(texts)) {
+    return {};
+  }
+
+  llvm::MD5 md5;
+  if (option.isInAllSubCommands()) {
+    updateField(md5, "*");
+  } else if (option.Subs.empty()) {
+    updateField(md5, SubCommand::getTopLevel().getName());
+  } else {
+    llvm::SmallVector<llvm::StringRef, 4> names;
+    for (const SubCommand* sub : option.Subs) {
+      names.push_back(sub->getName());
+    }
+    llvm::sort(names);
+    for (llvm::StringRef name : names) {
+      updateField(md5, name);
+    }
+  }
+  updateField(md5, optionKey(option));
+  updateField(md5, option.getStateLayout());
+  md5.update((llvm::Twine(texts.size()) + "#").str());
+  for (const std::string& text : texts) {
+    updateField(md5, text);
+  }
+  llvm::MD5::MD5Result result;
+  md5.final(result);
+  return {result.low(), result.high()};
+}
+
+}  // namespace
+
+void Option::noteValueChanged() {
+  if (ConfigHashDirty.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(config_hash->Lock);
+  if (ConfigHashDirty.load(std::memory_order_relaxed)) {
+    return;
+  }
+  ConfigHashDirty.store(true, std::memory_order_relaxed);
+  // A new option may reuse the address of a forgotten one.
+  if (!config_hash->Forgotten.empty()) {
+    config_hash->Forgotten.erase(this);
+  }
+  config_hash->Dirty.push_back(this);
+}
+
+// Called with config_hash->Lock held.
+void Option::rehashConfig() {
+  ConfigHashDirty.store(false, std::memory_order_relaxed);
+  ConfigFingerprint& stored = config_hash->Contributions[this];
+  subtractFrom(config_hash->Sum, stored);
+  stored = contribution(*this);
+  addTo(config_hash->Sum, stored);
+}
+
+void Option::forgetConfigHash() {
+  std::lock_guard<std::mutex> guard(config_hash->Lock);
+  if (ConfigHashDirty.load(std::memory_order_relaxed)) {
+    ConfigHashDirty.store(false, std::memory_order_relaxed);
+    config_hash->Forgotten.insert(this);
+  }
+  auto it = config_hash->Contributions.find(this);
+  if (it != config_hash->Contributions.end()) {
+    subtractFrom(config_hash->Sum, it->second);
+    config_hash->Contributions.erase(it);
+  }
+}
+
+auto ConfigFingerprint::str() const -> std::string {
+  llvm::SmallString<32> text;
+  llvm::raw_svector_ostream os(text);
+  os << llvm::format_hex_no_prefix(High, 16)
+     << llvm::format_hex_no_prefix(Low, 16);
+  return std::string(text);
+}
+
+auto GetConfigFingerprint() -> ConfigFingerprint {
+  std::lock_guard<std::mutex> guard(config_hash->Lock);
+  // Contributions are shared by all threads.
+  detail::SuspendOverrides suspend;
+  for (Option* option : config_hash->Dirty) {
+    if (!config_hash->Forgotten.contains(option)) {
+      option->rehashConfig();
+    }
+  }
+  config_hash->Dirty.clear();
+  config_hash->Forgotten.clear();
+  return config_hash->Sum;
+}
+
+void PrintConfigFingerprint(llvm::raw_ostream& os) {
+  os << GetConfigFingerprint().str() << '\n';
+}
+
+}  // namespace Commandline
@@ -0,0 +1,52 @@
+#ifndef COMMANDLINE_CONFIG_HASH_H
+#define COMMANDLINE_CONFIG_HASH_H
+
+#include <cstdint>
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Configuration fingerprint.
+//
+// The fingerprint is a 128-bit hash of the effective value of every
+// registered option, whether parsed, assigned or left at its default. Each
+// option contributes a hash of its subcommands, name, value type and value
+// texts (list elements in order); contributions are summed, so the result
+// does not depend on registration order. Options marked DoesNotAffectOutput,
+// aliases and options without a textual value (e.g. --help) are left out.
+//
+// Options queue themselves for rehashing whenever they are registered, parsed,
+// assigned or reset. Reading the fingerprint rehashes only the queued options,
+// so repeated reads cost O(1). Writes made directly to external storage, not
+// through the option, are not noticed.
+
+struct ConfigFingerprint {
+  uint64_t Low = 0;
+  uint64_t High = 0;
+
+  // Return the fingerprint as 32 lowercase hex digits.
+  auto str() const -> std::string;
+
+  friend auto operator==(const ConfigFingerprint& lhs,
+                         const ConfigFingerprint& rhs) -> bool {
+    return lhs.Low == rhs.Low && lhs.High == rhs.High;
+  }
+  friend auto operator!=(const ConfigFingerprint& lhs,
+                         const ConfigFingerprint& rhs) -> bool {
+    return !(lhs == rhs);
+  }
+};
+
+// Return the fingerprint of the current option values. Safe to call from any
+// thread, but values written concurrently may or may not be included.
+auto GetConfigFingerprint() -> ConfigFingerprint;
+
+// Print the fingerprint followed by a newline to os.
+void PrintConfigFingerprint(llvm::raw_ostream& os);
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_CONFIG_HASH_H
@@ -0,0 +1,715 @@
+#include "DynamicOptions.h"
+
+#include <limits>
+#include <memory>
+
+#include "CommandLine.h"
+#include "OptionSchema.h"
+#include "StaticOptions.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace Commandline {
+
+namespace {
+
+auto schemaError(const llvm::Twine& message) -> llvm::Error {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), message);
+}
+
+auto getString(const llvm::json::Object& object, llvm::StringRef key)
+    -> llvm::StringRef {
+  if (auto value = object.getString(key)) {
+    return *value;
+  }
+  return llvm::StringRef();
+}
+
+auto optionLabel(llvm::StringRef name) -> std::string {
+  return name.empty() ? std::string("positional option")
+                      : "option '" + name.str() + "'";
+}
+
+// The description of the entry named name in the schema array key.
+auto findDescription(const llvm::json::Object& schema, llvm::StringRef key,
+                     llvm::StringRef name) -> llvm::StringRef {
+  if (const llvm::json::Array* entries = schema.getArray(key)) {
+    for (const llvm::json::Value& value : *entries) {
+      if (const llvm::json::Object* entry = value.getAsObject()) {
+        if (getString(*entry, "name") == name) {
+          return getString(*entry, "description");
+        }
+      }
+    }
+  }
+  return llvm::StringRef();
+}
+
+// Destroys an option allocated from a set's arena.
+struct destroy_option {
+  void operator()(dynamic_option* option) const { option->~dynamic_option(); }
+};
+
+template <class DataType, class Stored>
+auto parseAs(llvm::StringRef arg, Stored& stored) -> const char* {
+  DataType value{};
+  if (const char* invalid = applyStaticValue(arg, value)) {
+    return invalid;
+  }
+  stored = value;
+  return nullptr;
+}
+
+}  // namespace
+
+// A subcommand named by a schema and not registered by the program. It is
+// unregistered with the options of its set.
+class dynamic_option_set::owned_subcommand : public SubCommand {
+ public:
+  owned_subcommand(llvm::StringRef name, llvm::StringRef description)
+      : SubCommand(name, description) {}
+  ~owned_subcommand() { unregisterSubCommand(); }
+};
+
+// Likewise for a category.
+class dynamic_option_set::owned_category : public OptionCategory {
+ public:
+  owned_category(llvm::StringRef name, llvm::StringRef description)
+      : OptionCategory(name, description) {}
+  ~owned_category() { unregisterCategory(); }
+};
+
+//===----------------------------------------------------------------------===//
+// dynamic_option
+//
+
+dynamic_option::dynamic_option(dynamic_option_set& set, dynamic_value_type type,
+                               llvm::StringRef type_name, bool list)
+    : Option(list ? ZeroOrMore : Optional, NotHidden),
+      Set(set),
+      Type(type),
+      TypeName(type_name),
+      List(list),
+      Printer(*this),
+      EnumPrinter(*this) {}
+
+auto dynamic_option::getBool() const -> bool {
+  assert(!List && Type == dynamic_value_type::Bool && "not a bool option");
+  return Values[0].Bool;
+}
+
+auto dynamic_option::getInt() const -> int64_t {
+  assert(!List && Type == dynamic_value_type::Int && "not an integer option");
+  return Values[0].Int;
+}
+
+auto dynamic_option::getUInt() const -> uint64_t {
+  assert(!List && Type == dynamic_value_type::UInt && "not an unsigned option");
+  return Values[0].UInt;
+}
+
+auto dynamic_option::getNumber() const -> double {
+  assert(!List && Type == dynamic_value_type::Number && "not a number option");
+  return Values[0].Number;
+}
+
+auto dynamic_option::getString() const -> llvm::StringRef {
+  assert(!List && Type == dynamic_value_type::String && "not a string option");
+  return Values[0].String;
+}
+
+auto dynamic_option::getLiteral() const -> llvm::StringRef {
+  assert(!List && Type == dynamic_value_type::Enum && "not an enum option");
+  return Literals[Values[0].Literal].Name;
+}
+
+auto dynamic_option::formatValue(const dynamic_value& value) const
+    -> std::string {
+  std::string text;
+  switch (Type) {
+    case dynamic_value_type::Bool:
+      text = value.Bool ? "true" : "false";
+      break;
+    case dynamic_value_type::Int:
+      text = std::to_string(value.Int);
+      break;
+    case dynamic_value_type::UInt:
+      text = std::to_string(value.UInt);
+      break;
+    case dynamic_value_type::Number:
+      formatValueText(Printer, value.Number, text);
+      break;
+    case dynamic_value_type::String:
+      text = value.String.str();
+      break;
+    case dynamic_value_type::Enum:
+      text = Literals[value.Literal].Name.str();
+      break;
+  }
+  return text;
+}
+
+auto dynamic_option::enum_printer::getOptionValue(unsigned /*n*/) const
+    -> const GenericOptionValue& {
+  // Only used to print value differences, which dynamic options print
+  // themselves.
+  static const OptionValue<int> unset{};
+  return unset;
+}
+
+auto dynamic_option::parseValue(llvm::StringRef arg, dynamic_value& value)
+    -> bool {
+  const char* invalid = nullptr;
+  switch (Type) {
+    case dynamic_value_type::Bool:
+      invalid = applyStaticValue(arg, value.Bool);
+      break;
+    case dynamic_value_type::Int:
+      invalid = TypeName == "int" ? parseAs<int>(arg, value.Int)
+                                  : parseAs<long>(arg, value.Int);
+      break;
+    case dynamic_value_type::UInt:
+      invalid = TypeName == "uint" ? parseAs<unsigned>(arg, value.UInt)
+                                   : parseAs<unsigned long>(arg, value.UInt);
+      break;
+    case dynamic_value_type::Number:
+      invalid = applyStaticValue(arg, value.Number);
+      break;
+    case dynamic_value_type::String:
+      value.String = Set.save(arg);
+      break;
+    case dynamic_value_type::Enum: {
+      const dynamic_literal* literal =
+          llvm::find_if(Literals, [&](const dynamic_literal& candidate) {
+            return candidate.Name == arg;
+          });
+      if (literal == Literals.end()) {
+        invalid = "value invalid for enum argument!";
+      } else {
+        value.Literal = static_cast<unsigned>(literal - Literals.begin());
+      }
+      break;
+    }
+  }
+  if (invalid) {
+    return error("'" + arg + "' " + invalid);
+  }
+  return false;
+}
+
+auto dynamic_option::handleOccurrence(unsigned pos,
+                                      llvm::StringRef /*arg_name*/,
+                                      llvm::StringRef arg) -> bool {
+  dynamic_value value;
+  if (parseValue(arg, value)) {
+    return true;
+  }
+  if (!List) {
+    Values[0] = value;
+  } else {
+    if (HoldsDefaults) {
+      Values.clear();
+      HoldsDefaults = false;
+    }
+    Values.push_back(value);
+  }
+  setPosition(pos);
+  return false;
+}
+
+auto dynamic_option::getValueExpectedFlagDefault() const
+    -> enum ValueExpected {
+  return Type == dynamic_value_type::Bool ? ValueOptional : ValueRequired;
+}
+
+auto dynamic_option::getOptionWidth() const -> size_t {
+  return Type == dynamic_value_type::Enum ? EnumPrinter.getOptionWidth(*this)
+                                          : Printer.getOptionWidth(*this);
+}
+
+void dynamic_option::printOptionInfo(size_t global_width,
+                                     llvm::raw_ostream& os) const {
+  if (Type == dynamic_value_type::Enum) {
+    EnumPrinter.printOptionInfo(*this, global_width, os);
+  } else {
+    Printer.printOptionInfo(*this, global_width, os);
+  }
+}
+
+void dynamic_option::printOptionValue(size_t global_width, bool force,
+                                      llvm::raw_ostream& os) const {
+  if (!force && !valueDiffersFromDefault()) {
+    return;
+  }
+  llvm::SmallVector<std::string, 4> values;
+  llvm::SmallVector<std::string, 4> defaults;
+  getValueTexts(values);
+  for (const dynamic_value& value : Defaults) {
+    defaults.push_back(formatValue(value));
+  }
+  if (List) {
+    printListOptionDiff(*this, values, defaults, global_width, os);
+  } else {
+    printScalarOptionDiff(*this, values[0], defaults[0], global_width, os);
+  }
+}
+
+auto dynamic_option::valueDiffersFromDefault() const -> bool {
+  if (Values.size() != Defaults.size()) {
+    return true;
+  }
+  for (size_t i = 0; i < Values.size(); ++i) {
+    if (formatValue(Values[i]) != formatValue(Defaults[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto dynamic_option::getValueTexts(llvm::SmallVectorImpl<std::string>& texts)
+    const -> bool {
+  for (const dynamic_value& value : Values) {
+    texts.push_back(formatValue(value));
+  }
+  return true;
+}
+
+namespace {
+
+void writeDynamicValue(llvm::json::OStream& json, const dynamic_option& option,
+                       const dynamic_value& value) {
+  switch (option.getType()) {
+    case dynamic_value_type::Bool:
+      json.value(value.Bool);
+      break;
+    case dynamic_value_type::Int:
+      json.value(value.Int);
+      break;
+    case dynamic_value_type::UInt:
+      json.value(value.UInt);
+      break;
+    case dynamic_value_type::Number:
+      json.value(value.Number);
+      break;
+    case dynamic_value_type::String:
+      json.value(value.String);
+      break;
+    case dynamic_value_type::Enum:
+      json.value(option.getLiterals()[value.Literal].Name);
+      break;
+  }
+}
+
+void writeDynamicValues(llvm::json::OStream& json, const dynamic_option& option,
+                        llvm::ArrayRef<dynamic_value> values) {
+  if (!option.isList()) {
+    writeDynamicValue(json, option, values[0]);
+    return;
+  }
+  json.array([&] {
+    for (const dynamic_value& value : values) {
+      writeDynamicValue(json, option, value);
+    }
+  });
+}
+
+}  // namespace
+
+void dynamic_option::writeValueJSON(llvm::json::OStream& json) const {
+  writeDynamicValues(json, *this, Values);
+}
+
+void dynamic_option::writeValueSchema(llvm::json::OStream& json) const {
+  json.attribute("kind", List ? "list" : "opt");
+  json.attribute("type", TypeName);
+  json.attributeBegin("default");
+  writeDynamicValues(json, *this, Defaults);
+  json.attributeEnd();
+}
+
+void dynamic_option::setDefault() {
+  Values.assign(Defaults.begin(), Defaults.end());
+  HoldsDefaults = List && !Defaults.empty();
+}
+
+//===----------------------------------------------------------------------===//
+// dynamic_option_set
+//
+
+dynamic_option_set::dynamic_option_set() = default;
+
+dynamic_option_set::~dynamic_option_set() { clear(); }
+
+auto dynamic_option_set::findSubCommand(llvm::StringRef name,
+                                        const llvm::json::Object& schema)
+    -> SubCommand& {
+  if (name == "*") {
+    return SubCommand::getAll();
+  }
+  if (name == SubCommand::getTopLevel().getName()) {
+    return SubCommand::getTopLevel();
+  }
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    if (sub->getName() == name) {
+      return *sub;
+    }
+  }
+  Subs.push_back(std::make_unique<owned_subcommand>(
+      save(name), save(findDescription(schema, "subcommands", name))));
+  return *Subs.back();
+}
+
+auto dynamic_option_set::findCategory(llvm::StringRef name,
+                                      const llvm::json::Object& schema)
+    -> OptionCategory& {
+  if (OptionCategory* category = findRegisteredCategory(name)) {
+    return *category;
+  }
+  Categories.push_back(std::make_unique<owned_category>(
+      save(name), save(findDescription(schema, "categories", name))));
+  return *Categories.back();
+}
+
+auto dynamic_option_set::createOption(const llvm::json::Object& entry,
+                                      const llvm::json::Object& schema)
+    -> llvm::Expected<dynamic_option*> {
+  llvm::StringRef name = getString(entry, "name");
+  std::string label = optionLabel(name);
+  auto fail = [&](const llvm::Twine& message) {
+    return schemaError(label + ": " + message);
+  };
+
+  llvm::StringRef type_name = getString(entry, "type");
+  dynamic_value_type type;
+  if (type_name == "bool") {
+    type = dynamic_value_type::Bool;
+  } else if (type_name == "int" || type_name == "long") {
+    type = dynamic_value_type::Int;
+  } else if (type_name == "uint" || type_name == "ulong") {
+    type = dynamic_value_type::UInt;
+  } else if (type_name == "number") {
+    type = dynamic_value_type::Number;
+  } else if (type_name == "string") {
+    type = dynamic_value_type::String;
+  } else if (type_name == "enum") {
+    type = dynamic_value_type::Enum;
+  } else {
+    return fail("unsupported type '" + type_name + "'");
+  }
+  llvm::StringRef kind = getString(entry, "kind");
+  if (!kind.empty() && kind != "opt" && kind != "list") {
+    return fail("unsupported kind '" + kind + "'");
+  }
+  bool list = kind == "list";
+
+  // The option is destroyed unless it is handed back; the arena keeps the
+  // memory until the set is cleared.
+  std::unique_ptr<dynamic_option, destroy_option> option(
+      new (Arena.Allocate(sizeof(dynamic_option), alignof(dynamic_option)))
+          dynamic_option(*this, type, save(type_name), list));
+  auto failed = [&](const llvm::Twine& message) {
+    llvm::Error error = fail(message);
+    return llvm::Expected<dynamic_option*>(std::move(error));
+  };
+
+  if (!name.empty()) {
+    option->setArgStr(save(name));
+  }
+  option->setDescription(save(getString(entry, "description")));
+  if (llvm::StringRef value_name = getString(entry, "value_name");
+      !value_name.empty()) {
+    option->setValueStr(save(value_name));
+  }
+  option->Printer.ValueName = option->ValueStr;
+  if (option->Printer.ValueName.empty()) {
+    option->Printer.ValueName = type == dynamic_value_type::Bool ? ""
+                                : type == dynamic_value_type::Enum
+                                    ? "value"
+                                    : option->TypeName;
+  }
+
+  if (type == dynamic_value_type::Enum) {
+    const llvm::json::Array* values = entry.getArray("values");
+    if (!values || values->empty()) {
+      return failed("enum options need \"values\"");
+    }
+    auto* literals = Arena.Allocate<dynamic_literal>(values->size());
+    for (size_t i = 0; i < values->size(); ++i) {
+      const llvm::json::Object* literal = (*values)[i].getAsObject();
+      if (!literal || getString(*literal, "name").empty()) {
+        return failed("enum values need a \"name\"");
+      }
+      new (&literals[i]) dynamic_literal{
+          save(getString(*literal, "name")),
+          save(getString(*literal, "description"))};
+    }
+    option->Literals = llvm::ArrayRef<dynamic_literal>(literals, values->size());
+  }
+
+  // Flags, each optional.
+  auto parseFlag = [&](const char* key, auto flag, auto set) -> bool {
+    const llvm::json::Value* value = entry.get(key);
+    if (!value) {
+      return true;
+    }
+    auto text = value->getAsString();
+    if (!text || !parseSchemaFlag(*text, flag)) {
+      return false;
+    }
+    (option.get()->*set)(flag);
+    return true;
+  };
+  if (!parseFlag("occurrences", NumOccurrencesFlag(),
+                 &Option::setNumOccurrencesFlag)) {
+    return failed("invalid occurrences");
+  }
+  if (!parseFlag("value_expected", ValueExpected(),
+                 &Option::setValueExpectedFlag)) {
+    return failed("invalid value_expected");
+  }
+  if (!parseFlag("hidden", OptionHidden(), &Option::setHiddenFlag)) {
+    return failed("invalid hidden");
+  }
+  if (!parseFlag("formatting", FormattingFlags(), &Option::setFormattingFlag)) {
+    return failed("invalid formatting");
+  }
+  if (const llvm::json::Array* misc = entry.getArray("misc")) {
+    for (const llvm::json::Value& value : *misc) {
+      auto text = value.getAsString();
+      MiscFlags flag;
+      if (!text || !parseSchemaFlag(*text, flag)) {
+        return failed("invalid misc flag");
+      }
+      // Values are read back by reference, so they cannot change at runtime.
+      if (flag == RuntimeMutable) {
+        return failed("dynamic options cannot be RuntimeMutable");
+      }
+      option->setMiscFlag(flag);
+    }
+  }
+  if (name.empty() && !option->isPositional() &&
+      !option->isConsumeAfter() && !option->isSink()) {
+    return failed("options other than positional ones need a name");
+  }
+
+  // Defaults: the schema's, or zero, false, empty or the first literal.
+  auto parseDefault = [&](const llvm::json::Value& json,
+                          dynamic_value& value) -> bool {
+    switch (type) {
+      case dynamic_value_type::Bool:
+        if (auto b = json.getAsBoolean()) {
+          value.Bool = *b;
+          return true;
+        }
+        return false;
+      case dynamic_value_type::Int:
+        if (auto i = json.getAsInteger()) {
+          value.Int = *i;
+          return type_name != "int" ||
+                 (*i >= std::numeric_limits<int>::min() &&
+                  *i <= std::numeric_limits<int>::max());
+        }
+        return false;
+      case dynamic_value_type::UInt:
+        if (auto i = json.getAsInteger(); i && *i >= 0) {
+          value.UInt = static_cast<uint64_t>(*i);
+          return type_name != "uint" ||
+                 value.UInt <= std::numeric_limits<unsigned>::max();
+        }
+        return false;
+      case dynamic_value_type::Number:
+        if (auto d = json.getAsNumber()) {
+          value.Number = *d;
+          return true;
+        }
+        return false;
+      case dynamic_value_type::String:
+        if (auto s = json.getAsString()) {
+          value.String = save(*s);
+          return true;
+        }
+        return false;
+      case dynamic_value_type::Enum:
+        if (auto s = json.getAsString()) {
+          for (size_t i = 0; i < option->Literals.size(); ++i) {
+            if (option->Literals[i].Name == *s) {
+              value.Literal = static_cast<unsigned>(i);
+              return true;
+            }
+          }
+        }
+        return false;
+    }
+    return false;
+  };
+  const llvm::json::Value* default_value = entry.get("default");
+  if (default_value && default_value->kind() == llvm::json::Value::Null) {
+    default_value = nullptr;
+  }
+  if (list) {
+    if (default_value) {
+      const llvm::json::Array* elements = default_value->getAsArray();
+      if (!elements) {
+        return failed("the default of a list is an array");
+      }
+      for (const llvm::json::Value& element : *elements) {
+        dynamic_value value;
+        if (!parseDefault(element, value)) {
+          return failed("default does not match type " + type_name);
+        }
+        option->Defaults.push_back(value);
+      }
+    }
+  } else {
+    dynamic_value value;
+    if (default_value && !parseDefault(*default_value, value)) {
+      return failed("default does not match type " + type_name);
+    }
+    option->Defaults.push_back(value);
+  }
+  option->setDefault();
+
+  // Categories and subcommands, by name.
+  if (const llvm::json::Array* categories = entry.getArray("categories")) {
+    for (const llvm::json::Value& value : *categories) {
+      auto category = value.getAsString();
+      if (!category) {
+        return failed("categories are names");
+      }
+      option->addCategory(findCategory(*category, schema));
+    }
+  }
+  if (const llvm::json::Array* subs = entry.getArray("subcommands")) {
+    for (const llvm::json::Value& value : *subs) {
+      auto sub = value.getAsString();
+      if (!sub) {
+        return failed("subcommands are names");
+      }
+      SubCommand& target = findSubCommand(*sub, schema);
+      // An option in no subcommand goes to the top level, as the schema
+      // writes it.
+      if (&target != &SubCommand::getTopLevel() || subs->size() > 1) {
+        option->addSubCommand(target);
+      }
+    }
+  }
+
+  // Named options must not clash with registered ones.
+  if (!name.empty()) {
+    // Querying the subcommands first brings the option maps up to date.
+    auto subs = getRegisteredSubcommands();
+    auto clashes = [&](SubCommand& sub) {
+      return sub.OptionsMap.count(name) != 0;
+    };
+    bool clash = false;
+    if (option->Subs.empty()) {
+      clash = clashes(SubCommand::getTopLevel());
+    } else if (option->isInAllSubCommands()) {
+      for (SubCommand* sub : subs) {
+        clash |= clashes(*sub);
+      }
+    } else {
+      for (SubCommand* sub : option->Subs) {
+        clash |= clashes(*sub);
+      }
+    }
+    if (clash) {
+      return failed("is already registered");
+    }
+  }
+
+  return option.release();
+}
+
+auto dynamic_option_set::load(const llvm::json::Value& schema) -> llvm::Error {
+  const llvm::json::Object* root = schema.getAsObject();
+  if (!root) {
+    return schemaError("the option schema must be a JSON object");
+  }
+  const llvm::json::Array* entries = root->getArray("options");
+  if (!entries) {
+    return schemaError("the option schema has no \"options\" array");
+  }
+
+  size_t first_new_sub = Subs.size();
+  size_t first_new_category = Categories.size();
+  std::vector<dynamic_option*> created;
+  llvm::StringMap<dynamic_option*> names;
+  auto discard = [&] {
+    for (dynamic_option* option : created) {
+      option->~dynamic_option();
+    }
+    Subs.resize(first_new_sub);
+    Categories.resize(first_new_category);
+  };
+  for (const llvm::json::Value& value : *entries) {
+    const llvm::json::Object* entry = value.getAsObject();
+    if (!entry) {
+      discard();
+      return schemaError("options must be objects");
+    }
+    llvm::Expected<dynamic_option*> option = createOption(*entry, *root);
+    if (!option) {
+      discard();
+      return option.takeError();
+    }
+    created.push_back(*option);
+    llvm::StringRef name = (*option)->ArgStr;
+    if (!name.empty() &&
+        (ByName.count(name) || !names.try_emplace(name, *option).second)) {
+      discard();
+      return schemaError(optionLabel(name) + ": is defined twice");
+    }
+  }
+
+  Option::addArguments(
+      std::vector<Option*>(created.begin(), created.end()));
+  for (dynamic_option* option : created) {
+    Options.push_back(option);
+    if (option->hasArgStr()) {
+      ByName[option->ArgStr] = option;
+    }
+  }
+  return llvm::Error::success();
+}
+
+auto dynamic_option_set::loadFile(llvm::StringRef path) -> llvm::Error {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return llvm::createStringError(buffer.getError(),
+                                   "cannot read " + path + ": " +
+                                       buffer.getError().message());
+  }
+  llvm::Expected<llvm::json::Value> schema =
+      llvm::json::parse((*buffer)->getBuffer());
+  if (!schema) {
+    return schemaError(path + ": " + llvm::toString(schema.takeError()));
+  }
+  if (llvm::Error error = load(*schema)) {
+    return schemaError(path + ": " + llvm::toString(std::move(error)));
+  }
+  return llvm::Error::success();
+}
+
+auto dynamic_option_set::lookup(llvm::StringRef name) const
+    -> dynamic_option* {
+  return ByName.lookup(name);
+}
+
+void dynamic_option_set::clear() {
+  if (!Options.empty()) {
+    Option::removeArguments(
+        std::vector<Option*>(Options.begin(), Options.end()));
+  }
+  for (dynamic_option* option : Options) {
+    option->~dynamic_option();
+  }
+  Options.clear();
+  ByName.clear();
+  Subs.clear();
+  Categories.clear();
+  Arena.Reset();
+}
+
+}  // namespace Commandline
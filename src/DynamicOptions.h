@@ -0,0 +1,217 @@
+#ifndef COMMANDLINE_DYNAMIC_OPTIONS_H
+#define COMMANDLINE_DYNAMIC_OPTIONS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Option.h"
+#include "OptionCategory.h"
+#include "Parser.h"
+#include "SubCommand.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/StringSaver.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Options defined at runtime.
+//
+// A dynamic_option_set creates options from a schema in the format written by
+// --print-option-schema, e.g. a plugin manifest read when the plugin loads.
+// The options are registered like any other: the parser looks them up,
+// -help lists them and occurrence flags are checked. Their values are kept
+// type-erased and read back through dynamic_option. Options, names and
+// literals are allocated from the set's arena, and clearing the set, or
+// destroying it, unregisters all of its options at once.
+//
+// Each schema option takes the fields PrintOptionSchema writes: name,
+// description, value_name, kind ("opt" or "list"), type ("bool", "int",
+// "long", "uint", "ulong", "number", "string" or "enum"), default,
+// occurrences, value_expected, hidden, formatting, misc (except
+// RuntimeMutable), values (the enum literals), categories and subcommands.
+// Only name and type are required (name may be empty for positional
+// options). Categories and subcommands are found by name; those not yet
+// registered are created, subcommands taking their description from the
+// schema's "subcommands" array.
+
+enum class dynamic_value_type { Bool, Int, UInt, Number, String, Enum };
+
+// One value of a dynamic option. The member in use follows the option's type:
+// Int holds int and long values, UInt uint and ulong ones, and Literal the
+// index of an enum literal.
+struct dynamic_value {
+  union {
+    bool Bool;
+    int64_t Int;
+    uint64_t UInt;
+    double Number;
+    unsigned Literal;
+  };
+  // String values, saved in the set's arena.
+  llvm::StringRef String;
+
+  dynamic_value() : UInt(0) {}
+};
+
+// A literal accepted by an enum option.
+struct dynamic_literal {
+  llvm::StringRef Name;
+  llvm::StringRef Description;
+};
+
+class dynamic_option_set;
+
+class dynamic_option final : public Option {
+ public:
+  auto getType() const -> dynamic_value_type { return Type; }
+  // The schema name of the type, e.g. "uint".
+  auto getTypeName() const -> llvm::StringRef { return TypeName; }
+  auto isList() const -> bool { return List; }
+  auto getLiterals() const -> llvm::ArrayRef<dynamic_literal> {
+    return Literals;
+  }
+
+  // The current values: one for opt options, any number for lists.
+  auto getValues() const -> llvm::ArrayRef<dynamic_value> { return Values; }
+  auto getDefaults() const -> llvm::ArrayRef<dynamic_value> {
+    return Defaults;
+  }
+
+  // The value of an opt option of the matching type.
+  auto getBool() const -> bool;
+  auto getInt() const -> int64_t;
+  auto getUInt() const -> uint64_t;
+  auto getNumber() const -> double;
+  auto getString() const -> llvm::StringRef;
+  // The name of the chosen literal of an enum option.
+  auto getLiteral() const -> llvm::StringRef;
+
+  // The argument text of value, as it would be given on the command line.
+  auto formatValue(const dynamic_value& value) const -> std::string;
+
+  auto getGenericParser() const -> const generic_parser_base* override {
+    return Type == dynamic_value_type::Enum ? &EnumPrinter : nullptr;
+  }
+
+ private:
+  friend class dynamic_option_set;
+
+  class value_printer final : public basic_parser_impl {
+   public:
+    value_printer(Option& o) : basic_parser_impl(o) {}
+    auto getValueName() const -> llvm::StringRef override { return ValueName; }
+
+    llvm::StringRef ValueName;
+  };
+
+  class enum_printer final : public generic_parser_base {
+   public:
+    enum_printer(dynamic_option& o) : generic_parser_base(o), Owner(o) {}
+    auto getNumOptions() const -> unsigned override {
+      return static_cast<unsigned>(Owner.Literals.size());
+    }
+    auto getOption(unsigned n) const -> llvm::StringRef override {
+      return Owner.Literals[n].Name;
+    }
+    auto getDescription(unsigned n) const -> llvm::StringRef override {
+      return Owner.Literals[n].Description;
+    }
+    auto getOptionValue(unsigned n) const
+        -> const GenericOptionValue& override;
+
+   private:
+    const dynamic_option& Owner;
+  };
+
+  // Options are created by dynamic_option_set::load.
+  dynamic_option(dynamic_option_set& set, dynamic_value_type type,
+                 llvm::StringRef type_name, bool list);
+
+  // Parse arg into value; return true and report on error.
+  auto parseValue(llvm::StringRef arg, dynamic_value& value) -> bool;
+
+  auto handleOccurrence(unsigned pos, llvm::StringRef arg_name,
+                        llvm::StringRef arg) -> bool override;
+  auto getValueExpectedFlagDefault() const -> enum ValueExpected override;
+  auto getOptionWidth() const -> size_t override;
+  void printOptionInfo(size_t global_width,
+                       llvm::raw_ostream& os) const override;
+  void printOptionValue(size_t global_width, bool force,
+                        llvm::raw_ostream& os) const override;
+  auto valueDiffersFromDefault() const -> bool override;
+  auto getValueTexts(llvm::SmallVectorImpl<std::string>& texts) const
+      -> bool override;
+  void writeValueJSON(llvm::json::OStream& json) const override;
+  void writeValueSchema(llvm::json::OStream& json) const override;
+  void setDefault() override;
+
+  dynamic_option_set& Set;
+  dynamic_value_type Type;
+  llvm::StringRef TypeName;
+  bool List;
+  // Set while a list holds its defaults, which the first occurrence replaces.
+  bool HoldsDefaults = false;
+  llvm::ArrayRef<dynamic_literal> Literals;
+  llvm::SmallVector<dynamic_value, 1> Values;
+  llvm::SmallVector<dynamic_value, 1> Defaults;
+  value_printer Printer;
+  enum_printer EnumPrinter;
+};
+
+class dynamic_option_set {
+ public:
+  dynamic_option_set();
+  dynamic_option_set(const dynamic_option_set&) = delete;
+  auto operator=(const dynamic_option_set&) -> dynamic_option_set& = delete;
+  ~dynamic_option_set();
+
+  // Create and register the options of schema. On error nothing is
+  // registered and the error names the offending option.
+  auto load(const llvm::json::Value& schema) -> llvm::Error;
+  // As load, reading the schema from the JSON file at path.
+  auto loadFile(llvm::StringRef path) -> llvm::Error;
+
+  // Return the option of this set named name, or null.
+  auto lookup(llvm::StringRef name) const -> dynamic_option*;
+  auto options() const -> llvm::ArrayRef<dynamic_option*> { return Options; }
+  auto size() const -> size_t { return Options.size(); }
+
+  // Unregister and destroy every option of the set, and the subcommands and
+  // categories it created, with one pass over the registry.
+  void clear();
+
+ private:
+  friend class dynamic_option;
+  class owned_subcommand;
+  class owned_category;
+
+  auto createOption(const llvm::json::Object& entry,
+                    const llvm::json::Object& schema)
+      -> llvm::Expected<dynamic_option*>;
+  // Find the subcommand named name, creating it if it is not registered.
+  auto findSubCommand(llvm::StringRef name, const llvm::json::Object& schema)
+      -> SubCommand&;
+  // Likewise for the category named name.
+  auto findCategory(llvm::StringRef name, const llvm::json::Object& schema)
+      -> OptionCategory&;
+  auto save(llvm::StringRef text) -> llvm::StringRef { return Saver.save(text); }
+
+  llvm::BumpPtrAllocator Arena;
+  llvm::StringSaver Saver{Arena};
+  std::vector<dynamic_option*> Options;
+  llvm::StringMap<dynamic_option*> ByName;
+  std::vector<std::unique_ptr<owned_subcommand>> Subs;
+  std::vector<std::unique_ptr<owned_category>> Categories;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_DYNAMIC_OPTIONS_H
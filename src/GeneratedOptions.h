@@ -0,0 +1,129 @@
+#ifndef COMMANDLINE_GENERATED_OPTIONS_H
+#define COMMANDLINE_GENERATED_OPTIONS_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "StaticOptions.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Option tables emitted by commandline-optgen.
+//
+// The generator reads a JSON option spec and writes a header declaring the
+// config struct and its enums, and a source file holding a constant
+// generated_options for it: the options sorted by name, a two level perfect
+// hash over the names, the enum literals, the help text rendered ahead of
+// time, and switch statements storing each option into its field. None of it
+// runs a static constructor, however many options the spec has.
+//
+// A generated_options is a schema like static_options: parse fills the
+// struct without registering anything, and static_option_binding registers
+// the options with a SubCommand in one call when the generic parser or -help
+// needs them. Use the commandline_option_gen CMake function to run the
+// generator.
+
+// Marks unused slots of the generated hash table.
+constexpr uint32_t GeneratedEmptySlot = 0xffffffffu;
+
+// Return the index of name in infos, or -1. bucket_seeds and slots are the
+// generated hash: the name's bucket, chosen with seed 0, gives the seed that
+// maps it to a slot holding its index.
+inline auto lookupGeneratedOption(llvm::ArrayRef<static_option_info> infos,
+                                  llvm::ArrayRef<uint32_t> bucket_seeds,
+                                  llvm::ArrayRef<uint32_t> slots,
+                                  std::string_view name) -> int {
+  if (slots.empty()) {
+    return -1;
+  }
+  uint32_t bucket = hashOptionName(name, 0) % bucket_seeds.size();
+  uint32_t slot = hashOptionName(name, bucket_seeds[bucket]) &
+                  static_cast<uint32_t>(slots.size() - 1);
+  uint32_t index = slots[slot];
+  if (index == GeneratedEmptySlot || infos[index].Name != name) {
+    return -1;
+  }
+  return static_cast<int>(index);
+}
+
+template <class Config>
+class generated_options {
+ public:
+  using config_type = Config;
+  // Store arg into the field of option index; return nullptr or the message
+  // describing why arg is invalid.
+  using apply_fn = const char* (*)(Config& values, size_t index,
+                                   llvm::StringRef arg);
+  // Copy the field of option index from defaults into values.
+  using reset_fn = void (*)(Config& values, const Config& defaults,
+                            size_t index);
+
+  constexpr generated_options(llvm::ArrayRef<static_option_info> infos,
+                              llvm::ArrayRef<uint32_t> bucket_seeds,
+                              llvm::ArrayRef<uint32_t> slots,
+                              int positional_index, std::string_view help,
+                              apply_fn apply, reset_fn reset)
+      : Infos(infos),
+        BucketSeeds(bucket_seeds),
+        Slots(slots),
+        PositionalIndex(positional_index),
+        Help(help),
+        Apply(apply),
+        Reset(reset) {}
+
+  auto size() const -> size_t { return Infos.size(); }
+  auto getPositionalIndex() const -> int { return PositionalIndex; }
+  auto getInfo(size_t index) const -> const static_option_info& {
+    return Infos[index];
+  }
+
+  // Return the index of the option named name, or -1.
+  auto lookup(std::string_view name) const -> int {
+    return lookupGeneratedOption(Infos, BucketSeeds, Slots, name);
+  }
+
+  auto apply(size_t index, Config& values, llvm::StringRef value) const
+      -> const char* {
+    return Apply(values, index, value);
+  }
+
+  void reset(size_t index, Config& values, const Config& defaults) const {
+    Reset(values, defaults, index);
+  }
+
+  // As static_options::parse.
+  auto parse(int argc, const char* const* argv, Config& values,
+             llvm::raw_ostream& errs = llvm::errs(), int first_arg = 1) const
+      -> bool {
+    return parseStaticArguments(*this, argc, argv, values, errs, first_arg);
+  }
+
+  // Print the help rendered by the generator, laid out as -help would print
+  // these options alone.
+  void printHelp(llvm::raw_ostream& os, llvm::StringRef program_name,
+                 llvm::StringRef overview = "") const {
+    if (!overview.empty()) {
+      os << "OVERVIEW: " << overview << "\n";
+    }
+    os << "USAGE: " << program_name
+       << llvm::StringRef(Help.data(), Help.size());
+  }
+
+ private:
+  llvm::ArrayRef<static_option_info> Infos;
+  llvm::ArrayRef<uint32_t> BucketSeeds;
+  llvm::ArrayRef<uint32_t> Slots;
+  int PositionalIndex;
+  // The help text following the program name on the usage line.
+  std::string_view Help;
+  apply_fn Apply;
+  reset_fn Reset;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_GENERATED_OPTIONS_H
@@ -0,0 +1,115 @@
+#include "HelpSearch.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <tuple>
+
+#include "CommandLine.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/GlobPattern.h"
+
+namespace Commandline {
+
+namespace {
+
+enum class Relevance { ExactName, NamePrefix, Name, Value, Help, None };
+
+// Does matches accept one of the enum value names of option?
+template <typename Matcher>
+auto matchesValue(Option* option, const Matcher& matches) -> bool {
+  const generic_parser_base* parser = option->getGenericParser();
+  if (parser == nullptr) {
+    return false;
+  }
+  for (unsigned i = 0, e = parser->getNumOptions(); i != e; ++i) {
+    llvm::StringRef value = parser->getOption(i);
+    if (!value.empty() && matches(value)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+auto SearchOptions(SubCommand& sub, llvm::StringRef pattern)
+    -> std::vector<Option*> {
+  std::string lower_pattern = pattern.lower();
+  bool glob = lower_pattern.find_first_of("*?[") != std::string::npos;
+
+  std::optional<llvm::GlobPattern> matcher;
+  if (glob) {
+    auto created = llvm::GlobPattern::create("*" + lower_pattern + "*");
+    if (created) {
+      matcher = std::move(*created);
+    } else {
+      // Not a valid glob; search for the text literally.
+      llvm::consumeError(created.takeError());
+      glob = false;
+    }
+  }
+  auto matches = [&](llvm::StringRef text) {
+    return glob ? matcher->match(text.lower())
+                : text.contains_insensitive(pattern);
+  };
+
+  // A search runs once per process, so scanning the registry is cheaper than
+  // building any index over it first.
+  std::vector<std::tuple<Relevance, llvm::StringRef, Option*>> found;
+  llvm::SmallPtrSet<Option*, 32> seen;
+  for (auto& entry : getRegisteredOptions(sub)) {
+    Option* option = entry.second;
+    if (option->getOptionHiddenFlag() == ReallyHidden ||
+        !seen.insert(option).second) {
+      continue;
+    }
+    llvm::StringRef name = entry.getKey();
+    Relevance relevance = Relevance::None;
+    if (!glob && name.equals_insensitive(pattern)) {
+      relevance = Relevance::ExactName;
+    } else if (!glob && name.startswith_insensitive(pattern)) {
+      relevance = Relevance::NamePrefix;
+    } else if (matches(name)) {
+      relevance = Relevance::Name;
+    } else if (matchesValue(option, matches)) {
+      relevance = Relevance::Value;
+    } else if (matches(option->HelpStr)) {
+      relevance = Relevance::Help;
+    }
+    if (relevance != Relevance::None) {
+      found.emplace_back(relevance, name, option);
+    }
+  }
+
+  llvm::sort(found);
+
+  std::vector<Option*> result;
+  result.reserve(found.size());
+  for (const auto& entry : found) {
+    result.push_back(std::get<2>(entry));
+  }
+  return result;
+}
+
+void PrintHelpSearch(SubCommand& sub, llvm::StringRef pattern,
+                     llvm::raw_ostream& os) {
+  std::vector<Option*> options = SearchOptions(sub, pattern);
+  if (options.empty()) {
+    os << "No options match '" << pattern << "'.\n";
+    return;
+  }
+
+  size_t width = 0;
+  for (const Option* option : options) {
+    width = std::max(width, option->getOptionWidth());
+  }
+  os << "OPTIONS MATCHING '" << pattern << "':\n\n";
+  for (const Option* option : options) {
+    option->printOptionInfo(width, os);
+  }
+}
+
+}  // namespace Commandline
@@ -0,0 +1,33 @@
+#ifndef COMMANDLINE_HELP_SEARCH_H
+#define COMMANDLINE_HELP_SEARCH_H
+
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+class Option;
+class SubCommand;
+
+//===----------------------------------------------------------------------===//
+// Help search.
+//
+// Patterns are matched case-insensitively against option names, help strings
+// and enum value names. A pattern containing '*', '?' or '[' is a glob that
+// may match anywhere in the text; any other pattern is a plain substring.
+
+// Return the options of sub matching pattern, most relevant first: an exact
+// name match, then name prefixes, other name matches, enum value matches and
+// finally help string matches. Ties are broken by name.
+auto SearchOptions(SubCommand& sub, llvm::StringRef pattern)
+    -> std::vector<Option*>;
+
+// Print the options of sub matching pattern to os in the usual help format.
+void PrintHelpSearch(SubCommand& sub, llvm::StringRef pattern,
+                     llvm::raw_ostream& os);
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_HELP_SEARCH_H
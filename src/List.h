@@ -5,6 +5,9 @@
 
 #include "Option.h"
 #include "OptionEnum.h"
+#include "OptionSchema.h"
+#include "OptionState.h"
+#include "ParseStats.h"
 #include "OptionValue.h"
 #include "Parser.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -18,16 +21,22 @@ namespace Commandline {
 // cl::location(x) modifier.
 //
 template <class DataType, class StorageClass>
-class list_storage {
+class list_storage : public OptionStorageWrites {
   StorageClass* Location = nullptr;  // Where to store the object...
   std::vector<OptionValue<DataType>> Default =
       std::vector<OptionValue<DataType>>();
   bool DefaultAssigned = false;
+  bool IsField = false;  // Bound by cl::field rather than cl::location?
 
  public:
   list_storage() = default;
 
-  void clear() {}
+  // Only a field's elements are owned by the option; a location is appended
+  // to and never cleared.
+  void clear() {
+    if (IsField)
+      Location->clear();
+  }
 
   bool setLocation(Option& O, StorageClass& L) {
     if (Location)
@@ -36,6 +45,19 @@ class list_storage {
     return false;
   }
 
+  // Used by cl::field. Elements already in L are the defaults, which the
+  // first occurrence replaces and setDefault restores.
+  bool setFieldLocation(Option& O, StorageClass& L) {
+    if (setLocation(O, L))
+      return true;
+    IsField = true;
+    for (const auto& V : L)
+      Default.push_back(V);
+    if (!Default.empty())
+      assignDefault();
+    return false;
+  }
+
   template <class T>
   void addValue(const T& V, bool initial = false) {
     assert(Location != nullptr &&
@@ -46,6 +68,13 @@ class list_storage {
       Default.push_back(V);
   }
 
+  const StorageClass& getValues() const {
+    assert(Location != nullptr &&
+           "cl::location(...) not specified for a command "
+           "line option with external storage!");
+    return *Location;
+  }
+
   const std::vector<OptionValue<DataType>>& getDefault() const {
     return Default;
   }
@@ -64,7 +93,7 @@ class list_storage {
 // FIXME: Reduce this API to a more narrow subset of std::vector
 //
 template <class DataType>
-class list_storage<DataType, bool> {
+class list_storage<DataType, bool> : public OptionStorageWrites {
   std::vector<DataType> Storage;
   std::vector<OptionValue<DataType>> Default;
   bool DefaultAssigned = false;
@@ -86,8 +115,14 @@ class list_storage<DataType, bool> {
 
   bool empty() const { return Storage.empty(); }
 
-  void push_back(const DataType& value) { Storage.push_back(value); }
-  void push_back(DataType&& value) { Storage.push_back(value); }
+  void push_back(const DataType& value) {
+    noteValueWrite();
+    Storage.push_back(value);
+  }
+  void push_back(DataType&& value) {
+    noteValueWrite();
+    Storage.push_back(value);
+  }
 
   using reference = typename std::vector<DataType>::reference;
   using const_reference = typename std::vector<DataType>::const_reference;
@@ -95,29 +130,44 @@ class list_storage<DataType, bool> {
   reference operator[](size_type pos) { return Storage[pos]; }
   const_reference operator[](size_type pos) const { return Storage[pos]; }
 
-  void clear() { Storage.clear(); }
+  void clear() {
+    noteValueWrite();
+    Storage.clear();
+  }
 
-  iterator erase(const_iterator pos) { return Storage.erase(pos); }
+  iterator erase(const_iterator pos) {
+    noteValueWrite();
+    return Storage.erase(pos);
+  }
   iterator erase(const_iterator first, const_iterator last) {
+    noteValueWrite();
     return Storage.erase(first, last);
   }
 
-  iterator erase(iterator pos) { return Storage.erase(pos); }
+  iterator erase(iterator pos) {
+    noteValueWrite();
+    return Storage.erase(pos);
+  }
   iterator erase(iterator first, iterator last) {
+    noteValueWrite();
     return Storage.erase(first, last);
   }
 
   iterator insert(const_iterator pos, const DataType& value) {
+    noteValueWrite();
     return Storage.insert(pos, value);
   }
   iterator insert(const_iterator pos, DataType&& value) {
+    noteValueWrite();
     return Storage.insert(pos, value);
   }
 
   iterator insert(iterator pos, const DataType& value) {
+    noteValueWrite();
     return Storage.insert(pos, value);
   }
   iterator insert(iterator pos, DataType&& value) {
+    noteValueWrite();
     return Storage.insert(pos, value);
   }
 
@@ -134,8 +184,12 @@ class list_storage<DataType, bool> {
     Storage.push_back(V);
     if (initial)
       Default.push_back(OptionValue<DataType>(V));
+    else
+      noteValueWrite();
   }
 
+  const std::vector<DataType>& getValues() const { return Storage; }
+
   const std::vector<OptionValue<DataType>>& getDefault() const {
     return Default;
   }
@@ -153,6 +207,7 @@ template <class DataType, class StorageClass = bool,
 class list : public Option, public list_storage<DataType, StorageClass> {
   std::vector<unsigned> Positions;
   ParserClass Parser;
+  bool HasCallback = false;  // Was setCallback called?
 
   enum ValueExpected getValueExpectedFlagDefault() const override {
     return Parser.getValueExpectedFlagDefault();
@@ -163,6 +218,13 @@ class list : public Option, public list_storage<DataType, StorageClass> {
     return Parser.getExtraOptionNames(OptionNames);
   }
 
+  const generic_parser_base* getGenericParser() const override {
+    if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>)
+      return &Parser;
+    else
+      return nullptr;
+  }
+
   bool handleOccurrence(unsigned pos, llvm::StringRef ArgName,
                         llvm::StringRef Arg) override {
     typename ParserClass::parser_data_type Val =
@@ -171,7 +233,9 @@ class list : public Option, public list_storage<DataType, StorageClass> {
       clear();
       list_storage<DataType, StorageClass>::overwriteDefault();
     }
-    if (Parser.parse(*this, ArgName, Arg, Val))
+    if (ParsePhaseTimer Timer(ParsePhase::ValueParsing,
+                              schemaTypeName<ParserClass>());
+        Parser.parse(*this, ArgName, Arg, Val))
       return true;  // Parse Error!
     list_storage<DataType, StorageClass>::addValue(Val);
     setPosition(pos);
@@ -185,12 +249,113 @@ class list : public Option, public list_storage<DataType, StorageClass> {
     return Parser.getOptionWidth(*this);
   }
 
-  void printOptionInfo(size_t GlobalWidth) const override {
-    Parser.printOptionInfo(*this, GlobalWidth);
+  void printOptionInfo(size_t GlobalWidth,
+                       llvm::raw_ostream& OS) const override {
+    Parser.printOptionInfo(*this, GlobalWidth, OS);
   }
 
-  // Unimplemented: list options don't currently store their default value.
-  void printOptionValue(size_t /*GlobalWidth*/, bool /*Force*/) const override {
+  void printOptionValue(size_t GlobalWidth, bool Force,
+                        llvm::raw_ostream& OS) const override {
+    if (!Force && !valueDiffersFromDefault())
+      return;
+    llvm::SmallVector<std::string, 4> Values;
+    llvm::SmallVector<std::string, 4> Defaults;
+    getValueTexts(Values);
+    for (auto& Val : list_storage<DataType, StorageClass>::getDefault()) {
+      std::string Text;
+      if (Val.hasValue() && formatValueText(Parser, Val.getValue(), Text))
+        Defaults.push_back(std::move(Text));
+    }
+    printListOptionDiff(*this, Values, Defaults, GlobalWidth, OS);
+  }
+
+  bool valueDiffersFromDefault() const override {
+    const auto& Values = list_storage<DataType, StorageClass>::getValues();
+    const auto& Defaults = list_storage<DataType, StorageClass>::getDefault();
+    if (Values.size() != Defaults.size())
+      return true;
+    auto Default = Defaults.begin();
+    for (const auto& Val : Values)
+      if ((Default++)->compare(Val))
+        return true;
+    return false;
+  }
+
+  bool getValueTexts(llvm::SmallVectorImpl<std::string>& Texts) const override {
+    for (const auto& Val : list_storage<DataType, StorageClass>::getValues()) {
+      std::string Text;
+      if (!formatValueText(Parser, static_cast<const DataType&>(Val), Text))
+        return false;
+      Texts.push_back(std::move(Text));
+    }
+    return true;
+  }
+
+  void writeValueJSON(llvm::json::OStream& json) const override {
+    json.array([&] {
+      for (const auto& Val : list_storage<DataType, StorageClass>::getValues())
+        writeSchemaValue(json, Parser, static_cast<const DataType&>(Val));
+    });
+  }
+
+  // Lists with external storage are not saved, since their storage cannot be
+  // cleared before restoring.
+  std::string getStateLayout() const override {
+    if constexpr (is_state_serializable_v<DataType> &&
+                  std::is_same_v<StorageClass, bool>)
+      return "list:" + stateTypeTag<DataType>();
+    else
+      return std::string();
+  }
+
+  void saveValue(llvm::SmallVectorImpl<char>& Out) const override {
+    if constexpr (is_state_serializable_v<DataType> &&
+                  std::is_same_v<StorageClass, bool>) {
+      const auto& Values = list_storage<DataType, StorageClass>::getValues();
+      writeStateValue(Out, static_cast<uint32_t>(Values.size()));
+      for (size_t i = 0, e = Values.size(); i != e; ++i) {
+        writeStateValue(Out, static_cast<uint32_t>(
+                                 i < Positions.size() ? Positions[i] : 0));
+        writeStateValue<DataType>(Out, Values[i]);
+      }
+    }
+  }
+
+  bool loadValue(llvm::StringRef& Data) override {
+    if constexpr (is_state_serializable_v<DataType> &&
+                  std::is_same_v<StorageClass, bool>) {
+      uint32_t Size = 0;
+      if (!readStateValue(Data, Size))
+        return false;
+      clear();
+      for (uint32_t i = 0; i != Size; ++i) {
+        uint32_t Pos = 0;
+        DataType Val = DataType();
+        if (!readStateValue(Data, Pos) || !readStateValue(Data, Val))
+          return false;
+        list_storage<DataType, StorageClass>::addValue(Val);
+        Positions.push_back(Pos);
+      }
+      // Values restored without any occurrence are the defaults, which the
+      // first parsed occurrence replaces.
+      if (getNumOccurrences() == 0)
+        list_storage<DataType, StorageClass>::assignDefault();
+      else
+        list_storage<DataType, StorageClass>::overwriteDefault();
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  void writeValueSchema(llvm::json::OStream& json) const override {
+    json.attribute("kind", "list");
+    json.attribute("type", schemaTypeName<ParserClass>());
+    json.attributeArray("default", [&] {
+      for (auto& Val : list_storage<DataType, StorageClass>::getDefault())
+        if (Val.hasValue())
+          writeSchemaValue(json, Parser, Val.getValue());
+    });
   }
 
   void setDefault() override {
@@ -198,11 +363,18 @@ class list : public Option, public list_storage<DataType, StorageClass> {
     list_storage<DataType, StorageClass>::clear();
     for (auto& Val : list_storage<DataType, StorageClass>::getDefault())
       list_storage<DataType, StorageClass>::addValue(Val.getValue());
+    if constexpr (!std::is_same_v<StorageClass, bool>)
+      markValueTouched();
+    else
+      clearValueTouched();
   }
 
   void done() {
-    addArgument();
     Parser.initialize();
+    if constexpr (!std::is_same_v<StorageClass, bool>)
+      markValueTouched();
+    // Last, so that the option is complete when another thread sees it.
+    addArgument();
   }
 
  public:
@@ -236,6 +408,7 @@ class list : public Option, public list_storage<DataType, StorageClass> {
   template <class... Mods>
   explicit list(const Mods&... Ms)
       : Option(ZeroOrMore, NotHidden), Parser(*this) {
+    this->bindStorageOwner(*this);
     apply(this, Ms...);
     done();
   }
@@ -243,8 +416,11 @@ class list : public Option, public list_storage<DataType, StorageClass> {
   void setCallback(
       std::function<void(const typename ParserClass::parser_data_type&)> CB) {
     Callback = CB;
+    HasCallback = true;
   }
 
+  bool hasCallback() const override { return HasCallback; }
+
   std::function<void(const typename ParserClass::parser_data_type&)> Callback =
       [](const typename ParserClass::parser_data_type&) {};
 };
@@ -1,19 +1,41 @@
 #ifndef COMMANDLINE_OPT_H
 #define COMMANDLINE_OPT_H
 
+#include "OptionOverride.h"
+#include "OptionReadProfile.h"
+#include "OptionSchema.h"
+#include "OptionState.h"
+#include "ParseStats.h"
 #include "Parser.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace Commandline {
 
+namespace detail {
+
+// Whether an option holding DataType in its own storage reads and writes it
+// with single atomic instructions. Only such options may be RuntimeMutable,
+// so that a runtime update never tears a concurrent read.
+template <class DataType>
+constexpr bool is_atomic_option_value_v =
+#if defined(__GNUC__)
+    std::is_trivially_copyable_v<DataType> &&
+    alignof(DataType) >= sizeof(DataType) &&
+    __atomic_always_lock_free(sizeof(DataType), 0);
+#else
+    false;
+#endif
+
+}  // namespace detail
+
 //===----------------------------------------------------------------------===//
 // Default storage class definition: external storage.  This implementation
 // assumes the user will specify a variable to store the data into with the
 // location(x) modifier.
 //
 template <class DataType, bool ExternalStorage, bool isClass>
-class opt_storage {
+class opt_storage : public OptionReadProfile, public OptionStorageWrites {
   DataType* Location = nullptr;  // Where to store the object...
   OptionValue<DataType> Default;
 
@@ -41,17 +63,27 @@ class opt_storage {
     *Location = V;
     if (initial)
       Default = V;
+    else
+      noteValueWrite();
   }
 
   DataType& getValue() {
     check_location();
+    noteRead();
+    if (DataType* V = detail::findOverride<DataType>(this))
+      return *V;
     return *Location;
   }
   const DataType& getValue() const {
     check_location();
+    noteRead();
+    if (const DataType* V = detail::findOverride<DataType>(this))
+      return *V;
     return *Location;
   }
 
+  const void* getOverrideKey() const { return this; }
+
   operator DataType() const { return this->getValue(); }
 
   const OptionValue<DataType>& getDefault() const { return Default; }
@@ -62,7 +94,9 @@ class opt_storage {
 // object in all cases that it is used.
 //
 template <class DataType>
-class opt_storage<DataType, false, true> : public DataType {
+class opt_storage<DataType, false, true> : public DataType,
+                                           public OptionReadProfile,
+                                           public OptionStorageWrites {
  public:
   OptionValue<DataType> Default;
 
@@ -71,10 +105,24 @@ class opt_storage<DataType, false, true> : public DataType {
     DataType::operator=(V);
     if (initial)
       Default = V;
+    else
+      noteValueWrite();
   }
 
-  DataType& getValue() { return *this; }
-  const DataType& getValue() const { return *this; }
+  DataType& getValue() {
+    noteRead();
+    if (DataType* V = detail::findOverride<DataType>(this))
+      return *V;
+    return *this;
+  }
+  const DataType& getValue() const {
+    noteRead();
+    if (const DataType* V = detail::findOverride<DataType>(this))
+      return *V;
+    return *this;
+  }
+
+  const void* getOverrideKey() const { return this; }
 
   const OptionValue<DataType>& getDefault() const { return Default; }
 };
@@ -84,7 +132,8 @@ class opt_storage<DataType, false, true> : public DataType {
 // to get at the value.
 //
 template <class DataType>
-class opt_storage<DataType, false, false> {
+class opt_storage<DataType, false, false> : public OptionReadProfile,
+                                            public OptionStorageWrites {
  public:
   DataType Value;
   OptionValue<DataType> Default;
@@ -93,21 +142,49 @@ class opt_storage<DataType, false, false> {
   // type.
   opt_storage() : Value(DataType()), Default() {}
 
+  // Values that fit an atomic instruction are copied in and out with relaxed
+  // atomics, so that runtime updates may race with reads by value.
   template <class T>
   void setValue(const T& V, bool initial = false) {
-    Value = V;
+    if constexpr (detail::is_atomic_option_value_v<DataType>) {
+      DataType NewValue = DataType();
+      NewValue = V;
+      __atomic_store(&Value, &NewValue, __ATOMIC_RELAXED);
+    } else {
+      Value = V;
+    }
     if (initial)
       Default = V;
+    else
+      noteValueWrite();
+  }
+  DataType& getValue() {
+    noteRead();
+    if (DataType* V = detail::findOverride<DataType>(this))
+      return *V;
+    return Value;
+  }
+  DataType getValue() const {
+    noteRead();
+    if (const DataType* V = detail::findOverride<DataType>(this))
+      return *V;
+    if constexpr (detail::is_atomic_option_value_v<DataType>) {
+      DataType Result;
+      __atomic_load(&Value, &Result, __ATOMIC_RELAXED);
+      return Result;
+    } else {
+      return Value;
+    }
   }
-  DataType& getValue() { return Value; }
-  DataType getValue() const { return Value; }
+
+  const void* getOverrideKey() const { return this; }
 
   const OptionValue<DataType>& getDefault() const { return Default; }
 
   operator DataType() const { return getValue(); }
 
   // If the datatype is a pointer, support -> on it.
-  DataType operator->() const { return Value; }
+  DataType operator->() const { return getValue(); }
 };
 
 //===----------------------------------------------------------------------===//
@@ -119,12 +196,15 @@ class opt
     : public Option,
       public opt_storage<DataType, ExternalStorage, std::is_class_v<DataType>> {
   ParserClass Parser;
+  bool HasCallback = false;  // Was setCallback called?
 
   bool handleOccurrence(unsigned pos, llvm::StringRef ArgName,
                         llvm::StringRef Arg) override {
     typename ParserClass::parser_data_type Val =
         typename ParserClass::parser_data_type();
-    if (Parser.parse(*this, ArgName, Arg, Val))
+    if (ParsePhaseTimer Timer(ParsePhase::ValueParsing,
+                              schemaTypeName<ParserClass>());
+        Parser.parse(*this, ArgName, Arg, Val))
       return true;  // Parse error!
     this->setValue(Val);
     this->setPosition(pos);
@@ -141,22 +221,126 @@ class opt
     return Parser.getExtraOptionNames(OptionNames);
   }
 
+  const generic_parser_base* getGenericParser() const override {
+    if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>)
+      return &Parser;
+    else
+      return nullptr;
+  }
+
   // Forward printing stuff to the parser...
   size_t getOptionWidth() const override {
     return Parser.getOptionWidth(*this);
   }
 
-  void printOptionInfo(size_t GlobalWidth) const override {
-    Parser.printOptionInfo(*this, GlobalWidth);
+  void printOptionInfo(size_t GlobalWidth,
+                       llvm::raw_ostream& OS) const override {
+    Parser.printOptionInfo(*this, GlobalWidth, OS);
   }
 
-  void printOptionValue(size_t GlobalWidth, bool Force) const override {
-    if (Force || this->getDefault().compare(this->getValue())) {
+  void printOptionValue(size_t GlobalWidth, bool Force,
+                        llvm::raw_ostream& OS) const override {
+    if (Force || valueDiffersFromDefault()) {
       printOptionDiff<ParserClass>(*this, Parser, this->getValue(),
-                                   this->getDefault(), GlobalWidth);
+                                   this->getDefault(), GlobalWidth, OS);
+    }
+  }
+
+  bool valueDiffersFromDefault() const override {
+    const OptionValue<DataType>& V = this->getDefault();
+    if constexpr (!std::is_class_v<DataType> ||
+                  std::is_same_v<DataType, std::string>) {
+      // Without cl::init the default is the value-initialized DataType.
+      if (!V.hasValue())
+        return !(this->getValue() == DataType());
+    }
+    return V.compare(this->getValue());
+  }
+
+  bool getValueTexts(llvm::SmallVectorImpl<std::string>& Texts) const override {
+    std::string Text;
+    if (!formatValueText(Parser, this->getValue(), Text))
+      return false;
+    Texts.push_back(std::move(Text));
+    return true;
+  }
+
+  void writeValueJSON(llvm::json::OStream& json) const override {
+    writeSchemaValue(json, Parser, this->getValue());
+  }
+
+  std::string getStateLayout() const override {
+    if constexpr (is_state_serializable_v<DataType>)
+      return "opt:" + stateTypeTag<DataType>();
+    else
+      return std::string();
+  }
+
+  void saveValue(llvm::SmallVectorImpl<char>& Out) const override {
+    if constexpr (is_state_serializable_v<DataType>)
+      writeStateValue<DataType>(Out, this->getValue());
+  }
+
+  bool loadValue(llvm::StringRef& Data) override {
+    if constexpr (is_state_serializable_v<DataType>) {
+      DataType Val = DataType();
+      if (!readStateValue(Data, Val))
+        return false;
+      this->setValue(Val);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  static constexpr bool is_runtime_mutable_v =
+      !ExternalStorage && !std::is_class_v<DataType> &&
+      detail::is_atomic_option_value_v<DataType>;
+
+  bool setRuntimeValue(llvm::StringRef Arg) override {
+    using ValueType = typename ParserClass::parser_data_type;
+    if constexpr (is_runtime_mutable_v &&
+                  std::is_assignable_v<DataType&, const ValueType&>) {
+      ValueType Val = ValueType();
+      if (Parser.parse(*this, ArgStr, Arg, Val))
+        return true;  // Parse error!
+      *this = Val;
+      return false;
+    } else {
+      return Option::setRuntimeValue(Arg);
     }
   }
 
+  bool parseOverride(llvm::StringRef Arg,
+                     ScopedOptionOverride& Scope) override {
+    using ValueType = typename ParserClass::parser_data_type;
+    if constexpr (std::is_copy_constructible_v<DataType> &&
+                  std::is_constructible_v<DataType, const ValueType&>) {
+      ValueType Val = ValueType();
+      if (Parser.parse(*this, ArgStr, Arg, Val))
+        return true;  // Parse error!
+      Scope.set(*this, Val);
+      return false;
+    } else {
+      return Option::parseOverride(Arg, Scope);
+    }
+  }
+
+  void writeValueSchema(llvm::json::OStream& json) const override {
+    json.attribute("kind", "opt");
+    json.attribute("type", schemaTypeName<ParserClass>());
+    json.attributeBegin("default");
+    const OptionValue<DataType>& V = this->getDefault();
+    if (V.hasValue())
+      writeSchemaValue(json, Parser, V.getValue());
+    else if constexpr (!std::is_class_v<DataType> ||
+                       std::is_same_v<DataType, std::string>)
+      writeSchemaValue(json, Parser, DataType());
+    else
+      json.value(nullptr);
+    json.attributeEnd();
+  }
+
   template <class T, class = std::enable_if_t<std::is_assignable_v<T&, T>>>
   void setDefaultImpl() {
     const OptionValue<DataType>& V = this->getDefault();
@@ -169,11 +353,23 @@ class opt
   template <class T, class = std::enable_if_t<!std::is_assignable_v<T&, T>>>
   void setDefaultImpl(...) {}
 
-  void setDefault() override { setDefaultImpl<DataType>(); }
+  void setDefault() override {
+    setDefaultImpl<DataType>();
+    if constexpr (ExternalStorage)
+      markValueTouched();
+    else
+      clearValueTouched();
+  }
 
   void done() {
-    addArgument();
     Parser.initialize();
+    if (!is_runtime_mutable_v && isRuntimeMutable())
+      error("RuntimeMutable requires a value stored in the option that fits "
+            "an atomic instruction");
+    if constexpr (ExternalStorage)
+      markValueTouched();
+    // Last, so that the option is complete when another thread sees it.
+    addArgument();
   }
 
  public:
@@ -195,6 +391,8 @@ class opt
 
   template <class... Mods>
   explicit opt(const Mods&... Ms) : Option(Optional, NotHidden), Parser(*this) {
+    this->bindReadProfile(*this);
+    this->bindStorageOwner(*this);
     apply(this, Ms...);
     done();
   }
@@ -202,8 +400,11 @@ class opt
   void setCallback(
       std::function<void(const typename ParserClass::parser_data_type&)> CB) {
     Callback = CB;
+    HasCallback = true;
   }
 
+  bool hasCallback() const override { return HasCallback; }
+
   std::function<void(const typename ParserClass::parser_data_type&)> Callback =
       [](const typename ParserClass::parser_data_type&) {};
 };
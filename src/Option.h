@@ -1,6 +1,9 @@
 #ifndef COMMANDLINE_OPTION_H
 #define COMMANDLINE_OPTION_H
 
+#include <atomic>
+#include <string>
+
 #include "OptionCategory.h"
 #include "OptionEnum.h"
 #include "SubCommand.h"
@@ -10,14 +13,23 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/Support/raw_ostream.h"
 
+namespace llvm::json {
+class OStream;
+}  // namespace llvm::json
+
 namespace Commandline {
 
+class ScopedOptionOverride;
+class generic_parser_base;
+
 //===----------------------------------------------------------------------===//
 //
 class Option {
   friend class alias;
+  friend class OptionStorageWrites;
 
   // Overriden by subclasses to handle the value passed into an argument. Should
   // return true if there was an error processing the argument and the program
@@ -42,10 +54,15 @@ class Option {
   uint16_t Value : 2;
   uint16_t HiddenFlag : 2;  // enum OptionHidden
   uint16_t Formatting : 2;  // enum FormattingFlags
-  uint16_t Misc : 5;
+  uint16_t Misc : 7;
   uint16_t FullyInitialized : 1;  // Has addArgument been called?
+  uint16_t ValueTouched : 1;      // May the value differ from the default?
   uint16_t Position;              // Position of last occurrence of the option
   uint16_t AdditionalVals;        // Greater than 0 for multi-valued option.
+  // Must the fingerprint rehash this option? Changed under the fingerprint's
+  // lock but read without it, from any thread that writes the value, so it
+  // is atomic and kept out of the bitfield.
+  std::atomic<bool> ConfigHashDirty{false};
 
  public:
   llvm::StringRef ArgStr;   // The argument string itself (ex: "help", "o")
@@ -89,6 +106,12 @@ class Option {
   auto isDefaultOption() const -> bool {
     return getMiscFlags() & Commandline::DefaultOption;
   }
+  auto affectsOutput() const -> bool {
+    return !(getMiscFlags() & Commandline::DoesNotAffectOutput);
+  }
+  auto isRuntimeMutable() const -> bool {
+    return getMiscFlags() & Commandline::RuntimeMutable;
+  }
 
   auto isConsumeAfter() const -> bool {
     return getNumOccurrencesFlag() == Commandline::ConsumeAfter;
@@ -102,11 +125,11 @@ class Option {
   // Accessor functions set by OptionModifiers
   //
   void setArgStr(llvm::StringRef s);
-  void setDescription(llvm::StringRef s) { HelpStr = s; }
-  void setValueStr(llvm::StringRef s) { ValueStr = s; }
+  void setDescription(llvm::StringRef s);
+  void setValueStr(llvm::StringRef s);
   void setNumOccurrencesFlag(enum NumOccurrencesFlag val) { Occurrences = val; }
   void setValueExpectedFlag(enum ValueExpected val) { Value = val; }
-  void setHiddenFlag(enum OptionHidden val) { HiddenFlag = val; }
+  void setHiddenFlag(enum OptionHidden val);
   void setFormattingFlag(enum FormattingFlags v) { Formatting = v; }
   void setMiscFlag(enum MiscFlags m) { Misc |= m; }
   void setPosition(unsigned pos) { Position = pos; }
@@ -123,6 +146,7 @@ class Option {
         Formatting(NormalFormatting),
         Misc(0),
         FullyInitialized(false),
+        ValueTouched(false),
         Position(0),
         AdditionalVals(0) {
     Categories.push_back(&getGeneralCategory());
@@ -130,6 +154,14 @@ class Option {
 
   inline void setNumAdditionalVals(unsigned n) { AdditionalVals = n; }
 
+  // Record that the value may no longer equal the default.
+  void markValueTouched() {
+    ValueTouched = true;
+    noteValueChanged();
+  }
+  // Record that setDefault restored the default through the storage.
+  void clearValueTouched() { ValueTouched = false; }
+
  public:
   virtual ~Option() = default;
 
@@ -137,21 +169,92 @@ class Option {
   //
   void addArgument();
 
+  // Register options with the Commandline system, as addArgument does for
+  // each, in a single queued registration.
+  static void addArguments(llvm::ArrayRef<Option*> options);
+
   /// Unregisters this option from the Commandline system.
   ///
   /// This option must have been the last option registered.
-  /// For testing purposes only.
+  /// For testing purposes only; plugins use a registration_scope.
   void removeArgument();
 
+  // Unregister options, as removeArgument does for each, with one pass over
+  // the positional and sink lists of each subcommand involved.
+  static void removeArguments(llvm::ArrayRef<Option*> options);
+
   // Return the width of the option tag for printing...
   virtual auto getOptionWidth() const -> size_t = 0;
 
-  // Print out information about this option. The to-be-maintained width is
-  // specified.
+  // Print out information about this option to os. The to-be-maintained width
+  // is specified.
   //
-  virtual void printOptionInfo(size_t global_width) const = 0;
+  virtual void printOptionInfo(size_t global_width,
+                               llvm::raw_ostream& os) const = 0;
+
+  // Print the value of this option and its default to os if force is set or
+  // the value differs from the default.
+  virtual void printOptionValue(size_t global_width, bool force,
+                                llvm::raw_ostream& os) const = 0;
+
+  // False if the value still equals the default because it was neither
+  // parsed nor written through the option or its storage since the last
+  // reset. Options with external storage always count as touched, since the
+  // program may write the storage directly. PrintOptionValues skips untouched
+  // options without comparing their values.
+  auto isValueTouched() const -> bool { return ValueTouched; }
+
+  // Return true if the current value differs from the default.
+  virtual auto valueDiffersFromDefault() const -> bool { return false; }
+
+  // Return true if a callback was set with cl::cb or setCallback. Parses
+  // giving such an option are not cached, since a cache hit skips the
+  // callback.
+  virtual auto hasCallback() const -> bool { return false; }
+
+  // Append the argument text of each current value to texts, in the order
+  // the parser would have received them. Return false if the values have no
+  // textual form.
+  virtual auto getValueTexts(llvm::SmallVectorImpl<std::string>& /*texts*/)
+      const -> bool {
+    return false;
+  }
+
+  // Write the current value to json: a single value for opt, an array for
+  // list and bits.
+  virtual void writeValueJSON(llvm::json::OStream& json) const;
+
+  // Describe the binary encoding saveValue uses, e.g. "opt:i4". The string
+  // feeds the layout hash of SaveOptionState. Options returning an empty
+  // string (e.g. action options) are not saved.
+  virtual auto getStateLayout() const -> std::string { return std::string(); }
+
+  // Append the current value to out in the encoding named by getStateLayout.
+  virtual void saveValue(llvm::SmallVectorImpl<char>& /*out*/) const {}
+
+  // Replace the current value with one written by saveValue, consuming it
+  // from the front of data. Return false if data is malformed.
+  virtual auto loadValue(llvm::StringRef& /*data*/) -> bool { return false; }
+
+  // Save or restore the occurrence count, position and value. Defined in
+  // OptionState.cc.
+  void saveState(llvm::SmallVectorImpl<char>& out) const;
+  auto loadState(llvm::StringRef& data) -> bool;
+
+  // Parse value with the option's parser and assign it as opt::operator=
+  // would, running the callback. Used by the runtime tuning endpoint. Returns
+  // true and reports through error() if the value is invalid or the option
+  // has no single assignable value.
+  virtual auto setRuntimeValue(llvm::StringRef /*value*/) -> bool {
+    return error("value cannot be changed at runtime");
+  }
 
-  virtual void printOptionValue(size_t global_width, bool force) const = 0;
+  // Parse value with the option's parser and set the result as this
+  // thread's override of the option in scope. Returns true and reports
+  // through error() if the value is invalid or the option has no single
+  // value to override. Defined in OptionOverride.cc.
+  virtual auto parseOverride(llvm::StringRef value,
+                             ScopedOptionOverride& scope) -> bool;
 
   virtual void setDefault() = 0;
 
@@ -161,7 +264,8 @@ class Option {
   // FirstLineIndentedBy is the count of chars of the first line
   //      i.e. the one containing the --<option name>.
   static void printHelpStr(llvm::StringRef help_str, size_t indent,
-                           size_t first_line_indented_by);
+                           size_t first_line_indented_by,
+                           llvm::raw_ostream& os = llvm::outs());
 
   // Prints the help string for an enum value.
   //
@@ -169,10 +273,24 @@ class Option {
   // FirstLineIndentedBy is the count of chars of the first line
   //      i.e. the one containing the =<value>.
   static void printEnumValHelpStr(llvm::StringRef help_str, size_t indent,
-                                  size_t first_line_indented_by);
+                                  size_t first_line_indented_by,
+                                  llvm::raw_ostream& os = llvm::outs());
 
   virtual void getExtraOptionNames(llvm::SmallVectorImpl<llvm::StringRef>&) {}
 
+  // Return the parser mapping literal names to values (e.g. the cl::values of
+  // an enum option), or nullptr if the option uses a basic parser.
+  virtual auto getGenericParser() const -> const generic_parser_base* {
+    return nullptr;
+  }
+
+  // Return the option this one stands for if it is an alias, or nullptr.
+  virtual auto getAliasTarget() const -> const Option* { return nullptr; }
+
+  // Write the "kind", "type" and "default" attributes of this option's schema
+  // into the JSON object currently open on json.
+  virtual void writeValueSchema(llvm::json::OStream& /*json*/) const {}
+
   // Wrapper around handleOccurrence that enforces Flags.
   //
   virtual auto addOccurrence(unsigned pos, llvm::StringRef arg_name,
@@ -189,6 +307,32 @@ class Option {
 
   inline auto getNumOccurrences() const -> int { return NumOccurrences; }
   void reset();
+
+  // Configuration fingerprint bookkeeping, defined in ConfigHash.cc.
+  // noteValueChanged queues this option for rehashing, rehashConfig replaces
+  // its contribution with one for the current value, and forgetConfigHash
+  // removes its contribution.
+  void noteValueChanged();
+  void rehashConfig();
+  void forgetConfigHash();
+};
+
+// Base of the storage classes of opt, list and bits. Writes the program makes
+// through the storage, e.g. setValue or push_back, mark the owning option
+// touched.
+class OptionStorageWrites {
+ public:
+  void bindStorageOwner(Option& option) { Owner = &option; }
+
+ protected:
+  void noteValueWrite() const {
+    if (Owner != nullptr) {
+      Owner->markValueTouched();
+    }
+  }
+
+ private:
+  Option* Owner = nullptr;
 };
 
 }  // namespace Commandline
@@ -12,6 +12,9 @@ class OptionCategory {
 
   void registerCategory();
 
+ protected:
+  void unregisterCategory();
+
  public:
   OptionCategory(llvm::StringRef const name,
                  llvm::StringRef const description = "")
@@ -70,7 +70,15 @@ enum MiscFlags {          // Miscellaneous flags to adjust argument
   Grouping = 0x08,
 
   // Default option
-  DefaultOption = 0x10
+  DefaultOption = 0x10,
+
+  // The value does not change what the program produces (e.g. verbosity or
+  // thread count), so it is left out of the configuration fingerprint.
+  DoesNotAffectOutput = 0x20,
+
+  // The value may be changed while the program runs, through the runtime
+  // tuning endpoint (see RuntimeTuning.h).
+  RuntimeMutable = 0x40
 };
 
 }  // namespace Commandline
@@ -0,0 +1,80 @@
+#include "OptionOverride.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "CommandLine.h"
+#include "llvm/ADT/STLExtras.h"
+
+namespace Commandline {
+
+namespace {
+
+struct OverrideEntry {
+  const void* Key;
+  const ScopedOptionOverride* Owner;
+  std::unique_ptr<detail::OverrideValue> Value;
+};
+
+// This thread's overrides, oldest first.
+auto overrideStack() -> std::vector<OverrideEntry>& {
+  thread_local std::vector<OverrideEntry> stack;
+  return stack;
+}
+
+}  // namespace
+
+auto detail::lookupOverride(const void* key) -> OverrideValue* {
+  std::vector<OverrideEntry>& stack = overrideStack();
+  for (auto it = stack.rbegin(), end = stack.rend(); it != end; ++it) {
+    if (it->Key == key) {
+      return it->Value.get();
+    }
+  }
+  return nullptr;
+}
+
+ScopedOptionOverride::~ScopedOptionOverride() {
+  if (Count == 0) {
+    return;
+  }
+  std::vector<OverrideEntry>& stack = overrideStack();
+  size_t before = stack.size();
+  llvm::erase_if(stack, [this](const OverrideEntry& entry) {
+    return entry.Owner == this;
+  });
+  (void)before;
+  assert(before - stack.size() == Count &&
+         "ScopedOptionOverride destroyed on another thread");
+  detail::ActiveOverrides = stack.size();
+}
+
+void ScopedOptionOverride::push(const void* key,
+                                std::unique_ptr<detail::OverrideValue> value) {
+  std::vector<OverrideEntry>& stack = overrideStack();
+  stack.push_back({key, this, std::move(value)});
+  ++Count;
+  detail::ActiveOverrides = stack.size();
+}
+
+auto ScopedOptionOverride::parse(Option& option, llvm::StringRef value)
+    -> bool {
+  return option.parseOverride(value, *this);
+}
+
+auto ScopedOptionOverride::parse(llvm::StringRef name, llvm::StringRef value)
+    -> bool {
+  Option* option = findRegisteredOption(name);
+  if (!option) {
+    return true;
+  }
+  return parse(*option, value);
+}
+
+auto Option::parseOverride(llvm::StringRef /*value*/,
+                           ScopedOptionOverride& /*scope*/) -> bool {
+  return error("value cannot be overridden");
+}
+
+}  // namespace Commandline
@@ -0,0 +1,130 @@
+#ifndef COMMANDLINE_OPTION_OVERRIDE_H
+#define COMMANDLINE_OPTION_OVERRIDE_H
+
+#include <cstddef>
+#include <memory>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace Commandline {
+
+class Option;
+template <class DataType, bool ExternalStorage, class ParserClass>
+class opt;
+
+//===----------------------------------------------------------------------===//
+// Thread-local option overrides.
+//
+// A ScopedOptionOverride gives options different values on the current thread
+// until it is destroyed. Reads of an opt on that thread, through getValue, its
+// conversion operator or operator->, see the override; the global value is
+// untouched and other threads keep seeing it. One request can turn on debug
+// output this way, and test shards running in parallel threads can each use
+// their own settings:
+//
+//   ScopedOptionOverride debug(Verbose, true);
+//   if (debug.parse("debug-only", request_debug_only))
+//     return;  // The option's parser reported the error.
+//
+// Overrides nest: the latest one set for an option wins until its scope is
+// destroyed, which must happen on the thread that created it. Only opt
+// supports overrides. Assignments through opt::operator= still change the
+// global value, and options of class type used directly as their base class
+// bypass the override as they bypass getValue. What is shared or persisted
+// ignores overrides: the configuration fingerprint, saved option state (and
+// so the parse cache and parse server), PrintOptionValues and the runtime
+// option dump.
+//
+// While a thread has no overrides, a read costs one extra thread-local load.
+
+namespace detail {
+
+// Number of overrides in force on this thread.
+inline thread_local size_t ActiveOverrides = 0;
+
+class OverrideValue {
+ public:
+  virtual ~OverrideValue() = default;
+};
+
+template <class DataType>
+class TypedOverrideValue final : public OverrideValue {
+ public:
+  explicit TypedOverrideValue(const DataType& value) : Value(value) {}
+
+  DataType Value;
+};
+
+// Return this thread's latest override for the opt storage key, or null.
+auto lookupOverride(const void* key) -> OverrideValue*;
+
+template <class DataType>
+auto findOverride(const void* key) -> DataType* {
+  if (ActiveOverrides == 0) {
+    return nullptr;
+  }
+  OverrideValue* value = lookupOverride(key);
+  return value ? &static_cast<TypedOverrideValue<DataType>*>(value)->Value
+               : nullptr;
+}
+
+// Hide this thread's overrides while alive, so that library code caching
+// values shared by all threads reads the global values.
+class SuspendOverrides {
+ public:
+  SuspendOverrides() : Saved(ActiveOverrides) { ActiveOverrides = 0; }
+  SuspendOverrides(const SuspendOverrides&) = delete;
+  auto operator=(const SuspendOverrides&) -> SuspendOverrides& = delete;
+  ~SuspendOverrides() { ActiveOverrides = Saved; }
+
+ private:
+  size_t Saved;
+};
+
+}  // namespace detail
+
+class ScopedOptionOverride {
+ public:
+  ScopedOptionOverride() = default;
+  // Override a single option.
+  template <class DataType, bool ExternalStorage, class ParserClass, class T>
+  ScopedOptionOverride(opt<DataType, ExternalStorage, ParserClass>& option,
+                       const T& value) {
+    set(option, value);
+  }
+  ScopedOptionOverride(const ScopedOptionOverride&) = delete;
+  auto operator=(const ScopedOptionOverride&)
+      -> ScopedOptionOverride& = delete;
+  // Remove the overrides set through this scope.
+  ~ScopedOptionOverride();
+
+  // Give option the value on this thread. No callback runs.
+  template <class DataType, bool ExternalStorage, class ParserClass, class T>
+  auto set(opt<DataType, ExternalStorage, ParserClass>& option, const T& value)
+      -> ScopedOptionOverride& {
+    push(option.getOverrideKey(),
+         std::make_unique<detail::TypedOverrideValue<DataType>>(
+             DataType(value)));
+    return *this;
+  }
+
+  // Parse value with the option's parser and override the option with the
+  // result. Returns true and reports through Option::error if the value is
+  // invalid or the option cannot be overridden.
+  auto parse(Option& option, llvm::StringRef value) -> bool;
+  // As above for the registered top-level option name. Returns true if there
+  // is no such option.
+  auto parse(llvm::StringRef name, llvm::StringRef value) -> bool;
+
+  // Number of overrides set through this scope.
+  auto size() const -> size_t { return Count; }
+
+ private:
+  void push(const void* key, std::unique_ptr<detail::OverrideValue> value);
+
+  size_t Count = 0;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_OPTION_OVERRIDE_H
@@ -0,0 +1,129 @@
+#include "OptionReadProfile.h"
+
+#include <mutex>
+
+#include "Option.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
+
+namespace Commandline {
+
+namespace {
+
+void printCounts(llvm::raw_ostream& os,
+                 const std::vector<OptionReadCount>& counts) {
+  os << "Option reads, most frequent first:\n";
+  for (const OptionReadCount& count : counts) {
+    os << llvm::format("  %14llu  ",
+                       static_cast<unsigned long long>(count.Reads))
+       << count.Name << '\n';
+  }
+}
+
+#if COMMANDLINE_PROFILE_OPTION_READS
+
+// The counters of live options and the totals of destroyed ones. Created by
+// the first counter, so it outlives every option and reports at exit.
+class ReadProfileRegistry {
+ public:
+  static auto get() -> ReadProfileRegistry& {
+    static ReadProfileRegistry registry;
+    return registry;
+  }
+
+  ~ReadProfileRegistry() {
+    // llvm::errs() may already be destroyed.
+    std::vector<OptionReadCount> result = counts();
+    if (!result.empty()) {
+      llvm::raw_fd_ostream os(2, /*shouldClose=*/false);
+      printCounts(os, result);
+    }
+  }
+
+  void add(const OptionReadProfile* profile) {
+    std::lock_guard<std::mutex> guard(Lock);
+    Live.push_back(profile);
+  }
+
+  void retire(const OptionReadProfile* profile) {
+    std::lock_guard<std::mutex> guard(Lock);
+    llvm::erase_value(Live, profile);
+    if (uint64_t reads = profile->getReadCount()) {
+      Retired.push_back({profile->getReadProfileName(), reads});
+    }
+  }
+
+  // Return the counts, most frequent first.
+  auto counts() -> std::vector<OptionReadCount> {
+    std::vector<OptionReadCount> result;
+    {
+      std::lock_guard<std::mutex> guard(Lock);
+      result = Retired;
+      for (const OptionReadProfile* profile : Live) {
+        if (uint64_t reads = profile->getReadCount()) {
+          result.push_back({profile->getReadProfileName(), reads});
+        }
+      }
+    }
+    llvm::stable_sort(result, [](const OptionReadCount& lhs,
+                                 const OptionReadCount& rhs) {
+      return lhs.Reads != rhs.Reads ? lhs.Reads > rhs.Reads
+                                    : lhs.Name < rhs.Name;
+    });
+    return result;
+  }
+
+ private:
+  std::mutex Lock;
+  std::vector<const OptionReadProfile*> Live;
+  std::vector<OptionReadCount> Retired;
+};
+
+#endif  // COMMANDLINE_PROFILE_OPTION_READS
+
+}  // namespace
+
+#if COMMANDLINE_PROFILE_OPTION_READS
+
+OptionReadProfile::OptionReadProfile() { ReadProfileRegistry::get().add(this); }
+
+OptionReadProfile::~OptionReadProfile() {
+  ReadProfileRegistry::get().retire(this);
+}
+
+auto OptionReadProfile::getReadCount() const -> uint64_t {
+  uint64_t total = 0;
+  for (const Shard& shard : ReadShards) {
+    total += shard.Count.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+auto OptionReadProfile::getReadProfileName() const -> std::string {
+  if (!Owner) {
+    return "<unbound>";
+  }
+  if (Owner->hasArgStr()) {
+    return Owner->ArgStr.str();
+  }
+  if (!Owner->ValueStr.empty()) {
+    return ("<" + Owner->ValueStr + ">").str();
+  }
+  return "<positional>";
+}
+
+auto GetOptionReadCounts() -> std::vector<OptionReadCount> {
+  return ReadProfileRegistry::get().counts();
+}
+
+#else
+
+auto GetOptionReadCounts() -> std::vector<OptionReadCount> { return {}; }
+
+#endif  // COMMANDLINE_PROFILE_OPTION_READS
+
+void PrintOptionReadProfile(llvm::raw_ostream& os) {
+  printCounts(os, GetOptionReadCounts());
+}
+
+}  // namespace Commandline
@@ -0,0 +1,87 @@
+#ifndef COMMANDLINE_OPTION_READ_PROFILE_H
+#define COMMANDLINE_OPTION_READ_PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+
+// Build with COMMANDLINE_PROFILE_OPTION_READS=1 to count how often each
+// option's value is read.
+#ifndef COMMANDLINE_PROFILE_OPTION_READS
+#define COMMANDLINE_PROFILE_OPTION_READS 0
+#endif
+
+namespace Commandline {
+
+class Option;
+
+//===----------------------------------------------------------------------===//
+// Option read profiling.
+//
+// In profiling builds every read of an opt's value through getValue, its
+// conversion operator or operator-> bumps a counter for that option. Counters
+// are split into per-thread shards, so concurrent readers do not contend. A
+// report of reads per option, most frequent first, is printed to stderr when
+// the program exits. Options read millions of times are candidates for a
+// cached local copy. Reads made by the library itself (printing, saving) are
+// counted too but are rare. Options of class type that are used directly as
+// their base class are not counted.
+//
+// In other builds the counters do not exist and reads are plain loads.
+
+struct OptionReadCount {
+  std::string Name;
+  uint64_t Reads = 0;
+};
+
+// Return the read count of every option, live or destroyed, most frequent
+// first. Empty unless profiling is compiled in.
+auto GetOptionReadCounts() -> std::vector<OptionReadCount>;
+
+// Print GetOptionReadCounts to os, one option per line.
+void PrintOptionReadProfile(llvm::raw_ostream& os);
+
+// Base of opt_storage holding the option's read counter.
+class OptionReadProfile {
+ public:
+#if COMMANDLINE_PROFILE_OPTION_READS
+  static constexpr unsigned num_shards = 8;
+
+  OptionReadProfile();
+  ~OptionReadProfile();
+  OptionReadProfile(const OptionReadProfile&) = delete;
+  auto operator=(const OptionReadProfile&) -> OptionReadProfile& = delete;
+
+  void noteRead() const {
+    ReadShards[shardIndex()].Count.fetch_add(1, std::memory_order_relaxed);
+  }
+  void bindReadProfile(const Option& option) { Owner = &option; }
+
+  auto getReadCount() const -> uint64_t;
+  auto getReadProfileName() const -> std::string;
+
+ private:
+  static auto shardIndex() -> unsigned {
+    static std::atomic<unsigned> next_shard{0};
+    thread_local unsigned shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % num_shards;
+    return shard;
+  }
+
+  struct alignas(64) Shard {
+    mutable std::atomic<uint64_t> Count{0};
+  };
+  Shard ReadShards[num_shards];
+  const Option* Owner = nullptr;
+#else
+  void noteRead() const {}
+  void bindReadProfile(const Option& /*option*/) {}
+#endif
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_OPTION_READ_PROFILE_H
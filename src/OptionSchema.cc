@@ -0,0 +1,302 @@
+#include "OptionSchema.h"
+
+#include <vector>
+
+#include "CommandLine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace Commandline {
+
+namespace {
+
+auto occurrencesName(NumOccurrencesFlag flag) -> llvm::StringRef {
+  switch (flag) {
+    case Optional:
+      return "Optional";
+    case ZeroOrMore:
+      return "ZeroOrMore";
+    case Required:
+      return "Required";
+    case OneOrMore:
+      return "OneOrMore";
+    case ConsumeAfter:
+      return "ConsumeAfter";
+  }
+  return "Optional";
+}
+
+auto valueExpectedName(ValueExpected flag) -> llvm::StringRef {
+  switch (flag) {
+    case ValueOptional:
+      return "ValueOptional";
+    case ValueRequired:
+      return "ValueRequired";
+    case ValueDisallowed:
+      return "ValueDisallowed";
+  }
+  return "ValueOptional";
+}
+
+auto hiddenName(OptionHidden flag) -> llvm::StringRef {
+  switch (flag) {
+    case NotHidden:
+      return "NotHidden";
+    case Hidden:
+      return "Hidden";
+    case ReallyHidden:
+      return "ReallyHidden";
+  }
+  return "NotHidden";
+}
+
+auto formattingName(FormattingFlags flag) -> llvm::StringRef {
+  switch (flag) {
+    case NormalFormatting:
+      return "NormalFormatting";
+    case Positional:
+      return "Positional";
+    case Prefix:
+      return "Prefix";
+    case AlwaysPrefix:
+      return "AlwaysPrefix";
+  }
+  return "NormalFormatting";
+}
+
+constexpr std::pair<MiscFlags, llvm::StringLiteral> misc_flag_names[] = {
+    {CommaSeparated, "CommaSeparated"},
+    {PositionalEatsArgs, "PositionalEatsArgs"},
+    {Sink, "Sink"},
+    {Grouping, "Grouping"},
+    {DefaultOption, "DefaultOption"},
+    {DoesNotAffectOutput, "DoesNotAffectOutput"},
+    {RuntimeMutable, "RuntimeMutable"},
+};
+
+auto sortedSubCommands() -> std::vector<SubCommand*> {
+  std::vector<SubCommand*> subs;
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    subs.push_back(sub);
+  }
+  llvm::sort(subs, [](const SubCommand* lhs, const SubCommand* rhs) {
+    return lhs->getName() < rhs->getName();
+  });
+  return subs;
+}
+
+// The options of every subcommand, each listed once and ordered by name, and
+// the names of the aliases that refer to each of them.
+struct Registry {
+  std::vector<Option*> Options;
+  llvm::DenseMap<const Option*, llvm::SmallVector<llvm::StringRef, 1>> Aliases;
+  std::vector<OptionCategory*> Categories;
+};
+
+auto collectRegistry(llvm::ArrayRef<SubCommand*> subs) -> Registry {
+  Registry registry;
+  llvm::SmallPtrSet<Option*, 32> seen;
+  auto add = [&](Option* option) {
+    if (!seen.insert(option).second) {
+      return;
+    }
+    if (const Option* target = option->getAliasTarget()) {
+      registry.Aliases[target].push_back(option->ArgStr);
+      return;
+    }
+    registry.Options.push_back(option);
+  };
+
+  for (SubCommand* sub : subs) {
+    for (Option* option : sub->PositionalOpts) {
+      add(option);
+    }
+    for (Option* option : sub->SinkOpts) {
+      add(option);
+    }
+    if (sub->ConsumeAfterOpt) {
+      add(sub->ConsumeAfterOpt);
+    }
+    std::vector<std::pair<llvm::StringRef, Option*>> named;
+    for (auto& entry : sub->OptionsMap) {
+      named.emplace_back(entry.getKey(), entry.second);
+    }
+    llvm::sort(named, llvm::less_first());
+    for (auto& entry : named) {
+      add(entry.second);
+    }
+  }
+  llvm::stable_sort(registry.Options, [](const Option* lhs, const Option* rhs) {
+    return lhs->ArgStr < rhs->ArgStr;
+  });
+  for (auto& entry : registry.Aliases) {
+    llvm::sort(entry.second);
+  }
+
+  llvm::SmallPtrSet<OptionCategory*, 8> seen_categories;
+  for (const Option* option : registry.Options) {
+    for (OptionCategory* category : option->Categories) {
+      if (seen_categories.insert(category).second) {
+        registry.Categories.push_back(category);
+      }
+    }
+  }
+  llvm::sort(registry.Categories,
+             [](const OptionCategory* lhs, const OptionCategory* rhs) {
+               return lhs->getName() < rhs->getName();
+             });
+  return registry;
+}
+
+void writeOption(llvm::json::OStream& json, const Option& option,
+                 llvm::ArrayRef<llvm::StringRef> aliases) {
+  json.object([&] {
+    json.attribute("name", option.ArgStr);
+    json.attributeArray("aliases", [&] {
+      for (llvm::StringRef alias : aliases) {
+        json.value(alias);
+      }
+    });
+    json.attribute("description", option.HelpStr);
+    json.attribute("value_name", option.ValueStr);
+    option.writeValueSchema(json);
+    json.attribute("occurrences",
+                   occurrencesName(option.getNumOccurrencesFlag()));
+    json.attribute("value_expected",
+                   valueExpectedName(option.getValueExpectedFlag()));
+    json.attribute("hidden", hiddenName(option.getOptionHiddenFlag()));
+    json.attribute("formatting", formattingName(option.getFormattingFlag()));
+    json.attributeArray("misc", [&] {
+      for (const auto& flag : misc_flag_names) {
+        if (option.getMiscFlags() & flag.first) {
+          json.value(flag.second);
+        }
+      }
+    });
+    if (const generic_parser_base* parser = option.getGenericParser()) {
+      json.attributeArray("values", [&] {
+        for (unsigned i = 0, e = parser->getNumOptions(); i != e; ++i) {
+          json.object([&] {
+            json.attribute("name", parser->getOption(i));
+            json.attribute("description", parser->getDescription(i));
+          });
+        }
+      });
+    }
+    json.attributeArray("categories", [&] {
+      for (const OptionCategory* category : option.Categories) {
+        json.value(category->getName());
+      }
+    });
+    json.attributeArray("subcommands", [&] {
+      // "*" stands for every subcommand, including ones registered later.
+      if (option.isInAllSubCommands()) {
+        json.value("*");
+        return;
+      }
+      // Options without cl::sub belong to the top-level subcommand.
+      if (option.Subs.empty()) {
+        json.value(SubCommand::getTopLevel().getName());
+        return;
+      }
+      llvm::SmallVector<llvm::StringRef, 4> names;
+      for (const SubCommand* sub : option.Subs) {
+        names.push_back(sub->getName());
+      }
+      llvm::sort(names);
+      for (llvm::StringRef name : names) {
+        json.value(name);
+      }
+    });
+  });
+}
+
+// Find the flag among candidates whose schema name is name.
+template <class Flag, size_t N, class NameFn>
+auto findFlag(llvm::StringRef name, const Flag (&candidates)[N],
+              NameFn flag_name, Flag& flag) -> bool {
+  for (Flag candidate : candidates) {
+    if (flag_name(candidate) == name) {
+      flag = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+auto parseSchemaFlag(llvm::StringRef name, NumOccurrencesFlag& flag) -> bool {
+  const NumOccurrencesFlag flags[] = {Optional, ZeroOrMore, Required,
+                                      OneOrMore, ConsumeAfter};
+  return findFlag(name, flags, occurrencesName, flag);
+}
+
+auto parseSchemaFlag(llvm::StringRef name, ValueExpected& flag) -> bool {
+  const ValueExpected flags[] = {ValueOptional, ValueRequired,
+                                 ValueDisallowed};
+  return findFlag(name, flags, valueExpectedName, flag);
+}
+
+auto parseSchemaFlag(llvm::StringRef name, OptionHidden& flag) -> bool {
+  const OptionHidden flags[] = {NotHidden, Hidden, ReallyHidden};
+  return findFlag(name, flags, hiddenName, flag);
+}
+
+auto parseSchemaFlag(llvm::StringRef name, FormattingFlags& flag) -> bool {
+  const FormattingFlags flags[] = {NormalFormatting, Positional, Prefix,
+                                   AlwaysPrefix};
+  return findFlag(name, flags, formattingName, flag);
+}
+
+auto parseSchemaFlag(llvm::StringRef name, MiscFlags& flag) -> bool {
+  for (const auto& entry : misc_flag_names) {
+    if (entry.second == name) {
+      flag = entry.first;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Option::writeValueJSON(llvm::json::OStream& json) const {
+  json.value(nullptr);
+}
+
+void PrintOptionSchema(llvm::raw_ostream& os) {
+  std::vector<SubCommand*> subs = sortedSubCommands();
+  Registry registry = collectRegistry(subs);
+
+  llvm::json::OStream json(os, 2);
+  json.object([&] {
+    json.attributeArray("subcommands", [&] {
+      for (const SubCommand* sub : subs) {
+        if (sub == &SubCommand::getAll()) {
+          continue;
+        }
+        json.object([&] {
+          json.attribute("name", sub->getName());
+          json.attribute("description", sub->getDescription());
+        });
+      }
+    });
+    json.attributeArray("categories", [&] {
+      for (const OptionCategory* category : registry.Categories) {
+        json.object([&] {
+          json.attribute("name", category->getName());
+          json.attribute("description", category->getDescription());
+        });
+      }
+    });
+    json.attributeArray("options", [&] {
+      for (const Option* option : registry.Options) {
+        writeOption(json, *option, registry.Aliases.lookup(option));
+      }
+    });
+  });
+  os << '\n';
+}
+
+}  // namespace Commandline
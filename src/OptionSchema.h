@@ -0,0 +1,168 @@
+#ifndef COMMANDLINE_OPTION_SCHEMA_H
+#define COMMANDLINE_OPTION_SCHEMA_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "OptionValue.h"
+#include "Parser.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Machine-readable option schema.
+//
+// The schema is a single JSON object with "subcommands", "categories" and
+// "options" arrays. Each option records its name, aliases, description, value
+// name, kind (opt, list or bits), value type, default, flags, enum values,
+// categories and subcommands. The object is written to the stream as it is
+// produced; no JSON tree is built in memory.
+
+// Formats accepted by --print-option-schema.
+enum class OptionSchemaFormat { JSON };
+
+// Write the JSON schema of every registered option to os.
+void PrintOptionSchema(llvm::raw_ostream& os);
+
+// Set flag to the flag the schema calls name, e.g. "ZeroOrMore". Return false
+// if no flag of that kind has the name.
+auto parseSchemaFlag(llvm::StringRef name, NumOccurrencesFlag& flag) -> bool;
+auto parseSchemaFlag(llvm::StringRef name, ValueExpected& flag) -> bool;
+auto parseSchemaFlag(llvm::StringRef name, OptionHidden& flag) -> bool;
+auto parseSchemaFlag(llvm::StringRef name, FormattingFlags& flag) -> bool;
+auto parseSchemaFlag(llvm::StringRef name, MiscFlags& flag) -> bool;
+
+// Return the schema type name of the values parsed by ParserClass.
+template <class ParserClass>
+auto schemaTypeName() -> llvm::StringRef {
+  using DataType = typename ParserClass::parser_data_type;
+  if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>) {
+    return "enum";
+  } else if constexpr (std::is_same_v<DataType, bool>) {
+    return "bool";
+  } else if constexpr (std::is_same_v<DataType, boolOrDefault>) {
+    return "boolOrDefault";
+  } else if constexpr (std::is_same_v<DataType, char>) {
+    return "char";
+  } else if constexpr (std::is_same_v<DataType, std::string>) {
+    return "string";
+  } else if constexpr (std::is_integral_v<DataType>) {
+    if constexpr (std::is_signed_v<DataType>) {
+      return sizeof(DataType) > sizeof(int) ? "long" : "int";
+    } else {
+      return sizeof(DataType) > sizeof(unsigned) ? "ulong" : "uint";
+    }
+  } else if constexpr (std::is_floating_point_v<DataType>) {
+    return "number";
+  } else {
+    return "value";
+  }
+}
+
+// Return the literal name parser maps to value, or an empty string if value
+// is not one of its literals.
+template <class ParserClass, class DataType>
+auto findLiteralName(const ParserClass& parser, const DataType& value)
+    -> llvm::StringRef {
+  if constexpr (std::is_base_of_v<generic_parser_base, ParserClass> &&
+                std::is_same_v<typename ParserClass::parser_data_type,
+                               DataType>) {
+    OptionValue<DataType> wrapped(value);
+    for (unsigned i = 0, e = parser.getNumOptions(); i != e; ++i) {
+      if (wrapped.hasValue() && !parser.getOptionValue(i).compare(wrapped)) {
+        return parser.getOption(i);
+      }
+    }
+  }
+  return llvm::StringRef();
+}
+
+// Write value as a JSON value. Enum values are written as the literal name
+// parser maps to them; values without a JSON representation become null.
+template <class ParserClass, class DataType>
+void writeSchemaValue(llvm::json::OStream& json, const ParserClass& parser,
+                      const DataType& value) {
+  if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>) {
+    llvm::StringRef name = findLiteralName(parser, value);
+    if (name.empty()) {
+      json.value(nullptr);
+    } else {
+      json.value(name);
+    }
+  } else if constexpr (std::is_same_v<DataType, bool>) {
+    json.value(value);
+  } else if constexpr (std::is_same_v<DataType, boolOrDefault>) {
+    if (value == BOU_UNSET) {
+      json.value(nullptr);
+    } else {
+      json.value(value == BOU_TRUE);
+    }
+  } else if constexpr (std::is_same_v<DataType, char>) {
+    json.value(llvm::StringRef(&value, 1));
+  } else if constexpr (std::is_same_v<DataType, std::string>) {
+    json.value(value);
+  } else if constexpr (std::is_integral_v<DataType>) {
+    if constexpr (std::is_unsigned_v<DataType> &&
+                  sizeof(DataType) >= sizeof(int64_t)) {
+      if (value > static_cast<DataType>(std::numeric_limits<int64_t>::max())) {
+        json.value(static_cast<double>(value));
+        return;
+      }
+    }
+    json.value(static_cast<int64_t>(value));
+  } else if constexpr (std::is_floating_point_v<DataType>) {
+    json.value(static_cast<double>(value));
+  } else {
+    json.value(nullptr);
+  }
+}
+
+// Set text to the argument text that parser reads back as value. Return false
+// if value has no textual form (e.g. the state object of an action option).
+template <class ParserClass, class DataType>
+auto formatValueText(const ParserClass& parser, const DataType& value,
+                     std::string& text) -> bool {
+  if constexpr (std::is_base_of_v<generic_parser_base, ParserClass>) {
+    text = findLiteralName(parser, value).str();
+    return !text.empty();
+  } else if constexpr (std::is_same_v<DataType, bool>) {
+    text = value ? "true" : "false";
+  } else if constexpr (std::is_same_v<DataType, boolOrDefault>) {
+    if (value == BOU_UNSET) {
+      return false;
+    }
+    text = value == BOU_TRUE ? "true" : "false";
+  } else if constexpr (std::is_same_v<DataType, char>) {
+    text.assign(1, value);
+  } else if constexpr (std::is_same_v<DataType, std::string>) {
+    text = value;
+  } else if constexpr (std::is_integral_v<DataType>) {
+    text = std::to_string(value);
+  } else if constexpr (std::is_floating_point_v<DataType>) {
+    // Use the fewest digits that still read back as the same value.
+    char buffer[32];
+    for (int digits = 1; digits <= std::numeric_limits<DataType>::max_digits10;
+         ++digits) {
+      std::snprintf(buffer, sizeof(buffer), "%.*g", digits,
+                    static_cast<double>(value));
+      if (static_cast<DataType>(std::strtod(buffer, nullptr)) == value) {
+        break;
+      }
+    }
+    text = buffer;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_OPTION_SCHEMA_H
@@ -0,0 +1,324 @@
+#include "OptionState.h"
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CommandLine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
+
+namespace Commandline {
+
+namespace {
+
+constexpr char state_magic[4] = {'C', 'L', 'S', 'T'};
+constexpr uint32_t state_version = 1;
+
+// Magic, version, layout hash and record count.
+constexpr size_t state_header_size = 4 + 4 + 8 + 4;
+
+// Record identifier and payload size.
+constexpr size_t state_record_header_size = 8 + 4;
+
+struct StateEntry {
+  uint64_t Id;
+  Option* Opt;
+};
+
+// The serializable options of every subcommand, each listed once, and the
+// hash of their layout. Subcommands and option names are visited in sorted
+// order so that the same binary always produces the same layout.
+struct StateLayout {
+  std::vector<StateEntry> Entries;
+  llvm::DenseMap<uint64_t, Option*> ById;
+  // Options whose values cannot be saved.
+  std::vector<Option*> Unsaved;
+  uint64_t Hash = 0;
+};
+
+auto collectStateLayout() -> StateLayout {
+  std::vector<SubCommand*> subs;
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    subs.push_back(sub);
+  }
+  llvm::sort(subs, [](const SubCommand* lhs, const SubCommand* rhs) {
+    return lhs->getName() < rhs->getName();
+  });
+
+  StateLayout layout;
+  std::string description;
+  llvm::SmallPtrSet<Option*, 32> seen;
+  auto add = [&](SubCommand* sub, const llvm::Twine& key, Option* option) {
+    if (option->getAliasTarget() || !seen.insert(option).second) {
+      return;
+    }
+    std::string encoding = option->getStateLayout();
+    if (encoding.empty()) {
+      layout.Unsaved.push_back(option);
+      return;
+    }
+    std::string name = (sub->getName() + llvm::Twine('\0') + key).str();
+    uint64_t id = llvm::xxHash64(name);
+    layout.Entries.push_back({id, option});
+    layout.ById[id] = option;
+    description += name;
+    description += '=';
+    description += encoding;
+    description += '\n';
+  };
+
+  for (SubCommand* sub : subs) {
+    for (size_t i = 0, e = sub->PositionalOpts.size(); i != e; ++i) {
+      add(sub, "#positional" + llvm::Twine(i), sub->PositionalOpts[i]);
+    }
+    for (size_t i = 0, e = sub->SinkOpts.size(); i != e; ++i) {
+      add(sub, "#sink" + llvm::Twine(i), sub->SinkOpts[i]);
+    }
+    if (sub->ConsumeAfterOpt) {
+      add(sub, "#consume-after", sub->ConsumeAfterOpt);
+    }
+    std::vector<std::pair<llvm::StringRef, Option*>> named;
+    for (auto& entry : sub->OptionsMap) {
+      named.emplace_back(entry.getKey(), entry.second);
+    }
+    llvm::sort(named, llvm::less_first());
+    for (auto& entry : named) {
+      add(sub, entry.first, entry.second);
+    }
+  }
+  layout.Hash = llvm::xxHash64(description);
+  return layout;
+}
+
+struct CachedStateLayout {
+  uint64_t Generation = 0;
+  bool Valid = false;
+  StateLayout Layout;
+};
+
+ManagedStatic<CachedStateLayout> state_layout;
+
+// Return the layout of the current registry, collecting it again only after
+// the registry changed.
+auto currentStateLayout() -> const StateLayout& {
+  uint64_t generation = getRegistryGeneration();
+  if (!state_layout->Valid || state_layout->Generation != generation) {
+    state_layout->Layout = collectStateLayout();
+    state_layout->Generation = generation;
+    state_layout->Valid = true;
+  }
+  return state_layout->Layout;
+}
+
+// Skip one value encoded as tag, e.g. "i4" or "s", in data. Return false if
+// data is too short.
+auto skipStateValue(llvm::StringRef& data, llvm::StringRef tag) -> bool {
+  size_t size = 0;
+  if (tag == "s") {
+    uint32_t length = 0;
+    if (!readStateValue(data, length)) {
+      return false;
+    }
+    size = length;
+  } else if (tag.size() < 2 || tag.drop_front().getAsInteger(10, size)) {
+    return false;
+  }
+  if (data.size() < size) {
+    return false;
+  }
+  data = data.drop_front(size);
+  return true;
+}
+
+// Return true if payload is exactly one record of an option whose layout is
+// encoding, as Option::saveState writes it.
+auto isWellFormedState(llvm::StringRef payload, llvm::StringRef encoding)
+    -> bool {
+  uint16_t occurrences = 0;
+  uint16_t position = 0;
+  if (!readStateValue(payload, occurrences) ||
+      !readStateValue(payload, position)) {
+    return false;
+  }
+  auto [kind, tag] = encoding.split(':');
+  if (kind == "opt") {
+    if (!skipStateValue(payload, tag)) {
+      return false;
+    }
+  } else if (kind == "list" || kind == "bits") {
+    if (kind == "bits" && !skipStateValue(payload, tag)) {
+      return false;
+    }
+    uint32_t count = 0;
+    if (!readStateValue(payload, count)) {
+      return false;
+    }
+    for (uint32_t i = 0; i != count; ++i) {
+      uint32_t pos = 0;
+      if (!readStateValue(payload, pos) ||
+          (kind == "list" && !skipStateValue(payload, tag))) {
+        return false;
+      }
+    }
+  } else {
+    return false;
+  }
+  return payload.empty();
+}
+
+auto stateError(const llvm::Twine& message) -> llvm::Error {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "option state: " + message);
+}
+
+}  // namespace
+
+void Option::saveState(llvm::SmallVectorImpl<char>& out) const {
+  writeStateValue(out, NumOccurrences);
+  writeStateValue(out, Position);
+  saveValue(out);
+}
+
+auto Option::loadState(llvm::StringRef& data) -> bool {
+  uint16_t occurrences = 0;
+  uint16_t position = 0;
+  if (!readStateValue(data, occurrences) || !readStateValue(data, position)) {
+    return false;
+  }
+  NumOccurrences = occurrences;
+  Position = position;
+  markValueTouched();
+  return loadValue(data);
+}
+
+auto GetOptionStateLayoutHash() -> uint64_t {
+  return currentStateLayout().Hash;
+}
+
+auto SaveOptionState(llvm::SmallVectorImpl<char>& out) -> bool {
+  const StateLayout& layout = currentStateLayout();
+  // Saved state is replayed in other processes and threads.
+  detail::SuspendOverrides suspend;
+
+  out.append(std::begin(state_magic), std::end(state_magic));
+  writeStateValue(out, state_version);
+  writeStateValue(out, layout.Hash);
+  size_t count_offset = out.size();
+  writeStateValue(out, uint32_t(0));
+
+  // Options still holding their defaults need no record; the loading process
+  // starts out with the same defaults.
+  uint32_t count = 0;
+  for (const StateEntry& entry : layout.Entries) {
+    if (!entry.Opt->isValueTouched()) {
+      continue;
+    }
+    writeStateValue(out, entry.Id);
+    size_t size_offset = out.size();
+    writeStateValue(out, uint32_t(0));
+    entry.Opt->saveState(out);
+    uint32_t size = out.size() - size_offset - sizeof(uint32_t);
+    llvm::SmallVector<char, 4> encoded;
+    writeStateValue(encoded, size);
+    std::copy(encoded.begin(), encoded.end(), out.begin() + size_offset);
+    ++count;
+  }
+
+  llvm::SmallVector<char, 4> encoded;
+  writeStateValue(encoded, count);
+  std::copy(encoded.begin(), encoded.end(), out.begin() + count_offset);
+
+  // Loading restores values without running callbacks, so a state is only
+  // complete if no option given on the command line has one.
+  auto given = [](const Option* option) {
+    return option->getNumOccurrences() > 0;
+  };
+  return llvm::none_of(layout.Unsaved, given) &&
+         llvm::none_of(layout.Entries, [&](const StateEntry& entry) {
+           return given(entry.Opt) && entry.Opt->hasCallback();
+         });
+}
+
+auto LoadOptionState(llvm::StringRef blob) -> llvm::Error {
+  if (blob.size() < state_header_size ||
+      !blob.startswith(llvm::StringRef(state_magic, sizeof(state_magic)))) {
+    return stateError("not an option state blob");
+  }
+  llvm::StringRef data = blob.drop_front(sizeof(state_magic));
+  uint32_t version = 0;
+  uint64_t hash = 0;
+  uint32_t count = 0;
+  readStateValue(data, version);
+  readStateValue(data, hash);
+  readStateValue(data, count);
+  if (version != state_version) {
+    return stateError("unsupported version " + llvm::Twine(version));
+  }
+
+  const StateLayout& layout = currentStateLayout();
+  if (hash != layout.Hash) {
+    return stateError("saved by a binary with different options");
+  }
+
+  // Check every record before changing any option, so that a failed load
+  // leaves the options as they were.
+  std::vector<std::pair<Option*, llvm::StringRef>> records;
+  records.reserve(count);
+  for (uint32_t i = 0; i != count; ++i) {
+    uint64_t id = 0;
+    uint32_t size = 0;
+    if (data.size() < state_record_header_size) {
+      return stateError("truncated record");
+    }
+    readStateValue(data, id);
+    readStateValue(data, size);
+    if (data.size() < size) {
+      return stateError("truncated record");
+    }
+    Option* option = layout.ById.lookup(id);
+    if (!option) {
+      return stateError("unknown option in record " + llvm::Twine(i));
+    }
+    llvm::StringRef payload = data.take_front(size);
+    if (!isWellFormedState(payload, option->getStateLayout())) {
+      return stateError("malformed value for option '" + option->ArgStr +
+                        "'");
+    }
+    records.emplace_back(option, payload);
+    data = data.drop_front(size);
+  }
+  if (!data.empty()) {
+    return stateError("trailing data");
+  }
+
+  for (auto& record : records) {
+    llvm::StringRef payload = record.second;
+    bool loaded = record.first->loadState(payload);
+    assert(loaded && payload.empty() && "record was checked above");
+    (void)loaded;
+  }
+  return llvm::Error::success();
+}
+
+auto LoadOptionStateFromFile(llvm::StringRef path) -> llvm::Error {
+  // Descriptors such as pipes have no size up front, so the buffer may not be
+  // mapped.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false,
+                                  /*IsVolatile=*/true);
+  if (!buffer) {
+    return llvm::createStringError(buffer.getError(),
+                                   "cannot open option state file '" + path +
+                                       "': " + buffer.getError().message());
+  }
+  return LoadOptionState((*buffer)->getBuffer());
+}
+
+}  // namespace Commandline
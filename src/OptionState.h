@@ -0,0 +1,140 @@
+#ifndef COMMANDLINE_OPTION_STATE_H
+#define COMMANDLINE_OPTION_STATE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Binary option state.
+//
+// SaveOptionState captures the values, occurrence counts and positions of all
+// registered options in a versioned blob. LoadOptionState restores them in
+// another process running the same binary, e.g. a worker handed the blob
+// through a pipe, memfd or inherited file descriptor. Loading does no
+// tokenization or string parsing.
+//
+// Options are identified by a hash of their subcommand and name (positional
+// options by their index). The header carries a hash of the option layout:
+// the identifier, kind and value encoding of every serializable option. A blob
+// written by a binary with a different layout is rejected as a whole.
+//
+// Only options whose values are numbers, enums, characters or strings are
+// serialized. Callbacks are not invoked when state is restored.
+
+// Append the state of every registered option to out. Return false if an
+// option given on the command line has a value that cannot be saved, or a
+// callback that loading the state would not run.
+auto SaveOptionState(llvm::SmallVectorImpl<char>& out) -> bool;
+
+// Restore the state saved by SaveOptionState. Options without a record keep
+// their values. Fails without touching any option if blob is not a state blob,
+// comes from a different option layout, is cut short or holds a malformed
+// record.
+auto LoadOptionState(llvm::StringRef blob) -> llvm::Error;
+
+// Return the hash of the option layout that SaveOptionState writes into the
+// blob header.
+auto GetOptionStateLayoutHash() -> uint64_t;
+
+// Restore the state saved in the file at path, which may name an inherited
+// descriptor such as /dev/fd/3.
+auto LoadOptionStateFromFile(llvm::StringRef path) -> llvm::Error;
+
+// Whether values of DataType can be written to the state blob.
+template <class DataType>
+constexpr bool is_state_serializable_v =
+    std::is_arithmetic_v<DataType> || std::is_enum_v<DataType> ||
+    std::is_same_v<DataType, std::string>;
+
+// Describe the encoding of DataType for the layout hash, e.g. "i4" for a
+// 32-bit integer or enum.
+template <class DataType>
+auto stateTypeTag() -> std::string {
+  if constexpr (std::is_same_v<DataType, std::string>) {
+    return "s";
+  } else if constexpr (std::is_floating_point_v<DataType>) {
+    return "f" + std::to_string(sizeof(DataType));
+  } else {
+    return "i" + std::to_string(sizeof(DataType));
+  }
+}
+
+// Append value to out in little-endian order. Strings are prefixed with
+// their length.
+template <class DataType>
+void writeStateValue(llvm::SmallVectorImpl<char>& out, const DataType& value) {
+  if constexpr (std::is_same_v<DataType, std::string>) {
+    writeStateValue(out, static_cast<uint32_t>(value.size()));
+    out.append(value.begin(), value.end());
+  } else if constexpr (std::is_enum_v<DataType>) {
+    writeStateValue(out, static_cast<std::underlying_type_t<DataType>>(value));
+  } else if constexpr (std::is_same_v<DataType, bool>) {
+    out.push_back(value ? 1 : 0);
+  } else {
+    using Bits = std::conditional_t<
+        sizeof(DataType) == 1, uint8_t,
+        std::conditional_t<
+            sizeof(DataType) == 2, uint16_t,
+            std::conditional_t<sizeof(DataType) == 4, uint32_t, uint64_t>>>;
+    static_assert(sizeof(Bits) == sizeof(DataType), "unsupported value size");
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = llvm::support::endian::byte_swap<Bits>(bits, llvm::support::little);
+    const char* bytes = reinterpret_cast<const char*>(&bits);
+    out.append(bytes, bytes + sizeof(bits));
+  }
+}
+
+// Read a value written by writeStateValue from the front of data and drop it.
+// Return false if data is too short.
+template <class DataType>
+auto readStateValue(llvm::StringRef& data, DataType& value) -> bool {
+  if constexpr (std::is_same_v<DataType, std::string>) {
+    uint32_t size = 0;
+    if (!readStateValue(data, size) || data.size() < size) {
+      return false;
+    }
+    value.assign(data.data(), size);
+    data = data.drop_front(size);
+  } else if constexpr (std::is_enum_v<DataType>) {
+    std::underlying_type_t<DataType> underlying;
+    if (!readStateValue(data, underlying)) {
+      return false;
+    }
+    value = static_cast<DataType>(underlying);
+  } else if constexpr (std::is_same_v<DataType, bool>) {
+    if (data.empty()) {
+      return false;
+    }
+    value = data.front() != 0;
+    data = data.drop_front();
+  } else {
+    using Bits = std::conditional_t<
+        sizeof(DataType) == 1, uint8_t,
+        std::conditional_t<
+            sizeof(DataType) == 2, uint16_t,
+            std::conditional_t<sizeof(DataType) == 4, uint32_t, uint64_t>>>;
+    if (data.size() < sizeof(Bits)) {
+      return false;
+    }
+    Bits bits;
+    std::memcpy(&bits, data.data(), sizeof(bits));
+    bits = llvm::support::endian::byte_swap<Bits>(bits, llvm::support::little);
+    std::memcpy(&value, &bits, sizeof(value));
+    data = data.drop_front(sizeof(Bits));
+  }
+  return true;
+}
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_OPTION_STATE_H
@@ -0,0 +1,191 @@
+#include "PackedFlags.h"
+
+#include <memory>
+#include <mutex>
+
+#include "OptionSchema.h"
+#include "OptionState.h"
+#include "ParseStats.h"
+#include "llvm/Support/JSON.h"
+
+namespace Commandline {
+
+namespace {
+
+// The bitset behind every packed_flag. Blocks are never freed or moved, so a
+// flag's word stays put; the bits of destroyed flags are reused. Created by
+// the first flag, so it outlives every flag.
+class PackedFlagRegistry {
+ public:
+  static constexpr unsigned words_per_block = 8;
+
+  static auto get() -> PackedFlagRegistry& {
+    static PackedFlagRegistry registry;
+    return registry;
+  }
+
+  auto allocate() -> unsigned {
+    std::lock_guard<std::mutex> guard(Lock);
+    if (!FreeBits.empty()) {
+      unsigned index = FreeBits.back();
+      FreeBits.pop_back();
+      return index;
+    }
+    if (NextBit == Blocks.size() * words_per_block * 64) {
+      Blocks.push_back(std::make_unique<Block>());
+    }
+    return NextBit++;
+  }
+
+  void release(unsigned index) {
+    word(index).fetch_and(~(uint64_t{1} << (index % 64)),
+                          std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(Lock);
+    FreeBits.push_back(index);
+  }
+
+  auto word(unsigned index) -> std::atomic<uint64_t>& {
+    unsigned word_index = index / 64;
+    std::lock_guard<std::mutex> guard(Lock);
+    return Blocks[word_index / words_per_block]
+        ->Words[word_index % words_per_block];
+  }
+
+  void snapshot(std::vector<uint64_t>& words) {
+    std::lock_guard<std::mutex> guard(Lock);
+    words.resize((NextBit + 63) / 64);
+    for (size_t i = 0; i < words.size(); ++i) {
+      words[i] = Blocks[i / words_per_block]
+                     ->Words[i % words_per_block]
+                     .load(std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  // One cache line of flags.
+  struct alignas(64) Block {
+    std::atomic<uint64_t> Words[words_per_block] = {};
+  };
+
+  std::mutex Lock;
+  std::vector<std::unique_ptr<Block>> Blocks;
+  std::vector<unsigned> FreeBits;
+  unsigned NextBit = 0;
+};
+
+}  // namespace
+
+auto takePackedFlagSnapshot() -> packed_flag_snapshot {
+  packed_flag_snapshot result;
+  PackedFlagRegistry::get().snapshot(result.Words);
+  return result;
+}
+
+void packed_flag::allocateBit() {
+  PackedFlagRegistry& registry = PackedFlagRegistry::get();
+  Index = registry.allocate();
+  Word = &registry.word(Index);
+  Mask = uint64_t{1} << (Index % 64);
+}
+
+packed_flag::~packed_flag() { PackedFlagRegistry::get().release(Index); }
+
+void packed_flag::setBit(bool V) {
+  if (V) {
+    Word->fetch_or(Mask, std::memory_order_relaxed);
+  } else {
+    Word->fetch_and(~Mask, std::memory_order_relaxed);
+  }
+}
+
+auto packed_flag::handleOccurrence(unsigned pos, llvm::StringRef ArgName,
+                                   llvm::StringRef Arg) -> bool {
+  bool value = false;
+  if (ParsePhaseTimer timer(ParsePhase::ValueParsing, "bool");
+      Parser.parse(*this, ArgName, Arg, value)) {
+    return true;  // Parse error!
+  }
+  setBit(value);
+  setPosition(pos);
+  return false;
+}
+
+auto packed_flag::getOptionWidth() const -> size_t {
+  return Parser.getOptionWidth(*this);
+}
+
+void packed_flag::printOptionInfo(size_t GlobalWidth,
+                                  llvm::raw_ostream& OS) const {
+  Parser.printOptionInfo(*this, GlobalWidth, OS);
+}
+
+void packed_flag::printOptionValue(size_t GlobalWidth, bool Force,
+                                   llvm::raw_ostream& OS) const {
+  if (Force || valueDiffersFromDefault()) {
+    Parser.printOptionDiff(*this, getValue(), Default, GlobalWidth, OS);
+  }
+}
+
+auto packed_flag::valueDiffersFromDefault() const -> bool {
+  // Without cl::init the default is false.
+  if (!Default.hasValue()) {
+    return getValue();
+  }
+  return Default.compare(getValue());
+}
+
+auto packed_flag::getValueTexts(llvm::SmallVectorImpl<std::string>& Texts)
+    const -> bool {
+  Texts.push_back(getValue() ? "true" : "false");
+  return true;
+}
+
+void packed_flag::writeValueJSON(llvm::json::OStream& json) const {
+  json.value(getValue());
+}
+
+auto packed_flag::getStateLayout() const -> std::string {
+  return "opt:" + stateTypeTag<bool>();
+}
+
+void packed_flag::saveValue(llvm::SmallVectorImpl<char>& Out) const {
+  writeStateValue<bool>(Out, getValue());
+}
+
+auto packed_flag::loadValue(llvm::StringRef& Data) -> bool {
+  bool value = false;
+  if (!readStateValue(Data, value)) {
+    return false;
+  }
+  setBit(value);
+  return true;
+}
+
+auto packed_flag::setRuntimeValue(llvm::StringRef Arg) -> bool {
+  bool value = false;
+  if (Parser.parse(*this, ArgStr, Arg, value)) {
+    return true;  // Parse error!
+  }
+  *this = value;
+  return false;
+}
+
+void packed_flag::writeValueSchema(llvm::json::OStream& json) const {
+  json.attribute("kind", "opt");
+  json.attribute("type", "bool");
+  json.attribute("default", Default.hasValue() && Default.getValue());
+}
+
+void packed_flag::setDefault() {
+  setBit(Default.hasValue() && Default.getValue());
+  // The bit is outside the option, as with external storage.
+  markValueTouched();
+}
+
+void packed_flag::done() {
+  Parser.initialize();
+  markValueTouched();
+  addArgument();
+}
+
+}  // namespace Commandline
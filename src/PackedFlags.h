@@ -0,0 +1,161 @@
+#ifndef COMMANDLINE_PACKED_FLAGS_H
+#define COMMANDLINE_PACKED_FLAGS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Option.h"
+#include "OptionReadProfile.h"
+#include "OptionValue.h"
+#include "Parser.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Packed boolean flags.
+//
+// A packed_flag is a boolean option whose value lives in one bit of a bitset
+// owned by the library rather than in the option object. Bits are handed out
+// in order of creation, 512 to a 64-byte block, so a program's feature
+// toggles share a few cache lines and testing one does not touch the option
+// metadata beyond the bit's address. Keep a packed_flag_ref to test a flag
+// without reading the option at all.
+//
+// A packed_flag takes neither cl::location nor callbacks such as cl::cb, and
+// ScopedOptionOverride does not apply to it: every thread reads the one bit,
+// and ScopedOptionOverride::parse reports that the flag cannot be
+// overridden.
+//
+// Bits are read and written with relaxed atomics, so a flag may be tested
+// while another thread parses. takePackedFlagSnapshot copies every word of
+// the bitset, each read atomically.
+
+class packed_flag;
+
+// The word and mask of one packed flag. A ref must not outlive its flag: the
+// word stays valid, but the bit of a destroyed flag is handed to the next
+// flag created, and the ref would then test that flag.
+class packed_flag_ref {
+ public:
+  packed_flag_ref() = default;
+  packed_flag_ref(const std::atomic<uint64_t>* word, uint64_t mask)
+      : Word(word), Mask(mask) {}
+
+  auto test() const -> bool {
+    return (Word->load(std::memory_order_relaxed) & Mask) != 0;
+  }
+  explicit operator bool() const { return test(); }
+
+ private:
+  const std::atomic<uint64_t>* Word = nullptr;
+  uint64_t Mask = 0;
+};
+
+// A copy of the packed flag bitset.
+class packed_flag_snapshot {
+ public:
+  auto test(const packed_flag& flag) const -> bool;
+  // The words of the bitset; bit i of word w is the flag with index
+  // w * 64 + i.
+  auto words() const -> llvm::ArrayRef<uint64_t> { return Words; }
+
+ private:
+  friend auto takePackedFlagSnapshot() -> packed_flag_snapshot;
+  std::vector<uint64_t> Words;
+};
+
+// Copy the value of every packed flag.
+auto takePackedFlagSnapshot() -> packed_flag_snapshot;
+
+// A boolean option stored in the packed flag bitset. It accepts the modifiers
+// of opt<bool> except location and callbacks; see above.
+class packed_flag final : public Option, public OptionReadProfile {
+  parser<bool> Parser;
+  std::atomic<uint64_t>* Word = nullptr;
+  uint64_t Mask = 0;
+  unsigned Index = 0;
+  OptionValue<bool> Default;
+
+  void allocateBit();
+  void setBit(bool V);
+
+  bool handleOccurrence(unsigned pos, llvm::StringRef ArgName,
+                        llvm::StringRef Arg) override;
+
+  enum ValueExpected getValueExpectedFlagDefault() const override {
+    return Parser.getValueExpectedFlagDefault();
+  }
+
+  size_t getOptionWidth() const override;
+  void printOptionInfo(size_t GlobalWidth,
+                       llvm::raw_ostream& OS) const override;
+  void printOptionValue(size_t GlobalWidth, bool Force,
+                        llvm::raw_ostream& OS) const override;
+  bool valueDiffersFromDefault() const override;
+  bool getValueTexts(llvm::SmallVectorImpl<std::string>& Texts) const override;
+  void writeValueJSON(llvm::json::OStream& json) const override;
+  // Saved state matches opt<bool>, so either can load it.
+  std::string getStateLayout() const override;
+  void saveValue(llvm::SmallVectorImpl<char>& Out) const override;
+  bool loadValue(llvm::StringRef& Data) override;
+  bool setRuntimeValue(llvm::StringRef Arg) override;
+  void writeValueSchema(llvm::json::OStream& json) const override;
+  void setDefault() override;
+
+  void done();
+
+ public:
+  // Command line options should not be copyable
+  packed_flag(const packed_flag&) = delete;
+  packed_flag& operator=(const packed_flag&) = delete;
+
+  template <class... Mods>
+  explicit packed_flag(const Mods&... Ms)
+      : Option(Optional, NotHidden), Parser(*this) {
+    allocateBit();
+    bindReadProfile(*this);
+    apply(this, Ms...);
+    done();
+  }
+  ~packed_flag() override;
+
+  // setInitialValue - Used by the cl::init modifier...
+  void setInitialValue(bool V) {
+    setBit(V);
+    Default = V;
+  }
+
+  parser<bool>& getParser() { return Parser; }
+
+  bool getValue() const {
+    noteRead();
+    return (Word->load(std::memory_order_relaxed) & Mask) != 0;
+  }
+  operator bool() const { return getValue(); }
+
+  bool operator=(bool V) {
+    setBit(V);
+    markValueTouched();
+    return V;
+  }
+
+  const OptionValue<bool>& getDefault() const { return Default; }
+
+  // The position of this flag in the bitset and in snapshot words.
+  unsigned getIndex() const { return Index; }
+  packed_flag_ref getRef() const { return packed_flag_ref(Word, Mask); }
+};
+
+inline auto packed_flag_snapshot::test(const packed_flag& flag) const -> bool {
+  unsigned index = flag.getIndex();
+  return index / 64 < Words.size() && (Words[index / 64] >> (index % 64)) & 1;
+}
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PACKED_FLAGS_H
@@ -0,0 +1,222 @@
+#include "ParseCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "CommandLine.h"
+#include "OptionState.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+namespace {
+
+constexpr char cache_magic[4] = {'C', 'L', 'P', 'C'};
+constexpr uint32_t cache_version = 1;
+constexpr llvm::StringLiteral cache_extension = ".clpc";
+
+// Pruning stops once the entries fit in this fraction of the limit, so that
+// a full cache is not pruned again on every store.
+constexpr uint64_t prune_target_percent = 75;
+
+// Processes sharing the directory scan it at most this often, unless one of
+// them alone has stored enough to fill the room pruning left.
+constexpr std::chrono::minutes prune_interval(1);
+
+// Touched after each scan; its age tells when the directory was last scanned.
+constexpr llvm::StringLiteral prune_stamp_name = "prune.stamp";
+
+struct ParseCacheConfig {
+  std::string Directory;
+  uint64_t MaxSize = default_parse_cache_size;
+  // Bytes this process stored since it last scanned the directory.
+  uint64_t StoredSinceScan = 0;
+};
+
+ManagedStatic<ParseCacheConfig> cache_config;
+
+auto entryPath(const llvm::MD5::MD5Result& key) -> llvm::SmallString<128> {
+  llvm::SmallString<128> path(cache_config->Directory);
+  llvm::sys::path::append(path, llvm::Twine(key.digest()) + cache_extension);
+  return path;
+}
+
+struct CacheEntry {
+  std::string Path;
+  uint64_t Size;
+  llvm::sys::TimePoint<> Modified;
+};
+
+auto pruneStampPath() -> llvm::SmallString<128> {
+  llvm::SmallString<128> path(cache_config->Directory);
+  llvm::sys::path::append(path, prune_stamp_name);
+  return path;
+}
+
+// Scanning the directory costs a stat per entry, so a store only scans it
+// when the stamp is stale or this process may have filled the cache itself.
+auto isPruneDue() -> bool {
+  uint64_t slack =
+      cache_config->MaxSize - cache_config->MaxSize / 100 * prune_target_percent;
+  if (cache_config->StoredSinceScan > slack) {
+    return true;
+  }
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(pruneStampPath(), status)) {
+    return true;
+  }
+  return std::chrono::system_clock::now() - status.getLastModificationTime() >=
+         prune_interval;
+}
+
+// Truncating the stamp updates its modification time.
+void touchPruneStamp() {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(pruneStampPath(), ec);
+}
+
+// Remove the oldest entries until the cache fits its size limit again.
+void pruneCache() {
+  cache_config->StoredSinceScan = 0;
+  touchPruneStamp();
+
+  std::vector<CacheEntry> entries;
+  uint64_t total = 0;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(cache_config->Directory, ec), end;
+       it != end && !ec; it.increment(ec)) {
+    if (llvm::sys::path::extension(it->path()) != cache_extension) {
+      continue;
+    }
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(it->path(), status)) {
+      continue;
+    }
+    entries.push_back(
+        {it->path(), status.getSize(), status.getLastModificationTime()});
+    total += status.getSize();
+  }
+  if (total <= cache_config->MaxSize) {
+    return;
+  }
+
+  llvm::sort(entries, [](const CacheEntry& lhs, const CacheEntry& rhs) {
+    return lhs.Modified < rhs.Modified;
+  });
+  uint64_t target = cache_config->MaxSize / 100 * prune_target_percent;
+  for (const CacheEntry& entry : entries) {
+    if (total <= target) {
+      break;
+    }
+    // Another process may have removed the entry already.
+    llvm::sys::fs::remove(entry.Path);
+    total -= entry.Size;
+  }
+}
+
+}  // namespace
+
+void EnableParseCache(llvm::StringRef directory, uint64_t max_size) {
+  cache_config->Directory = directory.str();
+  cache_config->MaxSize = max_size;
+  cache_config->StoredSinceScan = 0;
+}
+
+void DisableParseCache() { cache_config->Directory.clear(); }
+
+auto IsParseCacheEnabled() -> bool { return !cache_config->Directory.empty(); }
+
+auto FinishParseCacheKey(llvm::MD5& digest, llvm::ArrayRef<const char*> argv,
+                         bool long_options_use_double_dash)
+    -> llvm::MD5::MD5Result {
+  for (const char* arg : argv) {
+    if (arg) {
+      digest.update(llvm::StringRef(arg, std::strlen(arg) + 1));
+    }
+  }
+  digest.update(llvm::StringRef(long_options_use_double_dash ? "L" : "l"));
+  digest.update(llvm::Twine(GetOptionStateLayoutHash()).str());
+  llvm::MD5::MD5Result key;
+  digest.final(key);
+  return key;
+}
+
+auto LoadCachedParse(const llvm::MD5::MD5Result& key) -> bool {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(entryPath(key), /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    return false;
+  }
+
+  // The entry repeats its key, so that a file copied or renamed into the
+  // directory is never applied to the wrong command line.
+  llvm::StringRef data = (*buffer)->getBuffer();
+  llvm::SmallString<32> digest = key.digest();
+  uint32_t version = 0;
+  if (!data.consume_front(llvm::StringRef(cache_magic, sizeof(cache_magic))) ||
+      !readStateValue(data, version) || version != cache_version ||
+      !data.consume_front(digest)) {
+    return false;
+  }
+  if (llvm::Error error = LoadOptionState(data)) {
+    llvm::consumeError(std::move(error));
+    return false;
+  }
+  return true;
+}
+
+void StoreCachedParse(const llvm::MD5::MD5Result& key) {
+  llvm::SmallVector<char, 512> blob;
+  blob.append(std::begin(cache_magic), std::end(cache_magic));
+  writeStateValue(blob, cache_version);
+  llvm::SmallString<32> digest = key.digest();
+  blob.append(digest.begin(), digest.end());
+  if (!SaveOptionState(blob)) {
+    return;
+  }
+
+  // Failing to store an entry only costs the next parse its hit.
+  if (llvm::sys::fs::create_directories(cache_config->Directory)) {
+    return;
+  }
+  llvm::SmallString<128> model(cache_config->Directory);
+  llvm::sys::path::append(model, "%%%%%%%%%%%%.tmp");
+  int fd = -1;
+  llvm::SmallString<128> temp_path;
+  if (llvm::sys::fs::createUniqueFile(model, fd, temp_path)) {
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os.write(blob.data(), blob.size());
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(temp_path, entryPath(key))) {
+    llvm::sys::fs::remove(temp_path);
+    return;
+  }
+  cache_config->StoredSinceScan += blob.size();
+  if (isPruneDue()) {
+    pruneCache();
+  }
+}
+
+}  // namespace Commandline
@@ -0,0 +1,59 @@
+#ifndef COMMANDLINE_PARSE_CACHE_H
+#define COMMANDLINE_PARSE_CACHE_H
+
+#include <cstdint>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MD5.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Persistent parse cache.
+//
+// When enabled, ParseCommandLineOptions stores the option state produced by
+// each successful parse in a directory, keyed by a hash of the expanded
+// arguments, the name and contents of every response or config file read, and
+// the option layout. A later parse of the same command line by the same binary
+// restores that state instead of looking up options, parsing values and
+// distributing positional arguments.
+//
+// Entries are written to a temporary file and renamed into place, so
+// processes sharing the directory never see a partial entry. When the
+// directory grows beyond its size limit, the oldest entries are removed. The
+// directory is scanned for that at most once a minute, or sooner once this
+// process alone has stored a quarter of the limit, so it may briefly exceed
+// the limit.
+//
+// Command lines giving an option whose value cannot be saved, or an option
+// with a callback, are never cached (see SaveOptionState), since a hit would
+// skip the callback.
+
+constexpr uint64_t default_parse_cache_size = 64 << 20;
+
+// Cache parse results in directory, which is created on first use, keeping
+// its entries below max_size bytes.
+void EnableParseCache(llvm::StringRef directory,
+                      uint64_t max_size = default_parse_cache_size);
+
+void DisableParseCache();
+
+auto IsParseCacheEnabled() -> bool;
+
+// Add the expanded arguments and the option layout to digest, which already
+// holds the files read during expansion, and return the cache key.
+auto FinishParseCacheKey(llvm::MD5& digest, llvm::ArrayRef<const char*> argv,
+                         bool long_options_use_double_dash)
+    -> llvm::MD5::MD5Result;
+
+// Restore the option state stored under key. Return false if there is no
+// usable entry.
+auto LoadCachedParse(const llvm::MD5::MD5Result& key) -> bool;
+
+// Store the current option state under key.
+void StoreCachedParse(const llvm::MD5::MD5Result& key);
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PARSE_CACHE_H
@@ -0,0 +1,126 @@
+#ifndef COMMANDLINE_PARSE_DIAGNOSTICS_H
+#define COMMANDLINE_PARSE_DIAGNOSTICS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+class Option;
+struct ParseDiagnosticsAccess;
+
+//===----------------------------------------------------------------------===//
+// Structured parse diagnostics.
+//
+// The ParseCommandLineOptions overload taking a ParseDiagnostics records each
+// error instead of printing it, and never exits the process. Records hold the
+// pieces of a message, which is only formatted when print is called:
+//
+//   ParseDiagnostics diags;
+//   diags.setFailFast(true);
+//   switch (ParseCommandLineOptions(argc, argv, diags)) {
+//   case ParseResult::Success:
+//     break;
+//   case ParseResult::Error:
+//     return reply(400, diags.getRecords());
+//   case ParseResult::Help:
+//     PrintHelpMessage(os, diags.isHelpHidden(), diags.isHelpCategorized());
+//     return;
+//   ...
+//   }
+//
+// Errors an option reports through Option::error while the parse runs on the
+// thread, e.g. from a callback, are recorded too.
+
+enum class ParseDiagnosticKind {
+  // A response or configuration file could not be expanded.
+  ResponseFile,
+  // No option matches the argument.
+  UnknownArgument,
+  // An option rejected its occurrence or value.
+  OptionError,
+  // A Required or OneOrMore option did not occur.
+  MissingRequired,
+  // Fewer positional arguments than the positional options require.
+  NotEnoughPositionals,
+  // More positional arguments than the positional options accept.
+  TooManyPositionals,
+  // The program declares positional options that can never match.
+  PositionalSetup,
+};
+
+struct ParseDiagnostic {
+  ParseDiagnosticKind Kind = ParseDiagnosticKind::OptionError;
+  // Index of the argument in the command line after environment and
+  // response file expansion, or -1 if the error concerns no argument.
+  int ArgIndex = -1;
+  // The option concerned, or null. Printing the record needs it alive.
+  const Option* Opt = nullptr;
+  // The argument for UnknownArgument; the option name used for option
+  // errors, empty for positional options.
+  std::string Arg;
+  // For UnknownArgument, the nearest option with the argument's value, e.g.
+  // "output=a.o", if there is one.
+  std::string Suggestion;
+  // The option's message, or the file error for ResponseFile.
+  std::string Message;
+  // The number of positional arguments required (NotEnoughPositionals) or
+  // accepted (TooManyPositionals).
+  size_t Count = 0;
+};
+
+enum class ParseResult {
+  Success,
+  // The records describe what went wrong.
+  Error,
+  // --help or one of its variants was given. Nothing was printed.
+  Help,
+  // --version was given. Nothing was printed.
+  Version,
+  // An option such as --print-option-schema printed its output and would
+  // otherwise have exited.
+  Exit,
+};
+
+class ParseDiagnostics {
+ public:
+  // Stop parsing at the first error instead of reporting them all.
+  void setFailFast(bool fail_fast) { FailFast = fail_fast; }
+  auto isFailFast() const -> bool { return FailFast; }
+
+  auto getRecords() const -> llvm::ArrayRef<ParseDiagnostic> {
+    return Records;
+  }
+  auto empty() const -> bool { return Records.empty(); }
+
+  // The help printer asked for by a ParseResult::Help parse.
+  auto isHelpHidden() const -> bool { return HelpHidden; }
+  auto isHelpCategorized() const -> bool { return HelpCategorized; }
+
+  // Print every record as ParseCommandLineOptions prints errors without
+  // diagnostics.
+  void print(llvm::raw_ostream& os) const;
+  void print(llvm::raw_ostream& os, const ParseDiagnostic& diagnostic) const;
+
+ private:
+  friend struct ParseDiagnosticsAccess;
+
+  std::vector<ParseDiagnostic> Records;
+  std::string ProgramName;
+  std::string Argv0;
+  // The argument being handed to an option, for the records it reports.
+  int CurrentArg = -1;
+  ParseResult Request = ParseResult::Success;
+  bool HelpHidden = false;
+  bool HelpCategorized = false;
+  bool FailFast = false;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PARSE_DIAGNOSTICS_H
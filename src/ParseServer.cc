@@ -0,0 +1,518 @@
+#include "ParseServer.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "CommandLine.h"
+#include "OptionState.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+namespace Commandline {
+
+#ifndef _WIN32
+
+namespace {
+
+constexpr char request_magic[4] = {'C', 'L', 'R', 'Q'};
+constexpr char response_magic[4] = {'C', 'L', 'R', 'S'};
+constexpr uint32_t protocol_version = 3;
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+auto systemError(const llvm::Twine& message) -> llvm::Error {
+  std::error_code ec(errno, std::generic_category());
+  return llvm::createStringError(
+      ec, "parse server: " + message + ": " + ec.message());
+}
+
+struct ParseRequest {
+  std::vector<std::string> Argv;
+  std::string Cwd;
+  std::vector<std::string> Env;
+};
+
+void writeStrings(llvm::SmallVectorImpl<char>& out,
+                  const std::vector<std::string>& strings) {
+  writeStateValue(out, static_cast<uint32_t>(strings.size()));
+  for (const std::string& text : strings) {
+    writeStateValue(out, text);
+  }
+}
+
+auto readStrings(llvm::StringRef& data, std::vector<std::string>& strings)
+    -> bool {
+  uint32_t count = 0;
+  if (!readStateValue(data, count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i != count; ++i) {
+    std::string text;
+    if (!readStateValue(data, text)) {
+      return false;
+    }
+    strings.push_back(std::move(text));
+  }
+  return true;
+}
+
+void writeDiagnostics(llvm::SmallVectorImpl<char>& out,
+                      llvm::ArrayRef<ParseDiagnostic> diagnostics) {
+  writeStateValue(out, static_cast<uint32_t>(diagnostics.size()));
+  for (const ParseDiagnostic& diagnostic : diagnostics) {
+    writeStateValue(out, static_cast<uint8_t>(diagnostic.Kind));
+    writeStateValue(out, static_cast<int32_t>(diagnostic.ArgIndex));
+    writeStateValue(out, diagnostic.Arg);
+    writeStateValue(out, diagnostic.Suggestion);
+    writeStateValue(out, diagnostic.Message);
+    writeStateValue(out, static_cast<uint64_t>(diagnostic.Count));
+  }
+}
+
+auto readDiagnostics(llvm::StringRef& data,
+                     std::vector<ParseDiagnostic>& diagnostics) -> bool {
+  uint32_t count = 0;
+  if (!readStateValue(data, count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i != count; ++i) {
+    uint8_t kind = 0;
+    int32_t arg_index = 0;
+    uint64_t arg_count = 0;
+    ParseDiagnostic diagnostic;
+    if (!readStateValue(data, kind) ||
+        kind > static_cast<uint8_t>(ParseDiagnosticKind::PositionalSetup) ||
+        !readStateValue(data, arg_index) ||
+        !readStateValue(data, diagnostic.Arg) ||
+        !readStateValue(data, diagnostic.Suggestion) ||
+        !readStateValue(data, diagnostic.Message) ||
+        !readStateValue(data, arg_count)) {
+      return false;
+    }
+    diagnostic.Kind = static_cast<ParseDiagnosticKind>(kind);
+    diagnostic.ArgIndex = arg_index;
+    diagnostic.Count = arg_count;
+    diagnostics.push_back(std::move(diagnostic));
+  }
+  return true;
+}
+
+auto readHeader(llvm::StringRef& data, const char (&magic)[4]) -> bool {
+  uint32_t version = 0;
+  return data.consume_front(llvm::StringRef(magic, sizeof(magic))) &&
+         readStateValue(data, version) && version == protocol_version;
+}
+
+void encodeRequest(const ParseRequest& request,
+                   llvm::SmallVectorImpl<char>& out) {
+  out.append(std::begin(request_magic), std::end(request_magic));
+  writeStateValue(out, protocol_version);
+  writeStrings(out, request.Argv);
+  writeStateValue(out, request.Cwd);
+  writeStrings(out, request.Env);
+}
+
+auto decodeRequest(llvm::StringRef data, ParseRequest& request) -> bool {
+  return readHeader(data, request_magic) && readStrings(data, request.Argv) &&
+         !request.Argv.empty() && readStateValue(data, request.Cwd) &&
+         readStrings(data, request.Env) && data.empty();
+}
+
+void encodeResponse(const ParseResponse& response,
+                    llvm::SmallVectorImpl<char>& out) {
+  out.append(std::begin(response_magic), std::end(response_magic));
+  writeStateValue(out, protocol_version);
+  writeStateValue(out, static_cast<int32_t>(response.ExitCode));
+  writeStateValue(out, response.Parsed);
+  writeStateValue(out, response.StateComplete);
+  writeStateValue(out, response.Output);
+  writeStateValue(out, response.ErrorOutput);
+  writeDiagnostics(out, response.Diagnostics);
+  writeStateValue(out, response.ActiveSubCommand);
+  writeStateValue(out, response.State);
+}
+
+auto decodeResponse(llvm::StringRef data, ParseResponse& response) -> bool {
+  int32_t exit_code = 0;
+  if (!readHeader(data, response_magic) || !readStateValue(data, exit_code) ||
+      !readStateValue(data, response.Parsed) ||
+      !readStateValue(data, response.StateComplete) ||
+      !readStateValue(data, response.Output) ||
+      !readStateValue(data, response.ErrorOutput) ||
+      !readDiagnostics(data, response.Diagnostics) ||
+      !readStateValue(data, response.ActiveSubCommand) ||
+      !readStateValue(data, response.State) || !data.empty()) {
+    return false;
+  }
+  response.ExitCode = exit_code;
+  return true;
+}
+
+auto sendAll(int fd, llvm::StringRef data) -> bool {
+  while (!data.empty()) {
+    ssize_t written = ::send(fd, data.data(), data.size(), send_flags);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data = data.drop_front(written);
+  }
+  return true;
+}
+
+// Read fd until end of file.
+auto readAll(int fd, std::string& data) -> bool {
+  char buffer[4096];
+  while (true) {
+    ssize_t count = ::read(fd, buffer, sizeof(buffer));
+    if (count == 0) {
+      return true;
+    }
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.append(buffer, count);
+  }
+}
+
+// Return a descriptor for an anonymous temporary file, or -1.
+auto createScratchFile() -> int {
+  int fd = -1;
+  llvm::SmallString<128> path;
+  if (llvm::sys::fs::createTemporaryFile("parse-server", "tmp", fd, path)) {
+    return -1;
+  }
+  llvm::sys::fs::remove(path);
+  return fd;
+}
+
+auto readScratchFile(int fd, std::string& data) -> bool {
+  return ::lseek(fd, 0, SEEK_SET) == 0 && readAll(fd, data);
+}
+
+// Runs in a child forked for one request: adopt the client's directory and
+// environment, parse, and leave the error records and, if the parse
+// succeeded, the option state in state_fd.
+[[noreturn]] void runParse(const ParseServerConfig& config,
+                           ParseRequest& request, int out_fd, int err_fd,
+                           int state_fd) {
+  ::dup2(out_fd, STDOUT_FILENO);
+  ::dup2(err_fd, STDERR_FILENO);
+  if (!request.Cwd.empty() && ::chdir(request.Cwd.c_str()) != 0) {
+    llvm::errs() << request.Argv[0] << ": cannot change to directory '"
+                 << request.Cwd << "'\n";
+    std::exit(1);
+  }
+  std::vector<char*> env;
+  for (std::string& entry : request.Env) {
+    env.push_back(entry.data());
+  }
+  env.push_back(nullptr);
+  environ = env.data();
+
+  std::vector<const char*> argv;
+  for (const std::string& arg : request.Argv) {
+    argv.push_back(arg.c_str());
+  }
+  ParseDiagnostics diags;
+  ParseResult result = ParseCommandLineOptions(
+      static_cast<int>(argv.size()), argv.data(), diags, config.Overview,
+      config.EnvVar, config.LongOptionsUseDoubleDash);
+  llvm::SmallVector<char, 512> state;
+  writeDiagnostics(state, diags.getRecords());
+  llvm::raw_fd_ostream os(state_fd, /*shouldClose=*/false);
+  switch (result) {
+    case ParseResult::Success:
+      break;
+    case ParseResult::Error:
+      diags.print(llvm::errs());
+      os.write(state.data(), state.size());
+      os.flush();
+      std::exit(1);
+    case ParseResult::Help:
+      PrintHelpMessage(diags.isHelpHidden(), diags.isHelpCategorized());
+      std::exit(0);
+    case ParseResult::Version:
+      PrintVersionMessage();
+      std::exit(0);
+    case ParseResult::Exit:
+      std::exit(0);
+  }
+
+  // The parse succeeded. Record whether the state is complete, the active
+  // subcommand and the state itself.
+  llvm::SmallVector<char, 512> blob;
+  bool complete = SaveOptionState(blob);
+  std::string active;
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    if (*sub) {
+      active = sub->getName().str();
+    }
+  }
+  writeStateValue(state, complete);
+  writeStateValue(state, active);
+  state.append(blob.begin(), blob.end());
+  os.write(state.data(), state.size());
+  os.flush();
+  llvm::outs().flush();
+  std::exit(0);
+}
+
+// Runs in a child forked for each connection: read the request, parse it in
+// a further child and send back what that child produced.
+[[noreturn]] void handleConnection(const ParseServerConfig& config, int conn) {
+  ParseResponse response;
+  std::string data;
+  ParseRequest request;
+  int out_fd = createScratchFile();
+  int err_fd = createScratchFile();
+  int state_fd = createScratchFile();
+  if (!readAll(conn, data) || !decodeRequest(data, request)) {
+    response.ExitCode = 1;
+    response.ErrorOutput = "parse server: malformed request\n";
+  } else if (out_fd < 0 || err_fd < 0 || state_fd < 0) {
+    response.ExitCode = 1;
+    response.ErrorOutput = "parse server: cannot create scratch files\n";
+  } else {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(conn);
+      runParse(config, request, out_fd, err_fd, state_fd);
+    }
+    int status = 0;
+    while (pid > 0 && ::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (pid < 0) {
+      response.ExitCode = 1;
+      response.ErrorOutput = "parse server: cannot fork\n";
+    } else {
+      response.ExitCode = WIFEXITED(status) ? WEXITSTATUS(status)
+                                            : 128 + WTERMSIG(status);
+      readScratchFile(out_fd, response.Output);
+      readScratchFile(err_fd, response.ErrorOutput);
+      std::string state;
+      readScratchFile(state_fd, state);
+      llvm::StringRef rest(state);
+      if (readDiagnostics(rest, response.Diagnostics) &&
+          response.ExitCode == 0 &&
+          readStateValue(rest, response.StateComplete) &&
+          readStateValue(rest, response.ActiveSubCommand)) {
+        response.Parsed = true;
+        response.State = rest.str();
+      }
+    }
+  }
+
+  llvm::SmallVector<char, 1024> encoded;
+  encodeResponse(response, encoded);
+  sendAll(conn, llvm::StringRef(encoded.data(), encoded.size()));
+  ::close(conn);
+  // Skip the server's exit handlers and static destructors.
+  ::_exit(0);
+}
+
+}  // namespace
+
+auto RunParseServer(const ParseServerConfig& config) -> llvm::Error {
+  // The socket is bound under a temporary name and renamed into place once
+  // it listens, so that a client finding SocketPath can always connect.
+  std::string bound_path =
+      (config.SocketPath + ".tmp" + llvm::Twine(::getpid())).str();
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (config.SocketPath.empty() || bound_path.size() >= sizeof(addr.sun_path)) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        "parse server: bad socket path '" + config.SocketPath + "'");
+  }
+  std::memcpy(addr.sun_path, bound_path.c_str(), bound_path.size() + 1);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return systemError("cannot create socket");
+  }
+  ::unlink(bound_path.c_str());
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(fd, SOMAXCONN) != 0 ||
+      ::rename(bound_path.c_str(), config.SocketPath.c_str()) != 0) {
+    llvm::Error error = systemError("cannot listen on '" + config.SocketPath +
+                                    "'");
+    ::close(fd);
+    ::unlink(bound_path.c_str());
+    return error;
+  }
+
+  // Children inherit unwritten output, which they would print again.
+  llvm::outs().flush();
+  llvm::errs().flush();
+
+  std::vector<pid_t> handlers;
+  auto reap = [&](int flags) {
+    llvm::erase_if(handlers, [&](pid_t pid) {
+      return ::waitpid(pid, nullptr, flags) == pid;
+    });
+  };
+  for (unsigned served = 0;
+       config.MaxRequests == 0 || served < config.MaxRequests;) {
+    int conn = ::accept(fd, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      llvm::Error error = systemError("cannot accept connection");
+      ::close(fd);
+      return error;
+    }
+    ++served;
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(fd);
+      handleConnection(config, conn);
+    }
+    ::close(conn);
+    if (pid > 0) {
+      handlers.push_back(pid);
+    }
+    reap(WNOHANG);
+  }
+  ::close(fd);
+  ::unlink(config.SocketPath.c_str());
+  reap(0);
+  return llvm::Error::success();
+}
+
+auto SendParseRequest(llvm::StringRef socket_path,
+                      llvm::ArrayRef<const char*> argv)
+    -> llvm::Expected<ParseResponse> {
+  ParseRequest request;
+  for (const char* arg : argv) {
+    request.Argv.emplace_back(arg);
+  }
+  llvm::SmallString<256> cwd;
+  if (!llvm::sys::fs::current_path(cwd)) {
+    request.Cwd = std::string(cwd);
+  }
+  for (char** entry = environ; entry && *entry; ++entry) {
+    request.Env.emplace_back(*entry);
+  }
+  llvm::SmallVector<char, 4096> encoded;
+  encodeRequest(request, encoded);
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        "parse server: bad socket path '" + socket_path + "'");
+  }
+  std::memcpy(addr.sun_path, socket_path.data(), socket_path.size());
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return systemError("cannot create socket");
+  }
+  std::string data;
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      !sendAll(fd, llvm::StringRef(encoded.data(), encoded.size())) ||
+      ::shutdown(fd, SHUT_WR) != 0 || !readAll(fd, data)) {
+    llvm::Error error = systemError("cannot reach '" + socket_path + "'");
+    ::close(fd);
+    return error;
+  }
+  ::close(fd);
+
+  ParseResponse response;
+  if (!decodeResponse(data, response)) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::protocol_error),
+        "parse server: malformed response");
+  }
+  return response;
+}
+
+auto ParseCommandLineOptionsWithServer(llvm::StringRef socket_path, int argc,
+                                       const char* const* argv) -> bool {
+  llvm::Expected<ParseResponse> response =
+      SendParseRequest(socket_path, llvm::ArrayRef<const char*>(argv, argc));
+  if (!response) {
+    llvm::consumeError(response.takeError());
+    return false;
+  }
+
+  if (response->Parsed) {
+    if (!response->StateComplete) {
+      return false;
+    }
+    if (llvm::Error error = LoadOptionState(response->State)) {
+      llvm::consumeError(std::move(error));
+      return false;
+    }
+    for (SubCommand* sub : getRegisteredSubcommands()) {
+      if (sub->getName() == response->ActiveSubCommand) {
+        setActiveSubCommand(*sub);
+      }
+    }
+  }
+
+  llvm::outs() << response->Output;
+  llvm::outs().flush();
+  llvm::errs() << response->ErrorOutput;
+  if (!response->Parsed) {
+    std::exit(response->ExitCode);
+  }
+  return true;
+}
+
+#else  // _WIN32
+
+auto RunParseServer(const ParseServerConfig& /*config*/) -> llvm::Error {
+  return llvm::createStringError(
+      std::make_error_code(std::errc::function_not_supported),
+      "parse server: not supported on this platform");
+}
+
+auto SendParseRequest(llvm::StringRef /*socket_path*/,
+                      llvm::ArrayRef<const char*> /*argv*/)
+    -> llvm::Expected<ParseResponse> {
+  return llvm::createStringError(
+      std::make_error_code(std::errc::function_not_supported),
+      "parse server: not supported on this platform");
+}
+
+auto ParseCommandLineOptionsWithServer(llvm::StringRef /*socket_path*/,
+                                       int /*argc*/,
+                                       const char* const* /*argv*/) -> bool {
+  return false;
+}
+
+#endif  // _WIN32
+
+}  // namespace Commandline
@@ -0,0 +1,88 @@
+#ifndef COMMANDLINE_PARSE_SERVER_H
+#define COMMANDLINE_PARSE_SERVER_H
+
+#include <string>
+#include <vector>
+
+#include "ParseDiagnostics.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Parse server.
+//
+// A resident process that has already registered its options serves parse
+// requests over a Unix domain socket. A request carries an argv, the client's
+// working directory and its environment. The server forks a child for each
+// request, which starts from the warm registry, switches to the client's
+// directory and environment and runs ParseCommandLineOptions. Requests are
+// therefore parsed concurrently and independently of each other.
+//
+// The response carries the parse's exit status, everything it printed to
+// stdout and stderr (help text, error messages), the records of the errors it
+// found and, if it succeeded, the resulting option state as written by
+// SaveOptionState.
+//
+// Option callbacks run in the server's child, never in the client. The state
+// of a parse giving an option with a callback is therefore incomplete, and
+// the client shim leaves such command lines to a local parse.
+//
+// Only available on POSIX systems.
+
+struct ParseServerConfig {
+  // Path of the socket. An existing file at this path is replaced. The
+  // socket appears at the path only once it accepts connections.
+  std::string SocketPath;
+  llvm::StringRef Overview;
+  // Environment variable holding extra options, as for
+  // ParseCommandLineOptions. It is read from the client's environment.
+  const char* EnvVar = nullptr;
+  bool LongOptionsUseDoubleDash = false;
+  // Stop after this many requests; 0 serves forever.
+  unsigned MaxRequests = 0;
+};
+
+// Serve parse requests on config.SocketPath until config.MaxRequests have
+// been accepted. Returns an error if the socket cannot be set up.
+auto RunParseServer(const ParseServerConfig& config) -> llvm::Error;
+
+struct ParseResponse {
+  // Exit status of the parse: 0 if it succeeded or an option such as --help
+  // ended it early, 1 if it found errors.
+  int ExitCode = 0;
+  // True if parsing ran to completion and State holds its result.
+  bool Parsed = false;
+  // False if an option given on the command line could not be saved or has
+  // a callback.
+  bool StateComplete = false;
+  std::string Output;
+  std::string ErrorOutput;
+  // The errors the parse found. The records come from another process, so
+  // their Opt is null; Arg names the option.
+  std::vector<ParseDiagnostic> Diagnostics;
+  // Name of the subcommand the parse selected, if Parsed.
+  std::string ActiveSubCommand;
+  // The blob written by SaveOptionState, if Parsed.
+  std::string State;
+};
+
+// Send argv with the current directory and environment to the server at
+// socket_path and wait for its response.
+auto SendParseRequest(llvm::StringRef socket_path,
+                      llvm::ArrayRef<const char*> argv)
+    -> llvm::Expected<ParseResponse>;
+
+// Client shim for main: parse argc/argv through the server at socket_path.
+// Prints the server's output and error output, exits with its exit status if
+// the parse did not complete, and otherwise loads the resulting option state.
+// Returns false without printing anything if the server cannot be reached or
+// the state cannot be transferred, so that the caller can parse locally.
+auto ParseCommandLineOptionsWithServer(llvm::StringRef socket_path, int argc,
+                                       const char* const* argv) -> bool;
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PARSE_SERVER_H
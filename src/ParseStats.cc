@@ -0,0 +1,204 @@
+#include "ParseStats.h"
+
+#include "ManagedStatic.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+
+namespace Commandline {
+
+namespace {
+
+constexpr llvm::StringLiteral phase_names[num_parse_phases] = {
+    "response-files", "subcommand", "default-options", "lookup",
+    "value-parsing",  "positionals", "validation",
+};
+
+struct ParseStatsState {
+  ParseStats Stats;
+  ParseObserver* Observer = nullptr;
+  // Nesting depth of ParseStatsRecorder; phases are timed while positive.
+  unsigned Depth = 0;
+  // The innermost phase being timed.
+  ParsePhaseTimer* Current = nullptr;
+};
+
+ManagedStatic<ParseStatsState> parse_stats;
+
+#if COMMANDLINE_ENABLE_PARSE_STATS
+// The statistics that allocations on this thread are counted in, or null.
+// A plain pointer, so that allocation hooks can read it at any time.
+thread_local ParseStats* counting_stats = nullptr;
+
+// Stops allocation counting for its lifetime, so that the bookkeeping of the
+// instrumentation is not counted.
+class PauseCounting {
+ public:
+  PauseCounting() : Saved(counting_stats) { counting_stats = nullptr; }
+  ~PauseCounting() { counting_stats = Saved; }
+
+ private:
+  ParseStats* Saved;
+};
+#endif
+
+void printPhase(llvm::raw_ostream& os, llvm::StringRef name,
+                const ParsePhaseStats& phase) {
+  os << "  " << llvm::left_justify(name, 20)
+     << llvm::format("%8llu calls %12.3f us %8llu allocs %10llu bytes\n",
+                     static_cast<unsigned long long>(phase.Count),
+                     phase.Nanoseconds / 1000.0,
+                     static_cast<unsigned long long>(phase.Allocations),
+                     static_cast<unsigned long long>(phase.AllocatedBytes));
+}
+
+}  // namespace
+
+auto GetParsePhaseName(ParsePhase phase) -> llvm::StringRef {
+  return phase_names[static_cast<unsigned>(phase)];
+}
+
+void SetParseObserver(ParseObserver* observer) {
+  parse_stats->Observer = observer;
+}
+
+auto GetLastParseStats() -> const ParseStats& { return parse_stats->Stats; }
+
+void PrintParseStats(const ParseStats& stats, llvm::raw_ostream& os) {
+  if (!COMMANDLINE_ENABLE_PARSE_STATS) {
+    os << "Parse statistics are not enabled in this build.\n";
+    return;
+  }
+  os << llvm::format("Parse statistics (%.3f us, %llu allocations, %llu "
+                     "bytes in total):\n",
+                     stats.TotalNanoseconds / 1000.0,
+                     static_cast<unsigned long long>(stats.Allocations),
+                     static_cast<unsigned long long>(stats.AllocatedBytes));
+  for (unsigned i = 0; i != num_parse_phases; ++i) {
+    printPhase(os, phase_names[i], stats.Phases[i]);
+  }
+  os << "Option lookups: " << stats.LookupHits << " hits, "
+     << stats.PrefixFallbacks << " prefix fallbacks, "
+     << stats.NearestMatchSearches << " nearest-match searches\n";
+  os << "Arena: " << stats.ArenaBytes << " bytes used of "
+     << stats.ArenaSlabBytes << " bytes in slabs\n";
+  if (stats.ValueParsers.empty()) {
+    return;
+  }
+  llvm::SmallVector<llvm::StringRef, 8> types;
+  for (const auto& entry : stats.ValueParsers) {
+    types.push_back(entry.getKey());
+  }
+  llvm::sort(types);
+  os << "Value parsing by type:\n";
+  for (llvm::StringRef type : types) {
+    printPhase(os, type, stats.ValueParsers.lookup(type));
+  }
+}
+
+#if COMMANDLINE_ENABLE_PARSE_STATS
+
+void RecordParseAllocation(size_t bytes) {
+  if (ParseStats* stats = counting_stats) {
+    ++stats->Allocations;
+    stats->AllocatedBytes += bytes;
+  }
+}
+
+ParseStatsRecorder::ParseStatsRecorder()
+    : Start(std::chrono::steady_clock::now()), Outer(parse_stats->Depth == 0) {
+  if (Outer) {
+    parse_stats->Stats = ParseStats();
+    counting_stats = &parse_stats->Stats;
+  }
+  ++parse_stats->Depth;
+}
+
+ParseStatsRecorder::~ParseStatsRecorder() {
+  --parse_stats->Depth;
+  if (Outer) {
+    counting_stats = nullptr;
+    parse_stats->Stats.TotalNanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - Start)
+            .count();
+  }
+}
+
+void ParseStatsRecorder::noteArena(const llvm::BumpPtrAllocator& arena) {
+  ParseStats& stats = parse_stats->Stats;
+  stats.ArenaBytes = arena.getBytesAllocated();
+  stats.ArenaSlabBytes = arena.getTotalMemory();
+}
+
+ParsePhaseTimer::ParsePhaseTimer(ParsePhase phase, llvm::StringRef detail)
+    : Phase(phase), Detail(detail), Active(parse_stats->Depth != 0) {
+  if (!Active) {
+    return;
+  }
+  if (ParseObserver* observer = parse_stats->Observer) {
+    PauseCounting pause;
+    observer->phaseBegin(Phase, Detail);
+  }
+  Parent = parse_stats->Current;
+  parse_stats->Current = this;
+  StartAllocations = parse_stats->Stats.Allocations;
+  StartAllocatedBytes = parse_stats->Stats.AllocatedBytes;
+  Start = std::chrono::steady_clock::now();
+}
+
+ParsePhaseTimer::~ParsePhaseTimer() {
+  if (!Active) {
+    return;
+  }
+  uint64_t total = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - Start)
+                       .count();
+  PauseCounting pause;
+  ParseStats& stats = parse_stats->Stats;
+  uint64_t allocations = stats.Allocations - StartAllocations;
+  uint64_t allocated_bytes = stats.AllocatedBytes - StartAllocatedBytes;
+  parse_stats->Current = Parent;
+  if (Parent) {
+    Parent->NestedNanoseconds += total;
+    Parent->NestedAllocations += allocations;
+    Parent->NestedAllocatedBytes += allocated_bytes;
+  }
+  uint64_t nanoseconds = total - NestedNanoseconds;
+  auto add = [&](ParsePhaseStats& phase) {
+    ++phase.Count;
+    phase.Nanoseconds += nanoseconds;
+    phase.Allocations += allocations - NestedAllocations;
+    phase.AllocatedBytes += allocated_bytes - NestedAllocatedBytes;
+  };
+  add(stats.phase(Phase));
+  if (Phase == ParsePhase::ValueParsing) {
+    add(stats.ValueParsers[Detail]);
+  }
+  if (ParseObserver* observer = parse_stats->Observer) {
+    observer->phaseEnd(Phase, Detail, nanoseconds);
+  }
+}
+
+void CountParseLookup(ParseLookup kind) {
+  if (parse_stats->Depth == 0) {
+    return;
+  }
+  ParseStats& stats = parse_stats->Stats;
+  switch (kind) {
+    case ParseLookup::Hit:
+      ++stats.LookupHits;
+      break;
+    case ParseLookup::PrefixFallback:
+      ++stats.PrefixFallbacks;
+      break;
+    case ParseLookup::NearestMatch:
+      ++stats.NearestMatchSearches;
+      break;
+  }
+}
+
+#endif  // COMMANDLINE_ENABLE_PARSE_STATS
+
+}  // namespace Commandline
@@ -0,0 +1,186 @@
+#ifndef COMMANDLINE_PARSE_STATS_H
+#define COMMANDLINE_PARSE_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/raw_ostream.h"
+
+// Build with COMMANDLINE_ENABLE_PARSE_STATS=1 to compile the timers and
+// counters into the parser. They read the clock around every phase, so they
+// are left out by default.
+#ifndef COMMANDLINE_ENABLE_PARSE_STATS
+#define COMMANDLINE_ENABLE_PARSE_STATS 0
+#endif
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Parse instrumentation.
+//
+// ParseCommandLineOptions times each phase of its work and counts how option
+// lookups were resolved. The figures of the most recent parse are available
+// from GetLastParseStats and are printed by --print-parse-stats. A
+// ParseObserver additionally sees every phase as it begins and ends.
+//
+// Phases nest: values are parsed during lookup and positional handling. The
+// time and allocations of a nested phase count towards that phase only, so
+// the phases add up to no more than the whole parse.
+//
+// Heap allocations are counted per phase when an allocation hook reports
+// them through RecordParseAllocation, e.g. a replacement global operator new
+// such as the one in test/support. Only allocations made by the parsing
+// thread while a parse runs are counted. The parser's BumpPtrAllocator is
+// reported separately, since its slabs serve many small allocations.
+
+enum class ParsePhase : uint8_t {
+  ResponseFiles,        // Expanding response and config files
+  SubCommandSelection,  // Choosing the subcommand from the first argument
+  DefaultOptions,       // Registering the DefaultOptions
+  OptionLookup,         // Finding the option named by each argument
+  ValueParsing,         // Running an option's parser on a value
+  Positionals,          // Handing positional values to their options
+  Validation,           // Checking that required options were given
+};
+
+constexpr unsigned num_parse_phases = 7;
+
+auto GetParsePhaseName(ParsePhase phase) -> llvm::StringRef;
+
+struct ParsePhaseStats {
+  uint64_t Count = 0;
+  uint64_t Nanoseconds = 0;
+  uint64_t Allocations = 0;
+  uint64_t AllocatedBytes = 0;
+};
+
+struct ParseStats {
+  ParsePhaseStats Phases[num_parse_phases];
+  // ValueParsing split by parser type, e.g. "int" or "enum".
+  llvm::StringMap<ParsePhaseStats> ValueParsers;
+  // Lookups that found the option by its name.
+  uint64_t LookupHits = 0;
+  // Lookups that fell back to prefixed or grouped option matching.
+  uint64_t PrefixFallbacks = 0;
+  // Unknown arguments for which the nearest option name was searched.
+  uint64_t NearestMatchSearches = 0;
+  // Wall time of the whole parse.
+  uint64_t TotalNanoseconds = 0;
+  // Allocations of the whole parse, including those outside any phase.
+  uint64_t Allocations = 0;
+  uint64_t AllocatedBytes = 0;
+  // Bytes handed out by the parser's BumpPtrAllocator and the size of its
+  // slabs.
+  uint64_t ArenaBytes = 0;
+  uint64_t ArenaSlabBytes = 0;
+
+  auto phase(ParsePhase p) -> ParsePhaseStats& {
+    return Phases[static_cast<unsigned>(p)];
+  }
+  auto phase(ParsePhase p) const -> const ParsePhaseStats& {
+    return Phases[static_cast<unsigned>(p)];
+  }
+};
+
+class ParseObserver {
+ public:
+  virtual ~ParseObserver() = default;
+
+  // detail is the parser type for ValueParsing and empty otherwise.
+  // nanoseconds excludes the time spent in nested phases.
+  virtual void phaseBegin(ParsePhase /*phase*/, llvm::StringRef /*detail*/) {}
+  virtual void phaseEnd(ParsePhase /*phase*/, llvm::StringRef /*detail*/,
+                        uint64_t /*nanoseconds*/) {}
+};
+
+// Install observer, or remove the current one if observer is null. The
+// observer is not owned.
+void SetParseObserver(ParseObserver* observer);
+
+// Return the statistics of the most recent parse. All zero if the
+// instrumentation is compiled out.
+auto GetLastParseStats() -> const ParseStats&;
+
+void PrintParseStats(const ParseStats& stats, llvm::raw_ostream& os);
+
+// Allocation hook: count an allocation of bytes against the current parse
+// phase. Safe to call from operator new at any time; it does not allocate.
+#if COMMANDLINE_ENABLE_PARSE_STATS
+void RecordParseAllocation(size_t bytes);
+#else
+inline void RecordParseAllocation(size_t /*bytes*/) {}
+#endif
+
+enum class ParseLookup : uint8_t { Hit, PrefixFallback, NearestMatch };
+
+#if COMMANDLINE_ENABLE_PARSE_STATS
+
+// Collects statistics for one parse: clears them on construction and records
+// the total time on destruction. Phases timed outside a parse are ignored.
+class ParseStatsRecorder {
+ public:
+  ParseStatsRecorder();
+  ~ParseStatsRecorder();
+  ParseStatsRecorder(const ParseStatsRecorder&) = delete;
+  auto operator=(const ParseStatsRecorder&) -> ParseStatsRecorder& = delete;
+
+  // Record the usage of the parse's arena.
+  void noteArena(const llvm::BumpPtrAllocator& arena);
+
+ private:
+  std::chrono::steady_clock::time_point Start;
+  bool Outer;
+};
+
+// Adds the time until destruction to phase.
+class ParsePhaseTimer {
+ public:
+  explicit ParsePhaseTimer(ParsePhase phase,
+                           llvm::StringRef detail = llvm::StringRef());
+  ~ParsePhaseTimer();
+  ParsePhaseTimer(const ParsePhaseTimer&) = delete;
+  auto operator=(const ParsePhaseTimer&) -> ParsePhaseTimer& = delete;
+
+ private:
+  ParsePhase Phase;
+  llvm::StringRef Detail;
+  bool Active;
+  // The phase this one is nested in, or null.
+  ParsePhaseTimer* Parent = nullptr;
+  std::chrono::steady_clock::time_point Start;
+  // Allocation totals of the parse when the phase began.
+  uint64_t StartAllocations = 0;
+  uint64_t StartAllocatedBytes = 0;
+  // Totals of the phases nested in this one, which it does not count.
+  uint64_t NestedNanoseconds = 0;
+  uint64_t NestedAllocations = 0;
+  uint64_t NestedAllocatedBytes = 0;
+};
+
+void CountParseLookup(ParseLookup kind);
+
+#else
+
+class ParseStatsRecorder {
+ public:
+  ParseStatsRecorder() {}  // Not trivial, so unused instances do not warn.
+  void noteArena(const llvm::BumpPtrAllocator& /*arena*/) {}
+};
+
+class ParsePhaseTimer {
+ public:
+  explicit ParsePhaseTimer(ParsePhase /*phase*/,
+                           llvm::StringRef /*detail*/ = llvm::StringRef()) {}
+};
+
+inline void CountParseLookup(ParseLookup /*kind*/) {}
+
+#endif  // COMMANDLINE_ENABLE_PARSE_STATS
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PARSE_STATS_H
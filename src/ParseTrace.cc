@@ -0,0 +1,178 @@
+#include "ParseTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "ManagedStatic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+
+namespace Commandline {
+
+std::atomic<bool> parse_trace_enabled{false};
+
+namespace {
+
+constexpr size_t trace_detail_size = 96;
+
+struct TraceSlot {
+  // index + 1 of the event held, or 0 while the slot is being written.
+  std::atomic<uint64_t> Sequence{0};
+  const char* Name = nullptr;
+  uint64_t Timestamp = 0;
+  uint64_t Thread = 0;
+  int32_t ArgIndex = -1;
+  char Phase = 0;
+  uint8_t DetailSize = 0;
+  char Detail[trace_detail_size];
+};
+
+struct TraceBuffer {
+  std::unique_ptr<TraceSlot[]> Slots;
+  size_t Mask = 0;
+  std::atomic<uint64_t> Next{0};
+  std::chrono::steady_clock::time_point Base;
+};
+
+ManagedStatic<TraceBuffer> trace_buffer;
+
+void record(const char* name, char phase, llvm::StringRef detail,
+            int arg_index) {
+  TraceBuffer& buffer = *trace_buffer;
+  if (!buffer.Slots) {
+    return;
+  }
+  uint64_t index = buffer.Next.fetch_add(1, std::memory_order_relaxed);
+  TraceSlot& slot = buffer.Slots[index & buffer.Mask];
+  slot.Sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.Name = name;
+  slot.Phase = phase;
+  slot.Timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - buffer.Base)
+                       .count();
+  slot.Thread = llvm::get_threadid();
+  slot.ArgIndex = arg_index;
+  slot.DetailSize =
+      static_cast<uint8_t>(std::min(detail.size(), trace_detail_size));
+  if (slot.DetailSize) {
+    std::memcpy(slot.Detail, detail.data(), slot.DetailSize);
+  }
+  slot.Sequence.store(index + 1, std::memory_order_release);
+}
+
+// An event copied out of the buffer.
+struct TraceEvent {
+  const char* Name;
+  uint64_t Timestamp;
+  uint64_t Thread;
+  int32_t ArgIndex;
+  char Phase;
+  uint8_t DetailSize;
+  char Detail[trace_detail_size];
+};
+
+// Copy event index out of its slot. Returns false if it was overwritten or
+// is still being written.
+auto readEvent(const TraceBuffer& buffer, uint64_t index, TraceEvent& event)
+    -> bool {
+  const TraceSlot& slot = buffer.Slots[index & buffer.Mask];
+  if (slot.Sequence.load(std::memory_order_acquire) != index + 1) {
+    return false;
+  }
+  event.Name = slot.Name;
+  event.Timestamp = slot.Timestamp;
+  event.Thread = slot.Thread;
+  event.ArgIndex = slot.ArgIndex;
+  event.Phase = slot.Phase;
+  event.DetailSize = slot.DetailSize;
+  std::memcpy(event.Detail, slot.Detail, event.DetailSize);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.Sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+}  // namespace
+
+void EnableParseTrace(size_t capacity) {
+  TraceBuffer& buffer = *trace_buffer;
+  parse_trace_enabled.store(false, std::memory_order_relaxed);
+  size_t size = llvm::PowerOf2Ceil(std::max<size_t>(capacity, 2));
+  buffer.Slots = std::make_unique<TraceSlot[]>(size);
+  buffer.Mask = size - 1;
+  buffer.Next.store(0, std::memory_order_relaxed);
+  buffer.Base = std::chrono::steady_clock::now();
+  parse_trace_enabled.store(true, std::memory_order_release);
+}
+
+void DisableParseTrace() {
+  parse_trace_enabled.store(false, std::memory_order_relaxed);
+}
+
+void ClearParseTrace() {
+  TraceBuffer& buffer = *trace_buffer;
+  if (!buffer.Slots) {
+    return;
+  }
+  for (size_t i = 0; i <= buffer.Mask; ++i) {
+    buffer.Slots[i].Sequence.store(0, std::memory_order_relaxed);
+  }
+  buffer.Next.store(0, std::memory_order_release);
+}
+
+void WriteParseTraceJSON(llvm::raw_ostream& os) {
+  const TraceBuffer& buffer = *trace_buffer;
+  int64_t pid = static_cast<int64_t>(llvm::sys::Process::getProcessId());
+  llvm::json::OStream json(os);
+  json.object([&] {
+    json.attribute("displayTimeUnit", "ns");
+    json.attributeArray("traceEvents", [&] {
+      if (!buffer.Slots) {
+        return;
+      }
+      uint64_t end = buffer.Next.load(std::memory_order_acquire);
+      uint64_t size = buffer.Mask + 1;
+      TraceEvent event;
+      for (uint64_t i = end > size ? end - size : 0; i < end; ++i) {
+        if (!readEvent(buffer, i, event)) {
+          continue;
+        }
+        json.object([&] {
+          json.attribute("name", event.Name);
+          json.attribute("cat", "commandline");
+          json.attribute("ph", llvm::StringRef(&event.Phase, 1));
+          json.attribute("ts", event.Timestamp / 1000.0);
+          json.attribute("pid", pid);
+          json.attribute("tid", static_cast<int64_t>(event.Thread));
+          if (event.Phase != 'B') {
+            return;
+          }
+          json.attributeObject("args", [&] {
+            // Truncation may have split a UTF-8 sequence.
+            llvm::StringRef detail(event.Detail, event.DetailSize);
+            if (!detail.empty()) {
+              json.attribute("detail", llvm::json::isUTF8(detail)
+                                           ? detail.str()
+                                           : llvm::json::fixUTF8(detail));
+            }
+            if (event.ArgIndex >= 0) {
+              json.attribute("arg", static_cast<int64_t>(event.ArgIndex));
+            }
+          });
+        });
+      }
+    });
+  });
+}
+
+void ParseTraceScope::begin(llvm::StringRef detail, int arg_index) {
+  record(Name, 'B', detail, arg_index);
+}
+
+void ParseTraceScope::end() { record(Name, 'E', llvm::StringRef(), -1); }
+
+}  // namespace Commandline
@@ -0,0 +1,75 @@
+#ifndef COMMANDLINE_PARSE_TRACE_H
+#define COMMANDLINE_PARSE_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Parse tracing.
+//
+// When enabled, ParseCommandLineOptions, response and config file expansion,
+// every option occurrence and the help printers record begin and end events
+// in a ring buffer. Events carry the file or option name involved and the
+// index of the argument being processed. WriteParseTraceJSON writes them in
+// the Chrome trace_event format, which chrome://tracing and Perfetto display
+// as a flame chart.
+//
+// Recording takes no lock and does not allocate; once the buffer is full the
+// oldest events are overwritten. Names longer than a slot are truncated.
+
+constexpr size_t default_parse_trace_capacity = 1 << 14;
+
+// Start recording into a buffer of at least capacity events, discarding
+// events recorded so far. Must not be called while another thread parses.
+void EnableParseTrace(size_t capacity = default_parse_trace_capacity);
+
+// Stop recording. The recorded events remain available.
+void DisableParseTrace();
+
+// Discard the recorded events.
+void ClearParseTrace();
+
+// Write the recorded events, oldest first, as a Chrome trace JSON object.
+void WriteParseTraceJSON(llvm::raw_ostream& os);
+
+extern std::atomic<bool> parse_trace_enabled;
+
+inline auto IsParseTraceEnabled() -> bool {
+  return parse_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// Records a begin event on construction and the matching end event on
+// destruction. name must be a string literal.
+class ParseTraceScope {
+ public:
+  explicit ParseTraceScope(const char* name,
+                           llvm::StringRef detail = llvm::StringRef(),
+                           int arg_index = -1)
+      : Name(IsParseTraceEnabled() ? name : nullptr) {
+    if (Name) {
+      begin(detail, arg_index);
+    }
+  }
+  ~ParseTraceScope() {
+    if (Name) {
+      end();
+    }
+  }
+  ParseTraceScope(const ParseTraceScope&) = delete;
+  auto operator=(const ParseTraceScope&) -> ParseTraceScope& = delete;
+
+ private:
+  void begin(llvm::StringRef detail, int arg_index);
+  void end();
+
+  const char* Name;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_PARSE_TRACE_H
@@ -3,11 +3,24 @@
 
 #include "Option.h"
 #include "OptionValue.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 
 namespace Commandline {
 
+// Declared here rather than in CommandLine.h because parser<DataType> calls it
+// from a template body, which gcc requires to see the declaration.
+/// Adds a new option for parsing and provides the option it refers to.
+///
+/// \param O pointer to the option
+/// \param Name the string name for the option to handle during parsing
+///
+/// Literal options are used by some parsers to register special option values.
+/// This is how the PassNameParser registers pass names for opt.
+void AddLiteralOption(Option& O, llvm::StringRef Name);
+
 //===----------------------------------------------------------------------===//
 // Parameterizable parser for different data types. By default, known data types
 // (string, int, bool) have specialized parsers, that do what you would expect.
@@ -53,14 +66,16 @@ class generic_parser_base {
   virtual auto getOptionValue(unsigned n) const
       -> const GenericOptionValue& = 0;
 
-  // Print out information about this option. The to-be-maintained width is
-  // specified.
+  // Print out information about this option to os. The to-be-maintained width
+  // is specified.
   //
-  virtual void printOptionInfo(const Option& o, size_t global_width) const;
+  virtual void printOptionInfo(const Option& o, size_t global_width,
+                               llvm::raw_ostream& os) const;
 
   void printGenericOptionDiff(const Option& o, const GenericOptionValue& v,
                               const GenericOptionValue& Default,
-                              size_t global_width) const;
+                              size_t global_width,
+                              llvm::raw_ostream& os) const;
 
   // Print the value of an option and it's default.
   //
@@ -69,8 +84,8 @@ class generic_parser_base {
   template <class AnyOptionValue>
   void printOptionDiff(const Option& o, const AnyOptionValue& v,
                        const AnyOptionValue& Default,
-                       size_t global_width) const {
-    printGenericOptionDiff(o, v, Default, global_width);
+                       size_t global_width, llvm::raw_ostream& os) const {
+    printGenericOptionDiff(o, v, Default, global_width, os);
   }
 
   void initialize() {}
@@ -107,7 +122,17 @@ class generic_parser_base {
   //
   auto findOption(llvm::StringRef name) -> unsigned;
 
+  // Remove the named literal values with one pass over the table. Parsers
+  // whose values cannot be removed ignore the call.
+  virtual void removeLiteralOptions(llvm::ArrayRef<llvm::StringRef> /*names*/) {}
+
  protected:
+  // Record a literal value added to this parser in the active
+  // registration_scope, if any. Literal values show up in -help, so both
+  // this and noteLiteralsRemoved invalidate the rendered help.
+  void noteLiteralValue(llvm::StringRef name);
+  void noteLiteralsRemoved();
+
   Option& Owner;
 };
 
@@ -179,6 +204,7 @@ class parser : public generic_parser_base {
     OptionInfo x(name, static_cast<DataType>(v), help_str);
     Values.push_back(x);
     AddLiteralOption(Owner, name);
+    noteLiteralValue(name);
   }
 
   /// Remove the specified option.
@@ -187,6 +213,14 @@ class parser : public generic_parser_base {
     unsigned n = findOption(name);
     assert(n != Values.size() && "Option not found!");
     Values.erase(Values.begin() + n);
+    noteLiteralsRemoved();
+  }
+
+  void removeLiteralOptions(llvm::ArrayRef<llvm::StringRef> names) override {
+    llvm::erase_if(Values, [&](const OptionInfo& info) {
+      return llvm::is_contained(names, info.Name);
+    });
+    noteLiteralsRemoved();
   }
 };
 
@@ -211,13 +245,15 @@ class basic_parser_impl {  // non-template implementation of basic_parser<t>
   // Return the width of the option tag for printing...
   auto getOptionWidth(const Option& o) const -> size_t;
 
-  // Print out information about this option. The to-be-maintained width is
-  // specified.
+  // Print out information about this option to os. The to-be-maintained width
+  // is specified.
   //
-  void printOptionInfo(const Option& o, size_t global_width) const;
+  void printOptionInfo(const Option& o, size_t global_width,
+                       llvm::raw_ostream& os) const;
 
   // Print a placeholder for options that don't yet support printOptionDiff().
-  void printOptionNoValue(const Option& o, size_t global_width) const;
+  void printOptionNoValue(const Option& o, size_t global_width,
+                          llvm::raw_ostream& os) const;
 
   // Overload in subclass to provide a better default value.
   virtual auto getValueName() const -> llvm::StringRef { return "value"; }
@@ -227,7 +263,8 @@ class basic_parser_impl {  // non-template implementation of basic_parser<t>
 
  protected:
   // A helper for basic_parser::printOptionDiff.
-  void printOptionName(const Option& o, size_t global_width) const;
+  void printOptionName(const Option& o, size_t global_width,
+                       llvm::raw_ostream& os) const;
 };
 
 // The real basic parser is just a template wrapper that provides a typedef for
@@ -267,7 +304,7 @@ class parser<bool> : public basic_parser<bool> {
   }
 
   void printOptionDiff(const Option& o, bool v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -296,7 +333,7 @@ class parser<boolOrDefault> : public basic_parser<boolOrDefault> {
   }
 
   void printOptionDiff(const Option& o, boolOrDefault v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -319,7 +356,7 @@ class parser<int> : public basic_parser<int> {
   auto getValueName() const -> llvm::StringRef override { return "int"; }
 
   void printOptionDiff(const Option& o, int v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -342,7 +379,7 @@ class parser<long> final : public basic_parser<long> {
   auto getValueName() const -> llvm::StringRef override { return "long"; }
 
   void printOptionDiff(const Option& o, long v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -365,7 +402,7 @@ class parser<long long> : public basic_parser<long long> {
   auto getValueName() const -> llvm::StringRef override { return "long"; }
 
   void printOptionDiff(const Option& o, long long v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -388,7 +425,7 @@ class parser<unsigned> : public basic_parser<unsigned> {
   auto getValueName() const -> llvm::StringRef override { return "uint"; }
 
   void printOptionDiff(const Option& o, unsigned v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -411,7 +448,7 @@ class parser<unsigned long> final : public basic_parser<unsigned long> {
   auto getValueName() const -> llvm::StringRef override { return "ulong"; }
 
   void printOptionDiff(const Option& o, unsigned long v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -434,7 +471,7 @@ class parser<unsigned long long> : public basic_parser<unsigned long long> {
   auto getValueName() const -> llvm::StringRef override { return "ulong"; }
 
   void printOptionDiff(const Option& o, unsigned long long v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -457,7 +494,7 @@ class parser<double> : public basic_parser<double> {
   auto getValueName() const -> llvm::StringRef override { return "number"; }
 
   void printOptionDiff(const Option& o, double v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -480,7 +517,7 @@ class parser<float> : public basic_parser<float> {
   auto getValueName() const -> llvm::StringRef override { return "number"; }
 
   void printOptionDiff(const Option& o, float v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -506,7 +543,8 @@ class parser<std::string> : public basic_parser<std::string> {
   auto getValueName() const -> llvm::StringRef override { return "string"; }
 
   void printOptionDiff(const Option& o, llvm::StringRef v,
-                       const OptVal& Default, size_t global_width) const;
+                       const OptVal& Default, size_t global_width,
+                       llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -532,7 +570,7 @@ class parser<char> : public basic_parser<char> {
   auto getValueName() const -> llvm::StringRef override { return "char"; }
 
   void printOptionDiff(const Option& o, char v, OptVal Default,
-                       size_t global_width) const;
+                       size_t global_width, llvm::raw_ostream& os) const;
 
   // An out-of-line virtual method to provide a 'home' for this class.
   void anchor() override;
@@ -545,9 +583,10 @@ class parser<char> : public basic_parser<char> {
 // This overloaded function is selected by the generic parser.
 template <class ParserClass, class DT>
 void printOptionDiff(const Option& O, const generic_parser_base& P, const DT& V,
-                     const OptionValue<DT>& Default, size_t GlobalWidth) {
+                     const OptionValue<DT>& Default, size_t GlobalWidth,
+                     llvm::raw_ostream& OS) {
   OptionValue<DT> OV = V;
-  P.printOptionDiff(O, OV, Default, GlobalWidth);
+  P.printOptionDiff(O, OV, Default, GlobalWidth, OS);
 }
 
 // This is instantiated for basic parsers when the parsed value has a different
@@ -555,8 +594,9 @@ void printOptionDiff(const Option& O, const generic_parser_base& P, const DT& V,
 template <class ParserDT, class ValDT>
 struct OptionDiffPrinter {
   void print(const Option& O, const parser<ParserDT>& P, const ValDT& /*V*/,
-             const OptionValue<ValDT>& /*Default*/, size_t GlobalWidth) {
-    P.printOptionNoValue(O, GlobalWidth);
+             const OptionValue<ValDT>& /*Default*/, size_t GlobalWidth,
+             llvm::raw_ostream& OS) {
+    P.printOptionNoValue(O, GlobalWidth, OS);
   }
 };
 
@@ -565,8 +605,9 @@ struct OptionDiffPrinter {
 template <class DT>
 struct OptionDiffPrinter<DT, DT> {
   void print(const Option& O, const parser<DT>& P, const DT& V,
-             const OptionValue<DT>& Default, size_t GlobalWidth) {
-    P.printOptionDiff(O, V, Default, GlobalWidth);
+             const OptionValue<DT>& Default, size_t GlobalWidth,
+             llvm::raw_ostream& OS) {
+    P.printOptionDiff(O, V, Default, GlobalWidth, OS);
   }
 };
 
@@ -576,11 +617,25 @@ template <class ParserClass, class ValDT>
 void printOptionDiff(
     const Option& O,
     const basic_parser<typename ParserClass::parser_data_type>& P,
-    const ValDT& V, const OptionValue<ValDT>& Default, size_t GlobalWidth) {
+    const ValDT& V, const OptionValue<ValDT>& Default, size_t GlobalWidth,
+    llvm::raw_ostream& OS) {
   OptionDiffPrinter<typename ParserClass::parser_data_type, ValDT> printer;
-  printer.print(O, static_cast<const ParserClass&>(P), V, Default, GlobalWidth);
+  printer.print(O, static_cast<const ParserClass&>(P), V, Default, GlobalWidth,
+                OS);
 }
 
+// Print the values of a list or bits option and its defaults, each given as
+// argument text.
+void printListOptionDiff(const Option& O, llvm::ArrayRef<std::string> Values,
+                         llvm::ArrayRef<std::string> Defaults,
+                         size_t GlobalWidth, llvm::raw_ostream& OS);
+
+// Print the value of a scalar option and its default, each given as argument
+// text, as the basic parsers do.
+void printScalarOptionDiff(const Option& O, llvm::StringRef Value,
+                           llvm::StringRef Default, size_t GlobalWidth,
+                           llvm::raw_ostream& OS);
+
 }  // namespace Commandline
 
 #endif  // COMMANDLINE_PARSER_H
\ No newline at end of file
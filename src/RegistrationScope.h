@@ -0,0 +1,85 @@
+#ifndef COMMANDLINE_REGISTRATION_SCOPE_H
+#define COMMANDLINE_REGISTRATION_SCOPE_H
+
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace Commandline {
+
+class Option;
+class OptionCategory;
+class SubCommand;
+class generic_parser_base;
+
+//===----------------------------------------------------------------------===//
+// Registration scopes.
+//
+// A registration_scope records everything registered while it is active:
+// options, literal option names, the literal values parsers gain, categories
+// and subcommands. Unregistering the scope removes all of them together, with
+// one pass over each table they were added to, so a plugin's options can go
+// when the plugin is unloaded:
+//
+//   registration_scope scope;
+//   void* handle = dlopen(path, RTLD_NOW);  // Constructors register options.
+//   scope.close();
+//   ...
+//   scope.unregister();
+//   dlclose(handle);
+//
+// The recorded objects must still be alive when the scope is unregistered.
+// Scopes nest: while several are active, the innermost one records. A
+// scope only records registrations made on the thread that created it.
+
+class registration_scope {
+ public:
+  // Start recording registrations.
+  registration_scope();
+  registration_scope(const registration_scope&) = delete;
+  auto operator=(const registration_scope&) -> registration_scope& = delete;
+  // Unregister everything recorded, closing the scope first if needed.
+  ~registration_scope();
+
+  // Stop recording. Only the innermost active scope can be closed.
+  void close();
+  auto isActive() const -> bool { return Active; }
+
+  // Unregister everything recorded so far. The scope keeps recording if it
+  // is still active.
+  void unregister();
+
+  auto getOptions() const -> const std::vector<Option*>& { return Options; }
+  auto getCategories() const -> const std::vector<OptionCategory*>& {
+    return Categories;
+  }
+  auto getSubCommands() const -> const std::vector<SubCommand*>& {
+    return Subs;
+  }
+
+ private:
+  // The registration hooks record into the innermost active scope.
+  friend class Option;
+  friend class OptionCategory;
+  friend class SubCommand;
+  friend class generic_parser_base;
+  friend void AddLiteralOption(Option& O, llvm::StringRef Name);
+
+  // Return the innermost active scope, or null.
+  static auto active() -> registration_scope*;
+
+  registration_scope* Previous = nullptr;
+  bool Active = false;
+  std::vector<Option*> Options;
+  // Names added to the option maps for options without an argument string.
+  std::vector<std::pair<Option*, llvm::StringRef>> LiteralNames;
+  // Values added to the literal tables of parsers.
+  std::vector<std::pair<generic_parser_base*, llvm::StringRef>> LiteralValues;
+  std::vector<OptionCategory*> Categories;
+  std::vector<SubCommand*> Subs;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_REGISTRATION_SCOPE_H
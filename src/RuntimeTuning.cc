@@ -0,0 +1,361 @@
+#include "RuntimeTuning.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "CommandLine.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+
+namespace Commandline {
+
+namespace {
+
+ManagedStatic<std::shared_mutex> runtime_options_mutex;
+
+// Set while this thread holds the runtime options lock exclusively, so that
+// callbacks reading options do not wait for themselves.
+thread_local bool updating_options = false;
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+auto systemError(const llvm::Twine& message) -> llvm::Error {
+  std::error_code ec(errno, std::generic_category());
+  return llvm::createStringError(
+      ec, "runtime tuning: " + message + ": " + ec.message());
+}
+
+// Run one request line and return the reply.
+auto handleRequest(llvm::StringRef line) -> std::string {
+  std::string reply;
+  llvm::raw_string_ostream os(reply);
+  if (line == "dump") {
+    DumpRuntimeOptions(os);
+    os << "ok\n";
+    return reply;
+  }
+  auto [name, value] = line.split('=');
+  if (name.size() == line.size()) {
+    os << "error: expected name=value or dump\n";
+  } else if (llvm::Error error = SetRuntimeOption(name, value)) {
+    os << "error: " << llvm::toString(std::move(error)) << '\n';
+  } else {
+    os << "ok\n";
+  }
+  return reply;
+}
+
+// A connection that makes no progress for this long is closed.
+constexpr std::chrono::seconds idle_timeout(10);
+
+struct Connection {
+  int Fd;
+  // Received text not yet ending in a newline.
+  std::string Pending;
+  // Replies the socket has not taken yet.
+  std::string Unsent;
+  std::chrono::steady_clock::time_point LastActive;
+  // Has the client closed its side?
+  bool ReadClosed = false;
+};
+
+// Queue the replies to the request lines conn has sent so far. Returns false
+// if reading failed.
+auto readRequests(Connection& conn) -> bool {
+  char buffer[1024];
+  ssize_t count = ::read(conn.Fd, buffer, sizeof(buffer));
+  if (count < 0) {
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+  conn.LastActive = std::chrono::steady_clock::now();
+  if (count == 0) {
+    // A final line without a newline still counts.
+    llvm::StringRef line = llvm::StringRef(conn.Pending).trim();
+    if (!line.empty()) {
+      conn.Unsent += handleRequest(line);
+    }
+    conn.ReadClosed = true;
+    return true;
+  }
+  conn.Pending.append(buffer, count);
+  size_t end;
+  while ((end = conn.Pending.find('\n')) != std::string::npos) {
+    llvm::StringRef line =
+        llvm::StringRef(conn.Pending).take_front(end).trim();
+    if (!line.empty()) {
+      conn.Unsent += handleRequest(line);
+    }
+    conn.Pending.erase(0, end + 1);
+  }
+  return true;
+}
+
+// Send as much of the queued replies as the socket takes. Returns false if
+// sending failed.
+auto sendReplies(Connection& conn) -> bool {
+  while (!conn.Unsent.empty()) {
+    ssize_t written =
+        ::send(conn.Fd, conn.Unsent.data(), conn.Unsent.size(), send_flags);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    conn.Unsent.erase(0, written);
+    conn.LastActive = std::chrono::steady_clock::now();
+  }
+  return true;
+}
+
+struct TuningEndpoint {
+  std::mutex Lock;
+  std::thread Thread;
+  std::string SocketPath;
+  int ListenFd = -1;
+  int StopFds[2] = {-1, -1};
+
+  ~TuningEndpoint() { stop(); }
+
+  // Serve every connection from this one thread. Connections do not block,
+  // so a client that stays silent or reads its replies slowly holds up no
+  // one else.
+  void run() {
+    std::vector<Connection> conns;
+    std::vector<pollfd> fds;
+    while (true) {
+      auto now = std::chrono::steady_clock::now();
+      int timeout = -1;
+      fds.assign({{StopFds[0], POLLIN, 0}, {ListenFd, POLLIN, 0}});
+      for (const Connection& conn : conns) {
+        short events = conn.ReadClosed ? 0 : POLLIN;
+        if (!conn.Unsent.empty()) {
+          events |= POLLOUT;
+        }
+        fds.push_back({conn.Fd, events, 0});
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(
+            conn.LastActive + idle_timeout - now);
+        int left_ms = std::max<int>(0, left.count());
+        timeout = timeout < 0 ? left_ms : std::min(timeout, left_ms);
+      }
+      if (::poll(fds.data(), fds.size(), timeout) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      if (fds[0].revents != 0) {
+        break;
+      }
+
+      now = std::chrono::steady_clock::now();
+      size_t kept = 0;
+      for (size_t i = 0, e = conns.size(); i != e; ++i) {
+        Connection& conn = conns[i];
+        bool open;
+        if (fds[i + 2].revents != 0) {
+          open = (conn.ReadClosed || readRequests(conn)) &&
+                 sendReplies(conn) &&
+                 !(conn.ReadClosed && conn.Unsent.empty());
+        } else {
+          open = now - conn.LastActive < idle_timeout;
+        }
+        if (open) {
+          conns[kept++] = std::move(conn);
+        } else {
+          ::close(conn.Fd);
+        }
+      }
+      conns.resize(kept);
+
+      if (fds[1].revents != 0) {
+        int fd = ::accept(ListenFd, nullptr, nullptr);
+        if (fd >= 0) {
+          ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+          Connection conn;
+          conn.Fd = fd;
+          conn.LastActive = now;
+          conns.push_back(std::move(conn));
+        }
+      }
+    }
+    for (const Connection& conn : conns) {
+      ::close(conn.Fd);
+    }
+  }
+
+  void stop() {
+    std::lock_guard<std::mutex> guard(Lock);
+    if (!Thread.joinable()) {
+      return;
+    }
+    char byte = 0;
+    while (::write(StopFds[1], &byte, 1) < 0 && errno == EINTR) {
+    }
+    Thread.join();
+    ::close(ListenFd);
+    ::close(StopFds[0]);
+    ::close(StopFds[1]);
+    ::unlink(SocketPath.c_str());
+    ListenFd = StopFds[0] = StopFds[1] = -1;
+  }
+};
+
+ManagedStatic<TuningEndpoint> tuning_endpoint;
+
+#endif  // _WIN32
+
+}  // namespace
+
+auto RuntimeOptionsMutex() -> std::shared_mutex& {
+  return *runtime_options_mutex;
+}
+
+auto ReadRuntimeOptions() -> std::shared_lock<std::shared_mutex> {
+  if (updating_options) {
+    return std::shared_lock<std::shared_mutex>();
+  }
+  return std::shared_lock<std::shared_mutex>(RuntimeOptionsMutex());
+}
+
+auto SetRuntimeOption(llvm::StringRef name, llvm::StringRef value)
+    -> llvm::Error {
+  // Look the option up under the lock too, so that it is the one updated.
+  std::unique_lock<std::shared_mutex> lock(RuntimeOptionsMutex());
+  Option* option = findRegisteredOption(name);
+  if (!option) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        "unknown option '" + name + "'");
+  }
+  if (!option->isRuntimeMutable()) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::operation_not_permitted),
+        "option '" + name + "' cannot be changed at runtime");
+  }
+
+  std::string diagnostics;
+  llvm::raw_string_ostream os(diagnostics);
+  llvm::raw_ostream* previous = redirectThreadErrors(&os);
+  updating_options = true;
+  bool failed = option->setRuntimeValue(value);
+  updating_options = false;
+  lock.unlock();
+  redirectThreadErrors(previous);
+  if (failed) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        llvm::StringRef(os.str()).trim());
+  }
+  return llvm::Error::success();
+}
+
+void DumpRuntimeOptions(llvm::raw_ostream& os) {
+  std::shared_lock<std::shared_mutex> lock = ReadRuntimeOptions();
+  // The dump reports the values every thread shares.
+  detail::SuspendOverrides suspend;
+  llvm::SmallPtrSet<Option*, 16> seen;
+  std::vector<Option*> options;
+  forEachRegisteredOption([&](llvm::StringRef /*name*/, Option& option) {
+    if (option.isRuntimeMutable() && seen.insert(&option).second) {
+      options.push_back(&option);
+    }
+  });
+  llvm::sort(options, [](const Option* lhs, const Option* rhs) {
+    return lhs->ArgStr < rhs->ArgStr;
+  });
+
+  for (const Option* option : options) {
+    llvm::SmallVector<std::string, 4> texts;
+    if (!option->getValueTexts(texts)) {
+      continue;
+    }
+    for (const std::string& text : texts) {
+      os << option->ArgStr << '=' << text << '\n';
+    }
+  }
+}
+
+#ifndef _WIN32
+
+auto StartRuntimeTuning(llvm::StringRef socket_path) -> llvm::Error {
+  TuningEndpoint& endpoint = *tuning_endpoint;
+  std::lock_guard<std::mutex> guard(endpoint.Lock);
+  if (endpoint.Thread.joinable()) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::device_or_resource_busy),
+        "runtime tuning: already serving '" + endpoint.SocketPath + "'");
+  }
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+    return llvm::createStringError(
+        std::make_error_code(std::errc::invalid_argument),
+        "runtime tuning: bad socket path '" + socket_path + "'");
+  }
+  std::memcpy(addr.sun_path, socket_path.data(), socket_path.size());
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return systemError("cannot create socket");
+  }
+  std::string path = socket_path.str();
+  ::unlink(path.c_str());
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(fd, SOMAXCONN) != 0) {
+    llvm::Error error = systemError("cannot listen on '" + path + "'");
+    ::close(fd);
+    return error;
+  }
+  if (::pipe(endpoint.StopFds) != 0) {
+    llvm::Error error = systemError("cannot create pipe");
+    ::close(fd);
+    ::unlink(path.c_str());
+    return error;
+  }
+
+  endpoint.ListenFd = fd;
+  endpoint.SocketPath = std::move(path);
+  endpoint.Thread = std::thread([&endpoint] { endpoint.run(); });
+  return llvm::Error::success();
+}
+
+void StopRuntimeTuning() { tuning_endpoint->stop(); }
+
+#else  // _WIN32
+
+auto StartRuntimeTuning(llvm::StringRef /*socket_path*/) -> llvm::Error {
+  return llvm::createStringError(
+      std::make_error_code(std::errc::function_not_supported),
+      "runtime tuning: not supported on this platform");
+}
+
+void StopRuntimeTuning() {}
+
+#endif  // _WIN32
+
+}  // namespace Commandline
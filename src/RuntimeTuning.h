@@ -0,0 +1,66 @@
+#ifndef COMMANDLINE_RUNTIME_TUNING_H
+#define COMMANDLINE_RUNTIME_TUNING_H
+
+#include <shared_mutex>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Runtime option tuning.
+//
+// Options declared with the RuntimeMutable modifier may be changed after
+// startup. SetRuntimeOption parses the new value with the option's own parser
+// and assigns it through opt::operator=, so callbacks run. StartRuntimeTuning
+// serves the same operation on a Unix domain socket, one request per line:
+//
+//   name=value   set a top-level option; replies "ok" or "error: <message>"
+//   dump         replies "name=value" for each runtime mutable option, then
+//                "ok"
+//
+// Any number of clients may be connected at once. A connection that neither
+// sends requests nor takes replies for ten seconds is closed.
+//
+// Only opts storing a value that fits an atomic instruction (integers,
+// enums, bool, char, floating point, pointers) in the option itself may be
+// RuntimeMutable. Their values are written and read by value atomically, so
+// a thread may read such an option through its conversion operator or a
+// const reference while updates arrive. A reference obtained from the
+// non-const getValue is read without that protection.
+//
+// Updates hold the runtime options lock exclusively, and callbacks run while
+// it is held. Threads that need several runtime mutable options to be
+// consistent with each other should hold it shared, through
+// ReadRuntimeOptions. Callbacks may call ReadRuntimeOptions too; on the
+// updating thread it does not lock.
+
+// The lock that serializes runtime updates with their readers.
+auto RuntimeOptionsMutex() -> std::shared_mutex&;
+
+// Hold the runtime options lock shared until the returned lock is destroyed.
+auto ReadRuntimeOptions() -> std::shared_lock<std::shared_mutex>;
+
+// Set the top-level option name to value. Fails if the option is unknown, is
+// not RuntimeMutable, or rejects the value; the error carries the parser's
+// diagnostic.
+auto SetRuntimeOption(llvm::StringRef name, llvm::StringRef value)
+    -> llvm::Error;
+
+// Print "name=value" for the current value of each runtime mutable option, in
+// name order.
+void DumpRuntimeOptions(llvm::raw_ostream& os);
+
+// Serve updates on socket_path from a background thread. An existing file at
+// the path is replaced. Only POSIX systems are supported.
+auto StartRuntimeTuning(llvm::StringRef socket_path) -> llvm::Error;
+
+// Stop serving, wait for the thread and remove the socket. Does nothing if
+// the endpoint is not running.
+void StopRuntimeTuning();
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_RUNTIME_TUNING_H
@@ -0,0 +1,178 @@
+#include "StaticOptions.h"
+
+#include "CommandLine.h"
+#include "ValueProvenance.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+
+namespace Commandline {
+
+namespace {
+
+auto toStringRef(std::string_view s) -> llvm::StringRef {
+  return llvm::StringRef(s.data(), s.size());
+}
+
+auto programName(llvm::StringRef argv0) -> llvm::StringRef {
+  return llvm::sys::path::filename(argv0);
+}
+
+}  // namespace
+
+auto reportStaticOptionError(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                             llvm::StringRef name, const llvm::Twine& message)
+    -> bool {
+  errs << programName(argv0) << ": for the ";
+  if (name.empty()) {
+    errs << "positional argument: ";
+  } else {
+    errs << (name.size() > 1 ? "--" : "-") << name << " option: ";
+  }
+  errs << message << "\n";
+  return true;
+}
+
+auto reportUnknownStaticOption(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                               llvm::StringRef arg) -> bool {
+  errs << programName(argv0) << ": Unknown command line argument '" << arg
+       << "'.  Try: '" << argv0 << " --help'\n";
+  return true;
+}
+
+auto reportExtraPositional(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                           llvm::StringRef arg) -> bool {
+  errs << programName(argv0)
+       << ": Too many positional arguments specified! Unexpected '" << arg
+       << "'.  Try: '" << argv0 << " --help'\n";
+  return true;
+}
+
+static_option_proxy::static_option_proxy(const static_option_info& info,
+                                         SubCommand& sub,
+                                         OptionCategory& category, void* owner,
+                                         size_t index, apply_fn apply,
+                                         reset_fn reset)
+    : Option(Optional, NotHidden),
+      Info(info),
+      Printer(*this, toStringRef(info.ValueName)),
+      EnumPrinter(*this, info),
+      Owner(owner),
+      Index(index),
+      Apply(apply),
+      Reset(reset) {
+  switch (info.Kind) {
+    case static_option_kind::Flag:
+    case static_option_kind::Value:
+    case static_option_kind::List:
+      // The schema's own parse lets later occurrences win.
+      setNumOccurrencesFlag(ZeroOrMore);
+      setArgStr(toStringRef(info.Name));
+      break;
+    case static_option_kind::Positional:
+      setFormattingFlag(Positional);
+      break;
+    case static_option_kind::PositionalList:
+      setNumOccurrencesFlag(ZeroOrMore);
+      setFormattingFlag(Positional);
+      break;
+  }
+  setDescription(toStringRef(info.Help));
+  addCategory(category);
+  addSubCommand(sub);
+}
+
+auto static_option_proxy::enum_printer::getOption(unsigned n) const
+    -> llvm::StringRef {
+  return toStringRef(Info.Values[n].Name);
+}
+
+auto static_option_proxy::enum_printer::getDescription(unsigned n) const
+    -> llvm::StringRef {
+  return toStringRef(Info.Values[n].Help);
+}
+
+auto static_option_proxy::enum_printer::getOptionValue(unsigned /*n*/) const
+    -> const GenericOptionValue& {
+  // Only used to print value differences, which proxies do not do.
+  static const OptionValue<int> unset{};
+  return unset;
+}
+
+auto static_option_proxy::handleOccurrence(unsigned /*pos*/,
+                                           llvm::StringRef /*arg_name*/,
+                                           llvm::StringRef arg) -> bool {
+  if (Noting) {
+    return false;
+  }
+  if (const char* invalid = Apply(Owner, Index, arg)) {
+    return error("'" + arg + "' " + invalid);
+  }
+  return false;
+}
+
+auto static_option_proxy::getValueExpectedFlagDefault() const
+    -> enum ValueExpected {
+  return Info.Kind == static_option_kind::Flag ? ValueOptional : ValueRequired;
+}
+
+auto static_option_proxy::getOptionWidth() const -> size_t {
+  return Info.Values ? EnumPrinter.getOptionWidth(*this)
+                     : Printer.getOptionWidth(*this);
+}
+
+void static_option_proxy::printOptionInfo(size_t global_width,
+                                          llvm::raw_ostream& os) const {
+  if (Info.Values) {
+    EnumPrinter.printOptionInfo(*this, global_width, os);
+  } else {
+    Printer.printOptionInfo(*this, global_width, os);
+  }
+}
+
+void static_option_proxy::printOptionValue(size_t global_width, bool force,
+                                           llvm::raw_ostream& os) const {
+  if (force) {
+    Printer.printOptionNoValue(*this, global_width, os);
+  }
+}
+
+void static_option_proxy::setDefault() { Reset(Owner, Index); }
+
+void static_option_proxy::noteOccurrence(unsigned pos) {
+  // The arguments were argv itself, all from the command line.
+  ValueOriginScope origins({});
+  Noting = true;
+  addOccurrence(pos, ArgStr, "");
+  Noting = false;
+}
+
+auto parseStaticOptionsFallback(int argc, const char* const* argv,
+                                llvm::StringRef overview,
+                                llvm::raw_ostream* errs, const char* env_var)
+    -> bool {
+  return ParseCommandLineOptions(argc, argv, overview, errs, env_var);
+}
+
+void activateStaticOptions(SubCommand& sub) { setActiveSubCommand(sub); }
+
+auto canParseStaticOptionsAlone(SubCommand& sub, const char* env_var)
+    -> bool {
+  if (env_var && llvm::sys::Process::GetEnv(env_var)) {
+    return false;
+  }
+  auto needs_value = [](const Option* option) {
+    return option->getNumOccurrencesFlag() == Required ||
+           option->getNumOccurrencesFlag() == OneOrMore;
+  };
+  for (const auto& entry : getRegisteredOptions(sub)) {
+    if (needs_value(entry.second)) {
+      return false;
+    }
+  }
+  return llvm::none_of(sub.PositionalOpts, needs_value) &&
+         llvm::none_of(sub.SinkOpts, needs_value);
+}
+
+}  // namespace Commandline
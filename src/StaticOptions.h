@@ -0,0 +1,750 @@
+#ifndef COMMANDLINE_STATIC_OPTIONS_H
+#define COMMANDLINE_STATIC_OPTIONS_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Option.h"
+#include "OptionCategory.h"
+#include "Parser.h"
+#include "SubCommand.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+//===----------------------------------------------------------------------===//
+// Compile-time option schemas.
+//
+// A tool that only needs a fixed set of options can describe them as a
+// constexpr schema over a plain struct instead of declaring cl::opt globals:
+//
+//   struct Config {
+//     bool Verbose = false;
+//     int Jobs = 1;
+//     std::vector<std::string> Inputs;
+//   };
+//
+//   constexpr auto kOptions = make_static_options<Config>(
+//       static_flag<&Config::Verbose>("verbose", "Print progress"),
+//       static_opt<&Config::Jobs>("j", "Parallel jobs", "N"),
+//       static_positional<&Config::Inputs>("<inputs>"));
+//
+//   Config config;
+//   kOptions.parse(argc, argv, config);
+//
+// The name table is a perfect hash computed by the compiler, values are
+// stored straight into the struct's fields, and the parse loop dispatches on
+// the field index without virtual calls or registration. It accepts -name,
+// --name, -name=value, and -name value for options taking a value; "--" ends
+// option processing. Later occurrences override earlier ones. Grouping,
+// prefix options, response files and -help are left to the generic parser:
+// static_option_binding registers the schema with a SubCommand so that help
+// lists it and ParseCommandLineOptions fills the same struct.
+
+enum class static_option_kind : uint8_t {
+  Flag,            // bool; -name or -name=<bool>
+  Value,           // -name=<value> or -name <value>
+  List,            // Value, appended to a std::vector
+  Positional,      // a single positional argument
+  PositionalList,  // all positional arguments, appended to a std::vector
+};
+
+// A literal accepted by an enum field, as cl::values lists them.
+struct static_enum_value {
+  std::string_view Name;
+  std::string_view Help;
+  int Value;
+};
+
+struct static_option_info {
+  std::string_view Name;
+  std::string_view Help;
+  std::string_view ValueName;
+  static_option_kind Kind;
+  // The literals of an enum field; Values is null for other fields.
+  const static_enum_value* Values = nullptr;
+  size_t NumValues = 0;
+};
+
+// The name hash of compile-time and generated schemas: FNV-1a from a seeded
+// basis, finished with the MurmurHash3 mixer so nearby seeds give unrelated
+// slots.
+constexpr auto hashOptionName(std::string_view name, uint32_t seed)
+    -> uint32_t {
+  uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  return hash ^ (hash >> 16);
+}
+
+//===----------------------------------------------------------------------===//
+// Value conversion for schema fields. Each specialization provides parse,
+// returning true if arg is not a valid value, the ValueName shown in help and
+// the Invalid message reported after the quoted argument. The rules and
+// messages match the corresponding parser<DataType>.
+//
+template <class DataType>
+struct static_value;
+
+template <class DataType>
+struct static_integer_value {
+  static auto parse(llvm::StringRef arg, DataType& value) -> bool {
+    return arg.getAsInteger(0, value);
+  }
+};
+
+template <class DataType>
+struct static_float_value {
+  static auto parse(llvm::StringRef arg, DataType& value) -> bool {
+    double d;
+    if (!llvm::to_float(arg, d)) {
+      return true;
+    }
+    value = static_cast<DataType>(d);
+    return false;
+  }
+  static constexpr const char* ValueName = "number";
+  static constexpr const char* Invalid =
+      "value invalid for floating point argument!";
+};
+
+template <>
+struct static_value<bool> {
+  static auto parse(llvm::StringRef arg, bool& value) -> bool {
+    if (arg == "" || arg == "true" || arg == "TRUE" || arg == "True" ||
+        arg == "1") {
+      value = true;
+      return false;
+    }
+    if (arg == "false" || arg == "FALSE" || arg == "False" || arg == "0") {
+      value = false;
+      return false;
+    }
+    return true;
+  }
+  static constexpr const char* ValueName = "";
+  static constexpr const char* Invalid =
+      "is invalid value for boolean argument! Try 0 or 1";
+};
+
+template <>
+struct static_value<int> : static_integer_value<int> {
+  static constexpr const char* ValueName = "int";
+  static constexpr const char* Invalid = "value invalid for integer argument!";
+};
+
+template <>
+struct static_value<long> : static_integer_value<long> {
+  static constexpr const char* ValueName = "long";
+  static constexpr const char* Invalid = "value invalid for long argument!";
+};
+
+template <>
+struct static_value<long long> : static_integer_value<long long> {
+  static constexpr const char* ValueName = "long";
+  static constexpr const char* Invalid = "value invalid for llong argument!";
+};
+
+template <>
+struct static_value<unsigned> : static_integer_value<unsigned> {
+  static constexpr const char* ValueName = "uint";
+  static constexpr const char* Invalid = "value invalid for uint argument!";
+};
+
+template <>
+struct static_value<unsigned long> : static_integer_value<unsigned long> {
+  static constexpr const char* ValueName = "ulong";
+  static constexpr const char* Invalid = "value invalid for ulong argument!";
+};
+
+template <>
+struct static_value<unsigned long long>
+    : static_integer_value<unsigned long long> {
+  static constexpr const char* ValueName = "ulong";
+  static constexpr const char* Invalid = "value invalid for ullong argument!";
+};
+
+template <>
+struct static_value<double> : static_float_value<double> {};
+
+template <>
+struct static_value<float> : static_float_value<float> {};
+
+template <>
+struct static_value<std::string> {
+  static auto parse(llvm::StringRef arg, std::string& value) -> bool {
+    value.assign(arg.data(), arg.size());
+    return false;
+  }
+  static constexpr const char* ValueName = "string";
+  static constexpr const char* Invalid = "";
+};
+
+// Store arg into field, appending if it is a std::vector. Return nullptr on
+// success, or the message describing why arg is invalid.
+template <class DataType>
+auto applyStaticValue(llvm::StringRef arg, DataType& field) -> const char* {
+  using value = static_value<DataType>;
+  return value::parse(arg, field) ? value::Invalid : nullptr;
+}
+
+template <class DataType, class Alloc>
+auto applyStaticValue(llvm::StringRef arg, std::vector<DataType, Alloc>& field)
+    -> const char* {
+  DataType element{};
+  if (const char* invalid = applyStaticValue(arg, element)) {
+    return invalid;
+  }
+  field.push_back(std::move(element));
+  return nullptr;
+}
+
+// As applyStaticValue, for an enum field taking the literals values.
+template <class EnumType>
+auto applyStaticEnum(llvm::StringRef arg, const static_enum_value* values,
+                     size_t num_values, EnumType& field) -> const char* {
+  for (size_t i = 0; i < num_values; ++i) {
+    if (arg == llvm::StringRef(values[i].Name.data(), values[i].Name.size())) {
+      field = static_cast<EnumType>(values[i].Value);
+      return nullptr;
+    }
+  }
+  return "value invalid for enum argument!";
+}
+
+template <class EnumType, class Alloc>
+auto applyStaticEnum(llvm::StringRef arg, const static_enum_value* values,
+                     size_t num_values, std::vector<EnumType, Alloc>& field)
+    -> const char* {
+  EnumType element{};
+  if (const char* invalid = applyStaticEnum(arg, values, num_values, element)) {
+    return invalid;
+  }
+  field.push_back(element);
+  return nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// Field descriptors, created by static_flag, static_opt, static_list and
+// static_positional below.
+//
+template <class MemberPtr>
+struct static_member_traits;
+
+template <class Config, class DataType>
+struct static_member_traits<DataType Config::*> {
+  using config_type = Config;
+  using value_type = DataType;
+  using element_type = DataType;
+  static constexpr bool IsVector = false;
+};
+
+template <class Config, class DataType, class Alloc>
+struct static_member_traits<std::vector<DataType, Alloc> Config::*> {
+  using config_type = Config;
+  using value_type = std::vector<DataType, Alloc>;
+  using element_type = DataType;
+  static constexpr bool IsVector = true;
+};
+
+template <auto Member>
+struct static_option_field {
+  using traits = static_member_traits<decltype(Member)>;
+  using config_type = typename traits::config_type;
+  using element_type = typename traits::element_type;
+
+  static_option_info Info;
+
+  static auto apply(config_type& values, llvm::StringRef arg) -> const char* {
+    return applyStaticValue(arg, values.*Member);
+  }
+
+  static void reset(config_type& values, const config_type& defaults) {
+    values.*Member = defaults.*Member;
+  }
+};
+
+// A bool field set by -name, or by -name=<bool>.
+template <auto Member>
+constexpr auto static_flag(std::string_view name, std::string_view help)
+    -> static_option_field<Member> {
+  using traits = static_member_traits<decltype(Member)>;
+  static_assert(std::is_same_v<typename traits::value_type, bool>,
+                "static_flag requires a bool field");
+  return {{name, help, "", static_option_kind::Flag}};
+}
+
+// A field set by -name=<value> or -name <value>. value_name replaces the
+// type's name in help, as cl::value_desc does.
+template <auto Member>
+constexpr auto static_opt(std::string_view name, std::string_view help,
+                          std::string_view value_name = {})
+    -> static_option_field<Member> {
+  using traits = static_member_traits<decltype(Member)>;
+  static_assert(!traits::IsVector, "use static_list for vector fields");
+  if (value_name.empty()) {
+    value_name = static_value<typename traits::value_type>::ValueName;
+  }
+  return {{name, help, value_name, static_option_kind::Value}};
+}
+
+// A std::vector field each occurrence of -name appends to.
+template <auto Member>
+constexpr auto static_list(std::string_view name, std::string_view help,
+                           std::string_view value_name = {})
+    -> static_option_field<Member> {
+  using traits = static_member_traits<decltype(Member)>;
+  static_assert(traits::IsVector, "static_list requires a std::vector field");
+  if (value_name.empty()) {
+    value_name = static_value<typename traits::element_type>::ValueName;
+  }
+  return {{name, help, value_name, static_option_kind::List}};
+}
+
+// The field receiving positional arguments: every one of them if it is a
+// std::vector, otherwise at most one. help is shown in the usage line, e.g.
+// "<input files>".
+template <auto Member>
+constexpr auto static_positional(std::string_view help)
+    -> static_option_field<Member> {
+  using traits = static_member_traits<decltype(Member)>;
+  return {{"", help, "",
+           traits::IsVector ? static_option_kind::PositionalList
+                            : static_option_kind::Positional}};
+}
+
+// Report errors of static_options::parse in the generic parser's format.
+// Always return true.
+auto reportStaticOptionError(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                             llvm::StringRef name, const llvm::Twine& message)
+    -> bool;
+auto reportUnknownStaticOption(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                               llvm::StringRef arg) -> bool;
+auto reportExtraPositional(llvm::raw_ostream& errs, llvm::StringRef argv0,
+                           llvm::StringRef arg) -> bool;
+
+// The parse loop of static_options and generated_options: parse
+// argv[first_arg] to argv[argc - 1] into values with schema's lookup and
+// apply. Errors are printed to errs, after which parsing continues with the
+// next argument. Return false if there were errors. on_apply(index, arg_index)
+// is called for each value stored, with the index of its argument in argv.
+template <class Schema, class OnApply>
+auto parseStaticArguments(const Schema& schema, int argc,
+                          const char* const* argv,
+                          typename Schema::config_type& values,
+                          llvm::raw_ostream& errs, int first_arg,
+                          OnApply on_apply) -> bool {
+  llvm::StringRef argv0 = argc > 0 ? argv[0] : "";
+  int positional = schema.getPositionalIndex();
+  bool failed = false;
+  bool dash_dash = false;
+  bool seen_positional = false;
+  for (int i = first_arg; i < argc; ++i) {
+    llvm::StringRef arg(argv[i]);
+    if (dash_dash || arg.size() < 2 || arg[0] != '-') {
+      if (positional < 0 ||
+          (seen_positional && schema.getInfo(positional).Kind ==
+                                  static_option_kind::Positional)) {
+        failed |= reportExtraPositional(errs, argv0, arg);
+        continue;
+      }
+      seen_positional = true;
+      if (const char* invalid = schema.apply(positional, values, arg)) {
+        failed |= reportStaticOptionError(errs, argv0, "",
+                                          "'" + arg + "' " + invalid);
+      } else {
+        on_apply(static_cast<size_t>(positional), i);
+      }
+      continue;
+    }
+    if (arg == "--") {
+      dash_dash = true;
+      continue;
+    }
+
+    llvm::StringRef name = arg.drop_front(arg[1] == '-' ? 2 : 1);
+    llvm::StringRef value;
+    size_t equal = name.find('=');
+    if (equal != llvm::StringRef::npos) {
+      value = name.substr(equal + 1);
+      name = name.substr(0, equal);
+    }
+    int index = schema.lookup(std::string_view(name.data(), name.size()));
+    if (index < 0) {
+      failed |= reportUnknownStaticOption(errs, argv0, arg);
+      continue;
+    }
+    if (equal == llvm::StringRef::npos &&
+        schema.getInfo(index).Kind != static_option_kind::Flag) {
+      if (i + 1 == argc) {
+        failed |=
+            reportStaticOptionError(errs, argv0, name, "requires a value!");
+        continue;
+      }
+      value = argv[++i];
+    }
+    if (const char* invalid = schema.apply(index, values, value)) {
+      failed |= reportStaticOptionError(errs, argv0, name,
+                                        "'" + value + "' " + invalid);
+    } else {
+      on_apply(static_cast<size_t>(index), i);
+    }
+  }
+  return !failed;
+}
+
+template <class Schema>
+auto parseStaticArguments(const Schema& schema, int argc,
+                          const char* const* argv,
+                          typename Schema::config_type& values,
+                          llvm::raw_ostream& errs, int first_arg) -> bool {
+  return parseStaticArguments(schema, argc, argv, values, errs, first_arg,
+                              [](size_t /*index*/, int /*arg_index*/) {});
+}
+
+//===----------------------------------------------------------------------===//
+// A schema of Fields over the struct Config. Build one with
+// make_static_options.
+//
+template <class Config, class... Fields>
+class static_options {
+  static_assert(
+      (std::is_same_v<typename Fields::config_type, Config> && ...),
+      "every field must be a member of the schema's config struct");
+
+ public:
+  using config_type = Config;
+  static constexpr size_t NumFields = sizeof...(Fields);
+
+ private:
+  static constexpr uint16_t EmptySlot = 0xffff;
+  static_assert(NumFields < EmptySlot, "too many fields");
+
+  static constexpr auto getTableSize() -> size_t {
+    // Eight slots per name make a collision free seed easy to find.
+    size_t size = 8;
+    while (size < NumFields * 8) {
+      size *= 2;
+    }
+    return size;
+  }
+  static constexpr size_t TableSize = getTableSize();
+  static constexpr uint32_t MaxSeeds = 256;
+
+  std::array<static_option_info, NumFields> Infos;
+  std::array<uint16_t, TableSize> Table{};
+  uint32_t Seed = 0;
+  bool Perfect = false;
+  int PositionalIndex = -1;
+
+  // Fill Table for seed. Without probing, fail on the first collision.
+  constexpr auto fillTable(uint32_t seed, bool probe) -> bool {
+    for (uint16_t& slot : Table) {
+      slot = EmptySlot;
+    }
+    for (size_t i = 0; i < NumFields; ++i) {
+      if (Infos[i].Name.empty()) {
+        continue;
+      }
+      size_t slot = hashOptionName(Infos[i].Name, seed) & (TableSize - 1);
+      while (Table[slot] != EmptySlot) {
+        assert(Infos[Table[slot]].Name != Infos[i].Name &&
+               "option name used twice in a schema");
+        if (!probe) {
+          return false;
+        }
+        slot = (slot + 1) & (TableSize - 1);
+      }
+      Table[slot] = static_cast<uint16_t>(i);
+    }
+    return true;
+  }
+
+  template <size_t... I>
+  auto applyField(std::index_sequence<I...> /*unused*/, size_t index,
+                  Config& values, llvm::StringRef arg) const -> const char* {
+    const char* invalid = nullptr;
+    (void)((index == I ? (invalid = Fields::apply(values, arg), true)
+                       : false) ||
+           ...);
+    return invalid;
+  }
+
+  template <size_t... I>
+  void resetField(std::index_sequence<I...> /*unused*/, size_t index,
+                  Config& values, const Config& defaults) const {
+    (void)((index == I ? (Fields::reset(values, defaults), true) : false) ||
+           ...);
+  }
+
+ public:
+  constexpr explicit static_options(Fields... fields)
+      : Infos{fields.Info...} {
+    for (size_t i = 0; i < NumFields; ++i) {
+      if (Infos[i].Kind == static_option_kind::Positional ||
+          Infos[i].Kind == static_option_kind::PositionalList) {
+        assert(PositionalIndex < 0 && "more than one positional field");
+        PositionalIndex = static_cast<int>(i);
+      }
+    }
+    for (uint32_t seed = 0; seed < MaxSeeds && !Perfect; ++seed) {
+      Seed = seed;
+      Perfect = fillTable(seed, /*probe=*/false);
+    }
+    if (!Perfect) {
+      Seed = 0;
+      fillTable(Seed, /*probe=*/true);
+    }
+  }
+
+  // Return the index of the field named name, or -1.
+  constexpr auto lookup(std::string_view name) const -> int {
+    for (size_t slot = hashOptionName(name, Seed) & (TableSize - 1);;
+         slot = (slot + 1) & (TableSize - 1)) {
+      uint16_t index = Table[slot];
+      if (index == EmptySlot) {
+        return -1;
+      }
+      if (Infos[index].Name == name) {
+        return index;
+      }
+    }
+  }
+
+  // True if every name hashes to its own slot, so lookup makes one probe.
+  constexpr auto isPerfectHash() const -> bool { return Perfect; }
+
+  constexpr auto getInfo(size_t index) const -> const static_option_info& {
+    return Infos[index];
+  }
+
+  // Parse value as the field at index and store it into values. Return
+  // nullptr on success, or the message describing why value is invalid.
+  auto apply(size_t index, Config& values, llvm::StringRef value) const
+      -> const char* {
+    return applyField(std::index_sequence_for<Fields...>(), index, values,
+                      value);
+  }
+
+  // Copy the field at index from defaults into values.
+  void reset(size_t index, Config& values, const Config& defaults) const {
+    resetField(std::index_sequence_for<Fields...>(), index, values, defaults);
+  }
+
+  constexpr auto size() const -> size_t { return NumFields; }
+
+  // Return the index of the positional field, or -1.
+  constexpr auto getPositionalIndex() const -> int { return PositionalIndex; }
+
+  // Parse argv[first_arg] to argv[argc - 1] into values. Errors are printed
+  // to errs, after which parsing continues with the next argument. Return
+  // false if there were errors.
+  auto parse(int argc, const char* const* argv, Config& values,
+             llvm::raw_ostream& errs = llvm::errs(), int first_arg = 1) const
+      -> bool {
+    return parseStaticArguments(*this, argc, argv, values, errs, first_arg);
+  }
+};
+
+template <class Config, class... Fields>
+constexpr auto make_static_options(Fields... fields)
+    -> static_options<Config, Fields...> {
+  return static_options<Config, Fields...>(fields...);
+}
+
+//===----------------------------------------------------------------------===//
+// The Option standing for one schema field in the generic machinery. It
+// forwards occurrences to the schema and prints help like basic_parser, or
+// like the parser of a cl::values option for enum fields.
+//
+class static_option_proxy final : public Option {
+ public:
+  // Store arg into field index of owner; return nullptr or the message
+  // describing why arg is invalid.
+  using apply_fn = const char* (*)(void* owner, size_t index,
+                                   llvm::StringRef arg);
+  // Restore field index of owner to its default.
+  using reset_fn = void (*)(void* owner, size_t index);
+
+  // The proxy is not registered; see Option::addArguments.
+  static_option_proxy(const static_option_info& info, SubCommand& sub,
+                      OptionCategory& category, void* owner, size_t index,
+                      apply_fn apply, reset_fn reset);
+
+  auto getGenericParser() const -> const generic_parser_base* override {
+    return Info.Values ? &EnumPrinter : nullptr;
+  }
+
+  // Count an occurrence at argv[pos] whose value the schema already stored,
+  // as addOccurrence would: the origin, NumOccurrences and ValueTouched.
+  void noteOccurrence(unsigned pos);
+
+ private:
+  class value_printer final : public basic_parser_impl {
+   public:
+    value_printer(Option& o, llvm::StringRef value_name)
+        : basic_parser_impl(o), ValueName(value_name) {}
+    auto getValueName() const -> llvm::StringRef override { return ValueName; }
+
+   private:
+    llvm::StringRef ValueName;
+  };
+
+  class enum_printer final : public generic_parser_base {
+   public:
+    enum_printer(Option& o, const static_option_info& info)
+        : generic_parser_base(o), Info(info) {}
+    auto getNumOptions() const -> unsigned override {
+      return static_cast<unsigned>(Info.NumValues);
+    }
+    auto getOption(unsigned n) const -> llvm::StringRef override;
+    auto getDescription(unsigned n) const -> llvm::StringRef override;
+    auto getOptionValue(unsigned n) const
+        -> const GenericOptionValue& override;
+
+   private:
+    const static_option_info& Info;
+  };
+
+  auto handleOccurrence(unsigned pos, llvm::StringRef arg_name,
+                        llvm::StringRef arg) -> bool override;
+  auto getValueExpectedFlagDefault() const -> enum ValueExpected override;
+  auto getOptionWidth() const -> size_t override;
+  void printOptionInfo(size_t global_width,
+                       llvm::raw_ostream& os) const override;
+  void printOptionValue(size_t global_width, bool force,
+                        llvm::raw_ostream& os) const override;
+  void setDefault() override;
+
+  const static_option_info& Info;
+  value_printer Printer;
+  enum_printer EnumPrinter;
+  void* Owner;
+  size_t Index;
+  apply_fn Apply;
+  reset_fn Reset;
+  // Set while noteOccurrence runs addOccurrence for a stored value.
+  bool Noting = false;
+};
+
+// Run ParseCommandLineOptions and setActiveSubCommand for
+// static_option_binding, which cannot include CommandLine.h.
+auto parseStaticOptionsFallback(int argc, const char* const* argv,
+                                llvm::StringRef overview,
+                                llvm::raw_ostream* errs, const char* env_var)
+    -> bool;
+void activateStaticOptions(SubCommand& sub);
+
+// True if a schema parse alone may stand in for ParseCommandLineOptions on
+// sub: no option registered with sub is Required or OneOrMore, so nothing is
+// left to validate, and env_var is null or unset.
+auto canParseStaticOptionsAlone(SubCommand& sub, const char* env_var) -> bool;
+
+//===----------------------------------------------------------------------===//
+// Registers the fields of a schema (static_options or generated_options) with
+// sub for the lifetime of the binding, storing into values. -help lists them,
+// ParseCommandLineOptions parses them alongside cl::opt options, and
+// ResetAllOptionOccurrences restores the values the fields had when the
+// binding was made. All fields are registered in a single
+// Option::addArguments call.
+//
+template <class Schema>
+class static_option_binding {
+ public:
+  using config_type = typename Schema::config_type;
+
+  static_option_binding(const Schema& schema, config_type& values,
+                        SubCommand& sub = SubCommand::getTopLevel(),
+                        OptionCategory& category = getGeneralCategory())
+      : TheSchema(schema), Values(values), Defaults(values), Sub(sub) {
+    llvm::SmallVector<Option*, 0> options;
+    options.reserve(schema.size());
+    for (size_t i = 0; i < schema.size(); ++i) {
+      Proxies.emplace_back(schema.getInfo(i), sub, category, this, i, &apply,
+                           &reset);
+      options.push_back(&Proxies.back());
+    }
+    Option::addArguments(options);
+  }
+
+  static_option_binding(const static_option_binding&) = delete;
+  auto operator=(const static_option_binding&)
+      -> static_option_binding& = delete;
+
+  ~static_option_binding() {
+    for (static_option_proxy& proxy : Proxies) {
+      proxy.removeArgument();
+    }
+  }
+
+  // Parse with the schema alone and fall back to ParseCommandLineOptions,
+  // starting again from the defaults, if that fails: for arguments naming
+  // other options, -help, response files and malformed command lines. Only
+  // the generic parse prints errors; overview, errs and env_var are passed to
+  // it. The schema parse is skipped when canParseStaticOptionsAlone says the
+  // generic parse has more to do. Either way the fields' options count their
+  // occurrences and record their origins.
+  auto parse(int argc, const char* const* argv, llvm::StringRef overview = "",
+             llvm::raw_ostream* errs = nullptr, const char* env_var = nullptr)
+      -> bool {
+    int first_arg = 1;
+    bool top_level = &Sub == &SubCommand::getTopLevel();
+    if ((top_level ||
+         (argc > 1 && llvm::StringRef(argv[1]) == Sub.getName())) &&
+        canParseStaticOptionsAlone(Sub, env_var)) {
+      first_arg = top_level ? 1 : 2;
+      llvm::SmallVector<std::pair<size_t, int>, 8> occurrences;
+      if (parseStaticArguments(TheSchema, argc, argv, Values, llvm::nulls(),
+                               first_arg, [&](size_t index, int arg_index) {
+                                 occurrences.emplace_back(index, arg_index);
+                               })) {
+        for (auto [index, arg_index] : occurrences) {
+          Proxies[index].noteOccurrence(static_cast<unsigned>(arg_index));
+        }
+        activateStaticOptions(Sub);
+        return true;
+      }
+    }
+    Values = Defaults;
+    return parseStaticOptionsFallback(argc, argv, overview, errs, env_var);
+  }
+
+ private:
+  static auto apply(void* owner, size_t index, llvm::StringRef arg)
+      -> const char* {
+    auto* self = static_cast<static_option_binding*>(owner);
+    return self->TheSchema.apply(index, self->Values, arg);
+  }
+
+  static void reset(void* owner, size_t index) {
+    auto* self = static_cast<static_option_binding*>(owner);
+    self->TheSchema.reset(index, self->Values, self->Defaults);
+  }
+
+  const Schema& TheSchema;
+  config_type& Values;
+  config_type Defaults;
+  SubCommand& Sub;
+  std::deque<static_option_proxy> Proxies;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_STATIC_OPTIONS_H
@@ -0,0 +1,209 @@
+#include "ValueProvenance.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "ManagedStatic.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+
+namespace Commandline {
+
+namespace {
+
+struct ValueSource {
+  ValueSourceKind Kind;
+  std::string Name;
+};
+
+constexpr uint32_t no_next_occurrence = UINT32_MAX;
+
+struct OccurrenceOrigin {
+  ValueOrigin Origin;
+  // Index of the same option's next occurrence, or no_next_occurrence.
+  uint32_t Next;
+};
+
+// The first and last occurrences of an option.
+struct OriginChain {
+  uint32_t First;
+  uint32_t Last;
+};
+
+struct ProvenanceTable {
+  ProvenanceTable() {
+    add(ValueSourceKind::CommandLine, "argv");
+    growOccurrences();
+  }
+
+  auto add(ValueSourceKind kind, llvm::StringRef name) -> uint32_t {
+    // Kinds share the name space, so the key is prefixed with the kind.
+    llvm::SmallString<128> key;
+    key.push_back(static_cast<char>('0' + static_cast<int>(kind)));
+    key.append(name);
+    auto [it, inserted] =
+        Ids.try_emplace(key, static_cast<uint32_t>(Sources.size()));
+    if (inserted) {
+      Sources.push_back({kind, name.str()});
+    }
+    return it->second;
+  }
+
+  void record(const Option& option, ValueOrigin origin) {
+    if (NumOccurrences == OccurrenceCapacity) {
+      growOccurrences();
+    }
+    auto index = static_cast<uint32_t>(NumOccurrences++);
+    Occurrences[index] = {origin, no_next_occurrence};
+    auto [it, inserted] =
+        ByOption.try_emplace(&option, OriginChain{index, index});
+    if (!inserted) {
+      Occurrences[it->second.Last].Next = index;
+      it->second.Last = index;
+    }
+  }
+
+  // Call fn with each origin of option, in order, until it returns false.
+  template <class Fn>
+  void forEachOrigin(const Option& option, Fn fn) const {
+    auto it = ByOption.find(&option);
+    if (it == ByOption.end()) {
+      return;
+    }
+    for (uint32_t index = it->second.First; index != no_next_occurrence;
+         index = Occurrences[index].Next) {
+      if (!fn(Occurrences[index].Origin)) {
+        return;
+      }
+    }
+  }
+
+  void growOccurrences() {
+    // Typical command lines fit in the first allocation.
+    size_t capacity = std::max<size_t>(64, OccurrenceCapacity * 2);
+    auto grown = std::make_unique<OccurrenceOrigin[]>(capacity);
+    std::copy_n(Occurrences.get(), NumOccurrences, grown.get());
+    Occurrences = std::move(grown);
+    OccurrenceCapacity = capacity;
+  }
+
+  std::vector<ValueSource> Sources;
+  llvm::StringMap<uint32_t> Ids;
+  // One entry per occurrence, in the order they were recorded. Recording is
+  // on the parse's hot path, so this is a bare array rather than a vector.
+  // Entries of forgotten options stay until the table is cleared.
+  std::unique_ptr<OccurrenceOrigin[]> Occurrences;
+  size_t NumOccurrences = 0;
+  size_t OccurrenceCapacity = 0;
+  // The occurrences of each option, chained through OccurrenceOrigin::Next.
+  llvm::DenseMap<const Option*, OriginChain> ByOption;
+  // The origins of the arguments being parsed, indexed like argv. Empty if
+  // they all come from the command line.
+  llvm::ArrayRef<ValueOrigin> Arguments;
+  bool Parsing = false;
+};
+
+ManagedStatic<ProvenanceTable> provenance;
+
+}  // namespace
+
+auto AddValueSource(ValueSourceKind kind, llvm::StringRef name) -> uint32_t {
+  return provenance->add(kind, name);
+}
+
+auto GetValueSourceKind(uint32_t source) -> ValueSourceKind {
+  return provenance->Sources[source].Kind;
+}
+
+auto GetValueSourceName(uint32_t source) -> llvm::StringRef {
+  return provenance->Sources[source].Name;
+}
+
+auto GetValueOrigins(const Option& option)
+    -> llvm::SmallVector<ValueOrigin, 1> {
+  llvm::SmallVector<ValueOrigin, 1> origins;
+  provenance->forEachOrigin(option, [&](ValueOrigin origin) {
+    origins.push_back(origin);
+    return true;
+  });
+  return origins;
+}
+
+auto GetValueOrigin(const Option& option, unsigned occurrence)
+    -> std::optional<ValueOrigin> {
+  std::optional<ValueOrigin> found;
+  provenance->forEachOrigin(option, [&](ValueOrigin origin) {
+    if (occurrence-- != 0) {
+      return true;
+    }
+    found = origin;
+    return false;
+  });
+  return found;
+}
+
+auto DescribeValueOrigin(ValueOrigin origin) -> std::string {
+  const ProvenanceTable& table = *provenance;
+  if (origin.Source >= table.Sources.size()) {
+    return "unknown source";
+  }
+  const ValueSource& source = table.Sources[origin.Source];
+  switch (source.Kind) {
+    case ValueSourceKind::CommandLine:
+      return "argv[" + std::to_string(origin.Offset) + "]";
+    case ValueSourceKind::Environment:
+      return "$" + source.Name;
+    case ValueSourceKind::File:
+      return source.Name + ":" + std::to_string(origin.Offset);
+  }
+  return source.Name;
+}
+
+void PrintValueOrigins(const Option& option, llvm::raw_ostream& os) {
+  llvm::SmallVector<ValueOrigin, 1> origins = GetValueOrigins(option);
+  if (origins.empty()) {
+    return;
+  }
+  os << "from ";
+  llvm::interleaveComma(origins, os, [&](ValueOrigin origin) {
+    os << DescribeValueOrigin(origin);
+  });
+}
+
+void RecordValueOrigin(const Option& option, unsigned arg_index) {
+  ProvenanceTable& table = *provenance;
+  ValueOrigin origin{unknown_value_source, arg_index};
+  if (table.Arguments.empty()) {
+    if (table.Parsing) {
+      origin.Source = command_line_source;
+    }
+  } else if (arg_index < table.Arguments.size()) {
+    origin = table.Arguments[arg_index];
+  }
+  table.record(option, origin);
+}
+
+void ForgetValueOrigins(const Option& option) {
+  provenance->ByOption.erase(&option);
+}
+
+void ClearValueOrigins() {
+  provenance->NumOccurrences = 0;
+  provenance->ByOption.clear();
+}
+
+ValueOriginScope::ValueOriginScope(llvm::ArrayRef<ValueOrigin> origins)
+    : Saved(provenance->Arguments), SavedParsing(provenance->Parsing) {
+  provenance->Arguments = origins;
+  provenance->Parsing = true;
+}
+
+ValueOriginScope::~ValueOriginScope() {
+  provenance->Arguments = Saved;
+  provenance->Parsing = SavedParsing;
+}
+
+}  // namespace Commandline
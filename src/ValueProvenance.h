@@ -0,0 +1,94 @@
+#ifndef COMMANDLINE_VALUE_PROVENANCE_H
+#define COMMANDLINE_VALUE_PROVENANCE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+class Option;
+
+//===----------------------------------------------------------------------===//
+// Value provenance.
+//
+// Every occurrence of an option seen by ParseCommandLineOptions records where
+// its argument came from: the command line, the environment variable named by
+// EnvVar, or a line of a response or config file. An origin is a source ID
+// and an offset into that source. The origins live in a side table indexed
+// by option, so options carry no extra state. Resetting or unregistering an
+// option discards its origins.
+//
+// Sources are registered once per name and never removed. Recording is not
+// synchronized, like the rest of parsing.
+
+enum class ValueSourceKind : uint8_t {
+  CommandLine,  // Offset is the index in argv.
+  Environment,  // Offset is the 1-based index of the word in the variable.
+  File,         // Offset is the 1-based line of a response or config file.
+};
+
+struct ValueOrigin {
+  uint32_t Source = 0;
+  uint32_t Offset = 0;
+};
+
+// The source of arguments given in argv, always registered.
+constexpr uint32_t command_line_source = 0;
+
+// The source of occurrences added outside ParseCommandLineOptions.
+constexpr uint32_t unknown_value_source = UINT32_MAX;
+
+// Return the ID of the source of kind named name, registering it if needed.
+auto AddValueSource(ValueSourceKind kind, llvm::StringRef name) -> uint32_t;
+
+auto GetValueSourceKind(uint32_t source) -> ValueSourceKind;
+auto GetValueSourceName(uint32_t source) -> llvm::StringRef;
+
+// Return the origin of each occurrence of option, in the order they were
+// seen. For an option holding a single value the last one set it.
+auto GetValueOrigins(const Option& option) -> llvm::SmallVector<ValueOrigin, 1>;
+
+// Return the origin of the given occurrence of option, if it was recorded.
+auto GetValueOrigin(const Option& option, unsigned occurrence)
+    -> std::optional<ValueOrigin>;
+
+// Describe origin for people: "argv[3]", "$TOOL_OPTS" or
+// "/etc/tool.cfg:42".
+auto DescribeValueOrigin(ValueOrigin origin) -> std::string;
+
+// Print "from " and the description of each origin of option, comma
+// separated. Prints nothing if none were recorded.
+void PrintValueOrigins(const Option& option, llvm::raw_ostream& os);
+
+// Record that option occurred at index arg_index of the arguments being
+// parsed. Called by Option::addOccurrence.
+void RecordValueOrigin(const Option& option, unsigned arg_index);
+
+// Discard the origins of option, or of every option.
+void ForgetValueOrigins(const Option& option);
+void ClearValueOrigins();
+
+// Makes origins the origins of the arguments being parsed, indexed like
+// argv, for its lifetime. Empty origins mean every argument came from the
+// command line.
+class ValueOriginScope {
+ public:
+  explicit ValueOriginScope(llvm::ArrayRef<ValueOrigin> origins);
+  ~ValueOriginScope();
+  ValueOriginScope(const ValueOriginScope&) = delete;
+  auto operator=(const ValueOriginScope&) -> ValueOriginScope& = delete;
+
+ private:
+  llvm::ArrayRef<ValueOrigin> Saved;
+  bool SavedParsing;
+};
+
+}  // namespace Commandline
+
+#endif  // COMMANDLINE_VALUE_PROVENANCE_H
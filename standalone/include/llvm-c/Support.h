@@ -0,0 +1,16 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_C_SUPPORT_H
+#define COMMANDLINE_STANDALONE_LLVM_C_SUPPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parse the command line options registered with the library.
+void LLVMParseCommandLineOptions(int argc, const char* const* argv,
+                                 const char* Overview);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_C_SUPPORT_H
@@ -0,0 +1,136 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_ARRAYREF_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_ARRAYREF_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+
+// A constant reference to an array of T, as in LLVM's ADT.
+template <typename T>
+class ArrayRef {
+ public:
+  using value_type = T;
+  using iterator = const T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using size_type = size_t;
+
+  ArrayRef() = default;
+  ArrayRef(std::nullopt_t) {}
+  ArrayRef(const T& element) : Data(&element), Length(1) {}
+  constexpr ArrayRef(const T* data, size_t length)
+      : Data(data), Length(length) {}
+  ArrayRef(const T* first, const T* last) : Data(first), Length(last - first) {}
+  ArrayRef(const SmallVectorImpl<T>& vector)
+      : Data(vector.data()), Length(vector.size()) {}
+  template <typename A>
+  ArrayRef(const std::vector<T, A>& vector)
+      : Data(vector.data()), Length(vector.size()) {}
+  template <size_t N>
+  constexpr ArrayRef(const std::array<T, N>& array)
+      : Data(array.data()), Length(N) {}
+  template <size_t N>
+  constexpr ArrayRef(const T (&array)[N]) : Data(array), Length(N) {}
+  constexpr ArrayRef(const std::initializer_list<T>& list)
+      : Data(list.begin() == list.end() ? nullptr : list.begin()),
+        Length(list.size()) {}
+  // Allow ArrayRef<const T*> from ArrayRef<T*>.
+  template <typename U>
+  ArrayRef(const ArrayRef<U*>& other,
+           std::enable_if_t<std::is_convertible_v<U* const*, T const*>>* =
+               nullptr)
+      : Data(other.data()), Length(other.size()) {}
+
+  auto begin() const -> iterator { return Data; }
+  auto end() const -> iterator { return Data + Length; }
+  auto rbegin() const -> reverse_iterator { return reverse_iterator(end()); }
+  auto rend() const -> reverse_iterator { return reverse_iterator(begin()); }
+  auto empty() const -> bool { return Length == 0; }
+  auto data() const -> const T* { return Data; }
+  auto size() const -> size_t { return Length; }
+  auto front() const -> const T& { return Data[0]; }
+  auto back() const -> const T& { return Data[Length - 1]; }
+  auto operator[](size_t index) const -> const T& { return Data[index]; }
+
+  auto equals(ArrayRef rhs) const -> bool {
+    return Length == rhs.Length && std::equal(begin(), end(), rhs.begin());
+  }
+  auto slice(size_t start, size_t n) const -> ArrayRef {
+    return ArrayRef(Data + start, n);
+  }
+  auto slice(size_t start) const -> ArrayRef {
+    return slice(start, Length - start);
+  }
+  auto drop_front(size_t n = 1) const -> ArrayRef { return slice(n); }
+  auto drop_back(size_t n = 1) const -> ArrayRef {
+    return slice(0, Length - n);
+  }
+  auto take_front(size_t n = 1) const -> ArrayRef {
+    return n >= Length ? *this : drop_back(Length - n);
+  }
+  auto take_back(size_t n = 1) const -> ArrayRef {
+    return n >= Length ? *this : drop_front(Length - n);
+  }
+
+  auto vec() const -> std::vector<T> { return std::vector<T>(begin(), end()); }
+  operator std::vector<T>() const { return vec(); }
+
+ private:
+  const T* Data = nullptr;
+  size_t Length = 0;
+};
+
+// A mutable ArrayRef.
+template <typename T>
+class MutableArrayRef : public ArrayRef<T> {
+ public:
+  using iterator = T*;
+
+  MutableArrayRef() = default;
+  MutableArrayRef(T* data, size_t length) : ArrayRef<T>(data, length) {}
+  MutableArrayRef(SmallVectorImpl<T>& vector) : ArrayRef<T>(vector) {}
+  MutableArrayRef(std::vector<T>& vector) : ArrayRef<T>(vector) {}
+  template <size_t N>
+  MutableArrayRef(T (&array)[N]) : ArrayRef<T>(array) {}
+
+  auto data() const -> T* { return const_cast<T*>(ArrayRef<T>::data()); }
+  auto begin() const -> iterator { return data(); }
+  auto end() const -> iterator { return data() + this->size(); }
+  auto operator[](size_t index) const -> T& { return data()[index]; }
+};
+
+template <typename T>
+auto operator==(ArrayRef<T> lhs, ArrayRef<T> rhs) -> bool {
+  return lhs.equals(rhs);
+}
+template <typename T>
+auto operator!=(ArrayRef<T> lhs, ArrayRef<T> rhs) -> bool {
+  return !lhs.equals(rhs);
+}
+
+template <typename T>
+auto makeArrayRef(const T* data, size_t length) -> ArrayRef<T> {
+  return ArrayRef<T>(data, length);
+}
+template <typename T>
+auto makeArrayRef(const SmallVectorImpl<T>& vector) -> ArrayRef<T> {
+  return vector;
+}
+template <typename T>
+auto makeArrayRef(const std::vector<T>& vector) -> ArrayRef<T> {
+  return vector;
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_ARRAYREF_H
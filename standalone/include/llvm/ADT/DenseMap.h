@@ -0,0 +1,28 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_DENSEMAP_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_DENSEMAP_H
+
+#include <unordered_map>
+
+namespace llvm {
+
+// A hash map. LLVM's is open-addressed; the standalone one is a
+// std::unordered_map with the few extra members the library uses.
+template <typename KeyT, typename ValueT>
+class DenseMap : public std::unordered_map<KeyT, ValueT> {
+  using Base = std::unordered_map<KeyT, ValueT>;
+
+ public:
+  using Base::Base;
+
+  auto lookup(const KeyT& key) const -> ValueT {
+    auto it = this->find(key);
+    return it == this->end() ? ValueT() : it->second;
+  }
+  auto contains(const KeyT& key) const -> bool {
+    return this->find(key) != this->end();
+  }
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_DENSEMAP_H
@@ -0,0 +1,15 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_OPTIONAL_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_OPTIONAL_H
+
+#include <optional>
+
+namespace llvm {
+
+template <typename T>
+using Optional = std::optional<T>;
+
+inline constexpr std::nullopt_t None = std::nullopt;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_OPTIONAL_H
@@ -0,0 +1,182 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_STLEXTRAS_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_STLEXTRAS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/iterator_range.h"
+
+namespace llvm {
+
+// Range versions of the <algorithm> functions the library uses.
+
+template <typename R, typename Predicate>
+auto any_of(R&& range, Predicate predicate) -> bool {
+  return std::any_of(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename Predicate>
+auto all_of(R&& range, Predicate predicate) -> bool {
+  return std::all_of(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename Predicate>
+auto none_of(R&& range, Predicate predicate) -> bool {
+  return std::none_of(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename T>
+auto find(R&& range, const T& value) {
+  return std::find(std::begin(range), std::end(range), value);
+}
+
+template <typename R, typename Predicate>
+auto find_if(R&& range, Predicate predicate) {
+  return std::find_if(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename Predicate>
+auto count_if(R&& range, Predicate predicate) {
+  return std::count_if(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename Predicate>
+auto remove_if(R&& range, Predicate predicate) {
+  return std::remove_if(std::begin(range), std::end(range), predicate);
+}
+
+template <typename R, typename OutputIt>
+auto copy(R&& range, OutputIt out) -> OutputIt {
+  return std::copy(std::begin(range), std::end(range), out);
+}
+
+template <typename R, typename T>
+auto is_contained(R&& range, const T& value) -> bool {
+  return std::find(std::begin(range), std::end(range), value) !=
+         std::end(range);
+}
+
+template <typename R, typename T>
+auto lower_bound(R&& range, T&& value) {
+  return std::lower_bound(std::begin(range), std::end(range),
+                          std::forward<T>(value));
+}
+
+template <typename R, typename T, typename Compare>
+auto lower_bound(R&& range, T&& value, Compare compare) {
+  return std::lower_bound(std::begin(range), std::end(range),
+                          std::forward<T>(value), compare);
+}
+
+template <typename IteratorT>
+void sort(IteratorT first, IteratorT last) {
+  std::sort(first, last);
+}
+
+template <typename IteratorT, typename Compare>
+void sort(IteratorT first, IteratorT last, Compare compare) {
+  std::sort(first, last, compare);
+}
+
+template <typename R>
+void sort(R&& range) {
+  std::sort(std::begin(range), std::end(range));
+}
+
+template <typename R, typename Compare>
+void sort(R&& range, Compare compare) {
+  std::sort(std::begin(range), std::end(range), compare);
+}
+
+template <typename R>
+void stable_sort(R&& range) {
+  std::stable_sort(std::begin(range), std::end(range));
+}
+
+template <typename R, typename Compare>
+void stable_sort(R&& range, Compare compare) {
+  std::stable_sort(std::begin(range), std::end(range), compare);
+}
+
+template <typename IteratorT>
+void array_pod_sort(IteratorT first, IteratorT last) {
+  std::sort(first, last);
+}
+
+template <typename IteratorT, typename T>
+void array_pod_sort(IteratorT first, IteratorT last,
+                    int (*compare)(const T*, const T*)) {
+  std::sort(first, last, [compare](const auto& lhs, const auto& rhs) {
+    return compare(&lhs, &rhs) < 0;
+  });
+}
+
+template <typename Container, typename Predicate>
+void erase_if(Container& container, Predicate predicate) {
+  container.erase(
+      std::remove_if(container.begin(), container.end(), predicate),
+      container.end());
+}
+
+template <typename Container, typename T>
+void erase_value(Container& container, const T& value) {
+  container.erase(std::remove(container.begin(), container.end(), value),
+                  container.end());
+}
+
+template <typename R>
+auto drop_begin(R&& range, size_t n = 1) {
+  return make_range(std::next(std::begin(range), n), std::end(range));
+}
+
+template <typename R>
+auto drop_end(R&& range, size_t n = 1) {
+  return make_range(std::begin(range), std::prev(std::end(range), n));
+}
+
+template <typename IteratorT, typename EachFn, typename BetweenFn>
+void interleave(IteratorT first, IteratorT last, EachFn each,
+                BetweenFn between) {
+  if (first == last) {
+    return;
+  }
+  each(*first);
+  for (++first; first != last; ++first) {
+    between();
+    each(*first);
+  }
+}
+
+template <typename R, typename Stream, typename EachFn>
+void interleaveComma(const R& range, Stream& os, EachFn each) {
+  interleave(std::begin(range), std::end(range), each, [&] { os << ", "; });
+}
+
+template <typename R, typename Stream>
+void interleaveComma(const R& range, Stream& os) {
+  interleaveComma(range, os, [&](const auto& value) { os << value; });
+}
+
+// Orders pairs by their first member.
+struct less_first {
+  template <typename T>
+  auto operator()(const T& lhs, const T& rhs) const -> bool {
+    return std::less<>()(lhs.first, rhs.first);
+  }
+};
+
+// Orders pairs by their second member.
+struct less_second {
+  template <typename T>
+  auto operator()(const T& lhs, const T& rhs) const -> bool {
+    return std::less<>()(lhs.second, rhs.second);
+  }
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_STLEXTRAS_H
@@ -0,0 +1,45 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_STLFUNCTIONALEXTRAS_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_STLFUNCTIONALEXTRAS_H
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace llvm {
+
+template <typename Fn>
+class function_ref;
+
+// A non-owning reference to a callable, as in LLVM's ADT.
+template <typename Ret, typename... Params>
+class function_ref<Ret(Params...)> {
+ public:
+  function_ref() = default;
+  function_ref(std::nullptr_t) {}
+  template <typename Callable,
+            typename = std::enable_if_t<!std::is_same_v<
+                std::remove_cv_t<std::remove_reference_t<Callable>>,
+                function_ref>>>
+  function_ref(Callable&& callable)
+      : Callback(callbackFn<std::remove_reference_t<Callable>>),
+        Callee(reinterpret_cast<intptr_t>(&callable)) {}
+
+  auto operator()(Params... params) const -> Ret {
+    return Callback(Callee, std::forward<Params>(params)...);
+  }
+  explicit operator bool() const { return Callback; }
+
+ private:
+  template <typename Callable>
+  static auto callbackFn(intptr_t callable, Params... params) -> Ret {
+    return (*reinterpret_cast<Callable*>(callable))(
+        std::forward<Params>(params)...);
+  }
+
+  Ret (*Callback)(intptr_t callable, Params... params) = nullptr;
+  intptr_t Callee = 0;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_STLFUNCTIONALEXTRAS_H
@@ -0,0 +1,80 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_SMALLPTRSET_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_SMALLPTRSET_H
+
+#include <algorithm>
+#include <initializer_list>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+// A set of pointers that iterates in insertion order, like LLVM's SmallPtrSet
+// does while it is small.
+template <typename PtrT>
+class SmallPtrSetImpl {
+ public:
+  using iterator = typename std::vector<PtrT>::const_iterator;
+  using const_iterator = iterator;
+  using value_type = PtrT;
+
+  auto begin() const -> iterator { return Elements.begin(); }
+  auto end() const -> iterator { return Elements.end(); }
+  auto size() const -> unsigned { return static_cast<unsigned>(Elements.size()); }
+  auto empty() const -> bool { return Elements.empty(); }
+
+  auto insert(PtrT ptr) -> std::pair<iterator, bool> {
+    if (!Index.insert(ptr).second) {
+      return {std::find(Elements.begin(), Elements.end(), ptr), false};
+    }
+    Elements.push_back(ptr);
+    return {std::prev(Elements.end()), true};
+  }
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  auto erase(PtrT ptr) -> bool {
+    if (!Index.erase(ptr)) {
+      return false;
+    }
+    Elements.erase(std::find(Elements.begin(), Elements.end(), ptr));
+    return true;
+  }
+  auto count(PtrT ptr) const -> size_t { return Index.count(ptr); }
+  auto contains(PtrT ptr) const -> bool { return count(ptr) != 0; }
+  auto find(PtrT ptr) const -> iterator {
+    return contains(ptr) ? std::find(Elements.begin(), Elements.end(), ptr)
+                         : end();
+  }
+  void clear() {
+    Elements.clear();
+    Index.clear();
+  }
+
+ protected:
+  SmallPtrSetImpl() = default;
+
+ private:
+  std::vector<PtrT> Elements;
+  std::unordered_set<PtrT> Index;
+};
+
+template <typename PtrT, unsigned N>
+class SmallPtrSet : public SmallPtrSetImpl<PtrT> {
+ public:
+  SmallPtrSet() = default;
+  SmallPtrSet(std::initializer_list<PtrT> list) {
+    this->insert(list.begin(), list.end());
+  }
+  template <typename InputIt>
+  SmallPtrSet(InputIt first, InputIt last) {
+    this->insert(first, last);
+  }
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_SMALLPTRSET_H
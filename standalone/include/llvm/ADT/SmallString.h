@@ -0,0 +1,98 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_SMALLSTRING_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_SMALLSTRING_H
+
+#include <initializer_list>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+// A SmallVector of chars with string helpers.
+template <unsigned N>
+class SmallString : public SmallVector<char, N> {
+  using Base = SmallVector<char, N>;
+
+ public:
+  SmallString() = default;
+  SmallString(StringRef str) : Base(str.begin(), str.end()) {}
+  SmallString(const char* str) : SmallString(StringRef(str)) {}
+  SmallString(std::initializer_list<StringRef> refs) { append(refs); }
+  template <typename InputIt>
+  SmallString(InputIt first, InputIt last) : Base(first, last) {}
+
+  using Base::append;
+  using Base::assign;
+
+  void append(StringRef str) { Base::append(str.begin(), str.end()); }
+  void append(std::initializer_list<StringRef> refs) {
+    for (StringRef ref : refs) {
+      append(ref);
+    }
+  }
+  void assign(StringRef str) {
+    this->clear();
+    append(str);
+  }
+  void assign(std::initializer_list<StringRef> refs) {
+    this->clear();
+    append(refs);
+  }
+
+  auto str() const -> StringRef { return StringRef(this->data(), this->size()); }
+  operator StringRef() const { return str(); }
+  explicit operator std::string() const { return str().str(); }
+
+  // Return a null-terminated pointer to the contents.
+  auto c_str() -> const char* {
+    this->push_back('\0');
+    this->pop_back();
+    return this->data();
+  }
+
+  auto equals(StringRef rhs) const -> bool { return str().equals(rhs); }
+  auto compare(StringRef rhs) const -> int { return str().compare(rhs); }
+  auto startswith(StringRef prefix) const -> bool {
+    return str().startswith(prefix);
+  }
+  auto endswith(StringRef suffix) const -> bool {
+    return str().endswith(suffix);
+  }
+  auto find(char c, size_t from = 0) const -> size_t {
+    return str().find(c, from);
+  }
+  auto find(StringRef s, size_t from = 0) const -> size_t {
+    return str().find(s, from);
+  }
+  auto rfind(char c) const -> size_t { return str().rfind(c); }
+  auto substr(size_t start, size_t n = StringRef::npos) const -> StringRef {
+    return str().substr(start, n);
+  }
+
+  auto operator=(StringRef rhs) -> SmallString& {
+    assign(rhs);
+    return *this;
+  }
+  auto operator+=(StringRef rhs) -> SmallString& {
+    append(rhs);
+    return *this;
+  }
+  auto operator+=(char c) -> SmallString& {
+    this->push_back(c);
+    return *this;
+  }
+};
+
+template <unsigned N>
+auto operator==(const SmallString<N>& lhs, StringRef rhs) -> bool {
+  return lhs.str() == rhs;
+}
+template <unsigned N>
+auto operator!=(const SmallString<N>& lhs, StringRef rhs) -> bool {
+  return lhs.str() != rhs;
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_SMALLSTRING_H
@@ -0,0 +1,226 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_SMALLVECTOR_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_SMALLVECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+template <typename T>
+class ArrayRef;
+
+// The part of SmallVector that does not depend on the inline size. The
+// standalone version keeps its elements in a std::vector; there is no inline
+// storage, so the size parameter of SmallVector is only a hint.
+template <typename T>
+class SmallVectorImpl {
+  using Storage = std::vector<T>;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  SmallVectorImpl(const SmallVectorImpl&) = delete;
+
+  auto begin() -> iterator { return Elements.data(); }
+  auto end() -> iterator { return Elements.data() + Elements.size(); }
+  auto begin() const -> const_iterator { return Elements.data(); }
+  auto end() const -> const_iterator {
+    return Elements.data() + Elements.size();
+  }
+  auto rbegin() -> reverse_iterator { return reverse_iterator(end()); }
+  auto rend() -> reverse_iterator { return reverse_iterator(begin()); }
+  auto rbegin() const -> const_reverse_iterator {
+    return const_reverse_iterator(end());
+  }
+  auto rend() const -> const_reverse_iterator {
+    return const_reverse_iterator(begin());
+  }
+
+  auto size() const -> size_t { return Elements.size(); }
+  auto empty() const -> bool { return Elements.empty(); }
+  auto capacity() const -> size_t { return Elements.capacity(); }
+  auto data() -> T* { return Elements.data(); }
+  auto data() const -> const T* { return Elements.data(); }
+
+  auto operator[](size_t index) -> T& { return Elements[index]; }
+  auto operator[](size_t index) const -> const T& { return Elements[index]; }
+  auto front() -> T& { return Elements.front(); }
+  auto front() const -> const T& { return Elements.front(); }
+  auto back() -> T& { return Elements.back(); }
+  auto back() const -> const T& { return Elements.back(); }
+
+  void push_back(const T& value) { Elements.push_back(value); }
+  void push_back(T&& value) { Elements.push_back(std::move(value)); }
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> T& {
+    return Elements.emplace_back(std::forward<Args>(args)...);
+  }
+  void pop_back() { Elements.pop_back(); }
+  auto pop_back_val() -> T {
+    T result = std::move(Elements.back());
+    Elements.pop_back();
+    return result;
+  }
+
+  void clear() { Elements.clear(); }
+  void reserve(size_t n) { Elements.reserve(n); }
+  void resize(size_t n) { Elements.resize(n); }
+  void resize(size_t n, const T& value) { Elements.resize(n, value); }
+  void truncate(size_t n) { Elements.resize(n); }
+  void set_size(size_t n) { Elements.resize(n); }
+
+  template <typename InputIt>
+  void append(InputIt first, InputIt last) {
+    Elements.insert(Elements.end(), first, last);
+  }
+  void append(size_t n, const T& value) {
+    Elements.insert(Elements.end(), n, value);
+  }
+  void append(std::initializer_list<T> values) {
+    Elements.insert(Elements.end(), values);
+  }
+  void append(const SmallVectorImpl& other) {
+    append(other.begin(), other.end());
+  }
+
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last) {
+    Elements.assign(first, last);
+  }
+  void assign(size_t n, const T& value) { Elements.assign(n, value); }
+  void assign(std::initializer_list<T> values) { Elements.assign(values); }
+  void assign(const SmallVectorImpl& other) { Elements = other.Elements; }
+
+  auto insert(iterator pos, const T& value) -> iterator {
+    return wrap(Elements.insert(unwrap(pos), value));
+  }
+  auto insert(iterator pos, T&& value) -> iterator {
+    return wrap(Elements.insert(unwrap(pos), std::move(value)));
+  }
+  auto insert(iterator pos, size_t n, const T& value) -> iterator {
+    return wrap(Elements.insert(unwrap(pos), n, value));
+  }
+  template <typename InputIt,
+            typename = decltype(*std::declval<InputIt>(), void())>
+  auto insert(iterator pos, InputIt first, InputIt last) -> iterator {
+    return wrap(Elements.insert(unwrap(pos), first, last));
+  }
+  auto insert(iterator pos, std::initializer_list<T> values) -> iterator {
+    return wrap(Elements.insert(unwrap(pos), values));
+  }
+  template <typename... Args>
+  auto emplace(iterator pos, Args&&... args) -> iterator {
+    return wrap(Elements.emplace(unwrap(pos), std::forward<Args>(args)...));
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    return wrap(Elements.erase(unwrap(pos)));
+  }
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    return wrap(Elements.erase(unwrap(first), unwrap(last)));
+  }
+
+  void swap(SmallVectorImpl& other) { Elements.swap(other.Elements); }
+
+  auto operator=(const SmallVectorImpl& other) -> SmallVectorImpl& {
+    Elements = other.Elements;
+    return *this;
+  }
+  auto operator=(SmallVectorImpl&& other) -> SmallVectorImpl& {
+    Elements = std::move(other.Elements);
+    return *this;
+  }
+
+  auto operator==(const SmallVectorImpl& other) const -> bool {
+    return Elements == other.Elements;
+  }
+  auto operator!=(const SmallVectorImpl& other) const -> bool {
+    return Elements != other.Elements;
+  }
+  auto operator<(const SmallVectorImpl& other) const -> bool {
+    return Elements < other.Elements;
+  }
+
+ protected:
+  SmallVectorImpl() = default;
+  explicit SmallVectorImpl(Storage elements) : Elements(std::move(elements)) {}
+
+  Storage Elements;
+
+ private:
+  auto unwrap(const_iterator pos) -> typename Storage::iterator {
+    return Elements.begin() + (pos - begin());
+  }
+  auto wrap(typename Storage::iterator pos) -> iterator {
+    return begin() + (pos - Elements.begin());
+  }
+};
+
+template <typename T, unsigned N = 0>
+class SmallVector : public SmallVectorImpl<T> {
+  using Base = SmallVectorImpl<T>;
+
+ public:
+  SmallVector() = default;
+  explicit SmallVector(size_t n) : Base(std::vector<T>(n)) {}
+  SmallVector(size_t n, const T& value) : Base(std::vector<T>(n, value)) {}
+  template <typename InputIt,
+            typename = decltype(*std::declval<InputIt>(), void())>
+  SmallVector(InputIt first, InputIt last) : Base(std::vector<T>(first, last)) {}
+  SmallVector(std::initializer_list<T> values) : Base(std::vector<T>(values)) {}
+  template <typename Range,
+            typename = decltype(std::begin(std::declval<const Range&>()))>
+  explicit SmallVector(const Range& range)
+      : Base(std::vector<T>(std::begin(range), std::end(range))) {}
+  SmallVector(const SmallVector& other) : Base() { this->assign(other); }
+  SmallVector(SmallVector&& other) noexcept : Base() { this->swap(other); }
+  SmallVector(const SmallVectorImpl<T>& other) : Base() { this->assign(other); }
+  SmallVector(SmallVectorImpl<T>&& other) : Base() { this->swap(other); }
+
+  auto operator=(const SmallVector& other) -> SmallVector& {
+    Base::operator=(other);
+    return *this;
+  }
+  auto operator=(SmallVector&& other) noexcept -> SmallVector& {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+  auto operator=(const SmallVectorImpl<T>& other) -> SmallVector& {
+    Base::operator=(other);
+    return *this;
+  }
+  auto operator=(SmallVectorImpl<T>&& other) -> SmallVector& {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+  auto operator=(std::initializer_list<T> values) -> SmallVector& {
+    this->assign(values);
+    return *this;
+  }
+};
+
+template <typename Range>
+auto to_vector(Range&& range) {
+  using T = std::remove_const_t<
+      std::remove_reference_t<decltype(*std::begin(range))>>;
+  return SmallVector<T>(std::begin(range), std::end(range));
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_SMALLVECTOR_H
@@ -0,0 +1,83 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_STRINGEXTRAS_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_STRINGEXTRAS_H
+
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+
+namespace llvm {
+
+inline auto isDigit(char c) -> bool { return c >= '0' && c <= '9'; }
+inline auto isAlpha(char c) -> bool {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+inline auto isAlnum(char c) -> bool { return isAlpha(c) || isDigit(c); }
+inline auto isSpace(char c) -> bool {
+  return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' ||
+         c == '\v';
+}
+// The value of hex digit c, or -1U if c is not one.
+inline auto hexDigitValue(char c) -> unsigned {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return ~0U;
+}
+inline auto isHexDigit(char c) -> bool { return hexDigitValue(c) != ~0U; }
+inline auto toLower(char c) -> char {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+inline auto toUpper(char c) -> char {
+  return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+inline auto utostr(unsigned long long value) -> std::string {
+  return std::to_string(value);
+}
+inline auto itostr(long long value) -> std::string {
+  return std::to_string(value);
+}
+
+// Parse text as a floating-point number; true on success.
+inline auto to_float(const Twine& text, double& num) -> bool {
+  std::string storage = text.str();
+  char* end = nullptr;
+  num = std::strtod(storage.c_str(), &end);
+  return !storage.empty() && end == storage.c_str() + storage.size();
+}
+inline auto to_float(const Twine& text, float& num) -> bool {
+  double value;
+  if (!to_float(text, value)) {
+    return false;
+  }
+  num = static_cast<float>(value);
+  return true;
+}
+
+// Join the strings in range with separator between them.
+template <typename R>
+auto join(const R& range, StringRef separator) -> std::string {
+  std::string result;
+  bool first = true;
+  for (const auto& item : range) {
+    if (!first) {
+      result += separator;
+    }
+    first = false;
+    result += StringRef(item);
+  }
+  return result;
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_STRINGEXTRAS_H
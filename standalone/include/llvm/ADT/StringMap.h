@@ -0,0 +1,252 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_STRINGMAP_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_STRINGMAP_H
+
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/iterator_range.h"
+
+namespace llvm {
+
+// An entry of a StringMap: the key and the value.
+template <typename ValueT>
+class StringMapEntry {
+ public:
+  template <typename... Args>
+  explicit StringMapEntry(StringRef key, Args&&... args)
+      : second(std::forward<Args>(args)...), Key(key.str()) {}
+
+  auto getKey() const -> StringRef { return Key; }
+  auto first() const -> StringRef { return Key; }
+  auto getKeyData() const -> const char* { return Key.c_str(); }
+  auto getKeyLength() const -> size_t { return Key.size(); }
+  auto getValue() -> ValueT& { return second; }
+  auto getValue() const -> const ValueT& { return second; }
+
+  ValueT second;
+
+ private:
+  std::string Key;
+};
+
+// A map from strings to values that owns copies of its keys. Iteration order
+// is unspecified, as in LLVM. As in LLVM, erasing leaves a tombstone, so it
+// does not invalidate iterators to other entries or the erased one; inserting
+// may.
+template <typename ValueT>
+class StringMap {
+  using Entry = StringMapEntry<ValueT>;
+  using Slots = std::vector<std::unique_ptr<Entry>>;
+
+  template <typename SlotT, typename EntryT>
+  class IteratorImpl {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EntryT;
+    using difference_type = ptrdiff_t;
+    using pointer = EntryT*;
+    using reference = EntryT&;
+
+    IteratorImpl() = default;
+    IteratorImpl(SlotT* slot, SlotT* end) : Slot(slot), End(end) {
+      skipTombstones();
+    }
+    // Allow iterator to const_iterator conversion.
+    template <typename OtherSlot, typename OtherEntry>
+    IteratorImpl(const IteratorImpl<OtherSlot, OtherEntry>& other)
+        : Slot(other.Slot), End(other.End) {}
+
+    auto operator*() const -> EntryT& { return **Slot; }
+    auto operator->() const -> EntryT* { return Slot->get(); }
+    auto operator++() -> IteratorImpl& {
+      ++Slot;
+      skipTombstones();
+      return *this;
+    }
+    auto operator++(int) -> IteratorImpl {
+      IteratorImpl result = *this;
+      ++*this;
+      return result;
+    }
+    auto operator==(const IteratorImpl& other) const -> bool {
+      return Slot == other.Slot;
+    }
+    auto operator!=(const IteratorImpl& other) const -> bool {
+      return Slot != other.Slot;
+    }
+
+   private:
+    template <typename, typename>
+    friend class IteratorImpl;
+    friend class StringMap;
+
+    void skipTombstones() {
+      while (Slot != End && !*Slot) {
+        ++Slot;
+      }
+    }
+
+    SlotT* Slot = nullptr;
+    SlotT* End = nullptr;
+  };
+
+ public:
+  using mapped_type = ValueT;
+  using value_type = Entry;
+  using iterator = IteratorImpl<std::unique_ptr<Entry>, Entry>;
+  using const_iterator =
+      IteratorImpl<const std::unique_ptr<Entry>, const Entry>;
+
+  StringMap() = default;
+  explicit StringMap(unsigned initial_size) {
+    Index.reserve(initial_size);
+    Entries.reserve(initial_size);
+  }
+  StringMap(std::initializer_list<std::pair<StringRef, ValueT>> list) {
+    for (const auto& [key, value] : list) {
+      insert({key, value});
+    }
+  }
+  StringMap(const StringMap& other) { *this = other; }
+  StringMap(StringMap&&) noexcept = default;
+  auto operator=(const StringMap& other) -> StringMap& {
+    if (this != &other) {
+      clear();
+      for (const Entry& entry : other) {
+        try_emplace(entry.getKey(), entry.getValue());
+      }
+    }
+    return *this;
+  }
+  auto operator=(StringMap&&) noexcept -> StringMap& = default;
+
+  auto begin() -> iterator { return makeIterator(0); }
+  auto end() -> iterator { return makeIterator(Entries.size()); }
+  auto begin() const -> const_iterator { return makeIterator(0); }
+  auto end() const -> const_iterator { return makeIterator(Entries.size()); }
+
+  auto size() const -> unsigned { return static_cast<unsigned>(Index.size()); }
+  auto empty() const -> bool { return Index.empty(); }
+  void clear() {
+    Index.clear();
+    Entries.clear();
+  }
+
+  auto find(StringRef key) -> iterator {
+    auto it = Index.find(std::string_view(key));
+    return it == Index.end() ? end() : makeIterator(it->second);
+  }
+  auto find(StringRef key) const -> const_iterator {
+    auto it = Index.find(std::string_view(key));
+    return it == Index.end() ? end() : makeIterator(it->second);
+  }
+  auto count(StringRef key) const -> size_t {
+    return Index.count(std::string_view(key));
+  }
+  auto contains(StringRef key) const -> bool { return count(key) != 0; }
+  auto lookup(StringRef key) const -> ValueT {
+    auto it = Index.find(std::string_view(key));
+    return it == Index.end() ? ValueT() : Entries[it->second]->getValue();
+  }
+  auto at(StringRef key) const -> const ValueT& {
+    return Entries[Index.at(std::string_view(key))]->getValue();
+  }
+  auto operator[](StringRef key) -> ValueT& {
+    return try_emplace(key).first->getValue();
+  }
+
+  template <typename... Args>
+  auto try_emplace(StringRef key, Args&&... args) -> std::pair<iterator, bool> {
+    auto it = Index.find(std::string_view(key));
+    if (it != Index.end()) {
+      return {makeIterator(it->second), false};
+    }
+    // Drop the tombstones once they are half the table, as a rehash would.
+    if (Entries.size() >= 16 && Index.size() < Entries.size() / 2) {
+      compact();
+    }
+    auto entry = std::make_unique<Entry>(key, std::forward<Args>(args)...);
+    std::string_view stored(entry->getKeyData(), entry->getKeyLength());
+    Entries.push_back(std::move(entry));
+    Index.emplace(stored, Entries.size() - 1);
+    return {makeIterator(Entries.size() - 1), true};
+  }
+  auto insert(std::pair<StringRef, ValueT> key_value)
+      -> std::pair<iterator, bool> {
+    return try_emplace(key_value.first, std::move(key_value.second));
+  }
+  template <typename V>
+  auto insert_or_assign(StringRef key, V&& value)
+      -> std::pair<iterator, bool> {
+    auto result = try_emplace(key, std::forward<V>(value));
+    if (!result.second) {
+      result.first->second = std::forward<V>(value);
+    }
+    return result;
+  }
+
+  auto erase(StringRef key) -> bool {
+    auto it = Index.find(std::string_view(key));
+    if (it == Index.end()) {
+      return false;
+    }
+    size_t slot = it->second;
+    Index.erase(it);
+    Entries[slot].reset();
+    return true;
+  }
+  void erase(iterator it) { erase(it->getKey()); }
+
+  auto keys() const {
+    return KeyRange{this};
+  }
+
+ private:
+  struct KeyIterator : const_iterator {
+    using value_type = StringRef;
+    KeyIterator(const_iterator it) : const_iterator(it) {}
+    auto operator*() const -> StringRef {
+      return const_iterator::operator*().getKey();
+    }
+  };
+  struct KeyRange {
+    const StringMap* Map;
+    auto begin() const -> KeyIterator { return Map->begin(); }
+    auto end() const -> KeyIterator { return Map->end(); }
+  };
+
+  auto makeIterator(size_t slot) -> iterator {
+    return iterator(Entries.data() + slot, Entries.data() + Entries.size());
+  }
+  auto makeIterator(size_t slot) const -> const_iterator {
+    return const_iterator(Entries.data() + slot,
+                          Entries.data() + Entries.size());
+  }
+
+  void compact() {
+    Slots live;
+    live.reserve(Index.size());
+    for (std::unique_ptr<Entry>& entry : Entries) {
+      if (entry) {
+        Index[std::string_view(entry->getKeyData(), entry->getKeyLength())] =
+            live.size();
+        live.push_back(std::move(entry));
+      }
+    }
+    Entries = std::move(live);
+  }
+
+  Slots Entries;
+  std::unordered_map<std::string_view, size_t> Index;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_STRINGMAP_H
@@ -0,0 +1,381 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_STRINGREF_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_STRINGREF_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace llvm {
+
+class StringRef;
+
+auto getAsUnsignedInteger(StringRef str, unsigned radix,
+                          unsigned long long& result) -> bool;
+auto getAsSignedInteger(StringRef str, unsigned radix, long long& result)
+    -> bool;
+
+// A non-owning reference to a string of bytes, as in LLVM's ADT.
+class StringRef {
+ public:
+  static constexpr size_t npos = ~size_t(0);
+
+  using iterator = const char*;
+  using const_iterator = const char*;
+  using size_type = size_t;
+
+  StringRef() = default;
+  StringRef(std::nullptr_t) = delete;
+  constexpr StringRef(const char* str)
+      : Data(str), Length(str ? std::char_traits<char>::length(str) : 0) {}
+  constexpr StringRef(const char* data, size_t length)
+      : Data(data), Length(length) {}
+  StringRef(const std::string& str) : Data(str.data()), Length(str.size()) {}
+  constexpr StringRef(std::string_view str)
+      : Data(str.data()), Length(str.size()) {}
+
+  auto begin() const -> iterator { return Data; }
+  auto end() const -> iterator { return Data + Length; }
+  auto bytes_begin() const -> const unsigned char* {
+    return reinterpret_cast<const unsigned char*>(Data);
+  }
+  auto bytes_end() const -> const unsigned char* {
+    return reinterpret_cast<const unsigned char*>(Data + Length);
+  }
+
+  constexpr auto data() const -> const char* { return Data; }
+  constexpr auto size() const -> size_t { return Length; }
+  constexpr auto empty() const -> bool { return Length == 0; }
+  auto front() const -> char { return Data[0]; }
+  auto back() const -> char { return Data[Length - 1]; }
+  auto operator[](size_t index) const -> char { return Data[index]; }
+
+  template <typename Allocator>
+  auto copy(Allocator& allocator) const -> StringRef {
+    if (empty()) {
+      return StringRef();
+    }
+    char* storage = allocator.template Allocate<char>(Length);
+    std::copy(begin(), end(), storage);
+    return StringRef(storage, Length);
+  }
+
+  auto str() const -> std::string {
+    return Data ? std::string(Data, Length) : std::string();
+  }
+  operator std::string_view() const { return std::string_view(Data, Length); }
+
+  auto equals(StringRef rhs) const -> bool {
+    return Length == rhs.Length && compareMemory(Data, rhs.Data, Length) == 0;
+  }
+  auto equals_insensitive(StringRef rhs) const -> bool {
+    return Length == rhs.Length && compare_insensitive(rhs) == 0;
+  }
+  auto compare(StringRef rhs) const -> int {
+    if (int result =
+            compareMemory(Data, rhs.Data, std::min(Length, rhs.Length))) {
+      return result < 0 ? -1 : 1;
+    }
+    if (Length == rhs.Length) {
+      return 0;
+    }
+    return Length < rhs.Length ? -1 : 1;
+  }
+  auto compare_insensitive(StringRef rhs) const -> int;
+
+  auto edit_distance(StringRef other, bool allow_replacements = true,
+                     unsigned max_edit_distance = 0) const -> unsigned;
+
+  auto lower() const -> std::string;
+  auto upper() const -> std::string;
+
+  auto startswith(StringRef prefix) const -> bool {
+    return Length >= prefix.Length &&
+           compareMemory(Data, prefix.Data, prefix.Length) == 0;
+  }
+  auto starts_with(StringRef prefix) const -> bool {
+    return startswith(prefix);
+  }
+  auto startswith_insensitive(StringRef prefix) const -> bool {
+    return Length >= prefix.Length &&
+           substr(0, prefix.Length).equals_insensitive(prefix);
+  }
+  auto endswith(StringRef suffix) const -> bool {
+    return Length >= suffix.Length &&
+           compareMemory(end() - suffix.Length, suffix.Data, suffix.Length) ==
+               0;
+  }
+  auto ends_with(StringRef suffix) const -> bool { return endswith(suffix); }
+  auto endswith_insensitive(StringRef suffix) const -> bool {
+    return Length >= suffix.Length &&
+           drop_front(Length - suffix.Length).equals_insensitive(suffix);
+  }
+
+  auto find(char c, size_t from = 0) const -> size_t {
+    if (from >= Length) {
+      return npos;
+    }
+    const void* found = std::memchr(Data + from, c, Length - from);
+    return found ? static_cast<const char*>(found) - Data : npos;
+  }
+  auto find(StringRef str, size_t from = 0) const -> size_t {
+    if (from > Length) {
+      return npos;
+    }
+    size_t result = std::string_view(*this).find(std::string_view(str), from);
+    return result == std::string_view::npos ? npos : result;
+  }
+  auto find_insensitive(StringRef str, size_t from = 0) const -> size_t {
+    for (size_t i = from; i + str.size() <= Length; ++i) {
+      if (substr(i, str.size()).equals_insensitive(str)) {
+        return i;
+      }
+    }
+    return npos;
+  }
+  template <typename Predicate>
+  auto find_if(Predicate predicate, size_t from = 0) const -> size_t {
+    for (size_t i = from; i < Length; ++i) {
+      if (predicate(Data[i])) {
+        return i;
+      }
+    }
+    return npos;
+  }
+  auto rfind(char c, size_t from = npos) const -> size_t {
+    for (size_t i = std::min(from, Length); i != 0; --i) {
+      if (Data[i - 1] == c) {
+        return i - 1;
+      }
+    }
+    return npos;
+  }
+  auto rfind(StringRef str) const -> size_t {
+    size_t result = std::string_view(*this).rfind(std::string_view(str));
+    return result == std::string_view::npos ? npos : result;
+  }
+  auto find_first_of(char c, size_t from = 0) const -> size_t {
+    return find(c, from);
+  }
+  auto find_first_of(StringRef chars, size_t from = 0) const -> size_t {
+    for (size_t i = from; i < Length; ++i) {
+      if (chars.find(Data[i]) != npos) {
+        return i;
+      }
+    }
+    return npos;
+  }
+  auto find_first_not_of(char c, size_t from = 0) const -> size_t {
+    for (size_t i = from; i < Length; ++i) {
+      if (Data[i] != c) {
+        return i;
+      }
+    }
+    return npos;
+  }
+  auto find_first_not_of(StringRef chars, size_t from = 0) const -> size_t {
+    for (size_t i = from; i < Length; ++i) {
+      if (chars.find(Data[i]) == npos) {
+        return i;
+      }
+    }
+    return npos;
+  }
+  auto find_last_of(char c, size_t from = npos) const -> size_t {
+    return rfind(c, from);
+  }
+  auto find_last_of(StringRef chars, size_t from = npos) const -> size_t {
+    for (size_t i = std::min(from, Length); i != 0; --i) {
+      if (chars.find(Data[i - 1]) != npos) {
+        return i - 1;
+      }
+    }
+    return npos;
+  }
+  auto find_last_not_of(StringRef chars, size_t from = npos) const -> size_t {
+    for (size_t i = std::min(from, Length); i != 0; --i) {
+      if (chars.find(Data[i - 1]) == npos) {
+        return i - 1;
+      }
+    }
+    return npos;
+  }
+
+  auto contains(char c) const -> bool { return find(c) != npos; }
+  auto contains(StringRef other) const -> bool { return find(other) != npos; }
+  auto contains_insensitive(StringRef other) const -> bool {
+    return find_insensitive(other) != npos;
+  }
+  auto count(char c) const -> size_t {
+    return static_cast<size_t>(std::count(begin(), end(), c));
+  }
+  auto count(StringRef str) const -> size_t {
+    if (str.empty()) {
+      return 0;
+    }
+    size_t result = 0;
+    for (size_t pos = find(str); pos != npos; pos = find(str, pos + str.size())) {
+      ++result;
+    }
+    return result;
+  }
+
+  template <typename T>
+  auto getAsInteger(unsigned radix, T& result) const
+      -> std::enable_if_t<std::numeric_limits<T>::is_signed, bool> {
+    long long value;
+    if (getAsSignedInteger(*this, radix, value) ||
+        static_cast<T>(value) != value) {
+      return true;
+    }
+    result = static_cast<T>(value);
+    return false;
+  }
+  template <typename T>
+  auto getAsInteger(unsigned radix, T& result) const
+      -> std::enable_if_t<!std::numeric_limits<T>::is_signed, bool> {
+    unsigned long long value;
+    if (getAsUnsignedInteger(*this, radix, value) ||
+        static_cast<unsigned long long>(static_cast<T>(value)) != value) {
+      return true;
+    }
+    result = static_cast<T>(value);
+    return false;
+  }
+  auto getAsDouble(double& result, bool allow_inexact = true) const -> bool;
+
+  auto substr(size_t start, size_t n = npos) const -> StringRef {
+    start = std::min(start, Length);
+    return StringRef(Data + start, std::min(n, Length - start));
+  }
+  auto take_front(size_t n = 1) const -> StringRef {
+    return n >= Length ? *this : drop_back(Length - n);
+  }
+  auto take_back(size_t n = 1) const -> StringRef {
+    return n >= Length ? *this : drop_front(Length - n);
+  }
+  template <typename Predicate>
+  auto take_while(Predicate predicate) const -> StringRef {
+    return substr(0, find_if([&](char c) { return !predicate(c); }));
+  }
+  template <typename Predicate>
+  auto drop_while(Predicate predicate) const -> StringRef {
+    return substr(find_if([&](char c) { return !predicate(c); }));
+  }
+  auto drop_front(size_t n = 1) const -> StringRef { return substr(n); }
+  auto drop_back(size_t n = 1) const -> StringRef {
+    return substr(0, size() - std::min(n, size()));
+  }
+  auto consume_front(StringRef prefix) -> bool {
+    if (!startswith(prefix)) {
+      return false;
+    }
+    *this = drop_front(prefix.size());
+    return true;
+  }
+  auto consume_back(StringRef suffix) -> bool {
+    if (!endswith(suffix)) {
+      return false;
+    }
+    *this = drop_back(suffix.size());
+    return true;
+  }
+  auto slice(size_t start, size_t end) const -> StringRef {
+    start = std::min(start, Length);
+    end = std::min(std::max(start, end), Length);
+    return StringRef(Data + start, end - start);
+  }
+
+  auto split(char separator) const -> std::pair<StringRef, StringRef> {
+    return split(StringRef(&separator, 1));
+  }
+  auto split(StringRef separator) const -> std::pair<StringRef, StringRef> {
+    size_t index = find(separator);
+    if (index == npos) {
+      return {*this, StringRef()};
+    }
+    return {slice(0, index), slice(index + separator.size(), npos)};
+  }
+  auto rsplit(char separator) const -> std::pair<StringRef, StringRef> {
+    size_t index = rfind(separator);
+    if (index == npos) {
+      return {*this, StringRef()};
+    }
+    return {slice(0, index), slice(index + 1, npos)};
+  }
+
+  auto ltrim(StringRef chars = " \t\n\v\f\r") const -> StringRef {
+    return drop_front(std::min(Length, find_first_not_of(chars)));
+  }
+  auto rtrim(StringRef chars = " \t\n\v\f\r") const -> StringRef {
+    return drop_back(Length - std::min(Length, find_last_not_of(chars) + 1));
+  }
+  auto trim(StringRef chars = " \t\n\v\f\r") const -> StringRef {
+    return ltrim(chars).rtrim(chars);
+  }
+  auto ltrim(char c) const -> StringRef { return ltrim(StringRef(&c, 1)); }
+  auto rtrim(char c) const -> StringRef { return rtrim(StringRef(&c, 1)); }
+  auto trim(char c) const -> StringRef { return trim(StringRef(&c, 1)); }
+
+ private:
+  static auto compareMemory(const char* lhs, const char* rhs, size_t length)
+      -> int {
+    return length == 0 ? 0 : std::memcmp(lhs, rhs, length);
+  }
+
+  const char* Data = nullptr;
+  size_t Length = 0;
+};
+
+// A StringRef to a string literal, usable in constant expressions.
+class StringLiteral : public StringRef {
+ public:
+  template <size_t N>
+  constexpr StringLiteral(const char (&str)[N]) : StringRef(str, N - 1) {}
+};
+
+inline auto operator==(StringRef lhs, StringRef rhs) -> bool {
+  return lhs.equals(rhs);
+}
+inline auto operator!=(StringRef lhs, StringRef rhs) -> bool {
+  return !(lhs == rhs);
+}
+inline auto operator<(StringRef lhs, StringRef rhs) -> bool {
+  return lhs.compare(rhs) < 0;
+}
+inline auto operator<=(StringRef lhs, StringRef rhs) -> bool {
+  return lhs.compare(rhs) <= 0;
+}
+inline auto operator>(StringRef lhs, StringRef rhs) -> bool {
+  return lhs.compare(rhs) > 0;
+}
+inline auto operator>=(StringRef lhs, StringRef rhs) -> bool {
+  return lhs.compare(rhs) >= 0;
+}
+
+inline auto operator+=(std::string& buffer, StringRef string) -> std::string& {
+  return buffer.append(string.data(), string.size());
+}
+
+inline auto hash_value(StringRef string) -> size_t {
+  return std::hash<std::string_view>()(string);
+}
+
+}  // namespace llvm
+
+namespace std {
+template <>
+struct hash<llvm::StringRef> {
+  auto operator()(llvm::StringRef string) const -> size_t {
+    return llvm::hash_value(string);
+  }
+};
+}  // namespace std
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_STRINGREF_H
@@ -0,0 +1,75 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_TWINE_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_TWINE_H
+
+#include <cstdint>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+class raw_ostream;
+template <unsigned N>
+class SmallString;
+
+// A string built by concatenation. Unlike LLVM's Twine, which stores a tree
+// of references, this one owns the concatenated text; it is only used for
+// messages and paths, where the copy does not matter.
+class Twine {
+ public:
+  Twine() = default;
+  Twine(const char* str) : Text(str ? str : "") {}
+  Twine(StringRef str) : Text(str.str()) {}
+  Twine(const std::string& str) : Text(str) {}
+  template <unsigned N>
+  Twine(const SmallString<N>& str) : Text(str.str().str()) {}
+  explicit Twine(char c) : Text(1, c) {}
+  explicit Twine(int value) : Text(std::to_string(value)) {}
+  explicit Twine(unsigned value) : Text(std::to_string(value)) {}
+  explicit Twine(long value) : Text(std::to_string(value)) {}
+  explicit Twine(unsigned long value) : Text(std::to_string(value)) {}
+  explicit Twine(long long value) : Text(std::to_string(value)) {}
+  explicit Twine(unsigned long long value) : Text(std::to_string(value)) {}
+
+  auto str() const -> std::string { return Text; }
+  auto isTriviallyEmpty() const -> bool { return Text.empty(); }
+  auto toVector(SmallVectorImpl<char>& out) const -> StringRef {
+    out.assign(Text.begin(), Text.end());
+    return StringRef(out.data(), out.size());
+  }
+  auto toStringRef(SmallVectorImpl<char>& out) const -> StringRef {
+    return toVector(out);
+  }
+  auto toNullTerminatedStringRef(SmallVectorImpl<char>& out) const
+      -> StringRef {
+    toVector(out);
+    out.push_back('\0');
+    out.pop_back();
+    return StringRef(out.data(), out.size());
+  }
+  void print(raw_ostream& os) const;
+
+  auto concat(const Twine& suffix) const -> Twine {
+    Twine result(*this);
+    result.Text += suffix.Text;
+    return result;
+  }
+
+ private:
+  std::string Text;
+};
+
+inline auto operator+(const Twine& lhs, const Twine& rhs) -> Twine {
+  return lhs.concat(rhs);
+}
+inline auto operator+(const char* lhs, StringRef rhs) -> Twine {
+  return Twine(lhs).concat(rhs);
+}
+inline auto operator+(StringRef lhs, const char* rhs) -> Twine {
+  return Twine(lhs).concat(rhs);
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_TWINE_H
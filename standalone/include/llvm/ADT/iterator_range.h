@@ -0,0 +1,31 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_ADT_ITERATOR_RANGE_H
+#define COMMANDLINE_STANDALONE_LLVM_ADT_ITERATOR_RANGE_H
+
+#include <utility>
+
+namespace llvm {
+
+// A pair of iterators usable in a range-based for loop.
+template <typename IteratorT>
+class iterator_range {
+ public:
+  iterator_range(IteratorT begin_iterator, IteratorT end_iterator)
+      : Begin(std::move(begin_iterator)), End(std::move(end_iterator)) {}
+
+  auto begin() const -> IteratorT { return Begin; }
+  auto end() const -> IteratorT { return End; }
+  auto empty() const -> bool { return Begin == End; }
+
+ private:
+  IteratorT Begin;
+  IteratorT End;
+};
+
+template <typename T>
+auto make_range(T begin_iterator, T end_iterator) -> iterator_range<T> {
+  return iterator_range<T>(std::move(begin_iterator), std::move(end_iterator));
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_ADT_ITERATOR_RANGE_H
@@ -0,0 +1,12 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_CONFIG_LLVM_CONFIG_H
+#define COMMANDLINE_STANDALONE_LLVM_CONFIG_LLVM_CONFIG_H
+
+// What --version reports for the standalone build.
+#ifndef PACKAGE_NAME
+#define PACKAGE_NAME "commandline"
+#endif
+#ifndef PACKAGE_VERSION
+#define PACKAGE_VERSION "standalone"
+#endif
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_CONFIG_LLVM_CONFIG_H
@@ -0,0 +1,57 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ALLOCATOR_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "llvm/Support/MemAlloc.h"
+
+namespace llvm {
+
+// An arena handing out memory from growing slabs. Memory is only released
+// when the allocator is reset or destroyed.
+class BumpPtrAllocator {
+ public:
+  BumpPtrAllocator() = default;
+  BumpPtrAllocator(BumpPtrAllocator&& other) noexcept;
+  auto operator=(BumpPtrAllocator&& other) noexcept -> BumpPtrAllocator&;
+  BumpPtrAllocator(const BumpPtrAllocator&) = delete;
+  auto operator=(const BumpPtrAllocator&) -> BumpPtrAllocator& = delete;
+  ~BumpPtrAllocator();
+
+  auto Allocate(size_t size, size_t alignment) -> void*;
+  template <typename T>
+  auto Allocate(size_t num = 1) -> T* {
+    return static_cast<T*>(Allocate(num * sizeof(T), alignof(T)));
+  }
+  void Deallocate(const void* /*ptr*/, size_t /*size*/,
+                  size_t /*alignment*/) {}
+
+  // Free every slab but the first.
+  void Reset();
+
+  auto getBytesAllocated() const -> size_t { return BytesAllocated; }
+  auto getTotalMemory() const -> size_t;
+
+ private:
+  struct Slab {
+    char* Begin;
+    size_t Size;
+  };
+
+  static constexpr size_t slab_size = 4096;
+  static constexpr size_t size_threshold = slab_size;
+
+  void releaseAll();
+
+  char* Cur = nullptr;
+  char* End = nullptr;
+  std::vector<Slab> Slabs;
+  std::vector<Slab> CustomSlabs;
+  size_t BytesAllocated = 0;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ALLOCATOR_H
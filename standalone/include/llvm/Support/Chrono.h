@@ -0,0 +1,21 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_CHRONO_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_CHRONO_H
+
+#include <chrono>
+#include <ctime>
+
+namespace llvm {
+namespace sys {
+
+template <typename D = std::chrono::nanoseconds>
+using TimePoint = std::chrono::time_point<std::chrono::system_clock, D>;
+
+inline auto toTimeT(TimePoint<> time) -> std::time_t {
+  return std::chrono::system_clock::to_time_t(
+      std::chrono::time_point_cast<std::chrono::system_clock::duration>(time));
+}
+
+}  // namespace sys
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_CHRONO_H
@@ -0,0 +1,12 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_COMPILER_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_COMPILER_H
+
+// Makes clang reject a global whose initialization would run at startup.
+#if defined(__clang__)
+#define LLVM_REQUIRE_CONSTANT_INITIALIZATION \
+  [[clang::require_constant_initialization]]
+#else
+#define LLVM_REQUIRE_CONSTANT_INITIALIZATION
+#endif
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_COMPILER_H
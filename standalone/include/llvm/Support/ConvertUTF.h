@@ -0,0 +1,19 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_CONVERTUTF_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_CONVERTUTF_H
+
+#include <string>
+
+#include "llvm/ADT/ArrayRef.h"
+
+namespace llvm {
+
+// Whether src starts with a UTF-16 byte order mark, in either byte order.
+auto hasUTF16ByteOrderMark(ArrayRef<char> src) -> bool;
+
+// Convert UTF-16 text, starting with a byte order mark or in host byte order,
+// to UTF-8 in out. Return false if src is not valid UTF-16.
+auto convertUTF16ToUTF8String(ArrayRef<char> src, std::string& out) -> bool;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_CONVERTUTF_H
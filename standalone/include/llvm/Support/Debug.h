@@ -0,0 +1,19 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_DEBUG_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_DEBUG_H
+
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+
+// The stream for debug output.
+auto dbgs() -> raw_ostream&;
+
+}  // namespace llvm
+
+// Debug output is only available with LLVM's -debug flag, which the
+// standalone build does not have.
+#define LLVM_DEBUG(X) \
+  do {                \
+  } while (false)
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_DEBUG_H
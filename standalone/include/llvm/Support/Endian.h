@@ -0,0 +1,36 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ENDIAN_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ENDIAN_H
+
+#include <cstdint>
+#include <type_traits>
+
+namespace llvm {
+namespace support {
+
+enum endianness { big, little, native = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                                            ? big
+                                            : little };
+
+namespace endian {
+
+template <typename T>
+auto byte_swap(T value, endianness endian) -> T {
+  static_assert(std::is_integral_v<T>, "byte_swap needs an integer");
+  if (endian == native) {
+    return value;
+  }
+  using U = std::make_unsigned_t<T>;
+  U bits = static_cast<U>(value);
+  U swapped = 0;
+  for (unsigned i = 0; i < sizeof(T); ++i) {
+    swapped = static_cast<U>((swapped << 8) | (bits & 0xff));
+    bits = static_cast<U>(bits >> 8);
+  }
+  return static_cast<T>(swapped);
+}
+
+}  // namespace endian
+}  // namespace support
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ENDIAN_H
@@ -0,0 +1,42 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRC_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRC_H
+
+#include <system_error>
+
+namespace llvm {
+
+// Portable error codes that, unlike std::errc, convert to std::error_code.
+enum class errc {
+  argument_out_of_domain = static_cast<int>(std::errc::argument_out_of_domain),
+  bad_address = static_cast<int>(std::errc::bad_address),
+  bad_file_descriptor = static_cast<int>(std::errc::bad_file_descriptor),
+  device_or_resource_busy =
+      static_cast<int>(std::errc::device_or_resource_busy),
+  file_exists = static_cast<int>(std::errc::file_exists),
+  file_too_large = static_cast<int>(std::errc::file_too_large),
+  illegal_byte_sequence = static_cast<int>(std::errc::illegal_byte_sequence),
+  invalid_argument = static_cast<int>(std::errc::invalid_argument),
+  io_error = static_cast<int>(std::errc::io_error),
+  is_a_directory = static_cast<int>(std::errc::is_a_directory),
+  no_such_file_or_directory =
+      static_cast<int>(std::errc::no_such_file_or_directory),
+  not_a_directory = static_cast<int>(std::errc::not_a_directory),
+  not_supported = static_cast<int>(std::errc::not_supported),
+  operation_not_permitted =
+      static_cast<int>(std::errc::operation_not_permitted),
+  permission_denied = static_cast<int>(std::errc::permission_denied),
+  result_out_of_range = static_cast<int>(std::errc::result_out_of_range),
+};
+
+inline auto make_error_code(errc error) -> std::error_code {
+  return std::error_code(static_cast<int>(error), std::generic_category());
+}
+
+}  // namespace llvm
+
+namespace std {
+template <>
+struct is_error_code_enum<llvm::errc> : std::true_type {};
+}  // namespace std
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRC_H
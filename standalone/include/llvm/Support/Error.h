@@ -0,0 +1,150 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROR_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROR_H
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/ErrorOr.h"
+
+namespace llvm {
+
+class raw_ostream;
+
+// The payload of a failed Error.
+class ErrorInfoBase {
+ public:
+  virtual ~ErrorInfoBase() = default;
+  virtual auto message() const -> std::string = 0;
+  virtual auto convertToErrorCode() const -> std::error_code = 0;
+};
+
+// An error carrying a message and an error code.
+class StringError : public ErrorInfoBase {
+ public:
+  StringError(std::error_code code, const Twine& message)
+      : Message(message.str()), Code(code) {}
+  StringError(const Twine& message, std::error_code code)
+      : StringError(code, message) {}
+
+  auto message() const -> std::string override { return Message; }
+  auto convertToErrorCode() const -> std::error_code override { return Code; }
+  auto getMessage() const -> const std::string& { return Message; }
+
+ private:
+  std::string Message;
+  std::error_code Code;
+};
+
+// Success or an error payload. Unlike LLVM's Error, an unchecked failure is
+// not diagnosed; it is simply dropped.
+class [[nodiscard]] Error {
+ public:
+  Error() = default;
+  Error(Error&& other) noexcept = default;
+  auto operator=(Error&& other) noexcept -> Error& = default;
+  explicit Error(std::unique_ptr<ErrorInfoBase> payload)
+      : Payload(std::move(payload)) {}
+
+  static auto success() -> Error { return Error(); }
+
+  explicit operator bool() const { return Payload != nullptr; }
+
+  auto takePayload() -> std::unique_ptr<ErrorInfoBase> {
+    return std::move(Payload);
+  }
+
+ private:
+  std::unique_ptr<ErrorInfoBase> Payload;
+};
+
+using ErrorSuccess = Error;
+
+template <typename ErrT, typename... ArgTs>
+auto make_error(ArgTs&&... args) -> Error {
+  return Error(std::make_unique<ErrT>(std::forward<ArgTs>(args)...));
+}
+
+inline auto createStringError(std::error_code code, const Twine& message)
+    -> Error {
+  return make_error<StringError>(code, message);
+}
+inline auto createStringError(std::errc code, const Twine& message) -> Error {
+  return createStringError(std::make_error_code(code), message);
+}
+
+// The code of errors that have no sensible std::error_code.
+auto inconvertibleErrorCode() -> std::error_code;
+
+inline auto errorCodeToError(std::error_code code) -> Error {
+  if (!code) {
+    return Error::success();
+  }
+  return createStringError(code, code.message());
+}
+
+inline auto errorToErrorCode(Error error) -> std::error_code {
+  std::unique_ptr<ErrorInfoBase> payload = error.takePayload();
+  return payload ? payload->convertToErrorCode() : std::error_code();
+}
+
+// Return the message of error, or "" on success.
+inline auto toString(Error error) -> std::string {
+  std::unique_ptr<ErrorInfoBase> payload = error.takePayload();
+  return payload ? payload->message() : std::string();
+}
+
+inline void consumeError(Error error) { (void)error.takePayload(); }
+
+inline auto errorToBool(Error error) -> bool {
+  return error.takePayload() != nullptr;
+}
+
+// A value or an Error.
+template <typename T>
+class [[nodiscard]] Expected {
+ public:
+  Expected(Error error) : Storage(std::in_place_index<1>, std::move(error)) {
+    assert(std::get<1>(Storage) && "Expected built from success");
+  }
+  template <typename U,
+            typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+  Expected(U&& value)
+      : Storage(std::in_place_index<0>, std::forward<U>(value)) {}
+
+  explicit operator bool() const { return Storage.index() == 0; }
+
+  auto takeError() -> Error {
+    return *this ? Error::success() : std::move(std::get<1>(Storage));
+  }
+
+  auto get() -> T& { return std::get<0>(Storage); }
+  auto get() const -> const T& { return std::get<0>(Storage); }
+  auto operator*() -> T& { return get(); }
+  auto operator*() const -> const T& { return get(); }
+  auto operator->() -> T* { return &get(); }
+  auto operator->() const -> const T* { return &get(); }
+
+ private:
+  std::variant<T, Error> Storage;
+};
+
+template <typename T>
+auto cantFail(Expected<T> value) -> T {
+  assert(value && "cantFail called on a failure");
+  return std::move(*value);
+}
+inline void cantFail(Error error) {
+  assert(!error && "cantFail called on a failure");
+  (void)error;
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROR_H
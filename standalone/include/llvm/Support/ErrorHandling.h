@@ -0,0 +1,26 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRORHANDLING_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRORHANDLING_H
+
+#include <string>
+
+namespace llvm {
+
+class Twine;
+
+// Print reason to stderr and abort.
+[[noreturn]] void report_fatal_error(const char* reason,
+                                     bool gen_crash_diag = true);
+[[noreturn]] void report_fatal_error(const std::string& reason,
+                                     bool gen_crash_diag = true);
+[[noreturn]] void report_fatal_error(const Twine& reason,
+                                     bool gen_crash_diag = true);
+
+[[noreturn]] void llvm_unreachable_internal(const char* message,
+                                            const char* file, unsigned line);
+
+}  // namespace llvm
+
+#define llvm_unreachable(msg) \
+  ::llvm::llvm_unreachable_internal(msg, __FILE__, __LINE__)
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERRORHANDLING_H
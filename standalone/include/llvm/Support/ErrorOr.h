@@ -0,0 +1,45 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROROR_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROROR_H
+
+#include <cassert>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace llvm {
+
+// Either a value or a std::error_code.
+template <typename T>
+class ErrorOr {
+ public:
+  template <typename E, typename = std::enable_if_t<
+                            std::is_error_code_enum<E>::value ||
+                            std::is_error_condition_enum<E>::value>>
+  ErrorOr(E error) : Storage(std::error_code(make_error_code(error))) {}
+  ErrorOr(std::error_code error) : Storage(error) {}
+  template <typename U,
+            typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+  ErrorOr(U&& value) : Storage(std::in_place_index<0>,
+                               std::forward<U>(value)) {}
+
+  explicit operator bool() const { return Storage.index() == 0; }
+
+  auto getError() const -> std::error_code {
+    return *this ? std::error_code() : std::get<1>(Storage);
+  }
+
+  auto get() -> T& { return std::get<0>(Storage); }
+  auto get() const -> const T& { return std::get<0>(Storage); }
+  auto operator*() -> T& { return get(); }
+  auto operator*() const -> const T& { return get(); }
+  auto operator->() -> T* { return &get(); }
+  auto operator->() const -> const T* { return &get(); }
+
+ private:
+  std::variant<T, std::error_code> Storage;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_ERROROR_H
@@ -0,0 +1,145 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_FILESYSTEM_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_FILESYSTEM_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Chrono.h"
+
+namespace llvm {
+namespace sys {
+namespace fs {
+
+enum OpenFlags : unsigned {
+  OF_None = 0,
+  OF_Text = 1,
+  OF_Append = 2,
+};
+
+enum class file_type {
+  status_error,
+  file_not_found,
+  regular_file,
+  directory_file,
+  symlink_file,
+  block_file,
+  character_file,
+  fifo_file,
+  socket_file,
+  type_unknown,
+};
+
+// The result of stat.
+class file_status {
+ public:
+  file_status() = default;
+  file_status(file_type type, uint64_t device, uint64_t inode, uint64_t size,
+              TimePoint<> modified, uint32_t permissions)
+      : Type(type),
+        Device(device),
+        Inode(inode),
+        Size(size),
+        Modified(modified),
+        Permissions(permissions) {}
+
+  auto type() const -> file_type { return Type; }
+  auto getSize() const -> uint64_t { return Size; }
+  auto getLastModificationTime() const -> TimePoint<> { return Modified; }
+  auto getUniqueID() const -> std::pair<uint64_t, uint64_t> {
+    return {Device, Inode};
+  }
+  auto permissions() const -> uint32_t { return Permissions; }
+
+ private:
+  file_type Type = file_type::status_error;
+  uint64_t Device = 0;
+  uint64_t Inode = 0;
+  uint64_t Size = 0;
+  TimePoint<> Modified;
+  uint32_t Permissions = 0;
+};
+
+auto equivalent(const file_status& lhs, const file_status& rhs) -> bool;
+
+// Stat path, following symlinks if follow is set.
+auto status(const Twine& path, file_status& result, bool follow = true)
+    -> std::error_code;
+auto exists(const Twine& path) -> bool;
+auto is_directory(const Twine& path) -> bool;
+auto is_regular_file(const Twine& path) -> bool;
+
+auto remove(const Twine& path, bool ignore_non_existing = true)
+    -> std::error_code;
+// Remove path and everything under it.
+auto remove_directories(const Twine& path, bool ignore_errors = true)
+    -> std::error_code;
+auto rename(const Twine& from, const Twine& to) -> std::error_code;
+auto create_directory(const Twine& path, bool ignore_existing = true)
+    -> std::error_code;
+auto create_directories(const Twine& path, bool ignore_existing = true)
+    -> std::error_code;
+auto current_path(SmallVectorImpl<char>& result) -> std::error_code;
+auto make_absolute(SmallVectorImpl<char>& path) -> std::error_code;
+
+// Create and open a file named after model, with each '%' replaced by a
+// random hex digit.
+auto createUniqueFile(const Twine& model, int& result_fd,
+                      SmallVectorImpl<char>& result_path) -> std::error_code;
+// Create and open prefix-%%%%%%.suffix in the temporary directory.
+auto createTemporaryFile(const Twine& prefix, StringRef suffix, int& result_fd,
+                         SmallVectorImpl<char>& result_path)
+    -> std::error_code;
+// Create prefix-%%%%%% in the temporary directory.
+auto createUniqueDirectory(const Twine& prefix,
+                           SmallVectorImpl<char>& result_path)
+    -> std::error_code;
+
+class directory_entry {
+ public:
+  directory_entry() = default;
+  explicit directory_entry(std::string path) : Path(std::move(path)) {}
+
+  auto path() const -> const std::string& { return Path; }
+  auto status(file_status& result) const -> std::error_code {
+    return fs::status(Path, result);
+  }
+
+ private:
+  std::string Path;
+};
+
+// Iterates the entries of a directory, other than "." and "..". A
+// default-constructed iterator is the end.
+class directory_iterator {
+ public:
+  directory_iterator() = default;
+  directory_iterator(const Twine& path, std::error_code& ec);
+
+  auto increment(std::error_code& ec) -> directory_iterator&;
+
+  auto operator*() const -> const directory_entry& { return Entry; }
+  auto operator->() const -> const directory_entry* { return &Entry; }
+  auto operator==(const directory_iterator& other) const -> bool {
+    return State == other.State;
+  }
+  auto operator!=(const directory_iterator& other) const -> bool {
+    return !(*this == other);
+  }
+
+ private:
+  struct DirState;
+
+  std::shared_ptr<DirState> State;
+  directory_entry Entry;
+};
+
+}  // namespace fs
+}  // namespace sys
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_FILESYSTEM_H
@@ -0,0 +1,114 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_FORMAT_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_FORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+
+// A printf-style format string and its arguments, printed by raw_ostream.
+class format_object_base {
+ public:
+  explicit format_object_base(const char* fmt) : Fmt(fmt) {}
+  virtual ~format_object_base() = default;
+
+  // Format into buffer of size bytes, returning the length the full output
+  // needs, as snprintf does.
+  virtual auto snprint(char* buffer, unsigned size) const -> int = 0;
+
+ protected:
+  const char* Fmt;
+};
+
+template <typename... Ts>
+class format_object final : public format_object_base {
+ public:
+  format_object(const char* fmt, const Ts&... values)
+      : format_object_base(fmt), Values(values...) {}
+
+  auto snprint(char* buffer, unsigned size) const -> int override {
+    return std::apply(
+        [&](const auto&... values) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+          return std::snprintf(buffer, size, Fmt, values...);
+#pragma GCC diagnostic pop
+        },
+        Values);
+  }
+
+ private:
+  std::tuple<Ts...> Values;
+};
+
+template <typename... Ts>
+auto format(const char* fmt, const Ts&... values) -> format_object<Ts...> {
+  return format_object<Ts...>(fmt, values...);
+}
+
+// A string padded to a width.
+class FormattedString {
+ public:
+  enum Justification { JustifyNone, JustifyLeft, JustifyRight, JustifyCenter };
+
+  FormattedString(StringRef str, unsigned width, Justification justify)
+      : Str(str), Width(width), Justify(justify) {}
+
+ private:
+  friend class raw_ostream;
+
+  StringRef Str;
+  unsigned Width;
+  Justification Justify;
+};
+
+inline auto left_justify(StringRef str, unsigned width) -> FormattedString {
+  return FormattedString(str, width, FormattedString::JustifyLeft);
+}
+inline auto right_justify(StringRef str, unsigned width) -> FormattedString {
+  return FormattedString(str, width, FormattedString::JustifyRight);
+}
+inline auto center_justify(StringRef str, unsigned width) -> FormattedString {
+  return FormattedString(str, width, FormattedString::JustifyCenter);
+}
+
+// A number printed in hexadecimal or decimal with a minimum width.
+class FormattedNumber {
+ public:
+  FormattedNumber(uint64_t value, unsigned width, bool hex, bool upper,
+                  bool prefix)
+      : Value(value), Width(width), Hex(hex), Upper(upper), Prefix(prefix) {}
+
+ private:
+  friend class raw_ostream;
+
+  uint64_t Value;
+  unsigned Width;
+  bool Hex;
+  bool Upper;
+  bool Prefix;
+};
+
+inline auto format_hex(uint64_t value, unsigned width, bool upper = false)
+    -> FormattedNumber {
+  return FormattedNumber(value, width, true, upper, true);
+}
+inline auto format_hex_no_prefix(uint64_t value, unsigned width,
+                                 bool upper = false) -> FormattedNumber {
+  return FormattedNumber(value, width, true, upper, false);
+}
+inline auto format_decimal(int64_t value, unsigned width) -> FormattedNumber {
+  return FormattedNumber(static_cast<uint64_t>(value), width, false, false,
+                         false);
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_FORMAT_H
@@ -0,0 +1,36 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_GLOBPATTERN_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_GLOBPATTERN_H
+
+#include <bitset>
+#include <optional>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+namespace llvm {
+
+// A shell glob: '*', '?', '[...]' and '[^...]' or '[!...]' sets, and '\' to
+// escape the next character.
+class GlobPattern {
+ public:
+  static auto create(StringRef pattern) -> Expected<GlobPattern>;
+  auto match(StringRef text) const -> bool;
+
+ private:
+  // Each token of the pattern: a set of characters, or a '*' when Star is
+  // set.
+  struct Token {
+    bool Star = false;
+    std::bitset<256> Chars;
+  };
+
+  static auto matchTokens(const Token* tokens, const Token* end,
+                          StringRef text) -> bool;
+
+  std::vector<Token> Tokens;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_GLOBPATTERN_H
@@ -0,0 +1,304 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_JSON_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_JSON_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace json {
+
+class Array;
+class Object;
+
+// A JSON value. Strings are always owned.
+class Value {
+ public:
+  enum Kind { Null, Boolean, Number, String, Array, Object };
+
+  Value() = default;
+  Value(const Value& other);
+  Value(Value&& other) noexcept = default;
+  auto operator=(const Value& other) -> Value&;
+  auto operator=(Value&& other) noexcept -> Value& = default;
+  ~Value();
+
+  Value(std::nullptr_t) {}
+  Value(bool value) : Type(T_Boolean), Bool(value) {}
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T> &&
+                                                    !std::is_same_v<T, bool>>>
+  Value(T value) {
+    if constexpr (std::is_unsigned_v<T>) {
+      if (static_cast<uint64_t>(value) > INT64_MAX) {
+        Type = T_UINT64;
+        Uint = static_cast<uint64_t>(value);
+        return;
+      }
+    }
+    Type = T_Integer;
+    Int = static_cast<int64_t>(value);
+  }
+  Value(double value) : Type(T_Double), Double(value) {}
+  Value(float value) : Value(static_cast<double>(value)) {}
+  Value(const char* value) : Value(StringRef(value)) {}
+  Value(StringRef value) : Type(T_String), Str(value.str()) {}
+  Value(const std::string& value) : Type(T_String), Str(value) {}
+  Value(std::string&& value) : Type(T_String), Str(std::move(value)) {}
+  Value(const json::Array& value);
+  Value(json::Array&& value);
+  Value(const json::Object& value);
+  Value(json::Object&& value);
+  Value(std::initializer_list<Value> values);
+
+  auto kind() const -> Kind;
+
+  auto getAsNull() const -> Optional<std::nullptr_t>;
+  auto getAsBoolean() const -> Optional<bool>;
+  auto getAsNumber() const -> Optional<double>;
+  auto getAsInteger() const -> Optional<int64_t>;
+  auto getAsUINT64() const -> Optional<uint64_t>;
+  auto getAsString() const -> Optional<StringRef>;
+  auto getAsObject() const -> const json::Object*;
+  auto getAsObject() -> json::Object*;
+  auto getAsArray() const -> const json::Array*;
+  auto getAsArray() -> json::Array*;
+
+ private:
+  friend class OStream;
+  friend auto operator==(const Value& lhs, const Value& rhs) -> bool;
+
+  enum ValueType {
+    T_Null,
+    T_Boolean,
+    T_Double,
+    T_Integer,
+    T_UINT64,
+    T_String,
+    T_Object,
+    T_Array,
+  };
+
+  ValueType Type = T_Null;
+  bool Bool = false;
+  double Double = 0;
+  int64_t Int = 0;
+  uint64_t Uint = 0;
+  std::string Str;
+  std::unique_ptr<json::Object> Obj;
+  std::unique_ptr<json::Array> Arr;
+};
+
+auto operator==(const Value& lhs, const Value& rhs) -> bool;
+inline auto operator!=(const Value& lhs, const Value& rhs) -> bool {
+  return !(lhs == rhs);
+}
+
+// A JSON array.
+class Array {
+ public:
+  using value_type = Value;
+  using iterator = std::vector<Value>::iterator;
+  using const_iterator = std::vector<Value>::const_iterator;
+
+  Array() = default;
+  Array(std::initializer_list<Value> values) : Elements(values) {}
+  template <typename Collection>
+  explicit Array(const Collection& collection) {
+    for (const auto& value : collection) {
+      emplace_back(value);
+    }
+  }
+
+  auto operator[](size_t index) -> Value& { return Elements[index]; }
+  auto operator[](size_t index) const -> const Value& {
+    return Elements[index];
+  }
+  auto front() -> Value& { return Elements.front(); }
+  auto back() -> Value& { return Elements.back(); }
+  auto begin() -> iterator { return Elements.begin(); }
+  auto end() -> iterator { return Elements.end(); }
+  auto begin() const -> const_iterator { return Elements.begin(); }
+  auto end() const -> const_iterator { return Elements.end(); }
+  auto empty() const -> bool { return Elements.empty(); }
+  auto size() const -> size_t { return Elements.size(); }
+  void reserve(size_t size) { Elements.reserve(size); }
+  void clear() { Elements.clear(); }
+  void push_back(const Value& value) { Elements.push_back(value); }
+  void push_back(Value&& value) { Elements.push_back(std::move(value)); }
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    Elements.emplace_back(std::forward<Args>(args)...);
+  }
+
+  friend auto operator==(const Array& lhs, const Array& rhs) -> bool {
+    return lhs.Elements == rhs.Elements;
+  }
+  friend auto operator!=(const Array& lhs, const Array& rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+ private:
+  std::vector<Value> Elements;
+};
+
+// A JSON object. Keys are kept sorted.
+class Object {
+  using Storage = std::map<std::string, Value, std::less<>>;
+
+ public:
+  using iterator = Storage::iterator;
+  using const_iterator = Storage::const_iterator;
+  using value_type = Storage::value_type;
+
+  struct KV {
+    std::string K;
+    Value V;
+  };
+
+  Object() = default;
+  Object(std::initializer_list<KV> properties) {
+    for (const KV& property : properties) {
+      Properties.emplace(property.K, property.V);
+    }
+  }
+
+  auto begin() -> iterator { return Properties.begin(); }
+  auto end() -> iterator { return Properties.end(); }
+  auto begin() const -> const_iterator { return Properties.begin(); }
+  auto end() const -> const_iterator { return Properties.end(); }
+  auto empty() const -> bool { return Properties.empty(); }
+  auto size() const -> size_t { return Properties.size(); }
+  void clear() { Properties.clear(); }
+
+  auto find(StringRef key) -> iterator { return Properties.find(key); }
+  auto find(StringRef key) const -> const_iterator {
+    return Properties.find(key);
+  }
+  auto erase(StringRef key) -> bool {
+    auto it = Properties.find(key);
+    if (it == Properties.end()) {
+      return false;
+    }
+    Properties.erase(it);
+    return true;
+  }
+  auto operator[](StringRef key) -> Value& { return Properties[key.str()]; }
+  template <typename... Args>
+  auto try_emplace(StringRef key, Args&&... args)
+      -> std::pair<iterator, bool> {
+    return Properties.try_emplace(key.str(), std::forward<Args>(args)...);
+  }
+
+  auto get(StringRef key) -> Value*;
+  auto get(StringRef key) const -> const Value*;
+  auto getNull(StringRef key) const -> Optional<std::nullptr_t>;
+  auto getBoolean(StringRef key) const -> Optional<bool>;
+  auto getNumber(StringRef key) const -> Optional<double>;
+  auto getInteger(StringRef key) const -> Optional<int64_t>;
+  auto getString(StringRef key) const -> Optional<StringRef>;
+  auto getObject(StringRef key) const -> const Object*;
+  auto getObject(StringRef key) -> Object*;
+  auto getArray(StringRef key) const -> const json::Array*;
+  auto getArray(StringRef key) -> json::Array*;
+
+  friend auto operator==(const Object& lhs, const Object& rhs) -> bool {
+    return lhs.Properties == rhs.Properties;
+  }
+  friend auto operator!=(const Object& lhs, const Object& rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+ private:
+  Storage Properties;
+};
+
+// Parse a JSON document.
+auto parse(StringRef text) -> Expected<Value>;
+
+// Whether text is valid UTF-8. On failure, the offset of the first invalid
+// byte is stored in error_offset if it is not null.
+auto isUTF8(StringRef text, size_t* error_offset = nullptr) -> bool;
+// Replace invalid UTF-8 sequences in text with U+FFFD.
+auto fixUTF8(StringRef text) -> std::string;
+
+// Writes JSON to a stream as it is produced, without building a Value.
+// With a non-zero indent the output is pretty-printed.
+class OStream {
+ public:
+  using Block = function_ref<void()>;
+
+  explicit OStream(raw_ostream& os, unsigned indent_size = 0)
+      : OS(os), IndentSize(indent_size) {
+    Stack.emplace_back();
+  }
+  ~OStream();
+
+  void value(const Value& value);
+  void array(Block contents) {
+    arrayBegin();
+    contents();
+    arrayEnd();
+  }
+  void object(Block contents) {
+    objectBegin();
+    contents();
+    objectEnd();
+  }
+
+  void attribute(StringRef key, const Value& contents) {
+    attributeImpl(key, [&] { value(contents); });
+  }
+  void attributeArray(StringRef key, Block contents) {
+    attributeImpl(key, [&] { array(contents); });
+  }
+  void attributeObject(StringRef key, Block contents) {
+    attributeImpl(key, [&] { object(contents); });
+  }
+
+  void arrayBegin();
+  void arrayEnd();
+  void objectBegin();
+  void objectEnd();
+  void attributeBegin(StringRef key);
+  void attributeEnd();
+
+  void flush() { OS.flush(); }
+
+ private:
+  enum Context { Singleton, Array, Object };
+  struct State {
+    Context Ctx = Singleton;
+    bool HasValue = false;
+  };
+
+  void attributeImpl(StringRef key, Block contents) {
+    attributeBegin(key);
+    contents();
+    attributeEnd();
+  }
+  void valueBegin();
+  void newline();
+
+  raw_ostream& OS;
+  SmallVector<State, 16> Stack;
+  unsigned IndentSize;
+  unsigned Indent = 0;
+};
+
+auto operator<<(raw_ostream& os, const Value& value) -> raw_ostream&;
+
+}  // namespace json
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_JSON_H
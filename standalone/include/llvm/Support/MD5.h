@@ -0,0 +1,55 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_MD5_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_MD5_H
+
+#include <array>
+#include <cstdint>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+// The MD5 message digest (RFC 1321). Used for cache keys, not security.
+class MD5 {
+ public:
+  struct MD5Result : std::array<uint8_t, 16> {
+    // The digest as 32 lowercase hex digits.
+    auto digest() const -> SmallString<32>;
+    auto low() const -> uint64_t;
+    auto high() const -> uint64_t;
+    auto words() const -> std::pair<uint64_t, uint64_t> {
+      return {low(), high()};
+    }
+  };
+
+  MD5();
+
+  void update(ArrayRef<uint8_t> data);
+  void update(StringRef data);
+  void final(MD5Result& result);
+  auto final() -> MD5Result {
+    MD5Result result;
+    final(result);
+    return result;
+  }
+  auto result() -> MD5Result { return final(); }
+
+  static auto hash(ArrayRef<uint8_t> data) -> MD5Result;
+
+ private:
+  auto body(const uint8_t* data, size_t size) -> const uint8_t*;
+
+  uint32_t A = 0x67452301;
+  uint32_t B = 0xefcdab89;
+  uint32_t C = 0x98badcfe;
+  uint32_t D = 0x10325476;
+  uint32_t Hi = 0;
+  uint32_t Lo = 0;
+  uint8_t Buffer[64];
+  uint32_t Block[16];
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_MD5_H
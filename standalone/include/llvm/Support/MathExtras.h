@@ -0,0 +1,33 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_MATHEXTRAS_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_MATHEXTRAS_H
+
+#include <cstdint>
+
+namespace llvm {
+
+constexpr auto isPowerOf2_64(uint64_t value) -> bool {
+  return value && !(value & (value - 1));
+}
+
+// The smallest power of two that is at least value; 0 for 0.
+constexpr auto NextPowerOf2(uint64_t value) -> uint64_t {
+  value |= value >> 1;
+  value |= value >> 2;
+  value |= value >> 4;
+  value |= value >> 8;
+  value |= value >> 16;
+  value |= value >> 32;
+  return value + 1;
+}
+
+constexpr auto PowerOf2Ceil(uint64_t value) -> uint64_t {
+  return value ? NextPowerOf2(value - 1) : 0;
+}
+
+constexpr auto alignTo(uint64_t value, uint64_t align) -> uint64_t {
+  return (value + align - 1) / align * align;
+}
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_MATHEXTRAS_H
@@ -0,0 +1,15 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMALLOC_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMALLOC_H
+
+#include <cstddef>
+
+namespace llvm {
+
+// malloc and realloc that abort instead of returning null.
+auto safe_malloc(size_t size) -> void*;
+auto safe_calloc(size_t count, size_t size) -> void*;
+auto safe_realloc(void* ptr, size_t size) -> void*;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMALLOC_H
@@ -0,0 +1,45 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMORYBUFFER_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMORYBUFFER_H
+
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ErrorOr.h"
+
+namespace llvm {
+
+// The contents of a file, read into memory and null-terminated.
+class MemoryBuffer {
+ public:
+  MemoryBuffer(std::string contents, std::string identifier)
+      : Contents(std::move(contents)), Identifier(std::move(identifier)) {}
+
+  // Read the file at filename; "-" reads standard input. The remaining
+  // parameters are accepted for compatibility: the file is always read, never
+  // mapped, so the buffer is always null-terminated.
+  static auto getFile(const Twine& filename, bool is_text = false,
+                      bool requires_null_terminator = true,
+                      bool is_volatile = false)
+      -> ErrorOr<std::unique_ptr<MemoryBuffer>>;
+  static auto getMemBuffer(StringRef data,
+                           StringRef identifier = "<unknown>")
+      -> std::unique_ptr<MemoryBuffer>;
+
+  auto getBufferStart() const -> const char* { return Contents.data(); }
+  auto getBufferEnd() const -> const char* {
+    return Contents.data() + Contents.size();
+  }
+  auto getBufferSize() const -> size_t { return Contents.size(); }
+  auto getBuffer() const -> StringRef { return Contents; }
+  auto getBufferIdentifier() const -> StringRef { return Identifier; }
+
+ private:
+  std::string Contents;
+  std::string Identifier;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_MEMORYBUFFER_H
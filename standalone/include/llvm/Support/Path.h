@@ -0,0 +1,40 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_PATH_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_PATH_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+
+namespace llvm {
+namespace sys {
+namespace path {
+
+// POSIX path manipulation; '/' is the only separator.
+
+// Append each non-empty component to path, adding separators as needed.
+void append(SmallVectorImpl<char>& path, const Twine& a, const Twine& b = "",
+            const Twine& c = "", const Twine& d = "");
+
+auto filename(StringRef path) -> StringRef;
+auto parent_path(StringRef path) -> StringRef;
+auto stem(StringRef path) -> StringRef;
+// The extension of the file name, including the dot.
+auto extension(StringRef path) -> StringRef;
+
+auto has_parent_path(const Twine& path) -> bool;
+auto has_filename(const Twine& path) -> bool;
+auto is_absolute(const Twine& path) -> bool;
+auto is_relative(const Twine& path) -> bool;
+auto is_separator(char c) -> bool;
+
+// Convert path to the native separator, a no-op on POSIX.
+void native(SmallVectorImpl<char>& path);
+void remove_filename(SmallVectorImpl<char>& path);
+void system_temp_directory(bool erased_on_reboot,
+                           SmallVectorImpl<char>& result);
+
+}  // namespace path
+}  // namespace sys
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_PATH_H
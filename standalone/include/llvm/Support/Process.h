@@ -0,0 +1,24 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_PROCESS_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_PROCESS_H
+
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+namespace sys {
+
+class Process {
+ public:
+  using Pid = long;
+
+  static auto getProcessId() -> Pid;
+  // The value of the environment variable name, if it is set.
+  static auto GetEnv(StringRef name) -> std::optional<std::string>;
+};
+
+}  // namespace sys
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_PROCESS_H
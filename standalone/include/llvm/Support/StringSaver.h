@@ -0,0 +1,30 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_STRINGSAVER_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_STRINGSAVER_H
+
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
+
+namespace llvm {
+
+// Copies strings into an allocator as null-terminated strings.
+class StringSaver {
+ public:
+  explicit StringSaver(BumpPtrAllocator& alloc) : Alloc(alloc) {}
+
+  auto save(const char* str) -> StringRef { return save(StringRef(str)); }
+  auto save(StringRef str) -> StringRef;
+  auto save(const Twine& str) -> StringRef { return save(StringRef(str.str())); }
+  auto save(const std::string& str) -> StringRef {
+    return save(StringRef(str));
+  }
+
+ private:
+  BumpPtrAllocator& Alloc;
+};
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_STRINGSAVER_H
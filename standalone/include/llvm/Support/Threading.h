@@ -0,0 +1,16 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_THREADING_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_THREADING_H
+
+#include <cstdint>
+
+namespace llvm {
+
+// The standalone build always supports threads.
+constexpr auto llvm_is_multithreaded() -> bool { return true; }
+
+// The operating system's ID of the calling thread.
+auto get_threadid() -> uint64_t;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_THREADING_H
@@ -0,0 +1,68 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_VIRTUALFILESYSTEM_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_VIRTUALFILESYSTEM_H
+
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace llvm {
+namespace vfs {
+
+// The status of a file in a FileSystem.
+class Status {
+ public:
+  Status() = default;
+  Status(const Twine& name, const sys::fs::file_status& status)
+      : Name(name.str()), FileStatus(status) {}
+
+  auto getName() const -> StringRef { return Name; }
+  auto getType() const -> sys::fs::file_type { return FileStatus.type(); }
+  auto getSize() const -> uint64_t { return FileStatus.getSize(); }
+  auto exists() const -> bool {
+    return getType() != sys::fs::file_type::file_not_found;
+  }
+  auto isDirectory() const -> bool {
+    return getType() == sys::fs::file_type::directory_file;
+  }
+  auto isRegularFile() const -> bool {
+    return getType() == sys::fs::file_type::regular_file;
+  }
+  auto equivalent(const Status& other) const -> bool {
+    return sys::fs::equivalent(FileStatus, other.FileStatus);
+  }
+
+ private:
+  std::string Name;
+  sys::fs::file_status FileStatus;
+};
+
+// The file system seen by response file expansion.
+class FileSystem {
+ public:
+  virtual ~FileSystem() = default;
+
+  virtual auto status(const Twine& path) -> ErrorOr<Status> = 0;
+  virtual auto getBufferForFile(const Twine& name)
+      -> ErrorOr<std::unique_ptr<MemoryBuffer>> = 0;
+  virtual auto getCurrentWorkingDirectory() const
+      -> ErrorOr<std::string> = 0;
+
+  auto exists(const Twine& path) -> bool { return static_cast<bool>(status(path)); }
+  // Make path absolute against the working directory.
+  auto makeAbsolute(SmallVectorImpl<char>& path) const -> std::error_code;
+};
+
+// The file system of the operating system.
+auto getRealFileSystem() -> std::shared_ptr<FileSystem>;
+
+}  // namespace vfs
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_VIRTUALFILESYSTEM_H
@@ -0,0 +1,224 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_RAW_OSTREAM_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_RAW_OSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+class format_object_base;
+class FormattedString;
+class FormattedNumber;
+class Twine;
+
+namespace sys {
+namespace fs {
+enum OpenFlags : unsigned;
+}  // namespace fs
+}  // namespace sys
+
+// An output stream with an optional buffer in front of write_impl, as in
+// LLVM's Support library.
+class raw_ostream {
+ public:
+  enum class Colors {
+    BLACK,
+    RED,
+    GREEN,
+    YELLOW,
+    BLUE,
+    MAGENTA,
+    CYAN,
+    WHITE,
+    SAVEDCOLOR,
+    RESET,
+  };
+
+  explicit raw_ostream(bool unbuffered = false) : Unbuffered(unbuffered) {}
+  raw_ostream(const raw_ostream&) = delete;
+  auto operator=(const raw_ostream&) -> raw_ostream& = delete;
+  virtual ~raw_ostream();
+
+  // The number of bytes written so far, buffered or not.
+  auto tell() const -> uint64_t { return current_pos() + Used; }
+
+  void SetUnbuffered() {
+    flush();
+    Unbuffered = true;
+  }
+  void SetBuffered() { Unbuffered = false; }
+  auto GetNumBytesInBuffer() const -> size_t { return Used; }
+
+  void flush() {
+    if (Used) {
+      flushBuffer();
+    }
+  }
+
+  auto operator<<(char c) -> raw_ostream& { return write(c); }
+  auto operator<<(unsigned char c) -> raw_ostream& {
+    return write(static_cast<char>(c));
+  }
+  auto operator<<(signed char c) -> raw_ostream& {
+    return write(static_cast<char>(c));
+  }
+  auto operator<<(StringRef str) -> raw_ostream& {
+    return write(str.data(), str.size());
+  }
+  auto operator<<(const char* str) -> raw_ostream& {
+    return *this << StringRef(str);
+  }
+  auto operator<<(const std::string& str) -> raw_ostream& {
+    return write(str.data(), str.size());
+  }
+  auto operator<<(std::string_view str) -> raw_ostream& {
+    return write(str.data(), str.size());
+  }
+  auto operator<<(const SmallVectorImpl<char>& str) -> raw_ostream& {
+    return write(str.data(), str.size());
+  }
+  auto operator<<(unsigned long value) -> raw_ostream&;
+  auto operator<<(long value) -> raw_ostream&;
+  auto operator<<(unsigned long long value) -> raw_ostream&;
+  auto operator<<(long long value) -> raw_ostream&;
+  auto operator<<(const void* ptr) -> raw_ostream&;
+  auto operator<<(unsigned int value) -> raw_ostream& {
+    return *this << static_cast<unsigned long>(value);
+  }
+  auto operator<<(int value) -> raw_ostream& {
+    return *this << static_cast<long>(value);
+  }
+  auto operator<<(double value) -> raw_ostream&;
+  auto operator<<(const format_object_base& format) -> raw_ostream&;
+  auto operator<<(const FormattedString& str) -> raw_ostream&;
+  auto operator<<(const FormattedNumber& number) -> raw_ostream&;
+
+  auto write(char c) -> raw_ostream& { return write(&c, 1); }
+  auto write(const char* ptr, size_t size) -> raw_ostream&;
+
+  // Write num_spaces spaces.
+  auto indent(unsigned num_spaces) -> raw_ostream&;
+
+  // Colors are not supported; these are no-ops.
+  virtual auto changeColor(Colors /*color*/, bool /*bold*/ = false,
+                           bool /*background*/ = false) -> raw_ostream& {
+    return *this;
+  }
+  virtual auto resetColor() -> raw_ostream& { return *this; }
+  virtual auto is_displayed() const -> bool { return false; }
+  virtual auto has_colors() const -> bool { return false; }
+  void enable_colors(bool /*enable*/) {}
+
+ protected:
+  // Write size bytes at ptr to the underlying sink.
+  virtual void write_impl(const char* ptr, size_t size) = 0;
+  // The number of bytes written to the sink, excluding the buffer.
+  virtual auto current_pos() const -> uint64_t = 0;
+  virtual auto preferred_buffer_size() const -> size_t;
+
+ private:
+  void flushBuffer();
+
+  std::unique_ptr<char[]> Buffer;
+  size_t BufferSize = 0;
+  size_t Used = 0;
+  bool Unbuffered;
+};
+
+auto operator<<(raw_ostream& os, const Twine& twine) -> raw_ostream&;
+
+// A stream writing to a file descriptor.
+class raw_fd_ostream : public raw_ostream {
+ public:
+  raw_fd_ostream(int fd, bool should_close, bool unbuffered = false);
+  raw_fd_ostream(StringRef filename, std::error_code& ec);
+  raw_fd_ostream(StringRef filename, std::error_code& ec,
+                 sys::fs::OpenFlags flags);
+  ~raw_fd_ostream() override;
+
+  void close();
+  auto has_error() const -> bool { return static_cast<bool>(Error); }
+  auto error() const -> std::error_code { return Error; }
+  void clear_error() { Error = std::error_code(); }
+  auto getFD() const -> int { return FD; }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override;
+  auto current_pos() const -> uint64_t override { return Pos; }
+
+  int FD = -1;
+  bool ShouldClose = false;
+  uint64_t Pos = 0;
+  std::error_code Error;
+};
+
+// A stream appending to a std::string. Unbuffered, so the string is always
+// up to date.
+class raw_string_ostream : public raw_ostream {
+ public:
+  explicit raw_string_ostream(std::string& str)
+      : raw_ostream(/*unbuffered=*/true), Str(str) {}
+  ~raw_string_ostream() override;
+
+  auto str() -> std::string& {
+    flush();
+    return Str;
+  }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override {
+    Str.append(ptr, size);
+  }
+  auto current_pos() const -> uint64_t override { return Str.size(); }
+
+  std::string& Str;
+};
+
+// A stream appending to a SmallVector of chars.
+class raw_svector_ostream : public raw_ostream {
+ public:
+  explicit raw_svector_ostream(SmallVectorImpl<char>& str)
+      : raw_ostream(/*unbuffered=*/true), Str(str) {}
+  ~raw_svector_ostream() override;
+
+  auto str() const -> StringRef { return StringRef(Str.data(), Str.size()); }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override {
+    Str.append(ptr, ptr + size);
+  }
+  auto current_pos() const -> uint64_t override { return Str.size(); }
+
+  SmallVectorImpl<char>& Str;
+};
+
+// A stream that discards what is written to it.
+class raw_null_ostream : public raw_ostream {
+ public:
+  raw_null_ostream() : raw_ostream(/*unbuffered=*/true) {}
+  ~raw_null_ostream() override;
+
+ private:
+  void write_impl(const char* /*ptr*/, size_t size) override { Pos += size; }
+  auto current_pos() const -> uint64_t override { return Pos; }
+
+  uint64_t Pos = 0;
+};
+
+// Standard output, buffered.
+auto outs() -> raw_fd_ostream&;
+// Standard error, unbuffered.
+auto errs() -> raw_fd_ostream&;
+// A stream that discards its output.
+auto nulls() -> raw_ostream&;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_RAW_OSTREAM_H
@@ -0,0 +1,17 @@
+#ifndef COMMANDLINE_STANDALONE_LLVM_SUPPORT_XXHASH_H
+#define COMMANDLINE_STANDALONE_LLVM_SUPPORT_XXHASH_H
+
+#include <cstdint>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+// The 64-bit xxHash of data, with seed 0.
+auto xxHash64(StringRef data) -> uint64_t;
+auto xxHash64(ArrayRef<uint8_t> data) -> uint64_t;
+
+}  // namespace llvm
+
+#endif  // COMMANDLINE_STANDALONE_LLVM_SUPPORT_XXHASH_H
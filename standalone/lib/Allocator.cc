@@ -0,0 +1,123 @@
+#include "llvm/Support/Allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "llvm/Support/StringSaver.h"
+
+namespace llvm {
+
+BumpPtrAllocator::BumpPtrAllocator(BumpPtrAllocator&& other) noexcept
+    : Cur(other.Cur),
+      End(other.End),
+      Slabs(std::move(other.Slabs)),
+      CustomSlabs(std::move(other.CustomSlabs)),
+      BytesAllocated(other.BytesAllocated) {
+  other.Cur = other.End = nullptr;
+  other.Slabs.clear();
+  other.CustomSlabs.clear();
+  other.BytesAllocated = 0;
+}
+
+auto BumpPtrAllocator::operator=(BumpPtrAllocator&& other) noexcept
+    -> BumpPtrAllocator& {
+  if (this != &other) {
+    releaseAll();
+    Cur = other.Cur;
+    End = other.End;
+    Slabs = std::move(other.Slabs);
+    CustomSlabs = std::move(other.CustomSlabs);
+    BytesAllocated = other.BytesAllocated;
+    other.Cur = other.End = nullptr;
+    other.Slabs.clear();
+    other.CustomSlabs.clear();
+    other.BytesAllocated = 0;
+  }
+  return *this;
+}
+
+BumpPtrAllocator::~BumpPtrAllocator() { releaseAll(); }
+
+void BumpPtrAllocator::releaseAll() {
+  for (const Slab& slab : Slabs) {
+    std::free(slab.Begin);
+  }
+  for (const Slab& slab : CustomSlabs) {
+    std::free(slab.Begin);
+  }
+  Slabs.clear();
+  CustomSlabs.clear();
+  Cur = End = nullptr;
+}
+
+auto BumpPtrAllocator::Allocate(size_t size, size_t alignment) -> void* {
+  BytesAllocated += size;
+  auto align = [alignment](char* ptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    return reinterpret_cast<char*>((address + alignment - 1) &
+                                   ~(uintptr_t(alignment) - 1));
+  };
+  if (Cur) {
+    char* aligned = align(Cur);
+    if (aligned + size <= End) {
+      Cur = aligned + size;
+      return aligned;
+    }
+  }
+  size_t padded = size + alignment - 1;
+  if (padded > size_threshold) {
+    // Large allocations get a slab of their own.
+    char* slab = static_cast<char*>(safe_malloc(padded));
+    CustomSlabs.push_back({slab, padded});
+    return align(slab);
+  }
+  // Slabs double in size every 128 slabs, as in LLVM.
+  size_t slab_bytes = slab_size << std::min<size_t>(Slabs.size() / 128, 30);
+  char* slab = static_cast<char*>(safe_malloc(slab_bytes));
+  Slabs.push_back({slab, slab_bytes});
+  End = slab + slab_bytes;
+  char* aligned = align(slab);
+  Cur = aligned + size;
+  return aligned;
+}
+
+void BumpPtrAllocator::Reset() {
+  for (const Slab& slab : CustomSlabs) {
+    std::free(slab.Begin);
+  }
+  CustomSlabs.clear();
+  BytesAllocated = 0;
+  if (Slabs.empty()) {
+    return;
+  }
+  for (size_t i = 1; i < Slabs.size(); ++i) {
+    std::free(Slabs[i].Begin);
+  }
+  Slabs.resize(1);
+  Cur = Slabs.front().Begin;
+  End = Cur + Slabs.front().Size;
+}
+
+auto BumpPtrAllocator::getTotalMemory() const -> size_t {
+  size_t total = 0;
+  for (const Slab& slab : Slabs) {
+    total += slab.Size;
+  }
+  for (const Slab& slab : CustomSlabs) {
+    total += slab.Size;
+  }
+  return total;
+}
+
+auto StringSaver::save(StringRef str) -> StringRef {
+  char* copy = Alloc.Allocate<char>(str.size() + 1);
+  if (!str.empty()) {
+    std::memcpy(copy, str.data(), str.size());
+  }
+  copy[str.size()] = '\0';
+  return StringRef(copy, str.size());
+}
+
+}  // namespace llvm
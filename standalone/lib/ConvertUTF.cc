@@ -0,0 +1,84 @@
+#include "llvm/Support/ConvertUTF.h"
+
+#include <cstdint>
+
+namespace llvm {
+
+namespace {
+
+constexpr uint16_t byte_order_mark = 0xFEFF;
+constexpr uint16_t swapped_byte_order_mark = 0xFFFE;
+
+void appendUTF8(uint32_t rune, std::string& out) {
+  if (rune < 0x80) {
+    out.push_back(static_cast<char>(rune));
+  } else if (rune < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (rune >> 6)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  } else if (rune < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (rune >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (rune >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  }
+}
+
+auto readUnit(const char* p, bool swap) -> uint16_t {
+  uint16_t unit;
+  auto* bytes = reinterpret_cast<unsigned char*>(&unit);
+  bytes[swap ? 1 : 0] = static_cast<unsigned char>(p[0]);
+  bytes[swap ? 0 : 1] = static_cast<unsigned char>(p[1]);
+  return unit;
+}
+
+}  // namespace
+
+auto hasUTF16ByteOrderMark(ArrayRef<char> src) -> bool {
+  return src.size() >= 2 &&
+         ((src[0] == '\xff' && src[1] == '\xfe') ||
+          (src[0] == '\xfe' && src[1] == '\xff'));
+}
+
+auto convertUTF16ToUTF8String(ArrayRef<char> src, std::string& out) -> bool {
+  if (src.size() % 2) {
+    return false;
+  }
+  out.clear();
+  const char* p = src.data();
+  const char* end = p + src.size();
+  bool swap = false;
+  if (p != end) {
+    uint16_t first = readUnit(p, false);
+    if (first == byte_order_mark) {
+      p += 2;
+    } else if (first == swapped_byte_order_mark) {
+      swap = true;
+      p += 2;
+    }
+  }
+  while (p != end) {
+    uint32_t unit = readUnit(p, swap);
+    p += 2;
+    if (unit >= 0xD800 && unit < 0xDC00) {
+      if (p == end) {
+        return false;
+      }
+      uint32_t low = readUnit(p, swap);
+      if (low < 0xDC00 || low >= 0xE000) {
+        return false;
+      }
+      p += 2;
+      unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+    } else if (unit >= 0xDC00 && unit < 0xE000) {
+      return false;
+    }
+    appendUTF8(unit, out);
+  }
+  return true;
+}
+
+}  // namespace llvm
@@ -0,0 +1,72 @@
+#include "llvm/Support/ErrorHandling.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemAlloc.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+
+void report_fatal_error(const char* reason, bool gen_crash_diag) {
+  report_fatal_error(Twine(reason), gen_crash_diag);
+}
+
+void report_fatal_error(const std::string& reason, bool gen_crash_diag) {
+  report_fatal_error(Twine(reason), gen_crash_diag);
+}
+
+void report_fatal_error(const Twine& reason, bool gen_crash_diag) {
+  errs() << "LLVM ERROR: " << reason << '\n';
+  if (gen_crash_diag) {
+    std::abort();
+  }
+  std::exit(1);
+}
+
+void llvm_unreachable_internal(const char* message, const char* file,
+                               unsigned line) {
+  errs() << (message ? message : "UNREACHABLE executed") << " at " << file
+         << ':' << line << '\n';
+  std::abort();
+}
+
+auto inconvertibleErrorCode() -> std::error_code {
+  // LLVM uses a dedicated category; any code that is never produced by the
+  // system serves here.
+  return std::error_code(-1, std::generic_category());
+}
+
+auto dbgs() -> raw_ostream& { return errs(); }
+
+auto safe_malloc(size_t size) -> void* {
+  void* result = std::malloc(size);
+  if (!result && (size || !(result = std::malloc(1)))) {
+    report_fatal_error("Allocation failed");
+  }
+  return result;
+}
+
+auto safe_calloc(size_t count, size_t size) -> void* {
+  void* result = std::calloc(count, size);
+  if (!result && (count == 0 || size == 0)) {
+    result = std::malloc(1);
+  }
+  if (!result) {
+    report_fatal_error("Allocation failed");
+  }
+  return result;
+}
+
+auto safe_realloc(void* ptr, size_t size) -> void* {
+  void* result = std::realloc(ptr, size);
+  if (!result && (size || !(result = std::malloc(1)))) {
+    report_fatal_error("Allocation failed");
+  }
+  return result;
+}
+
+}  // namespace llvm
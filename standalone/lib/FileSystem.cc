@@ -0,0 +1,341 @@
+#include "llvm/Support/FileSystem.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <random>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+
+namespace llvm {
+namespace sys {
+namespace fs {
+
+namespace {
+
+auto lastError() -> std::error_code {
+  return std::error_code(errno, std::generic_category());
+}
+
+auto typeOf(mode_t mode) -> file_type {
+  if (S_ISREG(mode)) {
+    return file_type::regular_file;
+  }
+  if (S_ISDIR(mode)) {
+    return file_type::directory_file;
+  }
+  if (S_ISLNK(mode)) {
+    return file_type::symlink_file;
+  }
+  if (S_ISBLK(mode)) {
+    return file_type::block_file;
+  }
+  if (S_ISCHR(mode)) {
+    return file_type::character_file;
+  }
+  if (S_ISFIFO(mode)) {
+    return file_type::fifo_file;
+  }
+  if (S_ISSOCK(mode)) {
+    return file_type::socket_file;
+  }
+  return file_type::type_unknown;
+}
+
+// Replace each '%' in model with a random hex digit.
+auto fillModel(const Twine& model) -> std::string {
+  static thread_local std::mt19937_64 random(std::random_device{}());
+  std::string path = model.str();
+  for (char& c : path) {
+    if (c == '%') {
+      c = "0123456789abcdef"[random() & 15];
+    }
+  }
+  return path;
+}
+
+// Prefix model with the temporary directory.
+auto tempModel(const Twine& prefix, StringRef suffix) -> std::string {
+  SmallString<128> model;
+  path::system_temp_directory(true, model);
+  std::string name = prefix.str() + "-%%%%%%";
+  if (!suffix.empty()) {
+    name += '.';
+    name += suffix;
+  }
+  path::append(model, name);
+  return model.str().str();
+}
+
+void assign(SmallVectorImpl<char>& result, StringRef text) {
+  result.assign(text.begin(), text.end());
+}
+
+}  // namespace
+
+auto equivalent(const file_status& lhs, const file_status& rhs) -> bool {
+  return lhs.getUniqueID() == rhs.getUniqueID();
+}
+
+auto status(const Twine& path, file_status& result, bool follow)
+    -> std::error_code {
+  struct stat info;
+  std::string name = path.str();
+  int rc = follow ? ::stat(name.c_str(), &info) : ::lstat(name.c_str(), &info);
+  if (rc != 0) {
+    std::error_code ec = lastError();
+    result = file_status(ec == std::errc::no_such_file_or_directory
+                             ? file_type::file_not_found
+                             : file_type::status_error,
+                         0, 0, 0, TimePoint<>(), 0);
+    return ec;
+  }
+#if defined(__APPLE__)
+  auto modified = std::chrono::seconds(info.st_mtimespec.tv_sec) +
+                  std::chrono::nanoseconds(info.st_mtimespec.tv_nsec);
+#else
+  auto modified = std::chrono::seconds(info.st_mtim.tv_sec) +
+                  std::chrono::nanoseconds(info.st_mtim.tv_nsec);
+#endif
+  result = file_status(
+      typeOf(info.st_mode), info.st_dev, info.st_ino, info.st_size,
+      TimePoint<>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          modified)),
+      info.st_mode & 07777);
+  return std::error_code();
+}
+
+auto exists(const Twine& path) -> bool {
+  std::string name = path.str();
+  return ::access(name.c_str(), F_OK) == 0;
+}
+
+auto is_directory(const Twine& path) -> bool {
+  file_status result;
+  return !status(path, result) && result.type() == file_type::directory_file;
+}
+
+auto is_regular_file(const Twine& path) -> bool {
+  file_status result;
+  return !status(path, result) && result.type() == file_type::regular_file;
+}
+
+auto remove(const Twine& path, bool ignore_non_existing) -> std::error_code {
+  std::string name = path.str();
+  if (::remove(name.c_str()) != 0) {
+    std::error_code ec = lastError();
+    if (!ignore_non_existing || ec != std::errc::no_such_file_or_directory) {
+      return ec;
+    }
+  }
+  return std::error_code();
+}
+
+auto remove_directories(const Twine& path, bool ignore_errors)
+    -> std::error_code {
+  std::string name = path.str();
+  std::error_code ec;
+  directory_iterator it(name, ec);
+  for (directory_iterator end; !ec && it != end; it.increment(ec)) {
+    file_status entry;
+    std::error_code entry_ec = status(it->path(), entry, /*follow=*/false);
+    if (!entry_ec && entry.type() == file_type::directory_file) {
+      entry_ec = remove_directories(it->path(), ignore_errors);
+    } else if (!entry_ec) {
+      entry_ec = remove(it->path());
+    }
+    if (entry_ec && !ignore_errors) {
+      return entry_ec;
+    }
+  }
+  if (ec && !ignore_errors) {
+    return ec;
+  }
+  if (::rmdir(name.c_str()) != 0 && !ignore_errors) {
+    return lastError();
+  }
+  return std::error_code();
+}
+
+auto rename(const Twine& from, const Twine& to) -> std::error_code {
+  std::string source = from.str();
+  std::string target = to.str();
+  if (::rename(source.c_str(), target.c_str()) != 0) {
+    return lastError();
+  }
+  return std::error_code();
+}
+
+auto create_directory(const Twine& path, bool ignore_existing)
+    -> std::error_code {
+  std::string name = path.str();
+  if (::mkdir(name.c_str(), 0770) != 0) {
+    std::error_code ec = lastError();
+    if (ec != std::errc::file_exists || !ignore_existing) {
+      return ec;
+    }
+  }
+  return std::error_code();
+}
+
+auto create_directories(const Twine& path, bool ignore_existing)
+    -> std::error_code {
+  std::string name = path.str();
+  StringRef parent = path::parent_path(name);
+  if (!parent.empty() && !exists(parent)) {
+    if (std::error_code ec = create_directories(parent, ignore_existing)) {
+      return ec;
+    }
+  }
+  return create_directory(name, ignore_existing);
+}
+
+auto current_path(SmallVectorImpl<char>& result) -> std::error_code {
+  result.resize(256);
+  while (!::getcwd(result.data(), result.size())) {
+    if (errno != ERANGE) {
+      result.clear();
+      return lastError();
+    }
+    result.resize(result.size() * 2);
+  }
+  result.truncate(StringRef(result.data()).size());
+  return std::error_code();
+}
+
+auto make_absolute(SmallVectorImpl<char>& path) -> std::error_code {
+  StringRef text(path.data(), path.size());
+  if (path::is_absolute(text)) {
+    return std::error_code();
+  }
+  SmallString<128> absolute;
+  if (std::error_code ec = current_path(absolute)) {
+    return ec;
+  }
+  path::append(absolute, text);
+  assign(path, absolute.str());
+  return std::error_code();
+}
+
+auto createUniqueFile(const Twine& model, int& result_fd,
+                      SmallVectorImpl<char>& result_path) -> std::error_code {
+  for (int attempt = 0; attempt < 128; ++attempt) {
+    std::string path = fillModel(model);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd >= 0) {
+      result_fd = fd;
+      assign(result_path, path);
+      return std::error_code();
+    }
+    if (errno != EEXIST) {
+      return lastError();
+    }
+  }
+  return std::make_error_code(std::errc::file_exists);
+}
+
+auto createTemporaryFile(const Twine& prefix, StringRef suffix, int& result_fd,
+                         SmallVectorImpl<char>& result_path)
+    -> std::error_code {
+  return createUniqueFile(tempModel(prefix, suffix), result_fd, result_path);
+}
+
+auto createUniqueDirectory(const Twine& prefix,
+                           SmallVectorImpl<char>& result_path)
+    -> std::error_code {
+  std::string model = tempModel(prefix, "");
+  for (int attempt = 0; attempt < 128; ++attempt) {
+    std::string path = fillModel(model);
+    if (::mkdir(path.c_str(), 0700) == 0) {
+      assign(result_path, path);
+      return std::error_code();
+    }
+    if (errno != EEXIST) {
+      return lastError();
+    }
+  }
+  return std::make_error_code(std::errc::file_exists);
+}
+
+struct directory_iterator::DirState {
+  ~DirState() { ::closedir(Dir); }
+
+  DIR* Dir;
+  std::string Path;
+};
+
+directory_iterator::directory_iterator(const Twine& path,
+                                       std::error_code& ec) {
+  std::string name = path.str();
+  DIR* dir = ::opendir(name.c_str());
+  if (!dir) {
+    ec = lastError();
+    return;
+  }
+  State = std::make_shared<DirState>();
+  State->Dir = dir;
+  State->Path = std::move(name);
+  increment(ec);
+}
+
+auto directory_iterator::increment(std::error_code& ec)
+    -> directory_iterator& {
+  ec = std::error_code();
+  while (State) {
+    errno = 0;
+    dirent* entry = ::readdir(State->Dir);
+    if (!entry) {
+      if (errno) {
+        ec = lastError();
+      }
+      State.reset();
+      Entry = directory_entry();
+      break;
+    }
+    StringRef name(entry->d_name);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    SmallString<128> path(StringRef(State->Path));
+    path::append(path, name);
+    Entry = directory_entry(path.str().str());
+    break;
+  }
+  return *this;
+}
+
+}  // namespace fs
+
+auto Process::getProcessId() -> Pid { return static_cast<Pid>(::getpid()); }
+
+auto Process::GetEnv(StringRef name) -> std::optional<std::string> {
+  std::string key = name.str();
+  const char* value = std::getenv(key.c_str());
+  if (!value) {
+    return std::nullopt;
+  }
+  return std::string(value);
+}
+
+}  // namespace sys
+
+auto get_threadid() -> uint64_t {
+#if defined(__linux__)
+  return static_cast<uint64_t>(::syscall(SYS_gettid));
+#else
+  static_assert(sizeof(pthread_t) <= sizeof(uint64_t), "pthread_t too wide");
+  return reinterpret_cast<uint64_t>(pthread_self());
+#endif
+}
+
+}  // namespace llvm
@@ -0,0 +1,101 @@
+#include "llvm/Support/GlobPattern.h"
+
+namespace llvm {
+
+namespace {
+
+auto patternError(const Twine& message) -> Error {
+  return createStringError(errc::invalid_argument, message);
+}
+
+}  // namespace
+
+auto GlobPattern::create(StringRef pattern) -> Expected<GlobPattern> {
+  GlobPattern glob;
+  size_t i = 0;
+  while (i < pattern.size()) {
+    Token token;
+    char c = pattern[i++];
+    if (c == '*') {
+      token.Star = true;
+    } else if (c == '?') {
+      token.Chars.set();
+    } else if (c == '[') {
+      bool negate = i < pattern.size() &&
+                    (pattern[i] == '^' || pattern[i] == '!');
+      if (negate) {
+        ++i;
+      }
+      // A ']' right after the opening bracket is literal.
+      size_t close = pattern.find(']', i + 1);
+      if (close == StringRef::npos) {
+        return patternError("invalid glob pattern: " + pattern);
+      }
+      StringRef set = pattern.slice(i, close);
+      for (size_t j = 0; j < set.size(); ++j) {
+        if (j + 2 < set.size() && set[j + 1] == '-') {
+          unsigned char first = set[j];
+          unsigned char last = set[j + 2];
+          if (first > last) {
+            return patternError("invalid glob pattern: " + pattern);
+          }
+          for (unsigned ch = first; ch <= last; ++ch) {
+            token.Chars.set(ch);
+          }
+          j += 2;
+        } else {
+          token.Chars.set(static_cast<unsigned char>(set[j]));
+        }
+      }
+      if (negate) {
+        token.Chars.flip();
+      }
+      i = close + 1;
+    } else {
+      if (c == '\\') {
+        if (i == pattern.size()) {
+          return patternError("invalid glob pattern, stray '\\'");
+        }
+        c = pattern[i++];
+      }
+      token.Chars.set(static_cast<unsigned char>(c));
+    }
+    glob.Tokens.push_back(token);
+  }
+  return glob;
+}
+
+auto GlobPattern::matchTokens(const Token* tokens, const Token* end,
+                              StringRef text) -> bool {
+  // Backtrack to the most recent '*', as in the classic wildcard matcher.
+  const Token* star = nullptr;
+  size_t star_text = 0;
+  size_t i = 0;
+  while (i < text.size() || tokens != end) {
+    if (tokens != end) {
+      if (tokens->Star) {
+        star = tokens++;
+        star_text = i;
+        continue;
+      }
+      if (i < text.size() &&
+          tokens->Chars.test(static_cast<unsigned char>(text[i]))) {
+        ++tokens;
+        ++i;
+        continue;
+      }
+    }
+    if (!star || star_text == text.size()) {
+      return false;
+    }
+    tokens = star + 1;
+    i = ++star_text;
+  }
+  return true;
+}
+
+auto GlobPattern::match(StringRef text) const -> bool {
+  return matchTokens(Tokens.data(), Tokens.data() + Tokens.size(), text);
+}
+
+}  // namespace llvm
@@ -0,0 +1,764 @@
+#include "llvm/Support/JSON.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+
+namespace llvm {
+namespace json {
+
+Value::Value(const Value& other)
+    : Type(other.Type),
+      Bool(other.Bool),
+      Double(other.Double),
+      Int(other.Int),
+      Uint(other.Uint),
+      Str(other.Str),
+      Obj(other.Obj ? std::make_unique<json::Object>(*other.Obj) : nullptr),
+      Arr(other.Arr ? std::make_unique<json::Array>(*other.Arr) : nullptr) {}
+
+auto Value::operator=(const Value& other) -> Value& {
+  if (this != &other) {
+    Value copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+Value::~Value() = default;
+
+Value::Value(const json::Array& value)
+    : Type(T_Array), Arr(std::make_unique<json::Array>(value)) {}
+Value::Value(json::Array&& value)
+    : Type(T_Array), Arr(std::make_unique<json::Array>(std::move(value))) {}
+Value::Value(const json::Object& value)
+    : Type(T_Object), Obj(std::make_unique<json::Object>(value)) {}
+Value::Value(json::Object&& value)
+    : Type(T_Object), Obj(std::make_unique<json::Object>(std::move(value))) {}
+Value::Value(std::initializer_list<Value> values)
+    : Value(json::Array(values)) {}
+
+auto Value::kind() const -> Kind {
+  switch (Type) {
+    case T_Null:
+      return Null;
+    case T_Boolean:
+      return Boolean;
+    case T_Double:
+    case T_Integer:
+    case T_UINT64:
+      return Number;
+    case T_String:
+      return String;
+    case T_Object:
+      return Object;
+    case T_Array:
+      return Array;
+  }
+  return Null;
+}
+
+auto Value::getAsNull() const -> Optional<std::nullptr_t> {
+  if (Type == T_Null) {
+    return nullptr;
+  }
+  return None;
+}
+
+auto Value::getAsBoolean() const -> Optional<bool> {
+  if (Type == T_Boolean) {
+    return Bool;
+  }
+  return None;
+}
+
+auto Value::getAsNumber() const -> Optional<double> {
+  switch (Type) {
+    case T_Double:
+      return Double;
+    case T_Integer:
+      return static_cast<double>(Int);
+    case T_UINT64:
+      return static_cast<double>(Uint);
+    default:
+      return None;
+  }
+}
+
+auto Value::getAsInteger() const -> Optional<int64_t> {
+  if (Type == T_Integer) {
+    return Int;
+  }
+  if (Type == T_Double) {
+    double rounded = std::round(Double);
+    if (rounded == Double && rounded >= -9.2233720368547758e18 &&
+        rounded < 9.2233720368547758e18) {
+      return static_cast<int64_t>(Double);
+    }
+  }
+  return None;
+}
+
+auto Value::getAsUINT64() const -> Optional<uint64_t> {
+  if (Type == T_UINT64) {
+    return Uint;
+  }
+  if (Type == T_Integer && Int >= 0) {
+    return static_cast<uint64_t>(Int);
+  }
+  return None;
+}
+
+auto Value::getAsString() const -> Optional<StringRef> {
+  if (Type == T_String) {
+    return StringRef(Str);
+  }
+  return None;
+}
+
+auto Value::getAsObject() const -> const json::Object* {
+  return Type == T_Object ? Obj.get() : nullptr;
+}
+auto Value::getAsObject() -> json::Object* {
+  return Type == T_Object ? Obj.get() : nullptr;
+}
+auto Value::getAsArray() const -> const json::Array* {
+  return Type == T_Array ? Arr.get() : nullptr;
+}
+auto Value::getAsArray() -> json::Array* {
+  return Type == T_Array ? Arr.get() : nullptr;
+}
+
+auto operator==(const Value& lhs, const Value& rhs) -> bool {
+  if (lhs.kind() != rhs.kind()) {
+    return false;
+  }
+  switch (lhs.kind()) {
+    case Value::Null:
+      return true;
+    case Value::Boolean:
+      return lhs.Bool == rhs.Bool;
+    case Value::Number:
+      // Integers compare exactly; anything else as doubles.
+      if (lhs.Type == Value::T_Integer && rhs.Type == Value::T_Integer) {
+        return lhs.Int == rhs.Int;
+      }
+      if (lhs.Type == Value::T_UINT64 && rhs.Type == Value::T_UINT64) {
+        return lhs.Uint == rhs.Uint;
+      }
+      return *lhs.getAsNumber() == *rhs.getAsNumber();
+    case Value::String:
+      return lhs.Str == rhs.Str;
+    case Value::Array:
+      return *lhs.Arr == *rhs.Arr;
+    case Value::Object:
+      return *lhs.Obj == *rhs.Obj;
+  }
+  return false;
+}
+
+auto Object::get(StringRef key) -> Value* {
+  auto it = Properties.find(key);
+  return it == Properties.end() ? nullptr : &it->second;
+}
+
+auto Object::get(StringRef key) const -> const Value* {
+  auto it = Properties.find(key);
+  return it == Properties.end() ? nullptr : &it->second;
+}
+
+auto Object::getNull(StringRef key) const -> Optional<std::nullptr_t> {
+  const Value* value = get(key);
+  return value ? value->getAsNull() : None;
+}
+
+auto Object::getBoolean(StringRef key) const -> Optional<bool> {
+  const Value* value = get(key);
+  return value ? value->getAsBoolean() : None;
+}
+
+auto Object::getNumber(StringRef key) const -> Optional<double> {
+  const Value* value = get(key);
+  return value ? value->getAsNumber() : None;
+}
+
+auto Object::getInteger(StringRef key) const -> Optional<int64_t> {
+  const Value* value = get(key);
+  return value ? value->getAsInteger() : None;
+}
+
+auto Object::getString(StringRef key) const -> Optional<StringRef> {
+  const Value* value = get(key);
+  return value ? value->getAsString() : None;
+}
+
+auto Object::getObject(StringRef key) const -> const Object* {
+  const Value* value = get(key);
+  return value ? value->getAsObject() : nullptr;
+}
+
+auto Object::getObject(StringRef key) -> Object* {
+  Value* value = get(key);
+  return value ? value->getAsObject() : nullptr;
+}
+
+auto Object::getArray(StringRef key) const -> const json::Array* {
+  const Value* value = get(key);
+  return value ? value->getAsArray() : nullptr;
+}
+
+auto Object::getArray(StringRef key) -> json::Array* {
+  Value* value = get(key);
+  return value ? value->getAsArray() : nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// Parsing.
+
+namespace {
+
+class Parser {
+ public:
+  explicit Parser(StringRef text) : Start(text.begin()), P(text.begin()),
+                                    End(text.end()) {}
+
+  auto checkUTF8() -> bool {
+    size_t error_offset;
+    if (isUTF8(StringRef(Start, End - Start), &error_offset)) {
+      return true;
+    }
+    P = Start + error_offset;
+    return parseError("Invalid UTF-8 sequence");
+  }
+
+  auto parseValue(Value& out) -> bool;
+
+  auto assertEnd() -> bool {
+    eatWhitespace();
+    if (P == End) {
+      return true;
+    }
+    return parseError("Text after end of document");
+  }
+
+  auto takeError() -> Error { return std::move(Err); }
+
+ private:
+  void eatWhitespace() {
+    while (P != End && (*P == ' ' || *P == '\r' || *P == '\n' || *P == '\t')) {
+      ++P;
+    }
+  }
+
+  auto next() -> char { return P == End ? 0 : *P++; }
+  auto peek() const -> char { return P == End ? 0 : *P; }
+
+  auto parseNumber(char first, Value& out) -> bool;
+  auto parseString(std::string& out) -> bool;
+  auto parseUnicode(std::string& out) -> bool;
+  auto parseError(const char* message) -> bool;
+
+  const char* Start;
+  const char* P;
+  const char* End;
+  Error Err;
+};
+
+auto Parser::parseValue(Value& out) -> bool {
+  eatWhitespace();
+  if (P == End) {
+    return parseError("Unexpected EOF");
+  }
+  switch (char c = next()) {
+    case 'n':
+      out = nullptr;
+      return (next() == 'u' && next() == 'l' && next() == 'l') ||
+             parseError("Invalid JSON value (null?)");
+    case 't':
+      out = true;
+      return (next() == 'r' && next() == 'u' && next() == 'e') ||
+             parseError("Invalid JSON value (true?)");
+    case 'f':
+      out = false;
+      return (next() == 'a' && next() == 'l' && next() == 's' &&
+              next() == 'e') ||
+             parseError("Invalid JSON value (false?)");
+    case '"': {
+      std::string text;
+      if (parseString(text)) {
+        out = std::move(text);
+        return true;
+      }
+      return false;
+    }
+    case '[': {
+      out = json::Array{};
+      json::Array& array = *out.getAsArray();
+      eatWhitespace();
+      if (peek() == ']') {
+        ++P;
+        return true;
+      }
+      for (;;) {
+        array.emplace_back(nullptr);
+        if (!parseValue(array.back())) {
+          return false;
+        }
+        eatWhitespace();
+        switch (next()) {
+          case ',':
+            eatWhitespace();
+            continue;
+          case ']':
+            return true;
+          default:
+            return parseError("Expected , or ] after array element");
+        }
+      }
+    }
+    case '{': {
+      out = json::Object{};
+      json::Object& object = *out.getAsObject();
+      eatWhitespace();
+      if (peek() == '}') {
+        ++P;
+        return true;
+      }
+      for (;;) {
+        if (next() != '"') {
+          return parseError("Expected object key");
+        }
+        std::string key;
+        if (!parseString(key)) {
+          return false;
+        }
+        eatWhitespace();
+        if (next() != ':') {
+          return parseError("Expected : after object key");
+        }
+        eatWhitespace();
+        if (!object.try_emplace(key, nullptr).second) {
+          return parseError("Duplicate key");
+        }
+        if (!parseValue(object[key])) {
+          return false;
+        }
+        eatWhitespace();
+        switch (next()) {
+          case ',':
+            eatWhitespace();
+            continue;
+          case '}':
+            return true;
+          default:
+            return parseError("Expected , or } after object property");
+        }
+      }
+    }
+    default:
+      if (isDigit(c) || c == '-') {
+        return parseNumber(c, out);
+      }
+      return parseError("Invalid JSON value");
+  }
+}
+
+auto Parser::parseNumber(char first, Value& out) -> bool {
+  std::string text(1, first);
+  while (P != End && (isDigit(*P) || *P == '+' || *P == '-' || *P == 'e' ||
+                      *P == 'E' || *P == '.')) {
+    text.push_back(*P++);
+  }
+  char* end;
+  // Prefer an exact integer when the text is one.
+  errno = 0;
+  int64_t integer = std::strtoll(text.c_str(), &end, 10);
+  if (end == text.c_str() + text.size() && errno == 0) {
+    out = integer;
+    return true;
+  }
+  errno = 0;
+  uint64_t unsigned_integer = std::strtoull(text.c_str(), &end, 10);
+  if (first != '-' && end == text.c_str() + text.size() && errno == 0) {
+    out = unsigned_integer;
+    return true;
+  }
+  double value = std::strtod(text.c_str(), &end);
+  if (end != text.c_str() + text.size()) {
+    return parseError("Invalid JSON value (number?)");
+  }
+  out = value;
+  return true;
+}
+
+auto Parser::parseString(std::string& out) -> bool {
+  for (char c = next(); c != '"'; c = next()) {
+    if (P > End) {
+      return parseError("Unterminated string");
+    }
+    if (c == 0 && P == End) {
+      return parseError("Unterminated string");
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+      return parseError("Control character in string");
+    }
+    if (c != '\\') {
+      out.push_back(c);
+      continue;
+    }
+    switch (c = next()) {
+      case '"':
+      case '\\':
+      case '/':
+        out.push_back(c);
+        break;
+      case 'b':
+        out.push_back('\b');
+        break;
+      case 'f':
+        out.push_back('\f');
+        break;
+      case 'n':
+        out.push_back('\n');
+        break;
+      case 'r':
+        out.push_back('\r');
+        break;
+      case 't':
+        out.push_back('\t');
+        break;
+      case 'u':
+        if (!parseUnicode(out)) {
+          return false;
+        }
+        break;
+      default:
+        return parseError("Invalid escape sequence");
+    }
+  }
+  return true;
+}
+
+void encodeUTF8(uint32_t rune, std::string& out) {
+  if (rune < 0x80) {
+    out.push_back(static_cast<char>(rune));
+  } else if (rune < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (rune >> 6)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  } else if (rune < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (rune >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (rune >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((rune >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (rune & 0x3F)));
+  }
+}
+
+auto Parser::parseUnicode(std::string& out) -> bool {
+  auto parse4 = [this](uint16_t& unit) {
+    unit = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = next();
+      if (!isHexDigit(c)) {
+        return false;
+      }
+      unit = static_cast<uint16_t>(unit << 4 | hexDigitValue(c));
+    }
+    return true;
+  };
+  uint16_t first;
+  if (!parse4(first)) {
+    return parseError("Invalid \\u escape sequence");
+  }
+  // Unpaired surrogates become U+FFFD, as in LLVM.
+  if (first < 0xD800 || first >= 0xE000) {
+    encodeUTF8(first, out);
+    return true;
+  }
+  if (first >= 0xDC00 || peek() != '\\' || P + 1 == End || P[1] != 'u') {
+    encodeUTF8(0xFFFD, out);
+    return true;
+  }
+  P += 2;
+  uint16_t second;
+  if (!parse4(second)) {
+    return parseError("Invalid \\u escape sequence");
+  }
+  if (second < 0xDC00 || second >= 0xE000) {
+    encodeUTF8(0xFFFD, out);
+    encodeUTF8(second, out);
+    return true;
+  }
+  encodeUTF8(0x10000 + ((first - 0xD800) << 10) + (second - 0xDC00), out);
+  return true;
+}
+
+auto Parser::parseError(const char* message) -> bool {
+  unsigned line = 0;
+  const char* line_start = Start;
+  for (const char* c = Start; c != P && c != End; ++c) {
+    if (*c == '\n') {
+      ++line;
+      line_start = c + 1;
+    }
+  }
+  Err = createStringError(
+      inconvertibleErrorCode(),
+      Twine("[") + Twine(line + 1) + ":" + Twine(P - line_start) + ", byte=" +
+          Twine(P - Start) + "]: " + message);
+  return false;
+}
+
+}  // namespace
+
+auto parse(StringRef text) -> Expected<Value> {
+  Parser parser(text);
+  Value result;
+  if (parser.checkUTF8() && parser.parseValue(result) && parser.assertEnd()) {
+    return result;
+  }
+  return parser.takeError();
+}
+
+// Return the length of the UTF-8 sequence starting at text, or 0 if it is
+// invalid.
+static auto sequenceLength(const unsigned char* text, size_t size) -> size_t {
+  unsigned char c = text[0];
+  if (c < 0x80) {
+    return 1;
+  }
+  size_t length;
+  uint32_t rune;
+  if ((c & 0xE0) == 0xC0) {
+    length = 2;
+    rune = c & 0x1F;
+  } else if ((c & 0xF0) == 0xE0) {
+    length = 3;
+    rune = c & 0x0F;
+  } else if ((c & 0xF8) == 0xF0) {
+    length = 4;
+    rune = c & 0x07;
+  } else {
+    return 0;
+  }
+  if (size < length) {
+    return 0;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if ((text[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    rune = rune << 6 | (text[i] & 0x3F);
+  }
+  // Reject overlong forms, surrogates and values past U+10FFFF.
+  static const uint32_t minimum[] = {0, 0, 0x80, 0x800, 0x10000};
+  if (rune < minimum[length] || rune > 0x10FFFF ||
+      (rune >= 0xD800 && rune < 0xE000)) {
+    return 0;
+  }
+  return length;
+}
+
+auto isUTF8(StringRef text, size_t* error_offset) -> bool {
+  const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+  size_t i = 0;
+  while (i < text.size()) {
+    size_t length = sequenceLength(data + i, text.size() - i);
+    if (!length) {
+      if (error_offset) {
+        *error_offset = i;
+      }
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+auto fixUTF8(StringRef text) -> std::string {
+  const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+  std::string result;
+  size_t i = 0;
+  while (i < text.size()) {
+    size_t length = sequenceLength(data + i, text.size() - i);
+    if (!length) {
+      encodeUTF8(0xFFFD, result);
+      ++i;
+      continue;
+    }
+    result.append(text.data() + i, length);
+    i += length;
+  }
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Writing.
+
+static void quote(raw_ostream& os, StringRef text) {
+  os << '"';
+  for (unsigned char c : text) {
+    if (c == '"' || c == '\\') {
+      os << '\\';
+    }
+    if (c >= 0x20) {
+      os << c;
+      continue;
+    }
+    os << '\\';
+    switch (c) {
+      case '\t':
+        os << 't';
+        break;
+      case '\n':
+        os << 'n';
+        break;
+      case '\r':
+        os << 'r';
+        break;
+      default:
+        os << 'u' << format_hex_no_prefix(c, 4);
+        break;
+    }
+  }
+  os << '"';
+}
+
+OStream::~OStream() {
+  assert(Stack.size() == 1 && "Unmatched begin()/end()");
+}
+
+void OStream::valueBegin() {
+  assert(Stack.back().Ctx != Object && "Only attributes allowed here");
+  if (Stack.back().HasValue) {
+    assert(Stack.back().Ctx != Singleton && "Only one value allowed here");
+    OS << ',';
+  }
+  if (Stack.back().Ctx == Array) {
+    newline();
+  }
+  Stack.back().HasValue = true;
+}
+
+void OStream::newline() {
+  if (IndentSize) {
+    OS << '\n';
+    OS.indent(Indent);
+  }
+}
+
+void OStream::value(const Value& value) {
+  switch (value.kind()) {
+    case Value::Null:
+      valueBegin();
+      OS << "null";
+      return;
+    case Value::Boolean:
+      valueBegin();
+      OS << (*value.getAsBoolean() ? "true" : "false");
+      return;
+    case Value::Number:
+      valueBegin();
+      if (value.Type == Value::T_Integer) {
+        OS << value.Int;
+      } else if (value.Type == Value::T_UINT64) {
+        OS << value.Uint;
+      } else {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.*g",
+                      std::numeric_limits<double>::max_digits10,
+                      value.Double);
+        OS << buffer;
+      }
+      return;
+    case Value::String:
+      valueBegin();
+      quote(OS, *value.getAsString());
+      return;
+    case Value::Array:
+      return array([&] {
+        for (const Value& element : *value.getAsArray()) {
+          this->value(element);
+        }
+      });
+    case Value::Object:
+      return object([&] {
+        for (const auto& property : *value.getAsObject()) {
+          attribute(property.first, property.second);
+        }
+      });
+  }
+}
+
+void OStream::arrayBegin() {
+  valueBegin();
+  Stack.emplace_back();
+  Stack.back().Ctx = Array;
+  Indent += IndentSize;
+  OS << '[';
+}
+
+void OStream::arrayEnd() {
+  assert(Stack.back().Ctx == Array);
+  Indent -= IndentSize;
+  if (Stack.back().HasValue) {
+    newline();
+  }
+  OS << ']';
+  Stack.pop_back();
+}
+
+void OStream::objectBegin() {
+  valueBegin();
+  Stack.emplace_back();
+  Stack.back().Ctx = Object;
+  Indent += IndentSize;
+  OS << '{';
+}
+
+void OStream::objectEnd() {
+  assert(Stack.back().Ctx == Object);
+  Indent -= IndentSize;
+  if (Stack.back().HasValue) {
+    newline();
+  }
+  OS << '}';
+  Stack.pop_back();
+}
+
+void OStream::attributeBegin(StringRef key) {
+  assert(Stack.back().Ctx == Object && "Only attributes allowed here");
+  if (Stack.back().HasValue) {
+    OS << ',';
+  }
+  newline();
+  Stack.back().HasValue = true;
+  Stack.emplace_back();
+  Stack.back().Ctx = Singleton;
+  quote(OS, key);
+  OS << ':';
+  if (IndentSize) {
+    OS << ' ';
+  }
+}
+
+void OStream::attributeEnd() {
+  assert(Stack.back().Ctx == Singleton);
+  assert(Stack.back().HasValue && "Attribute must have a value");
+  Stack.pop_back();
+}
+
+auto operator<<(raw_ostream& os, const Value& value) -> raw_ostream& {
+  OStream(os).value(value);
+  return os;
+}
+
+}  // namespace json
+}  // namespace llvm
@@ -0,0 +1,230 @@
+// An implementation of MD5 after Alexander Peslyak's public domain version,
+// which LLVM's also follows.
+
+#include "llvm/Support/MD5.h"
+
+#include <cstring>
+
+namespace llvm {
+
+namespace {
+
+inline auto F(uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+  return z ^ (x & (y ^ z));
+}
+inline auto G(uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+  return y ^ (z & (x ^ y));
+}
+inline auto H(uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+  return x ^ y ^ z;
+}
+inline auto I(uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+  return y ^ (x | ~z);
+}
+
+template <typename Fn>
+inline void step(Fn f, uint32_t& a, uint32_t b, uint32_t c, uint32_t d,
+                 uint32_t x, uint32_t t, unsigned s) {
+  a += f(b, c, d) + x + t;
+  a = (a << s) | (a >> (32 - s));
+  a += b;
+}
+
+}  // namespace
+
+MD5::MD5() = default;
+
+auto MD5::body(const uint8_t* data, size_t size) -> const uint8_t* {
+  const uint8_t* ptr = data;
+  uint32_t a = A;
+  uint32_t b = B;
+  uint32_t c = C;
+  uint32_t d = D;
+
+  do {
+    uint32_t saved_a = a;
+    uint32_t saved_b = b;
+    uint32_t saved_c = c;
+    uint32_t saved_d = d;
+
+    for (int i = 0; i < 16; ++i) {
+      Block[i] = uint32_t(ptr[i * 4]) | uint32_t(ptr[i * 4 + 1]) << 8 |
+                 uint32_t(ptr[i * 4 + 2]) << 16 | uint32_t(ptr[i * 4 + 3]) << 24;
+    }
+    const uint32_t* x = Block;
+
+    step(F, a, b, c, d, x[0], 0xd76aa478, 7);
+    step(F, d, a, b, c, x[1], 0xe8c7b756, 12);
+    step(F, c, d, a, b, x[2], 0x242070db, 17);
+    step(F, b, c, d, a, x[3], 0xc1bdceee, 22);
+    step(F, a, b, c, d, x[4], 0xf57c0faf, 7);
+    step(F, d, a, b, c, x[5], 0x4787c62a, 12);
+    step(F, c, d, a, b, x[6], 0xa8304613, 17);
+    step(F, b, c, d, a, x[7], 0xfd469501, 22);
+    step(F, a, b, c, d, x[8], 0x698098d8, 7);
+    step(F, d, a, b, c, x[9], 0x8b44f7af, 12);
+    step(F, c, d, a, b, x[10], 0xffff5bb1, 17);
+    step(F, b, c, d, a, x[11], 0x895cd7be, 22);
+    step(F, a, b, c, d, x[12], 0x6b901122, 7);
+    step(F, d, a, b, c, x[13], 0xfd987193, 12);
+    step(F, c, d, a, b, x[14], 0xa679438e, 17);
+    step(F, b, c, d, a, x[15], 0x49b40821, 22);
+
+    step(G, a, b, c, d, x[1], 0xf61e2562, 5);
+    step(G, d, a, b, c, x[6], 0xc040b340, 9);
+    step(G, c, d, a, b, x[11], 0x265e5a51, 14);
+    step(G, b, c, d, a, x[0], 0xe9b6c7aa, 20);
+    step(G, a, b, c, d, x[5], 0xd62f105d, 5);
+    step(G, d, a, b, c, x[10], 0x02441453, 9);
+    step(G, c, d, a, b, x[15], 0xd8a1e681, 14);
+    step(G, b, c, d, a, x[4], 0xe7d3fbc8, 20);
+    step(G, a, b, c, d, x[9], 0x21e1cde6, 5);
+    step(G, d, a, b, c, x[14], 0xc33707d6, 9);
+    step(G, c, d, a, b, x[3], 0xf4d50d87, 14);
+    step(G, b, c, d, a, x[8], 0x455a14ed, 20);
+    step(G, a, b, c, d, x[13], 0xa9e3e905, 5);
+    step(G, d, a, b, c, x[2], 0xfcefa3f8, 9);
+    step(G, c, d, a, b, x[7], 0x676f02d9, 14);
+    step(G, b, c, d, a, x[12], 0x8d2a4c8a, 20);
+
+    step(H, a, b, c, d, x[5], 0xfffa3942, 4);
+    step(H, d, a, b, c, x[8], 0x8771f681, 11);
+    step(H, c, d, a, b, x[11], 0x6d9d6122, 16);
+    step(H, b, c, d, a, x[14], 0xfde5380c, 23);
+    step(H, a, b, c, d, x[1], 0xa4beea44, 4);
+    step(H, d, a, b, c, x[4], 0x4bdecfa9, 11);
+    step(H, c, d, a, b, x[7], 0xf6bb4b60, 16);
+    step(H, b, c, d, a, x[10], 0xbebfbc70, 23);
+    step(H, a, b, c, d, x[13], 0x289b7ec6, 4);
+    step(H, d, a, b, c, x[0], 0xeaa127fa, 11);
+    step(H, c, d, a, b, x[3], 0xd4ef3085, 16);
+    step(H, b, c, d, a, x[6], 0x04881d05, 23);
+    step(H, a, b, c, d, x[9], 0xd9d4d039, 4);
+    step(H, d, a, b, c, x[12], 0xe6db99e5, 11);
+    step(H, c, d, a, b, x[15], 0x1fa27cf8, 16);
+    step(H, b, c, d, a, x[2], 0xc4ac5665, 23);
+
+    step(I, a, b, c, d, x[0], 0xf4292244, 6);
+    step(I, d, a, b, c, x[7], 0x432aff97, 10);
+    step(I, c, d, a, b, x[14], 0xab9423a7, 15);
+    step(I, b, c, d, a, x[5], 0xfc93a039, 21);
+    step(I, a, b, c, d, x[12], 0x655b59c3, 6);
+    step(I, d, a, b, c, x[3], 0x8f0ccc92, 10);
+    step(I, c, d, a, b, x[10], 0xffeff47d, 15);
+    step(I, b, c, d, a, x[1], 0x85845dd1, 21);
+    step(I, a, b, c, d, x[8], 0x6fa87e4f, 6);
+    step(I, d, a, b, c, x[15], 0xfe2ce6e0, 10);
+    step(I, c, d, a, b, x[6], 0xa3014314, 15);
+    step(I, b, c, d, a, x[13], 0x4e0811a1, 21);
+    step(I, a, b, c, d, x[4], 0xf7537e82, 6);
+    step(I, d, a, b, c, x[11], 0xbd3af235, 10);
+    step(I, c, d, a, b, x[2], 0x2ad7d2bb, 15);
+    step(I, b, c, d, a, x[9], 0xeb86d391, 21);
+
+    a += saved_a;
+    b += saved_b;
+    c += saved_c;
+    d += saved_d;
+
+    ptr += 64;
+  } while (size -= 64);
+
+  A = a;
+  B = b;
+  C = c;
+  D = d;
+  return ptr;
+}
+
+void MD5::update(ArrayRef<uint8_t> data) {
+  const uint8_t* ptr = data.begin();
+  size_t size = data.size();
+
+  uint32_t saved_lo = Lo;
+  if ((Lo = (saved_lo + size) & 0x1fffffff) < saved_lo) {
+    ++Hi;
+  }
+  Hi += static_cast<uint32_t>(size >> 29);
+
+  size_t used = saved_lo & 0x3f;
+  if (used) {
+    size_t free = 64 - used;
+    if (size < free) {
+      std::memcpy(&Buffer[used], ptr, size);
+      return;
+    }
+    std::memcpy(&Buffer[used], ptr, free);
+    ptr += free;
+    size -= free;
+    body(Buffer, 64);
+  }
+
+  if (size >= 64) {
+    ptr = body(ptr, size & ~size_t(0x3f));
+    size &= 0x3f;
+  }
+  std::memcpy(Buffer, ptr, size);
+}
+
+void MD5::update(StringRef data) {
+  update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(data.data()),
+                           data.size()));
+}
+
+void MD5::final(MD5Result& result) {
+  size_t used = Lo & 0x3f;
+  Buffer[used++] = 0x80;
+  size_t free = 64 - used;
+  if (free < 8) {
+    std::memset(&Buffer[used], 0, free);
+    body(Buffer, 64);
+    used = 0;
+    free = 64;
+  }
+  std::memset(&Buffer[used], 0, free - 8);
+
+  Lo <<= 3;
+  for (int i = 0; i < 4; ++i) {
+    Buffer[56 + i] = static_cast<uint8_t>(Lo >> (8 * i));
+    Buffer[60 + i] = static_cast<uint8_t>(Hi >> (8 * i));
+  }
+  body(Buffer, 64);
+
+  const uint32_t words[] = {A, B, C, D};
+  for (int i = 0; i < 16; ++i) {
+    result[i] = static_cast<uint8_t>(words[i / 4] >> (8 * (i % 4)));
+  }
+}
+
+auto MD5::hash(ArrayRef<uint8_t> data) -> MD5Result {
+  MD5 md5;
+  md5.update(data);
+  return md5.final();
+}
+
+auto MD5::MD5Result::digest() const -> SmallString<32> {
+  SmallString<32> text;
+  for (uint8_t byte : *this) {
+    text.push_back("0123456789abcdef"[byte >> 4]);
+    text.push_back("0123456789abcdef"[byte & 15]);
+  }
+  return text;
+}
+
+auto MD5::MD5Result::low() const -> uint64_t {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = value << 8 | (*this)[i];
+  }
+  return value;
+}
+
+auto MD5::MD5Result::high() const -> uint64_t {
+  uint64_t value = 0;
+  for (int i = 15; i >= 8; --i) {
+    value = value << 8 | (*this)[i];
+  }
+  return value;
+}
+
+}  // namespace llvm
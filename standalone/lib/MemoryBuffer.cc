@@ -0,0 +1,107 @@
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace llvm {
+
+auto MemoryBuffer::getFile(const Twine& filename, bool /*is_text*/,
+                           bool /*requires_null_terminator*/,
+                           bool /*is_volatile*/)
+    -> ErrorOr<std::unique_ptr<MemoryBuffer>> {
+  std::string name = filename.str();
+  int fd = name == "-" ? STDIN_FILENO
+                       : ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::error_code(errno, std::generic_category());
+  }
+  std::string contents;
+  char chunk[16384];
+  for (;;) {
+    ssize_t size = ::read(fd, chunk, sizeof(chunk));
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::error_code ec(errno, std::generic_category());
+      if (fd != STDIN_FILENO) {
+        ::close(fd);
+      }
+      return ec;
+    }
+    if (size == 0) {
+      break;
+    }
+    contents.append(chunk, size);
+  }
+  if (fd != STDIN_FILENO) {
+    ::close(fd);
+  }
+  return std::make_unique<MemoryBuffer>(std::move(contents), std::move(name));
+}
+
+auto MemoryBuffer::getMemBuffer(StringRef data, StringRef identifier)
+    -> std::unique_ptr<MemoryBuffer> {
+  return std::make_unique<MemoryBuffer>(data.str(), identifier.str());
+}
+
+namespace vfs {
+
+auto FileSystem::makeAbsolute(SmallVectorImpl<char>& path) const
+    -> std::error_code {
+  StringRef text(path.data(), path.size());
+  if (sys::path::is_absolute(text)) {
+    return std::error_code();
+  }
+  ErrorOr<std::string> working_dir = getCurrentWorkingDirectory();
+  if (!working_dir) {
+    return working_dir.getError();
+  }
+  SmallString<128> absolute(*working_dir);
+  sys::path::append(absolute, text);
+  path.assign(absolute.begin(), absolute.end());
+  return std::error_code();
+}
+
+namespace {
+
+class RealFileSystem : public FileSystem {
+ public:
+  auto status(const Twine& path) -> ErrorOr<Status> override {
+    sys::fs::file_status result;
+    if (std::error_code ec = sys::fs::status(path, result)) {
+      return ec;
+    }
+    return Status(path, result);
+  }
+
+  auto getBufferForFile(const Twine& name)
+      -> ErrorOr<std::unique_ptr<MemoryBuffer>> override {
+    return MemoryBuffer::getFile(name);
+  }
+
+  auto getCurrentWorkingDirectory() const -> ErrorOr<std::string> override {
+    SmallString<256> dir;
+    if (std::error_code ec = sys::fs::current_path(dir)) {
+      return ec;
+    }
+    return dir.str().str();
+  }
+};
+
+}  // namespace
+
+auto getRealFileSystem() -> std::shared_ptr<FileSystem> {
+  static std::shared_ptr<FileSystem> file_system =
+      std::make_shared<RealFileSystem>();
+  return file_system;
+}
+
+}  // namespace vfs
+}  // namespace llvm
@@ -0,0 +1,119 @@
+#include "llvm/Support/Path.h"
+
+#include <cstdlib>
+
+namespace llvm {
+namespace sys {
+namespace path {
+
+auto is_separator(char c) -> bool { return c == '/'; }
+
+void append(SmallVectorImpl<char>& path, const Twine& a, const Twine& b,
+            const Twine& c, const Twine& d) {
+  for (const Twine* component : {&a, &b, &c, &d}) {
+    std::string text = component->str();
+    if (text.empty()) {
+      continue;
+    }
+    bool path_ends_with_separator = !path.empty() && is_separator(path.back());
+    bool text_starts_with_separator = is_separator(text.front());
+    if (path_ends_with_separator && text_starts_with_separator) {
+      // Keep a single separator between the two.
+      path.append(text.begin() + 1, text.end());
+      continue;
+    }
+    if (!path.empty() && !path_ends_with_separator &&
+        !text_starts_with_separator) {
+      path.push_back('/');
+    }
+    path.append(text.begin(), text.end());
+  }
+}
+
+auto filename(StringRef path) -> StringRef {
+  if (path == "/") {
+    return path;
+  }
+  // A trailing separator names the directory ".", as in LLVM.
+  if (!path.empty() && is_separator(path.back())) {
+    return ".";
+  }
+  size_t slash = path.rfind('/');
+  return slash == StringRef::npos ? path : path.substr(slash + 1);
+}
+
+auto parent_path(StringRef path) -> StringRef {
+  size_t end = path.size();
+  // Drop the file name.
+  while (end && !is_separator(path[end - 1])) {
+    --end;
+  }
+  if (end == 0) {
+    return StringRef();
+  }
+  // Drop the separators before it, except a root "/".
+  while (end > 1 && is_separator(path[end - 1])) {
+    --end;
+  }
+  return path.substr(0, end);
+}
+
+auto stem(StringRef path) -> StringRef {
+  StringRef name = filename(path);
+  if (name == "." || name == "..") {
+    return name;
+  }
+  size_t dot = name.rfind('.');
+  return dot == StringRef::npos ? name : name.substr(0, dot);
+}
+
+auto extension(StringRef path) -> StringRef {
+  StringRef name = filename(path);
+  if (name == "." || name == "..") {
+    return StringRef();
+  }
+  size_t dot = name.rfind('.');
+  return dot == StringRef::npos ? StringRef() : name.substr(dot);
+}
+
+auto has_parent_path(const Twine& path) -> bool {
+  std::string text = path.str();
+  return !parent_path(text).empty();
+}
+
+auto has_filename(const Twine& path) -> bool {
+  std::string text = path.str();
+  return !filename(text).empty();
+}
+
+auto is_absolute(const Twine& path) -> bool {
+  std::string text = path.str();
+  return !text.empty() && is_separator(text.front());
+}
+
+auto is_relative(const Twine& path) -> bool { return !is_absolute(path); }
+
+void native(SmallVectorImpl<char>& /*path*/) {}
+
+void remove_filename(SmallVectorImpl<char>& path) {
+  StringRef text(path.data(), path.size());
+  path.truncate(parent_path(text).size());
+}
+
+void system_temp_directory(bool /*erased_on_reboot*/,
+                           SmallVectorImpl<char>& result) {
+  result.clear();
+  for (const char* name : {"TMPDIR", "TMP", "TEMP", "TEMPDIR"}) {
+    if (const char* dir = std::getenv(name)) {
+      StringRef text(dir);
+      result.append(text.begin(), text.end());
+      return;
+    }
+  }
+  StringRef text("/tmp");
+  result.append(text.begin(), text.end());
+}
+
+}  // namespace path
+}  // namespace sys
+}  // namespace llvm
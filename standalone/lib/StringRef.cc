@@ -0,0 +1,190 @@
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+
+auto StringRef::compare_insensitive(StringRef rhs) const -> int {
+  size_t length = std::min(Length, rhs.Length);
+  for (size_t i = 0; i < length; ++i) {
+    unsigned char lhs_char = toLower(Data[i]);
+    unsigned char rhs_char = toLower(rhs.Data[i]);
+    if (lhs_char != rhs_char) {
+      return lhs_char < rhs_char ? -1 : 1;
+    }
+  }
+  if (Length == rhs.Length) {
+    return 0;
+  }
+  return Length < rhs.Length ? -1 : 1;
+}
+
+auto StringRef::edit_distance(StringRef other, bool allow_replacements,
+                              unsigned max_edit_distance) const -> unsigned {
+  // Levenshtein distance over one row, as in LLVM's ComputeEditDistance.
+  size_t m = Length;
+  size_t n = other.Length;
+  std::vector<unsigned> row(n + 1);
+  for (unsigned i = 1; i <= n; ++i) {
+    row[i] = i;
+  }
+  for (size_t y = 1; y <= m; ++y) {
+    row[0] = static_cast<unsigned>(y);
+    unsigned best_this_row = row[0];
+    unsigned previous = static_cast<unsigned>(y - 1);
+    char current = Data[y - 1];
+    for (size_t x = 1; x <= n; ++x) {
+      unsigned old_row = row[x];
+      if (allow_replacements) {
+        row[x] = std::min({previous + (current == other.Data[x - 1] ? 0u : 1u),
+                           row[x - 1] + 1, row[x] + 1});
+      } else if (current == other.Data[x - 1]) {
+        row[x] = previous;
+      } else {
+        row[x] = std::min(row[x - 1], row[x]) + 1;
+      }
+      previous = old_row;
+      best_this_row = std::min(best_this_row, row[x]);
+    }
+    if (max_edit_distance && best_this_row > max_edit_distance) {
+      return max_edit_distance + 1;
+    }
+  }
+  return row[n];
+}
+
+auto StringRef::lower() const -> std::string {
+  std::string result(Length, '\0');
+  for (size_t i = 0; i < Length; ++i) {
+    result[i] = toLower(Data[i]);
+  }
+  return result;
+}
+
+auto StringRef::upper() const -> std::string {
+  std::string result(Length, '\0');
+  for (size_t i = 0; i < Length; ++i) {
+    result[i] = toUpper(Data[i]);
+  }
+  return result;
+}
+
+// Guess the radix from a 0x, 0b, 0o or 0 prefix, consuming it.
+static auto autoSenseRadix(StringRef& str) -> unsigned {
+  if (str.empty()) {
+    return 10;
+  }
+  if (str.startswith("0x") || str.startswith("0X")) {
+    str = str.substr(2);
+    return 16;
+  }
+  if (str.startswith("0b") || str.startswith("0B")) {
+    str = str.substr(2);
+    return 2;
+  }
+  if (str.startswith("0o")) {
+    str = str.substr(2);
+    return 8;
+  }
+  if (str[0] == '0' && str.size() > 1 && isDigit(str[1])) {
+    str = str.substr(1);
+    return 8;
+  }
+  return 10;
+}
+
+// Consume the longest prefix of str that is an unsigned integer in radix.
+static auto consumeUnsignedInteger(StringRef& str, unsigned radix,
+                                   unsigned long long& result) -> bool {
+  if (radix == 0) {
+    radix = autoSenseRadix(str);
+  }
+  if (str.empty()) {
+    return true;
+  }
+  StringRef rest = str;
+  result = 0;
+  while (!rest.empty()) {
+    unsigned digit;
+    char c = rest[0];
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'z') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'Z') {
+      digit = c - 'A' + 10;
+    } else {
+      break;
+    }
+    if (digit >= radix) {
+      break;
+    }
+    unsigned long long previous = result;
+    result = result * radix + digit;
+    if (result / radix < previous) {
+      return true;  // Overflow.
+    }
+    rest = rest.substr(1);
+  }
+  if (str.size() == rest.size()) {
+    return true;
+  }
+  str = rest;
+  return false;
+}
+
+auto getAsUnsignedInteger(StringRef str, unsigned radix,
+                          unsigned long long& result) -> bool {
+  return consumeUnsignedInteger(str, radix, result) || !str.empty();
+}
+
+auto getAsSignedInteger(StringRef str, unsigned radix, long long& result)
+    -> bool {
+  unsigned long long value;
+  if (str.empty() || str.front() != '-') {
+    if (consumeUnsignedInteger(str, radix, value) || !str.empty() ||
+        static_cast<long long>(value) < 0) {
+      return true;
+    }
+    result = static_cast<long long>(value);
+    return false;
+  }
+  str = str.substr(1);
+  if (consumeUnsignedInteger(str, radix, value) || !str.empty() ||
+      static_cast<long long>(-value) > 0) {
+    return true;
+  }
+  result = static_cast<long long>(-value);
+  return false;
+}
+
+auto StringRef::getAsDouble(double& result, bool allow_inexact) const -> bool {
+  std::string text = str();
+  if (text.empty()) {
+    return true;
+  }
+  char* end = nullptr;
+  errno = 0;
+  result = std::strtod(text.c_str(), &end);
+  if (end != text.c_str() + text.size()) {
+    return true;
+  }
+  return !allow_inexact && errno == ERANGE;
+}
+
+void Twine::print(raw_ostream& os) const { os << Text; }
+
+auto operator<<(raw_ostream& os, const Twine& twine) -> raw_ostream& {
+  twine.print(os);
+  return os;
+}
+
+}  // namespace llvm
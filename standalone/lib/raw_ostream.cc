@@ -0,0 +1,241 @@
+#include "llvm/Support/raw_ostream.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+
+namespace llvm {
+
+raw_ostream::~raw_ostream() {
+  // Subclasses flush in their destructors, while write_impl still works.
+}
+
+auto raw_ostream::preferred_buffer_size() const -> size_t { return 4096; }
+
+void raw_ostream::flushBuffer() {
+  size_t used = Used;
+  Used = 0;
+  write_impl(Buffer.get(), used);
+}
+
+auto raw_ostream::write(const char* ptr, size_t size) -> raw_ostream& {
+  if (Unbuffered) {
+    flush();
+    write_impl(ptr, size);
+    return *this;
+  }
+  if (!Buffer) {
+    BufferSize = preferred_buffer_size();
+    Buffer = std::make_unique<char[]>(BufferSize);
+  }
+  if (Used + size > BufferSize) {
+    flush();
+    // Writes larger than the buffer bypass it.
+    if (size >= BufferSize) {
+      write_impl(ptr, size);
+      return *this;
+    }
+  }
+  std::memcpy(Buffer.get() + Used, ptr, size);
+  Used += size;
+  return *this;
+}
+
+auto raw_ostream::operator<<(unsigned long value) -> raw_ostream& {
+  return *this << static_cast<unsigned long long>(value);
+}
+
+auto raw_ostream::operator<<(long value) -> raw_ostream& {
+  return *this << static_cast<long long>(value);
+}
+
+auto raw_ostream::operator<<(unsigned long long value) -> raw_ostream& {
+  char buffer[32];
+  int size = std::snprintf(buffer, sizeof(buffer), "%llu", value);
+  return write(buffer, size);
+}
+
+auto raw_ostream::operator<<(long long value) -> raw_ostream& {
+  char buffer[32];
+  int size = std::snprintf(buffer, sizeof(buffer), "%lld", value);
+  return write(buffer, size);
+}
+
+auto raw_ostream::operator<<(const void* ptr) -> raw_ostream& {
+  char buffer[32];
+  int size = std::snprintf(buffer, sizeof(buffer), "0x%" PRIxPTR,
+                           reinterpret_cast<uintptr_t>(ptr));
+  return write(buffer, size);
+}
+
+auto raw_ostream::operator<<(double value) -> raw_ostream& {
+  char buffer[64];
+  int size = std::snprintf(buffer, sizeof(buffer), "%e", value);
+  return write(buffer, size);
+}
+
+auto raw_ostream::operator<<(const format_object_base& format)
+    -> raw_ostream& {
+  char small[128];
+  int size = format.snprint(small, sizeof(small));
+  if (size < 0) {
+    return *this;
+  }
+  if (static_cast<size_t>(size) < sizeof(small)) {
+    return write(small, size);
+  }
+  std::string large(size + 1, '\0');
+  format.snprint(large.data(), size + 1);
+  return write(large.data(), size);
+}
+
+auto raw_ostream::operator<<(const FormattedString& str) -> raw_ostream& {
+  size_t padding =
+      str.Width > str.Str.size() ? str.Width - str.Str.size() : 0;
+  switch (str.Justify) {
+    case FormattedString::JustifyNone:
+      return *this << str.Str;
+    case FormattedString::JustifyLeft:
+      *this << str.Str;
+      return indent(padding);
+    case FormattedString::JustifyRight:
+      indent(padding);
+      return *this << str.Str;
+    case FormattedString::JustifyCenter:
+      indent(padding / 2);
+      *this << str.Str;
+      return indent(padding - padding / 2);
+  }
+  return *this;
+}
+
+auto raw_ostream::operator<<(const FormattedNumber& number) -> raw_ostream& {
+  char buffer[32];
+  int size;
+  if (number.Hex) {
+    // The prefix counts towards the width, as in LLVM.
+    unsigned width = number.Width;
+    if (number.Prefix) {
+      width = width > 2 ? width - 2 : 0;
+      *this << "0x";
+    }
+    size = std::snprintf(buffer, sizeof(buffer),
+                         number.Upper ? "%0*llX" : "%0*llx", width,
+                         static_cast<unsigned long long>(number.Value));
+  } else {
+    size = std::snprintf(buffer, sizeof(buffer), "%*lld", number.Width,
+                         static_cast<long long>(number.Value));
+  }
+  return write(buffer, size);
+}
+
+auto raw_ostream::indent(unsigned num_spaces) -> raw_ostream& {
+  static const char spaces[] = "                                        ";
+  while (num_spaces) {
+    unsigned chunk =
+        std::min(num_spaces, static_cast<unsigned>(sizeof(spaces) - 1));
+    write(spaces, chunk);
+    num_spaces -= chunk;
+  }
+  return *this;
+}
+
+raw_fd_ostream::raw_fd_ostream(int fd, bool should_close, bool unbuffered)
+    : raw_ostream(unbuffered), FD(fd), ShouldClose(should_close) {
+  // Do not close the standard streams.
+  if (FD <= STDERR_FILENO) {
+    ShouldClose = false;
+  }
+}
+
+raw_fd_ostream::raw_fd_ostream(StringRef filename, std::error_code& ec)
+    : raw_fd_ostream(filename, ec, sys::fs::OF_None) {}
+
+raw_fd_ostream::raw_fd_ostream(StringRef filename, std::error_code& ec,
+                               sys::fs::OpenFlags flags)
+    : raw_ostream(/*unbuffered=*/false) {
+  ec = std::error_code();
+  if (filename == "-") {
+    FD = STDOUT_FILENO;
+    return;
+  }
+  int mode = O_WRONLY | O_CREAT | O_CLOEXEC;
+  mode |= (flags & sys::fs::OF_Append) ? O_APPEND : O_TRUNC;
+  FD = ::open(filename.str().c_str(), mode, 0666);
+  if (FD < 0) {
+    ec = std::error_code(errno, std::generic_category());
+    Error = ec;
+    return;
+  }
+  ShouldClose = true;
+}
+
+raw_fd_ostream::~raw_fd_ostream() {
+  if (FD >= 0) {
+    flush();
+    if (ShouldClose) {
+      ::close(FD);
+    }
+  }
+}
+
+void raw_fd_ostream::close() {
+  flush();
+  if (ShouldClose && FD >= 0) {
+    if (::close(FD) != 0) {
+      Error = std::error_code(errno, std::generic_category());
+    }
+  }
+  FD = -1;
+  ShouldClose = false;
+}
+
+void raw_fd_ostream::write_impl(const char* ptr, size_t size) {
+  Pos += size;
+  if (FD < 0) {
+    return;
+  }
+  while (size) {
+    ssize_t written = ::write(FD, ptr, size);
+    if (written < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      Error = std::error_code(errno, std::generic_category());
+      return;
+    }
+    ptr += written;
+    size -= written;
+  }
+}
+
+raw_string_ostream::~raw_string_ostream() { flush(); }
+
+raw_svector_ostream::~raw_svector_ostream() { flush(); }
+
+raw_null_ostream::~raw_null_ostream() { flush(); }
+
+auto outs() -> raw_fd_ostream& {
+  static raw_fd_ostream stream(STDOUT_FILENO, false);
+  return stream;
+}
+
+auto errs() -> raw_fd_ostream& {
+  static raw_fd_ostream stream(STDERR_FILENO, false, /*unbuffered=*/true);
+  return stream;
+}
+
+auto nulls() -> raw_ostream& {
+  static raw_null_ostream stream;
+  return stream;
+}
+
+}  // namespace llvm
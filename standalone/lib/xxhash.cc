@@ -0,0 +1,118 @@
+// The 64-bit xxHash by Yann Collet (BSD 2-clause), as in LLVM.
+
+#include "llvm/Support/xxhash.h"
+
+#include <cstring>
+
+namespace llvm {
+
+namespace {
+
+constexpr uint64_t prime64_1 = 11400714785074694791ULL;
+constexpr uint64_t prime64_2 = 14029467366897019727ULL;
+constexpr uint64_t prime64_3 = 1609587929392839161ULL;
+constexpr uint64_t prime64_4 = 9650029242287828579ULL;
+constexpr uint64_t prime64_5 = 2870177450012600261ULL;
+
+inline auto rotl64(uint64_t x, unsigned r) -> uint64_t {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline auto read64(const uint8_t* p) -> uint64_t {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = value << 8 | p[i];
+  }
+  return value;
+}
+
+inline auto read32(const uint8_t* p) -> uint32_t {
+  return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+         uint32_t(p[3]) << 24;
+}
+
+inline auto round(uint64_t acc, uint64_t input) -> uint64_t {
+  acc += input * prime64_2;
+  acc = rotl64(acc, 31);
+  acc *= prime64_1;
+  return acc;
+}
+
+inline auto mergeRound(uint64_t acc, uint64_t val) -> uint64_t {
+  val = round(0, val);
+  acc ^= val;
+  acc = acc * prime64_1 + prime64_4;
+  return acc;
+}
+
+}  // namespace
+
+auto xxHash64(ArrayRef<uint8_t> data) -> uint64_t {
+  const uint8_t* p = data.data();
+  const uint8_t* const end = p + data.size();
+  size_t len = data.size();
+  uint64_t seed = 0;
+  uint64_t h64;
+
+  if (len >= 32) {
+    const uint8_t* const limit = end - 32;
+    uint64_t v1 = seed + prime64_1 + prime64_2;
+    uint64_t v2 = seed + prime64_2;
+    uint64_t v3 = seed + 0;
+    uint64_t v4 = seed - prime64_1;
+    do {
+      v1 = round(v1, read64(p));
+      p += 8;
+      v2 = round(v2, read64(p));
+      p += 8;
+      v3 = round(v3, read64(p));
+      p += 8;
+      v4 = round(v4, read64(p));
+      p += 8;
+    } while (p <= limit);
+
+    h64 = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h64 = mergeRound(h64, v1);
+    h64 = mergeRound(h64, v2);
+    h64 = mergeRound(h64, v3);
+    h64 = mergeRound(h64, v4);
+  } else {
+    h64 = seed + prime64_5;
+  }
+
+  h64 += static_cast<uint64_t>(len);
+
+  while (p + 8 <= end) {
+    uint64_t const k1 = round(0, read64(p));
+    h64 ^= k1;
+    h64 = rotl64(h64, 27) * prime64_1 + prime64_4;
+    p += 8;
+  }
+
+  if (p + 4 <= end) {
+    h64 ^= static_cast<uint64_t>(read32(p)) * prime64_1;
+    h64 = rotl64(h64, 23) * prime64_2 + prime64_3;
+    p += 4;
+  }
+
+  while (p < end) {
+    h64 ^= (*p) * prime64_5;
+    h64 = rotl64(h64, 11) * prime64_1;
+    p++;
+  }
+
+  h64 ^= h64 >> 33;
+  h64 *= prime64_2;
+  h64 ^= h64 >> 29;
+  h64 *= prime64_3;
+  h64 ^= h64 >> 32;
+
+  return h64;
+}
+
+auto xxHash64(StringRef data) -> uint64_t {
+  return xxHash64(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+}  // namespace llvm
@@ -0,0 +1,1977 @@
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandLine.h"
+#include "HelperOptions.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+namespace {
+
+auto parse(std::initializer_list<const char*> args) -> bool {
+  std::vector<const char*> argv(args);
+  std::string errors;
+  llvm::raw_string_ostream os(errors);
+  return ParseCommandLineOptions(static_cast<int>(argv.size()), argv.data(),
+                                 "", &os);
+}
+
+namespace HelpCache {
+
+static opt<int> Depth("help-cache-depth", desc("Queue depth"), init(4));
+
+TEST(HelpCacheTest, RendersAgainAfterRegistryChange) {
+  ASSERT_TRUE(parse({"prog"}));
+
+  std::string first;
+  {
+    llvm::raw_string_ostream os(first);
+    PrintHelpMessage(os);
+  }
+  EXPECT_NE(first.find("Queue depth"), std::string::npos);
+
+  std::string second;
+  {
+    llvm::raw_string_ostream os(second);
+    PrintHelpMessage(os);
+  }
+  EXPECT_EQ(first, second);
+
+  Depth.setDescription("Maximum queue depth");
+  std::string third;
+  {
+    llvm::raw_string_ostream os(third);
+    PrintHelpMessage(os);
+  }
+  EXPECT_NE(third.find("Maximum queue depth"), std::string::npos);
+
+  {
+    opt<bool> Extra("help-cache-extra", desc("Temporary flag"));
+    std::string fourth;
+    llvm::raw_string_ostream os(fourth);
+    PrintHelpMessage(os);
+    os.flush();
+    EXPECT_NE(fourth.find("help-cache-extra"), std::string::npos);
+    Extra.removeArgument();
+  }
+  Depth.setDescription("Queue depth");
+}
+
+enum Scheduler { Fifo, Lifo, Random };
+
+static opt<Scheduler> Sched("help-cache-sched", desc("Scheduler"),
+                            values(clEnumValN(Fifo, "fifo", "First in"),
+                                   clEnumValN(Lifo, "lifo", "Last in")));
+
+TEST(HelpCacheTest, RendersAgainAfterLiteralChange) {
+  ASSERT_TRUE(parse({"prog"}));
+  auto render = [] {
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    PrintHelpMessage(os);
+    return os.str();
+  };
+  EXPECT_EQ(render().find("=random"), std::string::npos);
+  Sched.getParser().addLiteralOption("random", Random, "Any order");
+  EXPECT_NE(render().find("=random"), std::string::npos);
+  Sched.getParser().removeLiteralOption("random");
+  EXPECT_EQ(render().find("=random"), std::string::npos);
+}
+
+}  // namespace HelpCache
+
+namespace Completion {
+
+enum Color { Red, Green };
+
+static opt<Color> Paint("complete-paint", desc("Paint color"),
+                        values(clEnumValN(Red, "red", "Red paint"),
+                               clEnumValN(Green, "green", "Green paint")));
+static opt<std::string> Output("complete-output", desc("Output file"));
+
+auto complete(std::initializer_list<llvm::StringRef> words, unsigned index)
+    -> std::string {
+  std::vector<llvm::StringRef> line(words);
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  PrintCompletions(line, index, os);
+  os.flush();
+  return result;
+}
+
+TEST(CompletionTest, CompletesNamesAndValues) {
+  EXPECT_EQ(complete({"prog", "--complete-p"}, 1), "--complete-paint\n");
+  EXPECT_EQ(complete({"prog", "--complete-paint="}, 1),
+            "--complete-paint=red\n--complete-paint=green\n");
+  EXPECT_EQ(complete({"prog", "--complete-paint", "g"}, 2), "green\n");
+  EXPECT_EQ(complete({"prog", "--complete-output", ""}, 2),
+            std::string(CompletionFileHint) + "\n");
+}
+
+TEST(CompletionTest, SeesLateRegistrations) {
+  EXPECT_EQ(complete({"prog", "--complete-e"}, 1), "");
+  opt<bool> Extra("complete-extra", desc("Temporary flag"));
+  EXPECT_EQ(complete({"prog", "--complete-e"}, 1), "--complete-extra\n");
+  Extra.removeArgument();
+  EXPECT_EQ(complete({"prog", "--complete-e"}, 1), "");
+}
+
+}  // namespace Completion
+
+namespace HelpSearch {
+
+enum Level { Fast, Thorough };
+
+static opt<int> Retries("search-retries", desc("How often to retry"));
+static opt<bool> RetryBackoff("search-retries-backoff",
+                              desc("Back off between attempts"));
+static opt<Level> Effort("search-effort", desc("Optimization effort"),
+                         values(clEnumValN(Fast, "fast", "Quick"),
+                                clEnumValN(Thorough, "thorough", "Slow")));
+
+auto names(llvm::StringRef pattern) -> std::vector<std::string> {
+  std::vector<std::string> result;
+  for (Option* option : SearchOptions(SubCommand::getTopLevel(), pattern)) {
+    result.push_back(option->ArgStr.str());
+  }
+  return result;
+}
+
+TEST(HelpSearchTest, RanksNameMatchesFirst) {
+  EXPECT_EQ(names("search-retries"),
+            (std::vector<std::string>{"search-retries",
+                                      "search-retries-backoff"}));
+  EXPECT_EQ(names("RETRY"), std::vector<std::string>{"search-retries"});
+  EXPECT_EQ(names("thorough"), std::vector<std::string>{"search-effort"});
+  EXPECT_EQ(names("no-such-option-anywhere"), std::vector<std::string>{});
+}
+
+TEST(HelpSearchTest, MatchesGlobs) {
+  EXPECT_EQ(names("search-*-backoff"),
+            std::vector<std::string>{"search-retries-backoff"});
+  EXPECT_EQ(names("th?rough"), std::vector<std::string>{"search-effort"});
+}
+
+TEST(HelpSearchTest, PrintsMatchesInHelpFormat) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  PrintHelpSearch(SubCommand::getTopLevel(), "effort", os);
+  os.flush();
+  EXPECT_NE(text.find("--search-effort"), std::string::npos);
+  EXPECT_NE(text.find("=thorough"), std::string::npos);
+  EXPECT_EQ(text.find("search-retries"), std::string::npos);
+}
+
+}  // namespace HelpSearch
+
+namespace Schema {
+
+enum Mode { Eager, Lazy };
+
+static opt<Mode> Loading("schema-loading", desc("Loading mode"),
+                         values(clEnumValN(Eager, "eager", "Load up front"),
+                                clEnumValN(Lazy, "lazy", "Load on demand")),
+                         init(Lazy));
+static alias LoadingAlias("schema-l", desc("Alias for --schema-loading"),
+                          aliasopt(Loading));
+static list<int> Sizes("schema-sizes", desc("Sizes"), CommaSeparated,
+                       list_init<int>({1, 2}));
+
+auto findOption(const llvm::json::Array& options, llvm::StringRef name)
+    -> const llvm::json::Object* {
+  for (const llvm::json::Value& value : options) {
+    const llvm::json::Object* option = value.getAsObject();
+    if (option && *option->get("name") == name) {
+      return option;
+    }
+  }
+  return nullptr;
+}
+
+TEST(OptionSchemaTest, DescribesOptions) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  PrintOptionSchema(os);
+  os.flush();
+
+  llvm::Expected<llvm::json::Value> schema = llvm::json::parse(text);
+  ASSERT_TRUE(static_cast<bool>(schema)) << llvm::toString(schema.takeError());
+  const llvm::json::Array* options = schema->getAsObject()->getArray("options");
+  ASSERT_NE(options, nullptr);
+  EXPECT_EQ(findOption(*options, "schema-l"), nullptr);
+
+  const llvm::json::Object* loading = findOption(*options, "schema-loading");
+  ASSERT_NE(loading, nullptr);
+  EXPECT_EQ(*loading->get("type"), "enum");
+  EXPECT_EQ(*loading->get("default"), "lazy");
+  EXPECT_EQ(*loading->get("value_expected"), "ValueRequired");
+  EXPECT_EQ(*loading->getArray("aliases"), llvm::json::Array({"schema-l"}));
+  EXPECT_EQ(loading->getArray("values")->size(), 2u);
+
+  const llvm::json::Object* sizes = findOption(*options, "schema-sizes");
+  ASSERT_NE(sizes, nullptr);
+  EXPECT_EQ(*sizes->get("kind"), "list");
+  EXPECT_EQ(*sizes->get("type"), "int");
+  EXPECT_EQ(*sizes->getArray("default"), llvm::json::Array({1, 2}));
+  EXPECT_EQ(*sizes->getArray("misc"), llvm::json::Array({"CommaSeparated"}));
+}
+
+}  // namespace Schema
+
+namespace OptionValues {
+
+enum Feature { Inline, Vectorize, Unroll };
+
+static opt<std::string> Label("values-label", init("none"));
+static opt<unsigned> Jobs("values-jobs", init(1));
+static list<std::string> Defines("values-define");
+static bits<Feature> Features("values-feature",
+                              values(clEnumValN(Inline, "inline", ""),
+                                     clEnumValN(Vectorize, "vectorize", ""),
+                                     clEnumValN(Unroll, "unroll", "")));
+
+auto printValues(OptionValuesFormat format) -> std::string {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  PrintOptionValues(os, format);
+  os.flush();
+  return text;
+}
+
+TEST(OptionValuesTest, TracksTouchedOptions) {
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(Label.isValueTouched());
+  ASSERT_TRUE(parse({"prog", "--values-label=x"}));
+  EXPECT_TRUE(Label.isValueTouched());
+  EXPECT_FALSE(Jobs.isValueTouched());
+  Jobs = 1;
+  EXPECT_TRUE(Jobs.isValueTouched());
+  EXPECT_FALSE(static_cast<Option&>(Jobs).valueDiffersFromDefault());
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(Label.isValueTouched());
+  EXPECT_EQ(Label, "none");
+}
+
+TEST(OptionValuesTest, StorageWritesMarkTouched) {
+  ResetAllOptionOccurrences();
+  Label.setValue("direct");
+  Defines.push_back("D=1");
+  Features.addValue(Unroll);
+  EXPECT_TRUE(Label.isValueTouched());
+  EXPECT_TRUE(Defines.isValueTouched());
+  EXPECT_TRUE(Features.isValueTouched());
+  std::string text = printValues(OptionValuesFormat::ResponseFile);
+  EXPECT_NE(text.find("--values-label=direct\n"), std::string::npos) << text;
+  EXPECT_NE(text.find("--values-define=D=1\n"), std::string::npos) << text;
+  EXPECT_NE(text.find("--values-feature=unroll\n"), std::string::npos) << text;
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(Label.isValueTouched());
+  EXPECT_FALSE(Defines.isValueTouched());
+  EXPECT_FALSE(Features.isValueTouched());
+}
+
+TEST(OptionValuesTest, WritesReplayableResponseFile) {
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--values-label=a \"b\"", "--values-jobs=8",
+                     "--values-define=X=1", "--values-define=Y",
+                     "--values-feature=unroll",
+                     "--values-feature=inline"}));
+  std::string text = printValues(OptionValuesFormat::ResponseFile);
+  EXPECT_NE(text.find("\"--values-label=a \\\"b\\\"\"\n"), std::string::npos)
+      << text;
+  EXPECT_NE(text.find("--values-jobs=8\n"), std::string::npos) << text;
+  EXPECT_NE(text.find("--values-define=X=1\n--values-define=Y\n"),
+            std::string::npos)
+      << text;
+  EXPECT_NE(text.find("--values-feature=inline\n--values-feature=unroll\n"),
+            std::string::npos)
+      << text;
+
+  llvm::BumpPtrAllocator allocator;
+  llvm::StringSaver saver(allocator);
+  llvm::SmallVector<const char*, 16> args{"prog"};
+  TokenizeGNUCommandLine(text, saver, args);
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(ParseCommandLineOptions(static_cast<int>(args.size()),
+                                      args.data(), "", &llvm::nulls()));
+  EXPECT_EQ(Label, "a \"b\"");
+  EXPECT_EQ(Jobs, 8u);
+  EXPECT_EQ(Defines.size(), 2u);
+  EXPECT_TRUE(Features.isSet(Inline));
+  EXPECT_TRUE(Features.isSet(Unroll));
+  EXPECT_FALSE(Features.isSet(Vectorize));
+  ResetAllOptionOccurrences();
+}
+
+TEST(OptionValuesTest, WritesJSON) {
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--values-define=Z", "--values-jobs=3"}));
+  llvm::Expected<llvm::json::Value> values =
+      llvm::json::parse(printValues(OptionValuesFormat::JSON));
+  ASSERT_TRUE(static_cast<bool>(values)) << llvm::toString(values.takeError());
+  const llvm::json::Array* options = values->getAsObject()->getArray("options");
+  ASSERT_NE(options, nullptr);
+  EXPECT_EQ(options->size(), 2u);
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace OptionValues
+
+namespace State {
+
+enum Level { Low, High };
+
+static opt<int> Threads("state-threads", init(1));
+static opt<std::string> Output("state-output");
+static opt<Level> Mode("state-mode", values(clEnumValN(Low, "low", ""),
+                                            clEnumValN(High, "high", "")));
+static list<double> Weights("state-weight");
+
+TEST(OptionStateTest, RestoresSavedState) {
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--state-threads=8", "--state-output=a.o",
+                     "--state-mode=high", "--state-weight=0.5",
+                     "--state-weight=2"}));
+  llvm::SmallVector<char, 128> blob;
+  SaveOptionState(blob);
+
+  ResetAllOptionOccurrences();
+  ASSERT_EQ(Threads, 1);
+  llvm::Error error = LoadOptionState(llvm::StringRef(blob.data(), blob.size()));
+  ASSERT_FALSE(static_cast<bool>(error)) << llvm::toString(std::move(error));
+  EXPECT_EQ(Threads, 8);
+  EXPECT_EQ(Threads.getNumOccurrences(), 1);
+  EXPECT_EQ(Output, "a.o");
+  EXPECT_EQ(Mode, High);
+  ASSERT_EQ(Weights.size(), 2u);
+  EXPECT_EQ(Weights[1], 2.0);
+  EXPECT_EQ(Weights.getPosition(1), 5u);
+  ResetAllOptionOccurrences();
+}
+
+TEST(OptionStateTest, RejectsDifferentLayout) {
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--state-threads=2"}));
+  llvm::SmallVector<char, 128> blob;
+  SaveOptionState(blob);
+  ResetAllOptionOccurrences();
+
+  {
+    opt<unsigned> Extra("state-extra");
+    EXPECT_TRUE(llvm::errorToBool(
+        LoadOptionState(llvm::StringRef(blob.data(), blob.size()))));
+    Extra.removeArgument();
+  }
+  EXPECT_EQ(Threads, 1);
+  EXPECT_TRUE(llvm::errorToBool(
+      LoadOptionState(llvm::StringRef(blob.data(), blob.size() - 1))));
+  EXPECT_FALSE(llvm::errorToBool(
+      LoadOptionState(llvm::StringRef(blob.data(), blob.size()))));
+  EXPECT_EQ(Threads, 2);
+  ResetAllOptionOccurrences();
+}
+
+TEST(OptionStateTest, MalformedRecordChangesNothing) {
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--state-mode=high", "--state-output=a.o"}));
+  llvm::SmallVector<char, 128> blob;
+  SaveOptionState(blob);
+  ResetAllOptionOccurrences();
+
+  // The record of state-output follows that of state-mode. Make the length
+  // of its string run past the record.
+  llvm::StringRef text(blob.data(), blob.size());
+  size_t value = text.rfind("a.o");
+  ASSERT_NE(value, llvm::StringRef::npos);
+  blob[value - 4] = 100;
+  EXPECT_TRUE(llvm::errorToBool(LoadOptionState(text)));
+  EXPECT_EQ(Mode, Low);
+  EXPECT_FALSE(Mode.isValueTouched());
+  EXPECT_EQ(Output, "");
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace State
+
+namespace Cache {
+
+static int Parsed = 0;
+
+// Counts the values it parses, so the tests can tell a hit from a parse.
+struct CountingParser : parser<int> {
+  using parser<int>::parser;
+
+  bool parse(Option& O, llvm::StringRef ArgName, llvm::StringRef Arg,
+             int& Val) {
+    ++Parsed;
+    return parser<int>::parse(O, ArgName, Arg, Val);
+  }
+};
+
+static opt<int, false, CountingParser> Level("cache-level", init(0));
+
+static int Notified = 0;
+static opt<int> Notify("cache-notify", init(0),
+                       callback([](const int&) { ++Notified; }));
+
+TEST(ParseCacheTest, ReusesResultUntilInputsChange) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-cache", dir));
+  llvm::SmallString<128> rsp(dir);
+  llvm::sys::path::append(rsp, "args.rsp");
+  auto writeRsp = [&](llvm::StringRef text) {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(rsp, ec);
+    os << text;
+  };
+  std::string at = ("@" + rsp).str();
+  llvm::SmallString<128> cache(dir);
+  llvm::sys::path::append(cache, "cache");
+  EnableParseCache(cache);
+
+  writeRsp("--cache-level=3");
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", at.c_str()}));
+  EXPECT_EQ(Parsed, 1);
+
+  ResetAllOptionOccurrences();
+  ASSERT_EQ(Level, 0);
+  ASSERT_TRUE(parse({"prog", at.c_str()}));
+  EXPECT_EQ(Parsed, 1);
+  EXPECT_EQ(Level, 3);
+  EXPECT_EQ(Level.getNumOccurrences(), 1);
+
+  writeRsp("--cache-level=4");
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", at.c_str()}));
+  EXPECT_EQ(Parsed, 2);
+  EXPECT_EQ(Level, 4);
+
+  DisableParseCache();
+  ResetAllOptionOccurrences();
+  llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(ParseCacheTest, PrunesOnlyWhenDue) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-cache", dir));
+  auto writeFile = [&](llvm::StringRef name, size_t size) {
+    llvm::SmallString<128> path(dir);
+    llvm::sys::path::append(path, name);
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec);
+    os << std::string(size, 'x');
+    return path;
+  };
+  llvm::SmallString<128> old = writeFile("old.clpc", 8192);
+  llvm::SmallString<128> stamp = writeFile("prune.stamp", 0);
+  EnableParseCache(dir, 4096);
+
+  // The fresh stamp says another process has just scanned the directory.
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--cache-level=5"}));
+  EXPECT_TRUE(llvm::sys::fs::exists(old));
+
+  llvm::sys::fs::remove(stamp);
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--cache-level=6"}));
+  EXPECT_FALSE(llvm::sys::fs::exists(old));
+  EXPECT_TRUE(llvm::sys::fs::exists(stamp));
+
+  DisableParseCache();
+  ResetAllOptionOccurrences();
+  llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(ParseCacheTest, StoresValuesWithoutOverrides) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-cache", dir));
+  EnableParseCache(dir);
+  ResetAllOptionOccurrences();
+  {
+    ScopedOptionOverride scope(Level, 9);
+    ASSERT_TRUE(parse({"prog", "--cache-level=3"}));
+    EXPECT_EQ(Level, 9);
+    std::string printed;
+    llvm::raw_string_ostream os(printed);
+    PrintOptionValues(os, OptionValuesFormat::ResponseFile);
+    EXPECT_NE(printed.find("--cache-level=3\n"), std::string::npos)
+        << printed;
+  }
+  EXPECT_EQ(Level, 3);
+
+  int parsed = Parsed;
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--cache-level=3"}));
+  EXPECT_EQ(Parsed, parsed);
+  EXPECT_EQ(Level, 3);
+
+  DisableParseCache();
+  ResetAllOptionOccurrences();
+  llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(ParseCacheTest, ParsesOptionsWithCallbacks) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-cache", dir));
+  EnableParseCache(dir);
+
+  int notified = Notified;
+  for (int i = 1; i <= 2; ++i) {
+    ResetAllOptionOccurrences();
+    ASSERT_TRUE(parse({"prog", "--cache-notify=1"}));
+    EXPECT_EQ(Notified, notified + i);
+  }
+
+  DisableParseCache();
+  ResetAllOptionOccurrences();
+  llvm::sys::fs::remove_directories(dir);
+}
+
+}  // namespace Cache
+
+namespace Fingerprint {
+
+static opt<int> Opt("fingerprint-opt", init(2));
+static opt<unsigned> Verbosity("fingerprint-verbosity", DoesNotAffectOutput);
+static list<std::string> Inputs("fingerprint-input");
+
+TEST(ConfigHashTest, FollowsEffectiveValues) {
+  ResetAllOptionOccurrences();
+  ConfigFingerprint initial = GetConfigFingerprint();
+  EXPECT_EQ(initial.str().size(), 32u);
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+
+  ASSERT_TRUE(parse({"prog", "--fingerprint-verbosity=3"}));
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+
+  // Restating a default leaves the effective configuration unchanged.
+  ASSERT_TRUE(parse({"prog", "--fingerprint-opt=2"}));
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+
+  Opt = 3;
+  EXPECT_NE(GetConfigFingerprint(), initial);
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+
+  ASSERT_TRUE(parse({"prog", "--fingerprint-input=a", "--fingerprint-input=b"}));
+  ConfigFingerprint ab = GetConfigFingerprint();
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--fingerprint-input=b", "--fingerprint-input=a"}));
+  EXPECT_NE(GetConfigFingerprint(), ab);
+  ResetAllOptionOccurrences();
+}
+
+TEST(ConfigHashTest, SkipsRemovedOptions) {
+  ResetAllOptionOccurrences();
+  ConfigFingerprint initial = GetConfigFingerprint();
+  {
+    opt<int> Temp("fingerprint-temp", init(1));
+    Temp = 5;
+    Temp.removeArgument();
+  }
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+  {
+    opt<int> Temp("fingerprint-temp", init(1));
+    Temp = 5;
+    EXPECT_NE(GetConfigFingerprint(), initial);
+    Temp.removeArgument();
+  }
+  EXPECT_EQ(GetConfigFingerprint(), initial);
+}
+
+TEST(ConfigHashTest, NotesChangesFromOtherThreads) {
+  ResetAllOptionOccurrences();
+  ConfigFingerprint initial = GetConfigFingerprint();
+  std::atomic<bool> done{false};
+  // E.g. the runtime tuning thread, while the program reads the fingerprint.
+  std::thread writer([&] {
+    while (!done.load()) {
+      Opt.noteValueChanged();
+      Inputs.noteValueChanged();
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(GetConfigFingerprint(), initial);
+  }
+  done.store(true);
+  writer.join();
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Fingerprint
+
+namespace Server {
+
+static opt<int> Jobs("server-jobs", init(1));
+static list<std::string> Files("server-file");
+static int Traced = 0;
+static opt<bool> Trace("server-trace",
+                       callback([](const bool&) { ++Traced; }));
+
+TEST(ParseServerTest, ReturnsStateAndDiagnostics) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-server", dir));
+  ParseServerConfig config;
+  config.SocketPath = (dir + "/socket").str();
+  config.MaxRequests = 4;
+  ResetAllOptionOccurrences();
+  pid_t server = fork();
+  ASSERT_GE(server, 0);
+  if (server == 0) {
+    _exit(RunParseServer(config) ? 1 : 0);
+  }
+  // The server renames the socket into place once it listens.
+  while (!llvm::sys::fs::exists(config.SocketPath)) {
+    usleep(1000);
+  }
+
+  std::vector<const char*> good = {"prog", "--server-jobs=8",
+                                   "--server-file=a", "--server-file=b"};
+  ASSERT_TRUE(ParseCommandLineOptionsWithServer(
+      config.SocketPath, static_cast<int>(good.size()), good.data()));
+  EXPECT_EQ(Jobs, 8);
+  EXPECT_EQ(Jobs.getNumOccurrences(), 1);
+  EXPECT_EQ(std::vector<std::string>(Files.begin(), Files.end()),
+            (std::vector<std::string>{"a", "b"}));
+
+  std::vector<const char*> bad = {"prog", "--server-jobs=many"};
+  llvm::Expected<ParseResponse> response =
+      SendParseRequest(config.SocketPath, bad);
+  ASSERT_TRUE(static_cast<bool>(response));
+  EXPECT_EQ(response->ExitCode, 1);
+  EXPECT_FALSE(response->Parsed);
+  EXPECT_NE(response->ErrorOutput.find("server-jobs"), std::string::npos);
+  ASSERT_EQ(response->Diagnostics.size(), 1u);
+  EXPECT_EQ(response->Diagnostics[0].Kind, ParseDiagnosticKind::OptionError);
+  EXPECT_EQ(response->Diagnostics[0].ArgIndex, 1);
+  EXPECT_EQ(response->Diagnostics[0].Arg, "server-jobs");
+  EXPECT_EQ(response->Diagnostics[0].Opt, nullptr);
+
+  std::vector<const char*> help = {"prog", "--help"};
+  response = SendParseRequest(config.SocketPath, help);
+  ASSERT_TRUE(static_cast<bool>(response));
+  EXPECT_EQ(response->ExitCode, 0);
+  EXPECT_FALSE(response->Parsed);
+  EXPECT_NE(response->Output.find("--server-jobs"), std::string::npos);
+
+  // The callback would only run in the server, so the shim declines.
+  std::vector<const char*> traced = {"prog", "--server-trace"};
+  EXPECT_FALSE(ParseCommandLineOptionsWithServer(
+      config.SocketPath, static_cast<int>(traced.size()), traced.data()));
+  EXPECT_EQ(Traced, 0);
+
+  int status = 0;
+  ASSERT_EQ(waitpid(server, &status, 0), server);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_FALSE(llvm::sys::fs::exists(config.SocketPath));
+  llvm::sys::fs::remove_directories(dir);
+
+  // With the server gone, the shim reports that it could not be used.
+  EXPECT_FALSE(ParseCommandLineOptionsWithServer(
+      config.SocketPath, static_cast<int>(good.size()), good.data()));
+  ResetAllOptionOccurrences();
+}
+
+TEST(ParseServerTest, ServesConcurrentClients) {
+  constexpr int clients = 4;
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parse-server", dir));
+  ParseServerConfig config;
+  config.SocketPath = (dir + "/socket").str();
+  config.MaxRequests = clients;
+  ResetAllOptionOccurrences();
+  pid_t server = fork();
+  ASSERT_GE(server, 0);
+  if (server == 0) {
+    _exit(RunParseServer(config) ? 1 : 0);
+  }
+  while (!llvm::sys::fs::exists(config.SocketPath)) {
+    usleep(1000);
+  }
+
+  std::vector<std::string> args(clients);
+  std::vector<std::unique_ptr<llvm::Expected<ParseResponse>>> responses(
+      clients);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != clients; ++i) {
+    args[i] = "--server-jobs=" + std::to_string(10 + i);
+    threads.emplace_back([&, i] {
+      std::vector<const char*> argv = {"prog", args[i].c_str()};
+      responses[i] = std::make_unique<llvm::Expected<ParseResponse>>(
+          SendParseRequest(config.SocketPath, argv));
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i != clients; ++i) {
+    llvm::Expected<ParseResponse>& response = *responses[i];
+    ASSERT_TRUE(static_cast<bool>(response))
+        << llvm::toString(response.takeError());
+    ASSERT_TRUE(response->Parsed) << response->ErrorOutput;
+    EXPECT_EQ(response->ActiveSubCommand,
+              SubCommand::getTopLevel().getName().str());
+    ResetAllOptionOccurrences();
+    ASSERT_FALSE(llvm::errorToBool(LoadOptionState(response->State)));
+    EXPECT_EQ(Jobs, 10 + i);
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(server, &status, 0), server);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  llvm::sys::fs::remove_directories(dir);
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Server
+
+namespace Tuning {
+
+static int Changes = 0;
+// Callbacks run with the lock held exclusively and may still read options.
+static opt<int> Depth("tuning-depth", RuntimeMutable, init(4),
+                      callback([](const int&) {
+                        std::shared_lock<std::shared_mutex> lock =
+                            ReadRuntimeOptions();
+                        ++Changes;
+                      }));
+static opt<int> Fixed("tuning-fixed", init(1));
+
+TEST(RuntimeTuningTest, ValidatesAndAppliesUpdates) {
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(static_cast<bool>(SetRuntimeOption("tuning-depth", "9")));
+  EXPECT_EQ(Depth, 9);
+  EXPECT_EQ(Changes, 1);
+
+  llvm::Error error = SetRuntimeOption("tuning-depth", "deep");
+  ASSERT_TRUE(static_cast<bool>(error));
+  EXPECT_NE(llvm::toString(std::move(error)).find("tuning-depth"),
+            std::string::npos);
+  EXPECT_EQ(Depth, 9);
+  EXPECT_TRUE(static_cast<bool>(SetRuntimeOption("tuning-fixed", "2")));
+  llvm::consumeError(SetRuntimeOption("tuning-missing", "2"));
+  EXPECT_EQ(Fixed, 1);
+
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("runtime-tuning", dir));
+  std::string path = (dir + "/socket").str();
+  ASSERT_FALSE(static_cast<bool>(StartRuntimeTuning(path)));
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path.c_str());
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  std::string request = "tuning-depth=12\ntuning-fixed=3\ndump\n";
+  ASSERT_EQ(write(fd, request.data(), request.size()),
+            static_cast<ssize_t>(request.size()));
+  shutdown(fd, SHUT_WR);
+  std::string reply;
+  char buffer[256];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+    reply.append(buffer, n);
+  }
+  close(fd);
+  StopRuntimeTuning();
+  EXPECT_FALSE(llvm::sys::fs::exists(path));
+  llvm::sys::fs::remove_directories(dir);
+
+  EXPECT_EQ(reply,
+            "ok\n"
+            "error: option 'tuning-fixed' cannot be changed at runtime\n"
+            "tuning-depth=12\nok\n");
+  EXPECT_EQ(Depth, 12);
+  EXPECT_EQ(Changes, 2);
+  ResetAllOptionOccurrences();
+}
+
+TEST(RuntimeTuningTest, ReadsRaceWithUpdates) {
+  ResetAllOptionOccurrences();
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done.load()) {
+      int depth = Depth;
+      EXPECT_TRUE(depth == 4 || (depth >= 100 && depth < 200)) << depth;
+    }
+  });
+  for (int i = 100; i != 200; ++i) {
+    EXPECT_FALSE(llvm::errorToBool(
+        SetRuntimeOption("tuning-depth", std::to_string(i))));
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(Depth, 199);
+  Changes = 0;
+  ResetAllOptionOccurrences();
+}
+
+TEST(RuntimeTuningTest, ServesOtherClientsWhileOneIsIdle) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("runtime-tuning", dir));
+  std::string path = (dir + "/socket").str();
+  ASSERT_FALSE(static_cast<bool>(StartRuntimeTuning(path)));
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path.c_str());
+  auto connectClient = [&] {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)),
+              0);
+    return fd;
+  };
+
+  // The first client connects and then sends nothing.
+  int idle = connectClient();
+  int fd = connectClient();
+  std::string request = "dump\n";
+  ASSERT_EQ(write(fd, request.data(), request.size()),
+            static_cast<ssize_t>(request.size()));
+  shutdown(fd, SHUT_WR);
+  std::string reply;
+  char buffer[256];
+  pollfd readable = {fd, POLLIN, 0};
+  while (poll(&readable, 1, 5000) == 1) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n <= 0) {
+      break;
+    }
+    reply.append(buffer, n);
+  }
+  close(fd);
+  close(idle);
+  StopRuntimeTuning();
+  llvm::sys::fs::remove_directories(dir);
+
+  EXPECT_EQ(reply, "tuning-depth=4\nok\n");
+}
+
+}  // namespace Tuning
+
+namespace Stats {
+
+static opt<int> Count("stats-count");
+static list<std::string> Names("stats-name");
+
+struct PhaseCounter : ParseObserver {
+  int Begun = 0;
+  int Ended = 0;
+  void phaseBegin(ParsePhase /*phase*/, llvm::StringRef /*detail*/) override {
+    ++Begun;
+  }
+  void phaseEnd(ParsePhase /*phase*/, llvm::StringRef /*detail*/,
+                uint64_t /*nanoseconds*/) override {
+    ++Ended;
+  }
+};
+
+TEST(ParseStatsTest, CountsPhasesAndLookups) {
+  if (!COMMANDLINE_ENABLE_PARSE_STATS) {
+    GTEST_SKIP() << "parse statistics are compiled out";
+  }
+  PhaseCounter counter;
+  SetParseObserver(&counter);
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse(
+      {"prog", "--stats-count=3", "--stats-name=a", "--stats-name=b"}));
+  SetParseObserver(nullptr);
+  const ParseStats& stats = GetLastParseStats();
+  EXPECT_EQ(stats.phase(ParsePhase::ResponseFiles).Count, 1u);
+  EXPECT_EQ(stats.phase(ParsePhase::OptionLookup).Count, 3u);
+  EXPECT_EQ(stats.LookupHits, 3u);
+  EXPECT_EQ(stats.phase(ParsePhase::ValueParsing).Count, 3u);
+  EXPECT_EQ(stats.ValueParsers.lookup("int").Count, 1u);
+  EXPECT_EQ(stats.ValueParsers.lookup("string").Count, 2u);
+  EXPECT_EQ(stats.phase(ParsePhase::Validation).Count, 1u);
+  EXPECT_GT(stats.TotalNanoseconds, 0u);
+  // Value parsing nested in lookups is not counted twice.
+  uint64_t phases = 0;
+  for (const ParsePhaseStats& phase : stats.Phases) {
+    phases += phase.Nanoseconds;
+  }
+  EXPECT_LE(phases, stats.TotalNanoseconds);
+  EXPECT_GT(counter.Begun, 0);
+  EXPECT_EQ(counter.Begun, counter.Ended);
+
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(parse({"prog", "--stats-cuont=3"}));
+  EXPECT_EQ(stats.LookupHits, 0u);
+  EXPECT_EQ(stats.PrefixFallbacks, 1u);
+  EXPECT_EQ(stats.NearestMatchSearches, 1u);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  PrintParseStats(stats, os);
+  EXPECT_NE(os.str().find("1 nearest-match searches"), std::string::npos);
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Stats
+
+namespace Trace {
+
+static opt<int> Level("trace-level");
+
+TEST(ParseTraceTest, RecordsChromeTraceEvents) {
+  llvm::SmallString<128> rsp;
+  int fd = -1;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("trace", "rsp", fd, rsp));
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << "--trace-level=5";
+  }
+  std::string at = ("@" + rsp).str();
+  ResetAllOptionOccurrences();
+  EnableParseTrace();
+  ASSERT_TRUE(parse({"prog", at.c_str()}));
+  DisableParseTrace();
+  llvm::sys::fs::remove(rsp);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  WriteParseTraceJSON(os);
+  llvm::Expected<llvm::json::Value> trace = llvm::json::parse(os.str());
+  ASSERT_TRUE(static_cast<bool>(trace));
+  const llvm::json::Array* events =
+      trace->getAsObject()->getArray("traceEvents");
+  ASSERT_NE(events, nullptr);
+  std::vector<std::string> begun;
+  int depth = 0;
+  for (const llvm::json::Value& value : *events) {
+    const llvm::json::Object& event = *value.getAsObject();
+    if (*event.getString("ph") == "E") {
+      --depth;
+      continue;
+    }
+    ++depth;
+    std::string entry = event.getString("name")->str();
+    if (const llvm::json::Object* args = event.getObject("args")) {
+      if (llvm::Optional<llvm::StringRef> detail = args->getString("detail")) {
+        entry += " " + llvm::sys::path::filename(*detail).str();
+      }
+      if (llvm::Optional<int64_t> arg = args->getInteger("arg")) {
+        entry += " #" + std::to_string(*arg);
+      }
+    }
+    begun.push_back(entry);
+  }
+  EXPECT_EQ(depth, 0);
+  std::string file = llvm::sys::path::filename(rsp).str();
+  EXPECT_EQ(begun, (std::vector<std::string>{
+                       "ParseCommandLineOptions prog", "expandResponseFiles",
+                       "expandResponseFile " + file + " #1",
+                       "option trace-level #1"}));
+
+  // A small buffer keeps only the latest events.
+  EnableParseTrace(4);
+  ResetAllOptionOccurrences();
+  ASSERT_TRUE(parse({"prog", "--trace-level=1", "--trace-level=2"}));
+  DisableParseTrace();
+  text.clear();
+  WriteParseTraceJSON(os);
+  trace = llvm::json::parse(os.str());
+  ASSERT_TRUE(static_cast<bool>(trace));
+  EXPECT_EQ(trace->getAsObject()->getArray("traceEvents")->size(), 4u);
+  ClearParseTrace();
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Trace
+
+namespace ReadProfile {
+
+static opt<int> Hot("read-profile-hot", init(1));
+static opt<std::string> Cold("read-profile-cold");
+
+TEST(OptionReadProfileTest, CountsReadsPerOption) {
+  if (!COMMANDLINE_PROFILE_OPTION_READS) {
+    GTEST_SKIP() << "option read profiling is compiled out";
+  }
+  auto readsOf = [](llvm::StringRef name) -> uint64_t {
+    for (const OptionReadCount& count : GetOptionReadCounts()) {
+      if (count.Name == name) {
+        return count.Reads;
+      }
+    }
+    return 0;
+  };
+  uint64_t hot = readsOf("read-profile-hot");
+  uint64_t cold = readsOf("read-profile-cold");
+
+  int sum = 0;
+  for (int i = 0; i != 1000; ++i) {
+    sum += Hot;
+  }
+  std::thread reader([&] {
+    for (int i = 0; i != 1000; ++i) {
+      sum += Hot.getValue();
+    }
+  });
+  reader.join();
+  EXPECT_EQ(sum, 2000);
+  EXPECT_TRUE(Cold.getValue().empty());
+
+  EXPECT_EQ(readsOf("read-profile-hot") - hot, 2000u);
+  EXPECT_EQ(readsOf("read-profile-cold") - cold, 1u);
+  std::vector<OptionReadCount> counts = GetOptionReadCounts();
+  ASSERT_FALSE(counts.empty());
+  EXPECT_GE(counts.front().Reads, 2000u);
+}
+
+}  // namespace ReadProfile
+
+namespace Provenance {
+
+static opt<bool> Flag("provenance-flag");
+static opt<int> Level("provenance-level");
+static list<std::string> Names("provenance-name");
+
+auto describe(const Option& option) -> std::vector<std::string> {
+  std::vector<std::string> origins;
+  for (ValueOrigin origin : GetValueOrigins(option)) {
+    origins.push_back(DescribeValueOrigin(origin));
+  }
+  return origins;
+}
+
+TEST(ValueProvenanceTest, RecordsWhereEachOccurrenceCameFrom) {
+  llvm::SmallString<128> rsp;
+  int fd = -1;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("provenance", "rsp", fd, rsp));
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << "--provenance-level=2\n\n--provenance-name=a --provenance-name=b\n";
+  }
+  std::string at = ("@" + rsp).str();
+  ::setenv("PROVENANCE_TEST_OPTS", "-provenance-flag --provenance-name=env", 1);
+  ResetAllOptionOccurrences();
+  std::vector<const char*> argv{"prog", "--provenance-name=c", at.c_str(),
+                                "--provenance-level=3"};
+  ASSERT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls(),
+                                      "PROVENANCE_TEST_OPTS"));
+  ::unsetenv("PROVENANCE_TEST_OPTS");
+  llvm::sys::fs::remove(rsp);
+
+  std::string file = rsp.str().str();
+  EXPECT_EQ(describe(Flag),
+            (std::vector<std::string>{"$PROVENANCE_TEST_OPTS"}));
+  EXPECT_EQ(describe(Level), (std::vector<std::string>{file + ":1", "argv[3]"}));
+  EXPECT_EQ(describe(Names),
+            (std::vector<std::string>{"$PROVENANCE_TEST_OPTS", "argv[1]",
+                                      file + ":3", file + ":3"}));
+  std::optional<ValueOrigin> env = GetValueOrigin(Names, 0);
+  ASSERT_TRUE(env.has_value());
+  EXPECT_EQ(GetValueSourceKind(env->Source), ValueSourceKind::Environment);
+  EXPECT_EQ(env->Offset, 2u);
+  EXPECT_FALSE(GetValueOrigin(Names, 4).has_value());
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  PrintOptionValues(os, OptionValuesFormat::Origins);
+  EXPECT_NE(os.str().find("    from " + file + ":1, argv[3]\n"),
+            std::string::npos)
+      << text;
+
+  ResetAllOptionOccurrences();
+  EXPECT_TRUE(GetValueOrigins(Names).empty());
+}
+
+TEST(ValueProvenanceTest, ForgetsRemovedOptions) {
+  ResetAllOptionOccurrences();
+  {
+    opt<int> Temp("provenance-temp");
+    ASSERT_TRUE(parse({"prog", "--provenance-temp=1", "--provenance-level=2"}));
+    EXPECT_EQ(describe(Temp), (std::vector<std::string>{"argv[1]"}));
+    Temp.removeArgument();
+    EXPECT_TRUE(GetValueOrigins(Temp).empty());
+  }
+  // An option created at the same address starts without origins.
+  opt<int> Temp("provenance-temp");
+  EXPECT_TRUE(GetValueOrigins(Temp).empty());
+  EXPECT_EQ(describe(Level), (std::vector<std::string>{"argv[2]"}));
+  Temp.removeArgument();
+  ResetAllOptionOccurrences();
+}
+
+TEST(ValueProvenanceTest, CountsConfigFileLines) {
+  llvm::SmallString<128> cfg;
+  int fd = -1;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("provenance", "cfg", fd, cfg));
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << "# comment\n-a \\\n-b\n\n  -c\n";
+  }
+  llvm::BumpPtrAllocator allocator;
+  llvm::SmallVector<const char*, 8> args{"prog"};
+  llvm::SmallVector<ValueOrigin, 8> origins;
+  ExpansionContext context(allocator, tokenizeConfigFile);
+  context.setOrigins(&origins);
+  ASSERT_FALSE(static_cast<bool>(context.readConfigFile(cfg, args)));
+  llvm::sys::fs::remove(cfg);
+
+  ASSERT_EQ(args.size(), 4u);
+  ASSERT_EQ(origins.size(), args.size());
+  EXPECT_EQ(DescribeValueOrigin(origins[0]), "argv[0]");
+  std::vector<uint32_t> lines;
+  for (const ValueOrigin& origin : llvm::drop_begin(origins)) {
+    lines.push_back(origin.Offset);
+  }
+  EXPECT_EQ(lines, (std::vector<uint32_t>{2, 2, 5}));
+}
+
+}  // namespace Provenance
+
+namespace Static {
+
+struct HelperConfig {
+  bool Verbose = false;
+  int Jobs = 1;
+  std::string Output = "a.out";
+  std::vector<std::string> Defines;
+  std::vector<std::string> Inputs;
+};
+
+constexpr auto kHelperOptions = make_static_options<HelperConfig>(
+    static_flag<&HelperConfig::Verbose>("static-verbose", "Print progress"),
+    static_opt<&HelperConfig::Jobs>("static-jobs", "Parallel jobs", "N"),
+    static_opt<&HelperConfig::Output>("static-output", "Output file"),
+    static_list<&HelperConfig::Defines>("D", "Macro definitions"),
+    static_positional<&HelperConfig::Inputs>("<inputs>"));
+
+static_assert(kHelperOptions.isPerfectHash());
+static_assert(kHelperOptions.lookup("static-jobs") == 1);
+static_assert(kHelperOptions.lookup("D") == 3);
+static_assert(kHelperOptions.lookup("static-job") == -1);
+
+TEST(StaticOptionsTest, ParsesIntoConfigFields) {
+  std::vector<const char*> argv{"prog",          "a.c",
+                                "--static-jobs", "8",
+                                "-D=X",          "-static-verbose",
+                                "-D",            "Y=1",
+                                "--",            "-b.c"};
+  HelperConfig config;
+  std::string errors;
+  llvm::raw_string_ostream os(errors);
+  ASSERT_TRUE(kHelperOptions.parse(static_cast<int>(argv.size()), argv.data(),
+                                   config, os))
+      << errors;
+  EXPECT_TRUE(config.Verbose);
+  EXPECT_EQ(config.Jobs, 8);
+  EXPECT_EQ(config.Output, "a.out");
+  EXPECT_EQ(config.Defines, (std::vector<std::string>{"X", "Y=1"}));
+  EXPECT_EQ(config.Inputs, (std::vector<std::string>{"a.c", "-b.c"}));
+
+  argv = {"prog", "--static-jobs=many", "--static-verbose=2", "--nope",
+          "--static-output"};
+  EXPECT_FALSE(kHelperOptions.parse(static_cast<int>(argv.size()),
+                                    argv.data(), config, os));
+  EXPECT_EQ(os.str(),
+            "prog: for the --static-jobs option: 'many' value invalid for "
+            "integer argument!\n"
+            "prog: for the --static-verbose option: '2' is invalid value for "
+            "boolean argument! Try 0 or 1\n"
+            "prog: Unknown command line argument '--nope'.  Try: 'prog "
+            "--help'\n"
+            "prog: for the --static-output option: requires a value!\n");
+}
+
+TEST(StaticOptionsTest, BindsToGenericParser) {
+  HelperConfig config;
+  config.Jobs = 2;
+  {
+    static_option_binding<decltype(kHelperOptions)> binding(kHelperOptions,
+                                                            config);
+    std::string help;
+    llvm::raw_string_ostream help_os(help);
+    PrintHelpMessage(help_os);
+    EXPECT_NE(help.find("--static-jobs=<N>"), std::string::npos) << help;
+    EXPECT_NE(help.find("-D <string>"), std::string::npos) << help;
+    EXPECT_NE(help.find("<inputs>"), std::string::npos) << help;
+
+    std::vector<const char*> argv{"prog", "--static-jobs=4", "x.c"};
+    ASSERT_TRUE(binding.parse(static_cast<int>(argv.size()), argv.data()));
+    EXPECT_EQ(config.Jobs, 4);
+    EXPECT_EQ(config.Inputs, (std::vector<std::string>{"x.c"}));
+    // The schema parse counts occurrences like the generic one.
+    Option* jobs = getRegisteredOptions()["static-jobs"];
+    EXPECT_EQ(jobs->getNumOccurrences(), 1);
+    ASSERT_EQ(GetValueOrigins(*jobs).size(), 1u);
+    EXPECT_EQ(DescribeValueOrigin(GetValueOrigins(*jobs)[0]), "argv[1]");
+    EXPECT_EQ(getRegisteredOptions()["static-verbose"]->getNumOccurrences(),
+              0);
+
+    // An option outside the schema sends the whole command line through
+    // ParseCommandLineOptions, starting again from the defaults.
+    ResetAllOptionOccurrences();
+    EXPECT_EQ(config.Jobs, 2);
+    argv = {"prog", "-D", "A", "--help-cache-depth=9", "--static-verbose",
+            "y.c"};
+    ASSERT_TRUE(binding.parse(static_cast<int>(argv.size()), argv.data(), "",
+                              &llvm::nulls()));
+    EXPECT_EQ(HelpCache::Depth, 9);
+    EXPECT_TRUE(config.Verbose);
+    EXPECT_EQ(config.Defines, (std::vector<std::string>{"A"}));
+    EXPECT_EQ(config.Inputs, (std::vector<std::string>{"y.c"}));
+
+    argv = {"prog", "--static-jobs=x"};
+    std::string errors;
+    llvm::raw_string_ostream os(errors);
+    llvm::raw_ostream* previous = redirectThreadErrors(&os);
+    EXPECT_FALSE(
+        binding.parse(static_cast<int>(argv.size()), argv.data(), "", &os));
+    redirectThreadErrors(previous);
+    EXPECT_NE(os.str().find("for the --static-jobs option: 'x' value invalid "
+                            "for integer argument!"),
+              std::string::npos)
+        << errors;
+    ResetAllOptionOccurrences();
+  }
+  EXPECT_EQ(getRegisteredOptions().count("static-jobs"), 0u);
+}
+
+TEST(StaticOptionsTest, ValidatesOtherRequiredOptions) {
+  ResetAllOptionOccurrences();
+  HelperConfig config;
+  static_option_binding<decltype(kHelperOptions)> binding(kHelperOptions,
+                                                          config);
+  opt<int> needed("static-needed", Required);
+  std::vector<const char*> argv{"prog", "--static-jobs=3"};
+  std::string errors;
+  llvm::raw_string_ostream os(errors);
+  llvm::raw_ostream* previous = redirectThreadErrors(&os);
+  EXPECT_FALSE(
+      binding.parse(static_cast<int>(argv.size()), argv.data(), "", &os));
+  redirectThreadErrors(previous);
+  EXPECT_NE(errors.find("must be specified at least once!"), std::string::npos)
+      << errors;
+
+  ResetAllOptionOccurrences();
+  argv = {"prog", "--static-jobs=3", "--static-needed=1"};
+  EXPECT_TRUE(binding.parse(static_cast<int>(argv.size()), argv.data()));
+  EXPECT_EQ(config.Jobs, 3);
+  EXPECT_EQ(needed, 1);
+  needed.removeArgument();
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Static
+
+namespace Generated {
+
+using helper::BuildConfig;
+using helper::BuildConfigOptions;
+using helper::OptLevel;
+
+TEST(GeneratedOptionsTest, ParsesIntoConfigFields) {
+  for (size_t i = 0; i < BuildConfigOptions.size(); ++i) {
+    const static_option_info& info = BuildConfigOptions.getInfo(i);
+    if (!info.Name.empty()) {
+      EXPECT_EQ(BuildConfigOptions.lookup(info.Name), static_cast<int>(i));
+    }
+  }
+  EXPECT_EQ(BuildConfigOptions.lookup("gen-job"), -1);
+  EXPECT_EQ(BuildConfigOptions.lookup(""), -1);
+
+  std::vector<const char*> argv{"prog",      "a.c",           "--gen-jobs=8",
+                                "-I",        "inc",           "--gen-opt=Os",
+                                "-gen-ratio", "0.25",         "-gen-verbose",
+                                "b.c"};
+  BuildConfig config;
+  EXPECT_EQ(config.Jobs, 1u);
+  EXPECT_EQ(config.Level, OptLevel::O1);
+  std::string errors;
+  llvm::raw_string_ostream os(errors);
+  ASSERT_TRUE(BuildConfigOptions.parse(static_cast<int>(argv.size()),
+                                       argv.data(), config, os))
+      << errors;
+  EXPECT_TRUE(config.Verbose);
+  EXPECT_EQ(config.Jobs, 8u);
+  EXPECT_EQ(config.Output, "a.out");
+  EXPECT_EQ(config.GenRatio, 0.25);
+  EXPECT_EQ(config.Level, OptLevel::Size);
+  EXPECT_EQ(config.Includes, (std::vector<std::string>{"inc"}));
+  EXPECT_EQ(config.Inputs, (std::vector<std::string>{"a.c", "b.c"}));
+
+  argv = {"prog", "--gen-opt=O3", "--gen-jobs=-1"};
+  EXPECT_FALSE(BuildConfigOptions.parse(static_cast<int>(argv.size()),
+                                        argv.data(), config, os));
+  EXPECT_EQ(os.str(),
+            "prog: for the --gen-opt option: 'O3' value invalid for enum "
+            "argument!\n"
+            "prog: for the --gen-jobs option: '-1' value invalid for uint "
+            "argument!\n");
+}
+
+TEST(GeneratedOptionsTest, PrintsPrerenderedHelp) {
+  std::string help;
+  llvm::raw_string_ostream os(help);
+  BuildConfigOptions.printHelp(os, "prog", "builds things");
+  EXPECT_EQ(os.str(),
+            "OVERVIEW: builds things\n"
+            "USAGE: prog [options] <inputs>\n"
+            "\n"
+            "OPTIONS:\n"
+            "  -I <string>           - Include directories\n"
+            "  --gen-jobs=<N>        - Parallel jobs\n"
+            "  --gen-opt=<value>     - Optimization level\n"
+            "    =O0                 -   No optimization\n"
+            "    =O1                 -   Some optimization\n"
+            "    =Os                 -   Optimize for size\n"
+            "  --gen-output=<string> - Output file\n"
+            "  --gen-ratio=<number>  - Inlining ratio\n"
+            "                          between 0 and 1\n"
+            "  --gen-verbose         - Print progress\n");
+}
+
+TEST(GeneratedOptionsTest, BindsToGenericParser) {
+  BuildConfig config;
+  {
+    static_option_binding<generated_options<BuildConfig>> binding(
+        BuildConfigOptions, config);
+    std::string help;
+    llvm::raw_string_ostream help_os(help);
+    PrintHelpMessage(help_os);
+    EXPECT_NE(help.find("--gen-opt=<value>"), std::string::npos) << help;
+    EXPECT_NE(help.find("=Os"), std::string::npos) << help;
+
+    // Enum values also parse through the proxies on the generic path.
+    std::vector<const char*> argv{"prog", "--gen-opt=O0",
+                                  "--help-cache-depth=9", "x.c"};
+    ASSERT_TRUE(binding.parse(static_cast<int>(argv.size()), argv.data(), "",
+                              &llvm::nulls()));
+    EXPECT_EQ(HelpCache::Depth, 9);
+    EXPECT_EQ(config.Level, OptLevel::O0);
+    EXPECT_EQ(config.Inputs, (std::vector<std::string>{"x.c"}));
+    ResetAllOptionOccurrences();
+    EXPECT_EQ(config.Level, OptLevel::O1);
+  }
+  EXPECT_EQ(getRegisteredOptions().count("gen-opt"), 0u);
+
+  // The generated literals also serve hand-written options.
+  opt<OptLevel> level("gen-level", helper::getOptLevelValues());
+  std::vector<const char*> argv{"prog", "--gen-level=Os"};
+  EXPECT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls()));
+  EXPECT_EQ(level, OptLevel::Size);
+  ResetAllOptionOccurrences();
+  level.removeArgument();
+}
+
+}  // namespace Generated
+
+namespace Field {
+
+struct FieldConfig {
+  int Jobs = 4;
+  bool Verbose = false;
+  std::string Output = "out";
+  std::vector<std::string> Libs{"c"};
+};
+
+TEST(FieldTest, ParsesIntoConfigMembers) {
+  FieldConfig& config = getConfig<FieldConfig>();
+  opt<int, true> jobs("field-jobs", field(&FieldConfig::Jobs));
+  opt<bool, true> verbose("field-verbose", field(&FieldConfig::Verbose));
+  opt<std::string, true> output("field-output", field(&FieldConfig::Output));
+  list<std::string, std::vector<std::string>> libs(
+      "field-lib", field(&FieldConfig::Libs));
+
+  std::vector<const char*> argv{"prog", "--field-jobs=8", "--field-verbose",
+                                "--field-lib=m", "--field-lib=z"};
+  EXPECT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls()));
+  EXPECT_EQ(config.Jobs, 8);
+  EXPECT_TRUE(config.Verbose);
+  EXPECT_EQ(config.Output, "out");
+  EXPECT_EQ(config.Libs, (std::vector<std::string>{"m", "z"}));
+  EXPECT_EQ(jobs, 8);
+
+  std::string printed;
+  llvm::raw_string_ostream os(printed);
+  static_cast<Option&>(jobs).printOptionValue(20, false, os);
+  static_cast<Option&>(output).printOptionValue(20, false, os);
+  EXPECT_NE(printed.find("(default: 4)"), std::string::npos) << printed;
+  EXPECT_EQ(printed.find("field-output"), std::string::npos) << printed;
+
+  // A copy of the config is a snapshot; resetting restores each field.
+  FieldConfig snapshot = config;
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(config.Jobs, 4);
+  EXPECT_FALSE(config.Verbose);
+  EXPECT_EQ(config.Libs, (std::vector<std::string>{"c"}));
+  EXPECT_EQ(snapshot.Jobs, 8);
+  EXPECT_EQ(snapshot.Libs, (std::vector<std::string>{"m", "z"}));
+
+  jobs.removeArgument();
+  verbose.removeArgument();
+  output.removeArgument();
+  libs.removeArgument();
+}
+
+TEST(FieldTest, BindsToGivenObject) {
+  FieldConfig config;
+  config.Jobs = 2;
+  opt<int, true> jobs("field-object-jobs", field(config, &FieldConfig::Jobs));
+  std::vector<const char*> argv{"prog", "--field-object-jobs=3"};
+  EXPECT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls()));
+  EXPECT_EQ(config.Jobs, 3);
+  EXPECT_EQ(getConfig<FieldConfig>().Jobs, 4);
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(config.Jobs, 2);
+  jobs.removeArgument();
+}
+
+TEST(FieldTest, LocationListStillAppends) {
+  std::vector<std::string> libs{"c"};
+  list<std::string, std::vector<std::string>> lib("location-lib",
+                                                 location(libs));
+  std::vector<const char*> argv{"prog", "--location-lib=m"};
+  EXPECT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls()));
+  EXPECT_EQ(libs, (std::vector<std::string>{"c", "m"}));
+  // Resetting leaves the user's storage alone.
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(libs, (std::vector<std::string>{"c", "m"}));
+  lib.removeArgument();
+}
+
+}  // namespace Field
+
+namespace Packed {
+
+TEST(PackedFlagTest, StoresFlagsInSharedBitset) {
+  packed_flag a("packed-a", desc("First toggle"));
+  packed_flag b("packed-b", init(true));
+  packed_flag c("packed-c");
+  EXPECT_EQ(b.getIndex(), a.getIndex() + 1);
+  EXPECT_FALSE(a);
+  EXPECT_TRUE(b);
+
+  std::vector<const char*> argv{"prog", "--packed-a", "--packed-b=false",
+                                "-packed-c=1"};
+  EXPECT_TRUE(ParseCommandLineOptions(static_cast<int>(argv.size()),
+                                      argv.data(), "", &llvm::nulls()));
+  EXPECT_TRUE(a);
+  EXPECT_FALSE(b);
+  EXPECT_TRUE(c.getRef().test());
+
+  packed_flag_snapshot snapshot = takePackedFlagSnapshot();
+  EXPECT_TRUE(snapshot.test(a));
+  EXPECT_FALSE(snapshot.test(b));
+  EXPECT_TRUE(snapshot.test(c));
+
+  std::string printed;
+  llvm::raw_string_ostream os(printed);
+  static_cast<Option&>(b).printOptionValue(20, false, os);
+  EXPECT_NE(printed.find("(default: 1)"), std::string::npos) << printed;
+
+  ResetAllOptionOccurrences();
+  EXPECT_FALSE(a);
+  EXPECT_TRUE(b);
+  EXPECT_FALSE(c);
+  EXPECT_TRUE(snapshot.test(a));
+
+  a.removeArgument();
+  b.removeArgument();
+  c.removeArgument();
+}
+
+TEST(PackedFlagTest, ReusesBitsOfDestroyedFlags) {
+  unsigned index = 0;
+  {
+    packed_flag temporary("packed-temporary", init(true));
+    index = temporary.getIndex();
+    temporary.removeArgument();
+  }
+  packed_flag reused("packed-reused");
+  EXPECT_EQ(reused.getIndex(), index);
+  EXPECT_FALSE(reused);
+  reused.removeArgument();
+}
+
+TEST(PackedFlagTest, CannotBeOverridden) {
+  packed_flag flag("packed-fixed");
+  std::string errors;
+  llvm::raw_string_ostream os(errors);
+  llvm::raw_ostream* previous = redirectThreadErrors(&os);
+  ScopedOptionOverride scope;
+  EXPECT_TRUE(scope.parse("packed-fixed", "true"));
+  redirectThreadErrors(previous);
+  EXPECT_EQ(scope.size(), 0u);
+  EXPECT_FALSE(flag);
+  EXPECT_NE(errors.find("value cannot be overridden"), std::string::npos)
+      << errors;
+  flag.removeArgument();
+}
+
+}  // namespace Packed
+
+namespace Dynamic {
+
+auto pluginSchema() -> llvm::json::Value {
+  return llvm::json::Object{
+      {"categories",
+       llvm::json::Array{llvm::json::Object{
+           {"name", "Plugin options"}, {"description", "Set by the plugin"}}}},
+      {"subcommands",
+       llvm::json::Array{llvm::json::Object{
+           {"name", "plugin-run"}, {"description", "Run the plugin"}}}},
+      {"options",
+       llvm::json::Array{
+           llvm::json::Object{{"name", "plugin-level"},
+                              {"type", "int"},
+                              {"value_name", "N"},
+                              {"description", "Plugin level"},
+                              {"default", 3},
+                              {"categories", llvm::json::Array{"Plugin options"}}},
+           llvm::json::Object{
+               {"name", "plugin-mode"},
+               {"type", "enum"},
+               {"default", "fast"},
+               {"values",
+                llvm::json::Array{
+                    llvm::json::Object{{"name", "fast"},
+                                       {"description", "Go fast"}},
+                    llvm::json::Object{{"name", "safe"},
+                                       {"description", "Check everything"}}}}},
+           llvm::json::Object{{"name", "plugin-path"},
+                              {"type", "string"},
+                              {"kind", "list"},
+                              {"default", llvm::json::Array{"lib"}}},
+           llvm::json::Object{{"name", "plugin-target"},
+                              {"type", "string"},
+                              {"occurrences", "Required"},
+                              {"subcommands", llvm::json::Array{"plugin-run"}}},
+       }},
+  };
+}
+
+TEST(DynamicOptionsTest, RegistersOptionsFromSchema) {
+  dynamic_option_set set;
+  ASSERT_FALSE(llvm::errorToBool(set.load(pluginSchema())));
+  ASSERT_EQ(set.size(), 4u);
+  dynamic_option* level = set.lookup("plugin-level");
+  dynamic_option* mode = set.lookup("plugin-mode");
+  dynamic_option* path = set.lookup("plugin-path");
+  ASSERT_TRUE(level && mode && path);
+  EXPECT_EQ(level->getInt(), 3);
+  EXPECT_EQ(mode->getLiteral(), "fast");
+
+  EXPECT_TRUE(parse({"prog", "--plugin-level=7", "--plugin-mode=safe",
+                     "--plugin-path=a", "--plugin-path=b"}));
+  std::string help;
+  llvm::raw_string_ostream help_os(help);
+  PrintHelpMessage(help_os, false, true);
+  EXPECT_NE(help.find("Plugin options:"), std::string::npos) << help;
+  EXPECT_NE(help.find("--plugin-level=<N>"), std::string::npos) << help;
+  EXPECT_NE(help.find("=safe"), std::string::npos) << help;
+  EXPECT_NE(help.find("Check everything"), std::string::npos) << help;
+
+  EXPECT_EQ(level->getInt(), 7);
+  EXPECT_EQ(mode->getLiteral(), "safe");
+  ASSERT_EQ(path->getValues().size(), 2u);
+  EXPECT_EQ(path->formatValue(path->getValues()[1]), "b");
+
+  std::string printed;
+  llvm::raw_string_ostream os(printed);
+  static_cast<Option*>(level)->printOptionValue(20, false, os);
+  EXPECT_NE(printed.find("= 7"), std::string::npos) << printed;
+  EXPECT_NE(printed.find("(default: 3)"), std::string::npos) << printed;
+
+  // The Required option of the new subcommand is checked like any other.
+  EXPECT_FALSE(parse({"prog", "plugin-run"}));
+  EXPECT_TRUE(parse({"prog", "plugin-run", "--plugin-target=x86"}));
+  EXPECT_EQ(set.lookup("plugin-target")->getString(), "x86");
+  EXPECT_FALSE(parse({"prog", "--plugin-level=x"}));
+
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(level->getInt(), 3);
+  EXPECT_EQ(path->formatValue(path->getValues()[0]), "lib");
+
+  set.clear();
+  EXPECT_EQ(set.size(), 0u);
+  EXPECT_EQ(getRegisteredOptions().count("plugin-level"), 0u);
+  for (SubCommand* sub : getRegisteredSubcommands()) {
+    EXPECT_NE(sub->getName(), "plugin-run");
+  }
+  EXPECT_EQ(findRegisteredCategory("Plugin options"), nullptr);
+
+  // Loading again creates them afresh.
+  ASSERT_FALSE(llvm::errorToBool(set.load(pluginSchema())));
+  EXPECT_NE(findRegisteredCategory("Plugin options"), nullptr);
+  set.clear();
+}
+
+TEST(DynamicOptionsTest, ClearsDefaultOptions) {
+  dynamic_option_set set;
+  llvm::json::Value schema = llvm::json::Object{
+      {"options", llvm::json::Array{llvm::json::Object{
+                      {"name", "plugin-quiet"},
+                      {"type", "bool"},
+                      {"misc", llvm::json::Array{"DefaultOption"}}}}}};
+  ASSERT_FALSE(llvm::errorToBool(set.load(schema)));
+  EXPECT_TRUE(parse({"prog", "--plugin-quiet"}));
+  EXPECT_TRUE(set.lookup("plugin-quiet")->getBool());
+  ResetAllOptionOccurrences();
+
+  // The next parse must not add the destroyed option back.
+  set.clear();
+  EXPECT_FALSE(parse({"prog", "--plugin-quiet"}));
+  EXPECT_EQ(getRegisteredOptions().count("plugin-quiet"), 0u);
+  ResetAllOptionOccurrences();
+}
+
+TEST(DynamicOptionsTest, RejectsBadSchemaWhole) {
+  dynamic_option_set set;
+  llvm::json::Value schema = llvm::json::Object{
+      {"options",
+       llvm::json::Array{
+           llvm::json::Object{{"name", "plugin-ok"}, {"type", "bool"}},
+           llvm::json::Object{{"name", "plugin-bad"},
+                              {"type", "int"},
+                              {"default", "three"}},
+       }}};
+  llvm::Error error = set.load(schema);
+  ASSERT_TRUE(bool(error));
+  EXPECT_NE(llvm::toString(std::move(error)).find("plugin-bad"),
+            std::string::npos);
+  EXPECT_EQ(set.size(), 0u);
+  EXPECT_EQ(getRegisteredOptions().count("plugin-ok"), 0u);
+
+  // Names already registered by the program are refused too.
+  schema = llvm::json::Object{
+      {"options", llvm::json::Array{llvm::json::Object{
+                      {"name", "help-cache-depth"}, {"type", "int"}}}}};
+  EXPECT_TRUE(llvm::errorToBool(set.load(schema)));
+  EXPECT_EQ(set.size(), 0u);
+}
+
+}  // namespace Dynamic
+
+namespace Scope {
+
+enum Pass { Inline, Unroll, PluginPass };
+
+static opt<Pass> HostPass("scope-pass", desc("Pass to run"),
+                          values(clEnumValN(Inline, "inline", ""),
+                                 clEnumValN(Unroll, "unroll", "")));
+
+TEST(RegistrationScopeTest, UnregistersEverythingTogether) {
+  auto scope = std::make_unique<registration_scope>();
+  // What a plugin registers while it loads.
+  OptionCategory category("Scope plugin");
+  SubCommand command("scope-plugin", "Plugin command");
+  opt<int> level("scope-level", cat(category));
+  list<std::string> inputs(Positional, sub(command));
+  opt<Pass> literal(desc("Literal passes"),
+                    values(clEnumValN(Inline, "scope-inline", ""),
+                           clEnumValN(Unroll, "scope-unroll", "")));
+  HostPass.getParser().addLiteralOption("plugin", PluginPass, "From plugin");
+  scope->close();
+  EXPECT_EQ(scope->getOptions().size(), 3u);
+  EXPECT_FALSE(scope->isActive());
+
+  EXPECT_TRUE(parse({"prog", "--scope-level=2", "-scope-unroll",
+                     "--scope-pass=plugin"}));
+  EXPECT_EQ(level, 2);
+  EXPECT_EQ(literal, Unroll);
+  EXPECT_EQ(HostPass, PluginPass);
+  ResetAllOptionOccurrences();
+
+  // Registrations after close() are not recorded.
+  opt<bool> later("scope-later");
+  EXPECT_EQ(scope->getOptions().size(), 3u);
+
+  scope.reset();
+  llvm::StringMap<Option*>& options = getRegisteredOptions();
+  EXPECT_EQ(options.count("scope-level"), 0u);
+  EXPECT_EQ(options.count("scope-unroll"), 0u);
+  EXPECT_EQ(options.count("scope-later"), 1u);
+  EXPECT_EQ(options.count("scope-pass"), 1u);
+  EXPECT_EQ(findRegisteredCategory("Scope plugin"), nullptr);
+  for (SubCommand* registered : getRegisteredSubcommands()) {
+    EXPECT_NE(registered->getName(), "scope-plugin");
+  }
+  EXPECT_TRUE(parse({"prog", "--scope-pass=unroll"}));
+  EXPECT_FALSE(parse({"prog", "--scope-pass=plugin"}));
+  ResetAllOptionOccurrences();
+  later.removeArgument();
+}
+
+}  // namespace Scope
+
+namespace Concurrent {
+
+static opt<int> Round("concurrent-round", desc("Parse round"));
+
+TEST(ConcurrentRegistrationTest, RegistersWhileParsing) {
+  constexpr int num_threads = 32;
+  constexpr int per_thread = 16;
+  std::vector<std::string> names;
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < per_thread; ++i) {
+      names.push_back("concurrent-" + std::to_string(t) + "-" +
+                      std::to_string(i));
+    }
+  }
+  std::vector<std::string> category_names;
+  for (int t = 0; t < num_threads; ++t) {
+    category_names.push_back("Concurrent " + std::to_string(t));
+  }
+
+  std::vector<std::unique_ptr<opt<int>>> options(names.size());
+  // Categories cannot be unregistered from outside a registration_scope, so
+  // these stay registered, and alive, for the rest of the run.
+  static std::vector<std::unique_ptr<OptionCategory>> categories(num_threads);
+  std::atomic<int> finished{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      categories[t] = std::make_unique<OptionCategory>(category_names[t]);
+      for (int i = 0; i < per_thread; ++i) {
+        size_t n = t * per_thread + i;
+        options[n] = std::make_unique<opt<int>>(llvm::StringRef(names[n]),
+                                                cat(*categories[t]),
+                                                init(static_cast<int>(n)));
+      }
+      finished.fetch_add(1);
+    });
+  }
+
+  int rounds = 0;
+  while (finished.load() != num_threads) {
+    std::string arg = "--concurrent-round=" + std::to_string(++rounds);
+    EXPECT_TRUE(parse({"prog", arg.c_str()}));
+    EXPECT_EQ(Round, rounds);
+    ResetAllOptionOccurrences();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  llvm::StringMap<Option*>& registered = getRegisteredOptions();
+  for (const std::string& name : names) {
+    EXPECT_EQ(registered.count(name), 1u) << name;
+  }
+  EXPECT_NE(findRegisteredCategory("Concurrent 7"), nullptr);
+  EXPECT_TRUE(parse({"prog", "--concurrent-3-5=-1"}));
+  EXPECT_EQ(*options[3 * per_thread + 5], -1);
+  ResetAllOptionOccurrences();
+
+  std::vector<Option*> all;
+  for (auto& option : options) {
+    all.push_back(option.get());
+  }
+  Option::removeArguments(all);
+  EXPECT_EQ(getRegisteredOptions().count(names[0]), 0u);
+}
+
+TEST(ConcurrentRegistrationTest, QueriesWhileParsing) {
+  std::unique_ptr<opt<int>> late;
+  std::atomic<bool> done{false};
+  std::thread querier([&] {
+    late = std::make_unique<opt<int>>("concurrent-late", init(5));
+    while (!done.load()) {
+      EXPECT_EQ(findRegisteredOption("concurrent-round"), &Round);
+      EXPECT_NE(findRegisteredCategory(getGeneralCategory().getName()),
+                nullptr);
+      ScopedOptionOverride scope;
+      EXPECT_FALSE(scope.parse("concurrent-round", "-1"));
+      EXPECT_EQ(Round, -1);
+    }
+  });
+  for (int round = 1; round <= 200; ++round) {
+    std::string arg = "--concurrent-round=" + std::to_string(round);
+    EXPECT_TRUE(parse({"prog", arg.c_str()}));
+    EXPECT_EQ(Round, round);
+  }
+  done.store(true);
+  querier.join();
+
+  EXPECT_TRUE(parse({"prog", "--concurrent-late=6"}));
+  EXPECT_EQ(*late, 6);
+  ResetAllOptionOccurrences();
+  late->removeArgument();
+}
+
+TEST(ConcurrentRegistrationTest, UnregistersWhileParsing) {
+  std::atomic<bool> done{false};
+  std::thread plugin([&] {
+    for (int round = 0; !done.load(); ++round) {
+      // A plugin loaded and unloaded while the main thread parses.
+      registration_scope scope;
+      OptionCategory category("Concurrent plugin");
+      opt<int> level("concurrent-plugin-level", cat(category));
+      scope.close();
+      scope.unregister();
+    }
+  });
+  for (int round = 1; round <= 200; ++round) {
+    std::string arg = "--concurrent-round=" + std::to_string(round);
+    EXPECT_TRUE(parse({"prog", arg.c_str()}));
+    EXPECT_EQ(Round, round);
+    ResetAllOptionOccurrences();
+  }
+  done.store(true);
+  plugin.join();
+
+  // Nothing the plugin registered is applied after it was unloaded.
+  llvm::StringMap<Option*>& registered = getRegisteredOptions();
+  EXPECT_EQ(registered.count("concurrent-plugin-level"), 0u);
+  EXPECT_EQ(findRegisteredCategory("Concurrent plugin"), nullptr);
+}
+
+TEST(ConcurrentRegistrationTest, UnregistersFromParseCallback) {
+  // The parse defers the registration until it ends, so unregistering has to
+  // cancel it.
+  static opt<bool> Load(
+      "concurrent-load", callback([](const bool&) {
+        registration_scope scope;
+        opt<int> level("concurrent-loaded-level");
+        SubCommand command("concurrent-loaded", "Loaded command");
+      }));
+  EXPECT_TRUE(parse({"prog", "--concurrent-load"}));
+  ResetAllOptionOccurrences();
+  EXPECT_EQ(getRegisteredOptions().count("concurrent-loaded-level"), 0u);
+  for (SubCommand* registered : getRegisteredSubcommands()) {
+    EXPECT_NE(registered->getName(), "concurrent-loaded");
+  }
+  Load.removeArgument();
+}
+
+}  // namespace Concurrent
+
+namespace Override {
+
+static opt<bool> Verbose("override-verbose", desc("Verbose output"));
+static opt<std::string> DebugOnly("override-debug-only", desc("Debug type"),
+                                  init("none"));
+
+TEST(ScopedOptionOverrideTest, OverridesOnlyTheCurrentThread) {
+  std::atomic<bool> overridden{false};
+  std::atomic<bool> checked{false};
+  std::thread worker([&] {
+    ScopedOptionOverride debug(Verbose, true);
+    EXPECT_FALSE(debug.parse("override-debug-only", "isel"));
+    EXPECT_TRUE(debug.parse("override-debug-only-typo", "isel"));
+    EXPECT_EQ(debug.size(), 2u);
+    overridden = true;
+    while (!checked) {
+      std::this_thread::yield();
+    }
+    EXPECT_TRUE(Verbose);
+    EXPECT_EQ(DebugOnly.getValue(), "isel");
+    {
+      ScopedOptionOverride inner(Verbose, false);
+      EXPECT_FALSE(Verbose);
+    }
+    EXPECT_TRUE(Verbose);
+  });
+  while (!overridden) {
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(Verbose);
+  EXPECT_EQ(DebugOnly.getValue(), "none");
+  checked = true;
+  worker.join();
+
+  ScopedOptionOverride bad;
+  EXPECT_TRUE(bad.parse(Verbose, "maybe"));
+  EXPECT_EQ(bad.size(), 0u);
+  ConfigFingerprint original = GetConfigFingerprint();
+  {
+    ScopedOptionOverride local(DebugOnly, "local");
+    EXPECT_EQ(DebugOnly.getValue(), "local");
+    // Queue a rehash; the fingerprint still hashes the global value.
+    DebugOnly = "none";
+    EXPECT_EQ(GetConfigFingerprint(), original);
+  }
+  EXPECT_EQ(DebugOnly.getValue(), "none");
+}
+
+}  // namespace Override
+
+namespace Diagnostics {
+
+TEST(ParseDiagnosticsTest, RecordsErrorsWithoutExiting) {
+  opt<int> level("diag-level", desc("Level"));
+  opt<std::string> output("diag-output", Required, desc("Output"));
+  const char* args[] = {"prog", "--diag-levl=3", "--diag-level=high"};
+
+  ParseDiagnostics diags;
+  EXPECT_EQ(ParseCommandLineOptions(3, args, diags), ParseResult::Error);
+  ASSERT_EQ(diags.getRecords().size(), 3u);
+  const ParseDiagnostic& unknown = diags.getRecords()[0];
+  EXPECT_EQ(unknown.Kind, ParseDiagnosticKind::UnknownArgument);
+  EXPECT_EQ(unknown.ArgIndex, 1);
+  EXPECT_EQ(unknown.Arg, "--diag-levl=3");
+  EXPECT_EQ(unknown.Suggestion, "diag-level=3");
+  const ParseDiagnostic& invalid = diags.getRecords()[1];
+  EXPECT_EQ(invalid.Kind, ParseDiagnosticKind::OptionError);
+  EXPECT_EQ(invalid.ArgIndex, 2);
+  EXPECT_EQ(invalid.Opt, &level);
+  const ParseDiagnostic& missing = diags.getRecords()[2];
+  EXPECT_EQ(missing.Kind, ParseDiagnosticKind::MissingRequired);
+  EXPECT_EQ(missing.ArgIndex, -1);
+  EXPECT_EQ(missing.Opt, &output);
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  diags.print(os, unknown);
+  EXPECT_EQ(os.str(),
+            "prog: Unknown command line argument '--diag-levl=3'.  Try: "
+            "'prog --help'\nprog: Did you mean '--diag-level=3'?\n");
+  ResetAllOptionOccurrences();
+
+  diags.setFailFast(true);
+  EXPECT_EQ(ParseCommandLineOptions(3, args, diags), ParseResult::Error);
+  ASSERT_EQ(diags.getRecords().size(), 1u);
+  EXPECT_EQ(diags.getRecords()[0].Kind, ParseDiagnosticKind::UnknownArgument);
+  ResetAllOptionOccurrences();
+
+  const char* valid[] = {"prog", "--diag-output=a", "--diag-level=2"};
+  EXPECT_EQ(ParseCommandLineOptions(3, valid, diags), ParseResult::Success);
+  EXPECT_TRUE(diags.empty());
+  EXPECT_EQ(level, 2);
+  ResetAllOptionOccurrences();
+
+  level.removeArgument();
+  output.removeArgument();
+}
+
+TEST(ParseDiagnosticsTest, ReturnsHelpAndVersionRequests) {
+  ParseDiagnostics diags;
+  const char* help[] = {"prog", "--help-hidden", "--no-such-option"};
+  EXPECT_EQ(ParseCommandLineOptions(3, help, diags), ParseResult::Help);
+  EXPECT_TRUE(diags.isHelpHidden());
+  EXPECT_TRUE(diags.empty());
+  ResetAllOptionOccurrences();
+
+  const char* version[] = {"prog", "--version"};
+  EXPECT_EQ(ParseCommandLineOptions(2, version, diags), ParseResult::Version);
+  ResetAllOptionOccurrences();
+}
+
+}  // namespace Diagnostics
+
+}  // namespace
+
+}  // namespace Commandline
@@ -0,0 +1,68 @@
+// Replacement global operator new and delete that report every allocation to
+// RecordParseAllocation, so that ParseStats counts the heap allocations of
+// each parse phase. Link this into a test to measure allocations.
+
+#include <cstdlib>
+#include <new>
+
+#include "ParseStats.h"
+
+namespace {
+
+auto allocate(std::size_t size) -> void* {
+  Commandline::RecordParseAllocation(size);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+auto allocateAligned(std::size_t size, std::align_val_t alignment) -> void* {
+  Commandline::RecordParseAllocation(size);
+  void* p = nullptr;
+  std::size_t align = static_cast<std::size_t>(alignment);
+  if (align < sizeof(void*)) {
+    align = sizeof(void*);
+  }
+  if (posix_memalign(&p, align, size ? size : 1) != 0) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+}  // namespace
+
+auto operator new(std::size_t size) -> void* { return allocate(size); }
+auto operator new[](std::size_t size) -> void* { return allocate(size); }
+auto operator new(std::size_t size, const std::nothrow_t&) noexcept -> void* {
+  Commandline::RecordParseAllocation(size);
+  return std::malloc(size ? size : 1);
+}
+auto operator new[](std::size_t size, const std::nothrow_t&) noexcept
+    -> void* {
+  Commandline::RecordParseAllocation(size);
+  return std::malloc(size ? size : 1);
+}
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+  return allocateAligned(size, alignment);
+}
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void* {
+  return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,865 @@
+// commandline-optgen: turn a JSON option spec into a config struct and a
+// constant generated_options table (see src/GeneratedOptions.h).
+//
+// The spec is an object:
+//
+//   {
+//     "namespace": "tool",        // optional C++ namespace
+//     "struct": "ToolConfig",     // the config struct
+//     "options": [
+//       {"name": "jobs", "type": "int", "default": 4, "value_name": "N",
+//        "description": "Parallel jobs"},
+//       {"name": "level", "type": "enum", "enum": "Level",
+//        "values": [{"name": "fast", "description": "Fast"},
+//                   {"name": "small", "enumerator": "Small"}]},
+//       {"name": "D", "kind": "list", "type": "string", "field": "Defines"},
+//       {"kind": "list", "positional": true, "type": "string",
+//        "field": "Inputs", "description": "<inputs>"}
+//     ]
+//   }
+//
+// Types are bool, int, uint, long, ulong, number, string and enum, named as in
+// the option schema. Kinds are opt (the default) and list. Fields default to
+// the option name in CamelCase, enumerators to the literal in CamelCase.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "Behavior.h"
+#include "CommandLine.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace Commandline {
+
+namespace {
+
+opt<std::string> SpecPath(Positional, Required, desc("<spec.json>"));
+opt<std::string> OutputBase("o", Required,
+                            desc("Write <base>.h and <base>.cc"),
+                            value_desc("base"));
+
+struct EnumValueSpec {
+  std::string Name;
+  std::string Help;
+  std::string Enumerator;
+};
+
+struct OptionSpec {
+  std::string Name;
+  std::string Help;
+  std::string ValueName;
+  std::string Field;
+  std::string Type;     // the spec type, e.g. "uint"
+  std::string CppType;  // the element type in C++, e.g. "unsigned"
+  static_option_kind Kind = static_option_kind::Value;
+  std::string EnumName;
+  std::vector<EnumValueSpec> Values;
+  std::string Default;  // a C++ initializer, or empty for none
+  size_t Order = 0;     // the position in the spec
+};
+
+struct Spec {
+  std::string Namespace;
+  std::string Struct;
+  std::vector<OptionSpec> Options;  // sorted by name, positional last
+};
+
+auto specError(const llvm::Twine& message) -> llvm::Error {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), message);
+}
+
+auto isIdentifier(llvm::StringRef name) -> bool {
+  if (name.empty() || llvm::isDigit(name[0])) {
+    return false;
+  }
+  return llvm::all_of(
+      name, [](char c) { return llvm::isAlnum(c) || c == '_'; });
+}
+
+// "max-jobs" -> "MaxJobs".
+auto camelCase(llvm::StringRef name) -> std::string {
+  std::string result;
+  bool upper = true;
+  for (char c : name) {
+    if (!llvm::isAlnum(c)) {
+      upper = true;
+      continue;
+    }
+    result += upper ? llvm::toUpper(c) : c;
+    upper = false;
+  }
+  return result;
+}
+
+auto getString(const llvm::json::Object& object, llvm::StringRef key)
+    -> std::string {
+  if (auto value = object.getString(key)) {
+    return value->str();
+  }
+  return std::string();
+}
+
+// The C++ element type and help value name of a spec type.
+auto mapType(llvm::StringRef type, std::string& cpp_type,
+             std::string& value_name) -> bool {
+  static const std::map<std::string, std::pair<const char*, const char*>>
+      types = {{"bool", {"bool", ""}},
+               {"int", {"int", "int"}},
+               {"uint", {"unsigned", "uint"}},
+               {"long", {"long", "long"}},
+               {"ulong", {"unsigned long", "ulong"}},
+               {"number", {"double", "number"}},
+               {"string", {"std::string", "string"}}};
+  auto it = types.find(type.str());
+  if (it == types.end()) {
+    return false;
+  }
+  cpp_type = it->second.first;
+  value_name = it->second.second;
+  return true;
+}
+
+void writeStringLiteral(llvm::raw_ostream& os, llvm::StringRef text) {
+  os << '"';
+  for (unsigned char c : text) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (c < 0x20 || c == 0x7f) {
+          os << '\\' << static_cast<char>('0' + ((c >> 6) & 7))
+             << static_cast<char>('0' + ((c >> 3) & 7))
+             << static_cast<char>('0' + (c & 7));
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+auto quote(llvm::StringRef text) -> std::string {
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  writeStringLiteral(os, text);
+  return os.str();
+}
+
+// Return the C++ initializer for one default value of option.
+auto formatDefault(const OptionSpec& option, const llvm::json::Value& value)
+    -> llvm::Expected<std::string> {
+  auto mismatch = [&] {
+    return specError("option '" + option.Name + "': default does not match " +
+                     "type " + option.Type);
+  };
+  if (option.Type == "bool") {
+    if (auto b = value.getAsBoolean()) {
+      return std::string(*b ? "true" : "false");
+    }
+    return mismatch();
+  }
+  if (option.Type == "string") {
+    if (auto s = value.getAsString()) {
+      return quote(*s);
+    }
+    return mismatch();
+  }
+  if (option.Type == "enum") {
+    if (auto s = value.getAsString()) {
+      for (const EnumValueSpec& literal : option.Values) {
+        if (literal.Name == *s) {
+          return option.EnumName + "::" + literal.Enumerator;
+        }
+      }
+    }
+    return mismatch();
+  }
+  if (option.Type == "number") {
+    if (auto d = value.getAsNumber()) {
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), "%.17g", *d);
+      std::string text = buffer;
+      if (text.find_first_of(".eEn") == std::string::npos) {
+        text += ".0";
+      }
+      return text;
+    }
+    return mismatch();
+  }
+  auto i = value.getAsInteger();
+  if (!i) {
+    return mismatch();
+  }
+  bool is_unsigned = option.Type == "uint" || option.Type == "ulong";
+  if (is_unsigned && *i < 0) {
+    return mismatch();
+  }
+  std::string text = std::to_string(*i);
+  if (option.Type == "uint") {
+    text += "u";
+  } else if (option.Type == "long") {
+    text += "L";
+  } else if (option.Type == "ulong") {
+    text += "UL";
+  }
+  return text;
+}
+
+auto parseOption(const llvm::json::Object& object, OptionSpec& option)
+    -> llvm::Error {
+  option.Name = getString(object, "name");
+  option.Help = getString(object, "description");
+  option.Type = getString(object, "type");
+  std::string kind = getString(object, "kind");
+  bool positional = false;
+  if (auto value = object.getBoolean("positional")) {
+    positional = *value;
+  }
+  bool list = kind == "list";
+  if (!kind.empty() && kind != "opt" && !list) {
+    return specError("option '" + option.Name + "': unknown kind '" + kind +
+                     "'");
+  }
+  if (positional) {
+    option.Kind = list ? static_option_kind::PositionalList
+                       : static_option_kind::Positional;
+    if (!option.Name.empty()) {
+      return specError("positional option '" + option.Name +
+                       "' must not have a name");
+    }
+  } else if (option.Name.empty() || option.Name[0] == '-' ||
+             llvm::StringRef(option.Name).contains('=')) {
+    return specError("option name '" + option.Name + "' is not valid");
+  } else if (option.Type == "bool") {
+    if (list) {
+      return specError("option '" + option.Name + "': bool lists are not " +
+                       "supported");
+    }
+    option.Kind = static_option_kind::Flag;
+  } else {
+    option.Kind =
+        list ? static_option_kind::List : static_option_kind::Value;
+  }
+
+  option.Field = getString(object, "field");
+  if (option.Field.empty()) {
+    option.Field = camelCase(option.Name);
+  }
+  if (!isIdentifier(option.Field)) {
+    return specError("option '" + option.Name + "': field '" + option.Field +
+                     "' is not an identifier");
+  }
+
+  std::string value_name;
+  if (option.Type == "enum") {
+    option.EnumName = getString(object, "enum");
+    if (!isIdentifier(option.EnumName)) {
+      return specError("option '" + option.Name + "': enum options need an " +
+                       "\"enum\" type name");
+    }
+    const llvm::json::Array* values = object.getArray("values");
+    if (!values || values->empty()) {
+      return specError("option '" + option.Name + "': enum options need " +
+                       "\"values\"");
+    }
+    for (const llvm::json::Value& value : *values) {
+      const llvm::json::Object* literal = value.getAsObject();
+      if (!literal) {
+        return specError("option '" + option.Name + "': values must be " +
+                         "objects");
+      }
+      EnumValueSpec spec;
+      spec.Name = getString(*literal, "name");
+      spec.Help = getString(*literal, "description");
+      spec.Enumerator = getString(*literal, "enumerator");
+      if (spec.Enumerator.empty()) {
+        spec.Enumerator = camelCase(spec.Name);
+      }
+      if (!isIdentifier(spec.Enumerator)) {
+        return specError("option '" + option.Name + "': enumerator '" +
+                         spec.Enumerator + "' is not an identifier");
+      }
+      option.Values.push_back(std::move(spec));
+    }
+    option.CppType = option.EnumName;
+    value_name = "value";
+  } else if (!mapType(option.Type, option.CppType, value_name)) {
+    return specError("option '" + option.Name + "': unknown type '" +
+                     option.Type + "'");
+  }
+  option.ValueName = getString(object, "value_name");
+  if (option.ValueName.empty()) {
+    option.ValueName = value_name;
+  }
+
+  const llvm::json::Value* value = object.get("default");
+  // Scalars without a default start out zero, false or the first literal.
+  llvm::json::Value zero(0);
+  if (option.Type == "bool") {
+    zero = false;
+  } else if (option.Type == "enum") {
+    zero = option.Values[0].Name;
+  }
+  bool is_list = option.Kind == static_option_kind::List ||
+                 option.Kind == static_option_kind::PositionalList;
+  if (!value && !is_list && option.Type != "string") {
+    value = &zero;
+  }
+  if (value) {
+    if (is_list) {
+      const llvm::json::Array* elements = value->getAsArray();
+      if (!elements) {
+        return specError("option '" + option.Name + "': the default of a " +
+                         "list is an array");
+      }
+      std::vector<std::string> texts;
+      for (const llvm::json::Value& element : *elements) {
+        llvm::Expected<std::string> text = formatDefault(option, element);
+        if (!text) {
+          return text.takeError();
+        }
+        texts.push_back(std::move(*text));
+      }
+      option.Default = "{" + llvm::join(texts, ", ") + "}";
+    } else {
+      llvm::Expected<std::string> text = formatDefault(option, *value);
+      if (!text) {
+        return text.takeError();
+      }
+      option.Default = std::move(*text);
+    }
+  }
+  return llvm::Error::success();
+}
+
+auto parseSpec(llvm::StringRef text, Spec& spec) -> llvm::Error {
+  llvm::Expected<llvm::json::Value> root = llvm::json::parse(text);
+  if (!root) {
+    return root.takeError();
+  }
+  const llvm::json::Object* object = root->getAsObject();
+  if (!object) {
+    return specError("the spec must be a JSON object");
+  }
+  spec.Namespace = getString(*object, "namespace");
+  spec.Struct = getString(*object, "struct");
+  if (!isIdentifier(spec.Struct)) {
+    return specError("\"struct\" must name the config struct");
+  }
+  const llvm::json::Array* options = object->getArray("options");
+  if (!options || options->empty()) {
+    return specError("the spec has no \"options\"");
+  }
+  for (const llvm::json::Value& value : *options) {
+    const llvm::json::Object* option = value.getAsObject();
+    if (!option) {
+      return specError("options must be objects");
+    }
+    spec.Options.emplace_back();
+    spec.Options.back().Order = spec.Options.size() - 1;
+    if (llvm::Error error = parseOption(*option, spec.Options.back())) {
+      return error;
+    }
+  }
+
+  // Sorted by name, which puts the positional option (with no name) first;
+  // move it last.
+  std::stable_sort(spec.Options.begin(), spec.Options.end(),
+                   [](const OptionSpec& a, const OptionSpec& b) {
+                     if (a.Name.empty() != b.Name.empty()) {
+                       return b.Name.empty();
+                     }
+                     return a.Name < b.Name;
+                   });
+  std::map<std::string, const OptionSpec*> enums;
+  for (size_t i = 0; i < spec.Options.size(); ++i) {
+    const OptionSpec& option = spec.Options[i];
+    if (option.Name.empty()) {
+      if (i + 1 != spec.Options.size()) {
+        return specError("more than one positional option");
+      }
+    } else if (i > 0 && spec.Options[i - 1].Name == option.Name) {
+      return specError("option '" + option.Name + "' is defined twice");
+    }
+    for (size_t j = 0; j < i; ++j) {
+      if (spec.Options[j].Field == option.Field) {
+        return specError("field '" + option.Field + "' is used twice");
+      }
+    }
+    if (!option.EnumName.empty()) {
+      auto [it, inserted] = enums.emplace(option.EnumName, &option);
+      if (!inserted) {
+        const OptionSpec& first = *it->second;
+        bool same = first.Values.size() == option.Values.size();
+        for (size_t k = 0; same && k < option.Values.size(); ++k) {
+          same = first.Values[k].Name == option.Values[k].Name &&
+                 first.Values[k].Enumerator == option.Values[k].Enumerator;
+        }
+        if (!same) {
+          return specError("enum '" + option.EnumName +
+                           "' is declared with different values");
+        }
+      }
+    }
+  }
+  return llvm::Error::success();
+}
+
+//===----------------------------------------------------------------------===//
+// Perfect hash
+//
+// Names are spread over buckets of about four by hashOptionName with seed 0.
+// Buckets are placed largest first, each trying seeds until all of its names
+// land in distinct free slots of a power of two table at most half full.
+
+struct HashTables {
+  std::vector<uint32_t> BucketSeeds;
+  std::vector<uint32_t> Slots;
+};
+
+auto buildHash(const std::vector<OptionSpec>& options) -> HashTables {
+  std::vector<uint32_t> named;
+  for (uint32_t i = 0; i < options.size(); ++i) {
+    if (!options[i].Name.empty()) {
+      named.push_back(i);
+    }
+  }
+  size_t num_buckets = std::max<size_t>(1, (named.size() + 3) / 4);
+  size_t table_size = 2;
+  while (table_size < 2 * named.size()) {
+    table_size *= 2;
+  }
+
+  std::vector<std::vector<uint32_t>> buckets(num_buckets);
+  for (uint32_t index : named) {
+    buckets[hashOptionName(options[index].Name, 0) % num_buckets].push_back(
+        index);
+  }
+  std::vector<size_t> order(num_buckets);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  for (;;) {
+    HashTables tables;
+    tables.BucketSeeds.assign(num_buckets, 0);
+    tables.Slots.assign(table_size, GeneratedEmptySlot);
+    uint32_t mask = static_cast<uint32_t>(table_size - 1);
+    bool placed_all = true;
+    std::vector<uint32_t> slots;
+    for (size_t bucket : order) {
+      if (buckets[bucket].empty()) {
+        break;
+      }
+      bool placed = false;
+      for (uint32_t seed = 1; seed < (1u << 20) && !placed; ++seed) {
+        slots.clear();
+        placed = true;
+        for (uint32_t index : buckets[bucket]) {
+          uint32_t slot = hashOptionName(options[index].Name, seed) & mask;
+          if (tables.Slots[slot] != GeneratedEmptySlot ||
+              llvm::is_contained(slots, slot)) {
+            placed = false;
+            break;
+          }
+          slots.push_back(slot);
+        }
+        if (placed) {
+          tables.BucketSeeds[bucket] = seed;
+          for (size_t k = 0; k < slots.size(); ++k) {
+            tables.Slots[slots[k]] = buckets[bucket][k];
+          }
+        }
+      }
+      if (!placed) {
+        placed_all = false;
+        break;
+      }
+    }
+    if (placed_all) {
+      return tables;
+    }
+    table_size *= 2;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Help, laid out as the generic -help prints these options alone.
+
+auto argWidth(llvm::StringRef name) -> size_t {
+  // Two spaces, the dashes and " - ".
+  return name.size() + 2 + (name.size() == 1 ? 1 : 2) + 3;
+}
+
+auto optionWidth(const OptionSpec& option) -> size_t {
+  if (!option.Values.empty()) {
+    size_t width = argWidth(option.Name) + llvm::StringRef("=<value>").size();
+    for (const EnumValueSpec& literal : option.Values) {
+      width = std::max(width, literal.Name.size() + 8);
+    }
+    return width;
+  }
+  size_t width = argWidth(option.Name);
+  if (option.Kind != static_option_kind::Flag) {
+    width += option.ValueName.size() + 3;
+  }
+  return width;
+}
+
+void printHelpText(llvm::raw_ostream& os, llvm::StringRef help, size_t indent,
+                   size_t first_line_indented_by, llvm::StringRef prefix) {
+  std::pair<llvm::StringRef, llvm::StringRef> split = help.split('\n');
+  os.indent(indent - first_line_indented_by)
+      << " - " << prefix << split.first << "\n";
+  while (!split.second.empty()) {
+    split = split.second.split('\n');
+    os.indent(indent + prefix.size()) << split.first << "\n";
+  }
+}
+
+auto renderHelp(const Spec& spec) -> std::string {
+  std::string help;
+  llvm::raw_string_ostream os(help);
+  os << " [options]";
+  const OptionSpec& last = spec.Options.back();
+  if (last.Name.empty()) {
+    os << " " << last.Help;
+  }
+  os << "\n\nOPTIONS:\n";
+
+  size_t width = 0;
+  for (const OptionSpec& option : spec.Options) {
+    if (!option.Name.empty()) {
+      width = std::max(width, optionWidth(option));
+    }
+  }
+  for (const OptionSpec& option : spec.Options) {
+    if (option.Name.empty()) {
+      continue;
+    }
+    llvm::StringRef dashes = option.Name.size() == 1 ? "-" : "--";
+    os << "  " << dashes << option.Name;
+    if (!option.Values.empty()) {
+      os << "=<value>";
+      printHelpText(os, option.Help, width,
+                    argWidth(option.Name) + llvm::StringRef("=<value>").size(),
+                    "");
+      for (const EnumValueSpec& literal : option.Values) {
+        os << "    =" << literal.Name;
+        if (literal.Help.empty()) {
+          os << "\n";
+        } else {
+          printHelpText(os, literal.Help, width, literal.Name.size() + 8,
+                        "  ");
+        }
+      }
+      continue;
+    }
+    if (option.Kind != static_option_kind::Flag) {
+      os << (option.Name.size() == 1 ? " <" : "=<") << option.ValueName
+         << ">";
+    }
+    printHelpText(os, option.Help, width, optionWidth(option), "");
+  }
+  return os.str();
+}
+
+//===----------------------------------------------------------------------===//
+// Output
+
+auto headerGuard(llvm::StringRef base) -> std::string {
+  std::string guard;
+  for (char c : base) {
+    guard += llvm::isAlnum(c) ? llvm::toUpper(c) : '_';
+  }
+  return guard + "_H";
+}
+
+auto fieldType(const OptionSpec& option) -> std::string {
+  if (option.Kind == static_option_kind::List ||
+      option.Kind == static_option_kind::PositionalList) {
+    return "std::vector<" + option.CppType + ">";
+  }
+  return option.CppType;
+}
+
+void writeHeader(llvm::raw_ostream& os, const Spec& spec,
+                 llvm::StringRef spec_name, llvm::StringRef base) {
+  std::string guard = headerGuard(base);
+  os << "// Generated by commandline-optgen from " << spec_name
+     << ". Do not edit.\n\n"
+     << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+     << "#include <string>\n#include <vector>\n\n"
+     << "#include \"CommandLine.h\"\n\n";
+  if (!spec.Namespace.empty()) {
+    os << "namespace " << spec.Namespace << " {\n\n";
+  }
+
+  std::vector<std::string> written;
+  for (const OptionSpec& option : spec.Options) {
+    if (option.EnumName.empty() ||
+        llvm::is_contained(written, option.EnumName)) {
+      continue;
+    }
+    written.push_back(option.EnumName);
+    os << "enum class " << option.EnumName << " {\n";
+    for (const EnumValueSpec& literal : option.Values) {
+      os << "  " << literal.Enumerator << ",\n";
+    }
+    os << "};\n\n"
+       << "// The literals of " << option.EnumName
+       << ", for cl::opt<" << option.EnumName << "> options.\n"
+       << "inline auto get" << option.EnumName
+       << "Values() -> Commandline::ValuesClass {\n"
+       << "  return Commandline::ValuesClass({\n";
+    for (const EnumValueSpec& literal : option.Values) {
+      os << "      {" << quote(literal.Name) << ", int(" << option.EnumName
+         << "::" << literal.Enumerator << "), " << quote(literal.Help)
+         << "},\n";
+    }
+    os << "  });\n}\n\n";
+  }
+
+  // Fields are declared in spec order.
+  std::vector<const OptionSpec*> fields(spec.Options.size());
+  for (const OptionSpec& option : spec.Options) {
+    fields[option.Order] = &option;
+  }
+  os << "struct " << spec.Struct << " {\n";
+  for (const OptionSpec* field : fields) {
+    const OptionSpec& option = *field;
+    llvm::StringRef summary = llvm::StringRef(option.Help).split('\n').first;
+    if (!summary.empty()) {
+      os << "  // " << summary << "\n";
+    }
+    os << "  " << fieldType(option) << " " << option.Field;
+    if (!option.Default.empty()) {
+      os << (option.Default[0] == '{' ? "" : " = ") << option.Default;
+    }
+    os << ";\n";
+  }
+  os << "};\n\n"
+     << "// The options of " << spec.Struct << ". Constant initialized.\n"
+     << "extern const Commandline::generated_options<" << spec.Struct << "> "
+     << spec.Struct << "Options;\n\n";
+  if (!spec.Namespace.empty()) {
+    os << "}  // namespace " << spec.Namespace << "\n\n";
+  }
+  os << "#endif  // " << guard << "\n";
+}
+
+auto kindName(static_option_kind kind) -> llvm::StringRef {
+  switch (kind) {
+    case static_option_kind::Flag:
+      return "Flag";
+    case static_option_kind::Value:
+      return "Value";
+    case static_option_kind::List:
+      return "List";
+    case static_option_kind::Positional:
+      return "Positional";
+    case static_option_kind::PositionalList:
+      return "PositionalList";
+  }
+  return "Value";
+}
+
+void writeNumbers(llvm::raw_ostream& os, llvm::StringRef name,
+                  const std::vector<uint32_t>& numbers) {
+  os << "constexpr uint32_t " << name << "[] = {";
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    os << (i % 8 == 0 ? "\n    " : " ");
+    if (numbers[i] == GeneratedEmptySlot) {
+      os << "0xffffffff";
+    } else {
+      os << numbers[i];
+    }
+    os << ",";
+  }
+  os << "\n};\n\n";
+}
+
+void writeSource(llvm::raw_ostream& os, const Spec& spec,
+                 llvm::StringRef spec_name, llvm::StringRef base) {
+  os << "// Generated by commandline-optgen from " << spec_name
+     << ". Do not edit.\n\n"
+     << "#include \"" << base << ".h\"\n\n";
+  if (!spec.Namespace.empty()) {
+    os << "namespace " << spec.Namespace << " {\n\n";
+  }
+  os << "namespace {\n\n";
+
+  std::vector<std::string> written;
+  for (const OptionSpec& option : spec.Options) {
+    if (option.EnumName.empty() ||
+        llvm::is_contained(written, option.EnumName)) {
+      continue;
+    }
+    written.push_back(option.EnumName);
+    os << "constexpr Commandline::static_enum_value k" << option.EnumName
+       << "Values[] = {\n";
+    for (size_t i = 0; i < option.Values.size(); ++i) {
+      os << "    {" << quote(option.Values[i].Name) << ", "
+         << quote(option.Values[i].Help) << ", " << i << "},\n";
+    }
+    os << "};\n\n";
+  }
+
+  int positional = -1;
+  os << "constexpr Commandline::static_option_info kInfos[] = {\n";
+  for (size_t i = 0; i < spec.Options.size(); ++i) {
+    const OptionSpec& option = spec.Options[i];
+    if (option.Name.empty()) {
+      positional = static_cast<int>(i);
+    }
+    os << "    {" << quote(option.Name) << ", " << quote(option.Help) << ", "
+       << quote(option.ValueName)
+       << ", Commandline::static_option_kind::" << kindName(option.Kind);
+    if (!option.EnumName.empty()) {
+      os << ", k" << option.EnumName << "Values, " << option.Values.size();
+    }
+    os << "},\n";
+  }
+  os << "};\n\n";
+
+  HashTables tables = buildHash(spec.Options);
+  writeNumbers(os, "kBucketSeeds", tables.BucketSeeds);
+  writeNumbers(os, "kSlots", tables.Slots);
+
+  os << "constexpr char kHelp[] =";
+  std::string rendered = renderHelp(spec);
+  llvm::StringRef help = rendered;
+  while (!help.empty()) {
+    size_t end = help.find('\n');
+    end = end == llvm::StringRef::npos ? help.size() : end + 1;
+    os << "\n    ";
+    writeStringLiteral(os, help.take_front(end));
+    help = help.drop_front(end);
+  }
+  os << ";\n\n";
+
+  const std::string& config = spec.Struct;
+  os << "auto applyOption(" << config
+     << "& values, size_t index, llvm::StringRef arg)\n"
+     << "    -> const char* {\n"
+     << "  switch (index) {\n";
+  for (size_t i = 0; i < spec.Options.size(); ++i) {
+    const OptionSpec& option = spec.Options[i];
+    os << "    case " << i << ":\n";
+    if (option.EnumName.empty()) {
+      os << "      return Commandline::applyStaticValue(arg, values."
+         << option.Field << ");\n";
+    } else {
+      os << "      return Commandline::applyStaticEnum(arg, k"
+         << option.EnumName << "Values, " << option.Values.size()
+         << ", values." << option.Field << ");\n";
+    }
+  }
+  os << "  }\n  return nullptr;\n}\n\n";
+
+  os << "void resetOption(" << config << "& values, const " << config
+     << "& defaults, size_t index) {\n"
+     << "  switch (index) {\n";
+  for (size_t i = 0; i < spec.Options.size(); ++i) {
+    const std::string& field = spec.Options[i].Field;
+    os << "    case " << i << ":\n"
+       << "      values." << field << " = defaults." << field << ";\n"
+       << "      break;\n";
+  }
+  os << "  }\n}\n\n";
+
+  os << "}  // namespace\n\n"
+     << "constexpr Commandline::generated_options<" << config << "> " << config
+     << "Options(\n"
+     << "    kInfos, kBucketSeeds, kSlots, " << positional
+     << ", kHelp, &applyOption, &resetOption);\n";
+  if (!spec.Namespace.empty()) {
+    os << "\n}  // namespace " << spec.Namespace << "\n";
+  }
+}
+
+// Write text to path unless the file already holds it, so that unchanged
+// output does not trigger rebuilds.
+auto writeIfChanged(llvm::StringRef path, llvm::StringRef text)
+    -> llvm::Error {
+  if (auto existing = llvm::MemoryBuffer::getFile(path)) {
+    if ((*existing)->getBuffer() == text) {
+      return llvm::Error::success();
+    }
+  }
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  if (ec) {
+    return llvm::createStringError(ec, "cannot write " + path + ": " +
+                                           ec.message());
+  }
+  os << text;
+  return llvm::Error::success();
+}
+
+auto run() -> llvm::Error {
+  auto buffer = llvm::MemoryBuffer::getFile(SpecPath);
+  if (!buffer) {
+    return llvm::createStringError(buffer.getError(),
+                                   "cannot read " + SpecPath + ": " +
+                                       buffer.getError().message());
+  }
+  Spec spec;
+  if (llvm::Error error = parseSpec((*buffer)->getBuffer(), spec)) {
+    return error;
+  }
+
+  llvm::StringRef spec_name = llvm::sys::path::filename(SpecPath);
+  llvm::StringRef base = llvm::sys::path::filename(OutputBase);
+  std::string header;
+  std::string source;
+  {
+    llvm::raw_string_ostream os(header);
+    writeHeader(os, spec, spec_name, base);
+  }
+  {
+    llvm::raw_string_ostream os(source);
+    writeSource(os, spec, spec_name, base);
+  }
+  if (llvm::Error error = writeIfChanged(OutputBase + ".h", header)) {
+    return error;
+  }
+  return writeIfChanged(OutputBase + ".cc", source);
+}
+
+}  // namespace
+
+}  // namespace Commandline
+
+auto main(int argc, char** argv) -> int {
+  Commandline::ParseCommandLineOptions(
+      argc, argv, "Generate a config struct and option tables from a spec\n");
+  if (llvm::Error error = Commandline::run()) {
+    llvm::errs() << "commandline-optgen: " << Commandline::SpecPath << ": "
+                 << llvm::toString(std::move(error)) << "\n";
+    return 1;
+  }
+  return 0;
+}